@@ -16,6 +16,7 @@
 #include <QOpenGLShaderProgram>
 #include <QString>
 #include "Game.h"
+#include "DxtLib.h"
 
 bool AceLib::IsThread = true;
 
@@ -113,6 +114,7 @@ void AceLib::run() {
     }
         
     int ptr = 0;
+    unsigned char* dxt1 = NULL;
     if (texture->compressed != 18) {
         int iw = 0, ite;
         if (typ == 0) ptr = 216 + offset;
@@ -193,6 +195,7 @@ void AceLib::run() {
             ptr += 4;
             tempp = tempp / 2;
         }
+        dxt1 = bufor + ptr;
 
         unsigned short c[5] = {0,0,0,0,0};
         unsigned char r[4] = {0,0,0,0};
@@ -287,7 +290,10 @@ void AceLib::run() {
         texture->imageData = nd;
         texture->width = nw;
         texture->height = nh;
+        dxt1 = NULL;
     }
+    if(Game::compressedTextures)
+        DxtLib::Compress(texture, dxt1);
     texture->loaded = true;
     texture->editable = true;        
     //qDebug() << "--";
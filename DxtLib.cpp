@@ -0,0 +1,217 @@
+/*  This file is part of TSRE5.
+ *
+ *  TSRE5 - train sim game engine and MSTS/OR Editors. 
+ *  Copyright (C) 2016 Piotr Gadecki <pgadecki@gmail.com>
+ *
+ *  Licensed under GNU General Public License 3.0 or later. 
+ *
+ *  See LICENSE.md or https://www.gnu.org/licenses/gpl.html
+ */
+
+#include "DxtLib.h"
+#include "Texture.h"
+#include "Game.h"
+#include <QByteArray>
+#include <QOpenGLShaderProgram>
+
+static unsigned short to565(const int *c){
+    return (unsigned short)((((c[0] * 31 + 127) / 255) << 11) | (((c[1] * 63 + 127) / 255) << 5) | ((c[2] * 31 + 127) / 255));
+}
+
+static void from565(unsigned short c, int *out){
+    out[0] = ((c >> 11) << 3) | (c >> 13);
+    out[1] = (((c >> 5) & 0x3f) << 2) | ((c >> 9) & 0x3);
+    out[2] = ((c & 0x1f) << 3) | ((c >> 2) & 0x7);
+}
+
+// Level data for every mip down to 1x1 in texture->compressedLevels.
+// Given the DXT1 payload of an ACE file, it is kept as the first level.
+void DxtLib::Compress(Texture *t, const unsigned char *dxt1){
+    if(t->imageData == NULL || t->width <= 0 || t->height <= 0 || (t->bytesPerPixel != 3 && t->bytesPerPixel != 4))
+        return;
+    bool alpha = t->bytesPerPixel == 4;
+    unsigned int format = alpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    if(dxt1 != NULL)
+        format = alpha ? GL_COMPRESSED_RGBA_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    t->removeBorderAlpha();
+    bool keepSource = dxt1 != NULL && t->width % 4 == 0 && t->height % 4 == 0
+            && !(alpha && Game::AASamples > 0 && Game::AARemoveBorder);
+
+    int width = t->width;
+    int height = t->height;
+    QVector<unsigned char> rgba(width * height * 4);
+    for(int i = 0; i < width * height; i++){
+        rgba[i*4] = t->imageData[i*t->bytesPerPixel];
+        rgba[i*4 + 1] = t->imageData[i*t->bytesPerPixel + 1];
+        rgba[i*4 + 2] = t->imageData[i*t->bytesPerPixel + 2];
+        rgba[i*4 + 3] = alpha ? t->imageData[i*t->bytesPerPixel + 3] : 255;
+    }
+
+    int blockBytes = format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT ? 16 : 8;
+    QVector<QByteArray> levels;
+    while(true){
+        QByteArray level(((width + 3) / 4) * ((height + 3) / 4) * blockBytes, 0);
+        if(levels.size() == 0 && keepSource)
+            memcpy(level.data(), dxt1, level.size());
+        else
+            encodeLevel(rgba.constData(), width, height, format, (unsigned char*)level.data());
+        levels.push_back(level);
+        if(width == 1 && height == 1)
+            break;
+        downsample(rgba, width, height);
+    }
+    t->compressedLevels = levels;
+    t->compressedFormat = format;
+}
+
+// One 4x4 RGBA block to 8 bytes. With alpha, pixels below half alpha
+// are left transparent in the three color mode.
+void DxtLib::EncodeBC1(const unsigned char *block, unsigned char *out, bool alpha){
+    int mn[3] = {255, 255, 255};
+    int mx[3] = {0, 0, 0};
+    bool transparent = false;
+    for(int i = 0; i < 16; i++){
+        if(alpha && block[i*4 + 3] < 128){
+            transparent = true;
+            continue;
+        }
+        for(int k = 0; k < 3; k++){
+            mn[k] = qMin(mn[k], (int)block[i*4 + k]);
+            mx[k] = qMax(mx[k], (int)block[i*4 + k]);
+        }
+    }
+    if(mn[0] > mx[0]){
+        // nothing but transparent pixels
+        memset(out, 0, 4);
+        memset(out + 4, 0xff, 4);
+        return;
+    }
+    // pulled in a little, the extremes are seldom worth an endpoint
+    for(int k = 0; k < 3; k++){
+        int inset = (mx[k] - mn[k]) >> 4;
+        mn[k] += inset;
+        mx[k] -= inset;
+    }
+
+    unsigned short c0 = to565(mx);
+    unsigned short c1 = to565(mn);
+    if(transparent ? c0 > c1 : c0 < c1)
+        qSwap(c0, c1);
+    int p[4][3];
+    from565(c0, p[0]);
+    from565(c1, p[1]);
+    int colors = c0 > c1 ? 4 : 3;
+    for(int k = 0; k < 3; k++){
+        if(colors == 4){
+            p[2][k] = (2 * p[0][k] + p[1][k]) / 3;
+            p[3][k] = (p[0][k] + 2 * p[1][k]) / 3;
+        } else {
+            p[2][k] = (p[0][k] + p[1][k]) / 2;
+            p[3][k] = 0;
+        }
+    }
+
+    out[0] = c0 & 0xff;
+    out[1] = c0 >> 8;
+    out[2] = c1 & 0xff;
+    out[3] = c1 >> 8;
+    for(int ii = 0; ii < 4; ii++){
+        unsigned char bits = 0;
+        for(int jj = 0; jj < 4; jj++){
+            const unsigned char *px = block + (ii*4 + jj)*4;
+            int best = 3;
+            if(!alpha || px[3] >= 128){
+                int bestDist = 0x7fffffff;
+                for(int o = 0; o < colors; o++){
+                    int dr = px[0] - p[o][0];
+                    int dg = px[1] - p[o][1];
+                    int db = px[2] - p[o][2];
+                    int dist = dr*dr + dg*dg + db*db;
+                    if(dist < bestDist){
+                        bestDist = dist;
+                        best = o;
+                    }
+                }
+            }
+            bits |= best << (jj * 2);
+        }
+        out[4 + ii] = bits;
+    }
+}
+
+// One 4x4 RGBA block to 16 bytes, eight step alpha and a four color block.
+void DxtLib::EncodeBC3(const unsigned char *block, unsigned char *out){
+    int a0 = 0;
+    int a1 = 255;
+    for(int i = 0; i < 16; i++){
+        a0 = qMax(a0, (int)block[i*4 + 3]);
+        a1 = qMin(a1, (int)block[i*4 + 3]);
+    }
+    int a[8];
+    a[0] = a0;
+    a[1] = a1;
+    for(int i = 1; i < 7; i++)
+        a[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+
+    out[0] = a0;
+    out[1] = a1;
+    unsigned long long int bits = 0;
+    for(int i = 0; i < 16; i++){
+        int best = 0;
+        int bestDist = 256;
+        for(int o = 0; o < (a0 > a1 ? 8 : 1); o++){
+            int dist = qAbs(block[i*4 + 3] - a[o]);
+            if(dist < bestDist){
+                bestDist = dist;
+                best = o;
+            }
+        }
+        bits |= (unsigned long long int)best << (i * 3);
+    }
+    for(int i = 0; i < 6; i++)
+        out[2 + i] = (bits >> (i * 8)) & 0xff;
+    EncodeBC1(block, out + 8, false);
+}
+
+void DxtLib::encodeLevel(const unsigned char *rgba, int width, int height, unsigned int format, unsigned char *out){
+    unsigned char block[64];
+    for(int by = 0; by < height; by += 4){
+        for(int bx = 0; bx < width; bx += 4){
+            // edge blocks of small levels repeat the last row and column
+            for(int ii = 0; ii < 4; ii++){
+                int y = qMin(by + ii, height - 1);
+                for(int jj = 0; jj < 4; jj++){
+                    int x = qMin(bx + jj, width - 1);
+                    memcpy(block + (ii*4 + jj)*4, rgba + (y*width + x)*4, 4);
+                }
+            }
+            if(format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT){
+                EncodeBC3(block, out);
+                out += 16;
+            } else {
+                EncodeBC1(block, out, format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT);
+                out += 8;
+            }
+        }
+    }
+}
+
+void DxtLib::downsample(QVector<unsigned char> &rgba, int &width, int &height){
+    int w = qMax(width / 2, 1);
+    int h = qMax(height / 2, 1);
+    QVector<unsigned char> out(w * h * 4);
+    for(int y = 0; y < h; y++){
+        int y0 = qMin(y*2, height - 1);
+        int y1 = qMin(y*2 + 1, height - 1);
+        for(int x = 0; x < w; x++){
+            int x0 = qMin(x*2, width - 1);
+            int x1 = qMin(x*2 + 1, width - 1);
+            for(int k = 0; k < 4; k++)
+                out[(y*w + x)*4 + k] = (rgba[(y0*width + x0)*4 + k] + rgba[(y0*width + x1)*4 + k]
+                        + rgba[(y1*width + x0)*4 + k] + rgba[(y1*width + x1)*4 + k] + 2) / 4;
+        }
+    }
+    rgba.swap(out);
+    width = w;
+    height = h;
+}
@@ -0,0 +1,42 @@
+/*  This file is part of TSRE5.
+ *
+ *  TSRE5 - train sim game engine and MSTS/OR Editors. 
+ *  Copyright (C) 2016 Piotr Gadecki <pgadecki@gmail.com>
+ *
+ *  Licensed under GNU General Public License 3.0 or later. 
+ *
+ *  See LICENSE.md or https://www.gnu.org/licenses/gpl.html
+ */
+
+#ifndef DXTLIB_H
+#define DXTLIB_H
+
+#include <QVector>
+
+class Texture;
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+// BC1/BC3 encoding of loaded textures with their whole mip chain, run on
+// the loader thread so the GL thread only uploads the levels. Encoding
+// is a fast bounding box fit, not the best quality a tool gives.
+class DxtLib {
+public:
+    static void Compress(Texture *t, const unsigned char *dxt1 = NULL);
+    static void EncodeBC1(const unsigned char *block, unsigned char *out, bool alpha);
+    static void EncodeBC3(const unsigned char *block, unsigned char *out);
+
+private:
+    static void encodeLevel(const unsigned char *rgba, int width, int height, unsigned int format, unsigned char *out);
+    static void downsample(QVector<unsigned char> &rgba, int &width, int &height);
+};
+
+#endif /* DXTLIB_H */
@@ -64,6 +64,8 @@ WorldObj* DynTrackObj::clone(){
 }
 
 DynTrackObj::~DynTrackObj() {
+    if(proceduralShape)
+        ProceduralShape::Release(shape);
 }
 
 bool DynTrackObj::allowNew(){
@@ -126,11 +128,24 @@ void DynTrackObj::rotate(float x, float y, float z){
 void DynTrackObj::deleteVBO(){
     //this->shape.deleteVBO();
     this->init = false;
+    // procedural shapes are shared, only MSTS style ones are owned here
+    if(proceduralShape)
+        ProceduralShape::Release(shape);
+    proceduralShape = false;
     for(int i = 0; i < shape.size(); i++){
         shape[i]->deleteVBO();
         delete shape[i];
     }
     shape.clear();
+    deletePlaceholder();
+}
+
+void DynTrackObj::deletePlaceholder(){
+    for(int i = 0; i < placeholder.size(); i++){
+        placeholder[i]->deleteVBO();
+        delete placeholder[i];
+    }
+    placeholder.clear();
 }
 
 void DynTrackObj::removedFromTDB(){
@@ -367,37 +382,25 @@ void DynTrackObj::render(GLUU* gluu, float lod, float posx, float posz, float* p
 
     if (!init) {
         QVector<TSection> tsections;
-        for(int i = 0; i < 5; i++){
-            if(sections[i].sectIdx > 100000000)
-                continue;
-            tsections.push_back(TSection(0, sections[i].type, sections[i].a, sections[i].r));
-        }
+        QMap<int, float> angles;
+        getProceduralInput(tsections, angles);
         if (Game::proceduralTracks) {
             TrackShape *tsh = Game::trackDB->tsection->shape[sectionIdx];
-            QMap<int, float> angles;
-            if(Game::useSuperelevation){
-                Game::trackDB->fillTrackAngles(x, -y, UiD, angles);
-                bool positiveAngles = false;
-                for(int i = 0; i < tsections.size(); i++){
-                    if(tsections[i].angle > 0)
-                        positiveAngles = true;
-                }
-                if(positiveAngles){
-                    QList<int> keys = angles.keys();
-                    for(int j = 0; j < keys.size(); j++){
-                        angles[keys[j]] = -angles[keys[j]];
-                    }
-                }
-            }
-            ProceduralShape::GetShape(templateName, shape, tsh, angles);
+            init = ProceduralShape::GetShape(templateName, shape, tsh, angles);
+            proceduralShape = init;
+            // MSTS style dyntrack until the procedural shape is generated
+            if(!init && placeholder.size() == 0)
+                ProceduralMstsDyntrack::GenShape(placeholder, tsections);
+            if(init)
+                deletePlaceholder();
         } else {
             ProceduralMstsDyntrack::GenShape(shape, tsections);
+            init = true;
         }
-        init = true;
-    } else {
-        for(int i = 0; i < shape.size(); i++){
-            shape[i]->render(selectionColor);
-        }
+    }
+    QVector<OglObj*> &drawn = init ? shape : placeholder;
+    for(int i = 0; i < drawn.size(); i++){
+        drawn[i]->render(selectionColor);
     }
     
     if(selected){
@@ -405,6 +408,38 @@ void DynTrackObj::render(GLUU* gluu, float lod, float posx, float posz, float* p
     }   
 };
 
+void DynTrackObj::getProceduralInput(QVector<TSection> &tsections, QMap<int, float> &angles){
+    for(int i = 0; i < 5; i++){
+        if(sections[i].sectIdx > 100000000)
+            continue;
+        tsections.push_back(TSection(0, sections[i].type, sections[i].a, sections[i].r));
+    }
+    if(!Game::useSuperelevation)
+        return;
+    Game::trackDB->fillTrackAngles(x, -y, UiD, angles);
+    bool positiveAngles = false;
+    for(int i = 0; i < tsections.size(); i++){
+        if(tsections[i].angle > 0)
+            positiveAngles = true;
+    }
+    if(positiveAngles){
+        QList<int> keys = angles.keys();
+        for(int j = 0; j < keys.size(); j++){
+            angles[keys[j]] = -angles[keys[j]];
+        }
+    }
+}
+
+bool DynTrackObj::bakeProceduralShape(){
+    if(sections == NULL)
+        return false;
+    QVector<TSection> tsections;
+    QMap<int, float> angles;
+    getProceduralInput(tsections, angles);
+    TrackShape *tsh = Game::trackDB->tsection->shape[sectionIdx];
+    return ProceduralShape::Bake(templateName, tsh, angles);
+}
+
 bool DynTrackObj::getSimpleBorder(float* border){
     if(shape.size() > 0){
         if(shape[0] != NULL)
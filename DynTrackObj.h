@@ -13,8 +13,10 @@
 
 #include "WorldObj.h"
 #include <QString>
+#include <QMap>
 
 class OglObj;
+class TSection;
 
 class DynTrackObj : public WorldObj {
 public:
@@ -46,15 +48,20 @@ public:
     int getDefaultDetailLevel();
     int updateTrackSectionInfo(QHash<unsigned int, unsigned int> shapes, QHash<unsigned int, unsigned int> sect);
     void render(GLUU* gluu, float lod, float posx, float posz, float* playerW, float* target, float fov, int selectionColor, int renderMode);
+    bool bakeProceduralShape();
 private:
     int tex1;
     int tex2;
     bool init;
+    bool proceduralShape = false;
+    QVector<OglObj*> placeholder;
     float elevation;
     float* jNodePosn = NULL;
     int sidxSelected = 0;
     bool getSimpleBorder(float* border);
     bool getBoxPoints(QVector<float> &points);
+    void deletePlaceholder();
+    void getProceduralInput(QVector<TSection> &tsections, QMap<int, float> &angles);
 };
 
 #endif	/* DYNTRACKOBJ_H */
@@ -16,6 +16,7 @@
 #include "SFile.h"
 #include <QDebug>
 #include <QFile>
+#include <QDataStream>
 #include "Game.h"
 #include "GLUU.h"
 #include "OglObj.h"
@@ -343,6 +344,8 @@ void Eng::load(){
                             
                             // if(Game::debugOutput) qDebug() << __FILE__ << __LINE__ << "Load-OR Attributes: " << loadpath;
                             
+                            // listed even when missing, the catalog sees it appear
+                            addToFileList(loadpath);
                             QFile file(loadpath);
                             if (!file.open(QIODevice::ReadOnly)) {
                                 if(Game::debugOutput) qDebug() << __FILE__ << __LINE__<< ": Error opening file:" << file.errorString();
@@ -604,6 +607,49 @@ void Eng::load(){
     return;
 }
 
+// Everything load() reads, written to the trainset catalog of EngLib.
+// Shape ids are runtime data and are not stored.
+void Eng::saveCatalog(QDataStream &out){
+    out << name << path << pathid << orpathid << orpath;
+    out << filePaths;
+    out << (qint32)coupling.size();
+    for(int i = 0; i < coupling.size(); i++)
+        out << coupling[i].type << coupling[i].r0[0] << coupling[i].r0[1] << coupling[i].velocity;
+    out << shape.name << shape.altpath << shape.x << shape.y << shape.z;
+    out << (qint32)freightanimShape.size();
+    for(int i = 0; i < freightanimShape.size(); i++)
+        out << freightanimShape[i].name << freightanimShape[i].altpath 
+            << freightanimShape[i].x << freightanimShape[i].y << freightanimShape[i].z;
+    out << engName << displayName << searchKeywords << engType << typeHash << type << brakeSystemType;
+    out << (qint32)wagonTypeId << mass << sizex << sizey << sizez;
+    out << maxSpeed << maxForce << maxPower << maxCurrent;
+    out << souncCabFile << (qint32)flip << (qint32)loaded << kierunek;
+}
+
+void Eng::loadCatalog(QDataStream &in){
+    qint32 count, val;
+    in >> name >> path >> pathid >> orpathid >> orpath;
+    in >> filePaths;
+    in >> count;
+    coupling.resize(count);
+    for(int i = 0; i < coupling.size(); i++)
+        in >> coupling[i].type >> coupling[i].r0[0] >> coupling[i].r0[1] >> coupling[i].velocity;
+    in >> shape.name >> shape.altpath >> shape.x >> shape.y >> shape.z;
+    in >> count;
+    freightanimShape.resize(count);
+    for(int i = 0; i < freightanimShape.size(); i++)
+        in >> freightanimShape[i].name >> freightanimShape[i].altpath 
+            >> freightanimShape[i].x >> freightanimShape[i].y >> freightanimShape[i].z;
+    in >> engName >> displayName >> searchKeywords >> engType >> typeHash >> type >> brakeSystemType;
+    in >> val >> mass >> sizex >> sizey >> sizez;
+    wagonTypeId = val;
+    in >> maxSpeed >> maxForce >> maxPower >> maxCurrent;
+    in >> souncCabFile >> val;
+    flip = val;
+    in >> val >> kierunek;
+    loaded = val;
+}
+
 bool Eng::engFilter(QString q){
     if(q == "") return true;
     if(q == "electric" && wagonTypeId == 4)
@@ -20,6 +20,7 @@ class Ruch;
 class SoundVariables;
 class TrainNetworkEng;
 class ContentHierarchyInfo;
+class QDataStream;
 
 class Eng {
 public:
@@ -76,6 +77,8 @@ public:
     Eng(QString p, QString n);
     Eng(QString src, QString p, QString n);
     void load();
+    void saveCatalog(QDataStream &out);
+    void loadCatalog(QDataStream &in);
     float getFullWidth();
     QString getCouplingsName();
     void select();
@@ -0,0 +1,191 @@
+/*  This file is part of TSRE5.
+ *
+ *  TSRE5 - train sim game engine and MSTS/OR Editors. 
+ *  Copyright (C) 2016 Piotr Gadecki <pgadecki@gmail.com>
+ *
+ *  Licensed under GNU General Public License 3.0 or later. 
+ *
+ *  See LICENSE.md or https://www.gnu.org/licenses/gpl.html
+ */
+
+#include "EngIndex.h"
+#include "Eng.h"
+#include <QStringList>
+#include <algorithm>
+#include <iterator>
+
+void EngIndex::Push(QVector<int> &list, int id){
+    // ids come in growing order, so lists stay sorted
+    if(list.size() > 0 && list.back() == id)
+        return;
+    list.push_back(id);
+}
+
+void EngIndex::addGrams(QString text, int id){
+    text = text.toLower();
+    if(text.length() == 0)
+        return;
+    if(text.length() < 3){
+        Push(grams[text], id);
+        return;
+    }
+    for(int i = 0; i + 3 <= text.length(); i++)
+        Push(grams[text.mid(i, 3)], id);
+}
+
+void EngIndex::add(int id, Eng *e){
+    if(e == NULL)
+        return;
+    addGrams(e->displayName, id);
+    addGrams(e->engName, id);
+    addGrams(e->searchKeywords, id);
+    addGrams(e->name, id);
+    Push(wagonTypes[e->wagonTypeId], id);
+    for(int i = 0; i < e->coupling.size(); i++)
+        Push(couplings[e->coupling[i].type.toLower()], id);
+    Push(brakes[e->brakeSystemType.toLower()], id);
+    masses.push_back(QPair<float, int>(e->mass, id));
+    lengths.push_back(QPair<float, int>(e->sizez, id));
+    rangesSorted = false;
+    Push(all, id);
+}
+
+void EngIndex::clear(){
+    grams.clear();
+    wagonTypes.clear();
+    couplings.clear();
+    brakes.clear();
+    masses.clear();
+    lengths.clear();
+    all.clear();
+    rangesSorted = true;
+}
+
+void EngIndex::Intersect(QVector<int> &result, const QVector<int> &list, bool &first){
+    if(first){
+        result = list;
+        first = false;
+        return;
+    }
+    QVector<int> out;
+    std::set_intersection(result.begin(), result.end(), list.begin(), list.end(), std::back_inserter(out));
+    result = out;
+}
+
+QVector<int> EngIndex::Range(QVector<QPair<float, int>> &values, float min, float max){
+    QVector<int> list;
+    auto it = values.begin();
+    if(min >= 0)
+        it = std::lower_bound(values.begin(), values.end(), QPair<float, int>(min, -1));
+    for(; it != values.end(); ++it){
+        if(max >= 0 && it->first > max)
+            break;
+        list.push_back(it->second);
+    }
+    std::sort(list.begin(), list.end());
+    return list;
+}
+
+QVector<int> EngIndex::search(Query &q, const std::unordered_map<int, Eng*> &eng){
+    if(!rangesSorted){
+        std::sort(masses.begin(), masses.end());
+        std::sort(lengths.begin(), lengths.end());
+        rangesSorted = true;
+    }
+    
+    // smallest facets first keeps intersections short
+    QVector<int> result;
+    bool first = true;
+    if(q.wagonTypeId != -1)
+        Intersect(result, wagonTypes.value(q.wagonTypeId), first);
+    if(q.coupling.length() > 0)
+        Intersect(result, couplings.value(q.coupling.toLower()), first);
+    if(q.brake.length() > 0)
+        Intersect(result, brakes.value(q.brake.toLower()), first);
+    
+    QString text = q.text.toLower();
+    if(text.length() >= 3){
+        for(int i = 0; i + 3 <= text.length(); i++){
+            Intersect(result, grams.value(text.mid(i, 3)), first);
+            if(result.size() == 0)
+                break;
+        }
+    } else if(text.length() > 0){
+        // too short for trigrams, look through the keys instead
+        QVector<int> list;
+        for(auto it = grams.begin(); it != grams.end(); ++it)
+            if(it.key().contains(text))
+                list += it.value();
+        std::sort(list.begin(), list.end());
+        list.erase(std::unique(list.begin(), list.end()), list.end());
+        Intersect(result, list, first);
+    }
+    
+    if(q.massMin >= 0 || q.massMax >= 0)
+        Intersect(result, Range(masses, q.massMin, q.massMax), first);
+    if(q.lengthMin >= 0 || q.lengthMax >= 0)
+        Intersect(result, Range(lengths, q.lengthMin, q.lengthMax), first);
+    if(first)
+        result = all;
+    
+    // trigrams only narrow it down, text is checked on what is left
+    QVector<int> out;
+    for(int i = 0; i < result.size(); i++){
+        auto it = eng.find(result[i]);
+        if(it == eng.end()) continue;
+        Eng *e = it->second;
+        if(e == NULL) continue;
+        if(e->loaded != 1) continue;
+        if(text.length() > 0)
+            if(!e->searchFilter(text) && !e->name.contains(text, Qt::CaseInsensitive))
+                continue;
+        out.push_back(result[i]);
+    }
+    return out;
+}
+
+bool EngIndex::ParseRange(QString val, float &min, float &max){
+    QStringList parts = val.split("-");
+    if(parts.size() == 1)
+        parts.push_back(parts[0]);
+    if(parts.size() != 2)
+        return false;
+    bool ok = true;
+    if(parts[0].length() > 0)
+        min = parts[0].toFloat(&ok);
+    if(ok && parts[1].length() > 0)
+        max = parts[1].toFloat(&ok);
+    return ok;
+}
+
+EngIndex::Query EngIndex::ParseQuery(QString engFilter, QString couplingFilter, QString searchText){
+    Query q;
+    QHash<QString, int> types;
+    types["carriage"] = 1;
+    types["freight"] = 2;
+    types["tender"] = 3;
+    types["electric"] = 4;
+    types["diesel"] = 5;
+    types["steam"] = 6;
+    types["eot"] = 7;
+    if(engFilter.length() > 0)
+        q.wagonTypeId = types.value(engFilter, -2);
+    q.coupling = couplingFilter;
+    
+    QStringList text;
+    foreach(QString word, searchText.split(" ", QString::SkipEmptyParts)){
+        QString key = word.section(":", 0, 0).toLower();
+        QString val = word.section(":", 1);
+        if(key == "mass" && ParseRange(val, q.massMin, q.massMax))
+            continue;
+        if(key == "length" && ParseRange(val, q.lengthMin, q.lengthMax))
+            continue;
+        if(key == "brake" && val.length() > 0){
+            q.brake = val;
+            continue;
+        }
+        text.push_back(word);
+    }
+    q.text = text.join(" ");
+    return q;
+}
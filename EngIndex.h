@@ -0,0 +1,62 @@
+/*  This file is part of TSRE5.
+ *
+ *  TSRE5 - train sim game engine and MSTS/OR Editors. 
+ *  Copyright (C) 2016 Piotr Gadecki <pgadecki@gmail.com>
+ *
+ *  Licensed under GNU General Public License 3.0 or later. 
+ *
+ *  See LICENSE.md or https://www.gnu.org/licenses/gpl.html
+ */
+
+#ifndef ENGINDEX_H
+#define	ENGINDEX_H
+
+#include <unordered_map>
+#include <QString>
+#include <QHash>
+#include <QVector>
+#include <QPair>
+
+class Eng;
+
+// Inverted index over the rolling stock of EngLib. Names are split into
+// trigrams, so substring search only looks at entries sharing them.
+// Type, coupling and brake are facets, mass and length are ranges.
+// Entries are added as EngLib loads them.
+class EngIndex {
+public:
+    struct Query {
+        QString text;
+        int wagonTypeId = -1;
+        QString coupling;
+        QString brake;
+        float massMin = -1;
+        float massMax = -1;
+        float lengthMin = -1;
+        float lengthMax = -1;
+    };
+    
+    void add(int id, Eng *e);
+    void clear();
+    QVector<int> search(Query &q, const std::unordered_map<int, Eng*> &eng);
+    // search box text may hold "mass:40-80", "length:-20" or "brake:vacuum"
+    static Query ParseQuery(QString engFilter, QString couplingFilter, QString searchText);
+    
+private:
+    QHash<QString, QVector<int>> grams;
+    QHash<int, QVector<int>> wagonTypes;
+    QHash<QString, QVector<int>> couplings;
+    QHash<QString, QVector<int>> brakes;
+    QVector<QPair<float, int>> masses;
+    QVector<QPair<float, int>> lengths;
+    QVector<int> all;
+    bool rangesSorted = true;
+    
+    void addGrams(QString text, int id);
+    static void Push(QVector<int> &list, int id);
+    static void Intersect(QVector<int> &result, const QVector<int> &list, bool &first);
+    static QVector<int> Range(QVector<QPair<float, int>> &values, float min, float max);
+    static bool ParseRange(QString val, float &min, float &max);
+};
+
+#endif	/* ENGINDEX_H */
@@ -16,10 +16,35 @@
 #include <QDateTime>
 #include <QProgressDialog>
 #include <QCoreApplication>
+#include <QFileInfo>
+#include <QDataStream>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QAtomicInt>
 #include "Game.h"
 
 //int EngLib::jesteng = 0;
 //std::unordered_map<int, Eng*> EngLib::eng;
+
+namespace {
+const quint32 CatalogMagic = 0x474E4554; // "TENG"
+const quint32 CatalogVersion = 1;
+}
+
+// Eng files don't share anything while parsing, so they load side by side.
+class EngLoadTask : public QRunnable {
+public:
+    QString pathid;
+    QString path;
+    QString name;
+    Eng **out;
+    QAtomicInt *done;
+
+    void run(){
+        *out = new Eng(pathid, path, name);
+        done->fetchAndAddRelaxed(1);
+    }
+};
     
 EngLib::EngLib() {
 }
@@ -35,23 +60,27 @@ int EngLib::getEngByPointer(Eng* pointer){
     return -1;
 }
 
-int EngLib::addEng(QString path, QString name) {
+QString EngLib::MakePathid(QString path, QString name){
     QString pathid = (path + "/" + name).toLower();
     pathid.replace("\\", "/");
     pathid.replace("//", "/");
+    return pathid;
+}
+
+int EngLib::addEng(QString path, QString name) {
+    QString pathid = MakePathid(path, name);
     //qDebug() << pathid;
-    for ( auto it = eng.begin(); it != eng.end(); ++it ){
-        if(it->second == NULL) continue;
-        if (((Eng*) it->second)->pathid.length() == pathid.length())
-            if (((Eng*) it->second)->pathid == pathid) {
-                ((Eng*) it->second)->ref++;
-                //qDebug() <<"engid "<< pathid;
-                return (int)it->first;
-            }
+    int id = engByPathid.value(pathid, -1);
+    if(id >= 0 && eng[id] != NULL){
+        eng[id]->ref++;
+        //qDebug() <<"engid "<< pathid;
+        return id;
     }
     //qDebug() << "Nowy " << jesteng << " eng: " << pathid;
 
     eng[jesteng] = new Eng(pathid, path, name);
+    engByPathid[pathid] = jesteng;
+    index.add(jesteng, eng[jesteng]);
     // qDebug() << "EngLib 49 : "<< pathid << " ~ emass: " << eng[jesteng]->mass ;
 
     return jesteng++;
@@ -68,16 +97,20 @@ int EngLib::removeBroken() {
 
 void EngLib::removeAll(){
     eng.clear();
+    engByPathid.clear();
+    index.clear();
     jesteng = 0;
 }
 
 int EngLib::getEngByPathid(QString pathid) {
+    int id = engByPathid.value(pathid, -1);
+    if(id >= 0 && eng[id] != NULL)
+        return id;
+    // broken files change their pathid while loading
     for ( auto it = eng.begin(); it != eng.end(); ++it ){
         if(it->second == NULL) continue;
-        if (((Eng*) it->second)->pathid.length() == pathid.length())
-            if (((Eng*) it->second)->pathid == pathid) {
-                return (int)it->first;
-            }
+        if (((Eng*) it->second)->pathid == pathid)
+            return (int)it->first;
     }
     return -1;
 }
@@ -129,22 +162,139 @@ int EngLib::loadAll(QString gameRoot, bool gui){
         }
     }
     
+    // unchanged files come from the catalog, the rest is parsed in parallel
+    QHash<QString, Eng*> catalog = LoadCatalog(gameRoot);
+    QVector<Eng*> loaded(dirPaths.size(), NULL);
+    QVector<QString> pathids(dirPaths.size());
+    QVector<EngLoadTask*> tasks;
+    QAtomicInt done(0);
+    for(int i = 0; i < dirPaths.size(); i++){
+        pathids[i] = MakePathid(dirPaths[i], engPaths[i]);
+        int id = engByPathid.value(pathids[i], -1);
+        if(id >= 0 && eng[id] != NULL){
+            // registered already, its catalog entry stays and is saved again
+            delete catalog.take(pathids[i]);
+            continue;
+        }
+        loaded[i] = catalog.take(pathids[i]);
+        if(loaded[i] != NULL)
+            continue;
+        EngLoadTask *task = new EngLoadTask();
+        task->setAutoDelete(false);
+        task->pathid = pathids[i];
+        task->path = dirPaths[i];
+        task->name = engPaths[i];
+        task->out = &loaded[i];
+        task->done = &done;
+        tasks.push_back(task);
+    }
+    int removed = catalog.size();
+    qDeleteAll(catalog);
+    if(Game::debugOutput) qDebug() << "eng catalog" << dirPaths.size() - tasks.size() << "parse" << tasks.size();
+    
     QProgressDialog *progress = NULL;
-    if(gui){
-        progress = new QProgressDialog("Loading TRAINS...", "", 0, dirPaths.size());
+    if(gui && tasks.size() > 0){
+        progress = new QProgressDialog("Loading TRAINS...", "", 0, tasks.size());
         progress->setWindowModality(Qt::WindowModal);
         progress->setCancelButton(NULL);
         progress->setWindowFlags(Qt::CustomizeWindowHint);
     }
-    for(int i = 0; i < dirPaths.size(); i++){
-        //qDebug() << path << dirFile <<"/"<< engfile;
-        addEng(dirPaths[i],engPaths[i]);
+    for(int i = 0; i < tasks.size(); i++)
+        QThreadPool::globalInstance()->start(tasks[i]);
+    while(!QThreadPool::globalInstance()->waitForDone(50)){
         if(progress != NULL){
-            progress->setValue(i+1);
+            progress->setValue(done.load());
             QCoreApplication::processEvents(QEventLoop::AllEvents, 50);
         }
     }
+    qDeleteAll(tasks);
+    
+    for(int i = 0; i < dirPaths.size(); i++){
+        if(loaded[i] == NULL) continue;
+        eng[jesteng] = loaded[i];
+        engByPathid[pathids[i]] = jesteng;
+        index.add(jesteng, loaded[i]);
+        jesteng++;
+    }
+    // files registered before are saved with the rest
+    for(int i = 0; i < dirPaths.size(); i++){
+        int id = engByPathid.value(pathids[i], -1);
+        if(loaded[i] == NULL && id >= 0)
+            loaded[i] = eng[id];
+    }
+    if(tasks.size() > 0 || removed > 0)
+        SaveCatalog(gameRoot, pathids, loaded);
+    
     if(Game::debugOutput) qDebug() << "loaded" << (QDateTime::currentMSecsSinceEpoch() - timeNow)/1000<< "s";
     delete progress;
     return 0;
+}
+
+QString EngLib::CatalogPath(QString gameRoot){
+    QString path = gameRoot + "/cache/trainset.dat";
+    path.replace("\\", "/");
+    path.replace("//", "/");
+    return path;
+}
+
+QVector<qint64> EngLib::FileTimes(Eng *e){
+    QVector<qint64> times;
+    for(int i = 0; i < e->filePaths.size(); i++){
+        QFileInfo info(e->filePaths[i]);
+        if(info.exists())
+            times.push_back(info.lastModified().toMSecsSinceEpoch());
+        else
+            times.push_back(-1);
+    }
+    return times;
+}
+
+QHash<QString, Eng*> EngLib::LoadCatalog(QString gameRoot){
+    QHash<QString, Eng*> catalog;
+    QFile file(CatalogPath(gameRoot));
+    if(!file.open(QIODevice::ReadOnly))
+        return catalog;
+    QDataStream in(&file);
+    quint32 magic, version;
+    bool ortsEng;
+    qint32 count;
+    in >> magic >> version >> ortsEng >> count;
+    if(magic != CatalogMagic || version != CatalogVersion || ortsEng != Game::ortsEngEnable)
+        return catalog;
+    
+    QString pathid;
+    QVector<qint64> times;
+    for(int i = 0; i < count && in.status() == QDataStream::Ok; i++){
+        Eng *e = new Eng();
+        in >> pathid >> times;
+        e->loadCatalog(in);
+        // an entry is only as good as the files it was read from
+        if(in.status() != QDataStream::Ok || times != FileTimes(e)){
+            delete e;
+            continue;
+        }
+        catalog[pathid] = e;
+    }
+    return catalog;
+}
+
+void EngLib::SaveCatalog(QString gameRoot, QVector<QString> &pathids, QVector<Eng*> &list){
+    QFile file(CatalogPath(gameRoot));
+    QDir().mkpath(QFileInfo(file).absolutePath());
+    if(!file.open(QIODevice::WriteOnly)){
+        qDebug() << "eng catalog: failed to write" << file.fileName();
+        return;
+    }
+    qint32 count = 0;
+    for(int i = 0; i < list.size(); i++)
+        if(list[i] != NULL)
+            count++;
+    QDataStream out(&file);
+    out << CatalogMagic << CatalogVersion << Game::ortsEngEnable << count;
+    for(int i = 0; i < list.size(); i++){
+        if(list[i] == NULL) continue;
+        out << pathids[i] << FileTimes(list[i]);
+        list[i]->saveCatalog(out);
+    }
+    file.close();
 }
\ No newline at end of file
@@ -13,6 +13,9 @@
 
 #include <unordered_map>
 #include <QString>
+#include <QHash>
+#include <QVector>
+#include "EngIndex.h"
 
 class Eng;
 
@@ -20,6 +23,7 @@ class EngLib {
 public:
     int jesteng = 0;
     std::unordered_map<int, Eng*> eng;
+    EngIndex index;
     EngLib();
     virtual ~EngLib();
     int addEng(QString path, QString name);
@@ -29,7 +33,13 @@ public:
     int removeBroken();
     void removeAll();
 private:
-
+    QHash<QString, int> engByPathid;
+    static QString MakePathid(QString path, QString name);
+    // parsed trainset of the last loadAll, checked by file times
+    static QString CatalogPath(QString gameRoot);
+    static QVector<qint64> FileTimes(Eng *e);
+    static QHash<QString, Eng*> LoadCatalog(QString gameRoot);
+    static void SaveCatalog(QString gameRoot, QVector<QString> &pathids, QVector<Eng*> &list);
 };
 
 #endif	/* ENGLIB_H */
@@ -100,29 +100,41 @@ void EngListWidget::fs(QString n){
 }
 
 void EngListWidget::fillEngList(){
-    fillEngList("","","");
-}
-
-void EngListWidget::fillEngList(QString engFilter, QString couplingFilter, QString searchFilter){
     items.clear();
 
     Eng * e;
-    totalVal.setText(QString::number(Game::currentEngLib->jesteng));
-    
     for (int i = 0; i < Game::currentEngLib->jesteng; i++){
         e = Game::currentEngLib->eng[i];
         if(e == NULL) continue;
         if(e->loaded !=1) continue;
-        if(!e->engFilter(engFilter)) continue;
-        if(!e->couplingFilter(couplingFilter)) continue;
-        if(!e->searchFilter(searchFilter)) continue;
-        
         new QListWidgetItem ( e->displayName, &items, i);
     }
     items.sortItems(Qt::AscendingOrder);
+    fs("");
+}
+
+void EngListWidget::fillEngList(QString engFilter, QString couplingFilter, QString searchFilter){
+    // the list is built once in fillEngList(), filters only hide items
+    EngIndex::Query q = EngIndex::ParseQuery(engFilter, couplingFilter, searchFilter);
+    QVector<int> ids = Game::currentEngLib->index.search(q, Game::currentEngLib->eng);
+    QVector<bool> visible(Game::currentEngLib->jesteng, false);
+    for(int i = 0; i < ids.size(); i++)
+        visible[ids[i]] = true;
     
-    if(items.count() < Game::currentEngLib->jesteng)
-    totalVal.setText(QString::number(items.count()) + " / " + QString::number(Game::currentEngLib->jesteng));
+    int count = 0;
+    items.setUpdatesEnabled(false);
+    for (int i = 0; i < items.count(); i++){
+        QListWidgetItem *item = items.item(i);
+        bool show = item->type() < visible.size() && visible[item->type()];
+        item->setHidden(!show);
+        if(show) 
+            count++;
+    }
+    items.setUpdatesEnabled(true);
+    
+    totalVal.setText(QString::number(Game::currentEngLib->jesteng));
+    if(count < Game::currentEngLib->jesteng)
+    totalVal.setText(QString::number(count) + " / " + QString::number(Game::currentEngLib->jesteng));
 }
 
 void EngListWidget::itemsSelected(){
@@ -12,6 +12,10 @@
 #include "ErrorMessage.h"
 #include "ErrorMessagesWindow.h"
 
+// messages of the current thread go to this list instead of the window,
+// checks running off the GUI thread hand them over when they are done
+static thread_local QVector<ErrorMessage*>* Collector = NULL;
+
 QVector<ErrorMessage*> ErrorMessagesLib::ErrorMessages;
 ErrorMessagesWindow* ErrorMessagesLib::Window = NULL;
 
@@ -23,6 +27,10 @@ ErrorMessagesWindow* ErrorMessagesLib::GetWindow(QWidget *w){
 
 QString ErrorMessagesLib::PushErrorMessage(ErrorMessage* e){
     QString reply = "";
+    if(Collector != NULL){
+        Collector->push_back(e);
+        return reply;
+    }
     ErrorMessages.push_back(e);
     
     if(Window != NULL)
@@ -32,6 +40,24 @@ QString ErrorMessagesLib::PushErrorMessage(ErrorMessage* e){
     return reply;
 }
 
+void ErrorMessagesLib::PushErrorMessages(QVector<ErrorMessage*> &list){
+    if(list.size() == 0)
+        return;
+    ErrorMessages += list;
+    
+    if(Window != NULL)
+        if(Window->isVisible())
+            Window->refreshErrorList();
+}
+
+void ErrorMessagesLib::BeginCollect(QVector<ErrorMessage*> *list){
+    Collector = list;
+}
+
+void ErrorMessagesLib::EndCollect(){
+    Collector = NULL;
+}
+
 ErrorMessagesLib::ErrorMessagesLib() {
 }
 
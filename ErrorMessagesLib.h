@@ -13,6 +13,7 @@
 
 #include <QHash>
 #include <QString>
+#include <QVector>
 
 class QWidget;
 class ErrorMessage;
@@ -24,6 +25,9 @@ public:
     static QVector<ErrorMessage*> ErrorMessages;
     static ErrorMessagesWindow* GetWindow(QWidget *w);
     static QString PushErrorMessage(ErrorMessage* e);
+    static void PushErrorMessages(QVector<ErrorMessage*> &list);
+    static void BeginCollect(QVector<ErrorMessage*> *list);
+    static void EndCollect();
     
     ErrorMessagesLib();
     virtual ~ErrorMessagesLib();
@@ -15,6 +15,7 @@
 #include "ErrorMessage.h"
 #include "ErrorMessageProperties.h"
 #include "GeoCoordinates.h"
+#include "RouteChecker.h"
 
 ErrorMessagesWindow::ErrorMessagesWindow(QWidget* parent) : QWidget(parent) {
     brushes[(int)ErrorMessage::Type_Error] = QBrush(QColor(Game::StyleRedText));
@@ -39,6 +40,12 @@ ErrorMessagesWindow::ErrorMessagesWindow(QWidget* parent) : QWidget(parent) {
     QPushButton *bDeleteActionEvent = new QPushButton("Delete");
     QObject::connect(bDeleteActionEvent, SIGNAL(released()),
                       this, SLOT(bDeleteServiceSelected()));*/
+    bCheckRoute = new QPushButton("Check Route");
+    QObject::connect(bCheckRoute, SIGNAL(released()),
+                      this, SLOT(checkRouteSelected()));
+    QObject::connect(RouteChecker::Instance(), SIGNAL(finished()),
+                      this, SLOT(checkRouteFinished()));
+    errorListLayout->addWidget(bCheckRoute);
     errorListLayout->addWidget(&errorList);
     errorListLayout->addWidget(properties);
     //errorListLayout->addWidget(bNewActionEvent);
@@ -76,6 +83,19 @@ ErrorMessagesWindow::ErrorMessagesWindow(QWidget* parent) : QWidget(parent) {
     refreshErrorList();
 }
 
+void ErrorMessagesWindow::checkRouteSelected(){
+    if(Game::currentRoute == NULL)
+        return;
+    bCheckRoute->setEnabled(false);
+    RouteChecker::Instance()->start(Game::currentRoute, true);
+    if(!RouteChecker::Instance()->isRunning())
+        bCheckRoute->setEnabled(true);
+}
+
+void ErrorMessagesWindow::checkRouteFinished(){
+    bCheckRoute->setEnabled(true);
+}
+
 void ErrorMessagesWindow::selectRequestReceived(GameObj* o){
     emit selectObject(o);
 }
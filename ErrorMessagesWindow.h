@@ -32,6 +32,8 @@ public slots:
     void jumpRequestReceived(PreciseTileCoordinate *c);
     void selectRequestReceived(GameObj *o);
     void refreshErrorList();
+    void checkRouteSelected();
+    void checkRouteFinished();
     
 signals:
     void windowClosed();
@@ -42,6 +44,7 @@ private:
     QHash<int, QBrush> brushes;
     QTreeWidget errorList;
     ErrorMessageProperties *properties;
+    QPushButton *bCheckRoute;
     
 };
 
@@ -21,6 +21,7 @@
 #include "TerrainLib.h"
 #include "TS.h"
 #include "Game.h"
+#include "InitScheduler.h"
 #include "FileFunctions.h"
 #include "ReadFile.h"
 #include "TDB.h"
@@ -100,6 +101,83 @@ int ForestObj::GetListIdByTexture(QString texture){
     return 0;
 }
 
+// trees are x, y, z, scale each, relative to the forest position.
+// With instancing only one tree goes to the VBO and the vertex shader
+// places it for every entry of trees, otherwise all trees are expanded.
+void ForestObj::InitTreeShape(OglObj &shape, QVector<float> &trees, float treeSizeX, float treeSizeZ){
+    GLUU* gluu = GLUU::get();
+    float alpha = -gluu->alphaTest;
+    float treeSizeXt = treeSizeX*0.7;
+    int count = trees.size()/4;
+    bool instanced = Game::instancedForests && OglObj::InstancingSupported();
+    int expand = count;
+    if(instanced)
+        expand = 1;
+    
+    float* punkty = new float[expand*24*9];
+    int ptr = 0;
+    for(int uu = 0; uu < expand; uu++){
+        float tposx = 0, wysokosc = 0, tposz = 0, scale = 1;
+        if(!instanced){
+            tposx = trees[uu*4];
+            wysokosc = trees[uu*4+1];
+            tposz = trees[uu*4+2];
+            scale = trees[uu*4+3];
+        }
+        float sizeX = treeSizeXt*scale;
+        float sizeZ = treeSizeZ*scale;
+        for(int j = -1; j < 2; j+=2){
+            for(int i = -1; i<2; i+=2){
+                    punkty[ptr++] = -sizeX*i*j/2.0 + tposx;
+                    punkty[ptr++] = wysokosc+sizeZ;
+                    punkty[ptr++] = -sizeX*i/2.0 + tposz;
+                    punkty[ptr++] = 0; punkty[ptr++] = 1; punkty[ptr++] = 0;
+                    punkty[ptr++] = 0; punkty[ptr++] = 0;
+                    punkty[ptr++] = alpha;
+
+                    punkty[ptr++] = sizeX*i*j/2.0 + tposx;
+                    punkty[ptr++] = wysokosc+sizeZ;
+                    punkty[ptr++] = sizeX*i/2.0 + tposz;
+                    punkty[ptr++] = 0; punkty[ptr++] = 1; punkty[ptr++] = 0;
+                    punkty[ptr++] = 1; punkty[ptr++] = 0;
+                    punkty[ptr++] = alpha;
+
+                    punkty[ptr++] = sizeX*i*j/2.0 + tposx;
+                    punkty[ptr++] = wysokosc;
+                    punkty[ptr++] = sizeX*i/2.0 + tposz;
+                    punkty[ptr++] = 0; punkty[ptr++] = 1; punkty[ptr++] = 0;
+                    punkty[ptr++] = 1; punkty[ptr++] = 1;
+                    punkty[ptr++] = alpha;
+
+                    punkty[ptr++] = -sizeX*i*j/2.0 + tposx;
+                    punkty[ptr++] = wysokosc;
+                    punkty[ptr++] = -sizeX*i/2.0 + tposz;
+                    punkty[ptr++] = 0; punkty[ptr++] = 1; punkty[ptr++] = 0;
+                    punkty[ptr++] = 0; punkty[ptr++] = 1;
+                    punkty[ptr++] = alpha;
+
+                    punkty[ptr++] = -sizeX*i*j/2.0 + tposx;
+                    punkty[ptr++] = wysokosc+sizeZ;
+                    punkty[ptr++] = -sizeX*i/2.0 + tposz;
+                    punkty[ptr++] = 0; punkty[ptr++] = 1; punkty[ptr++] = 0;
+                    punkty[ptr++] = 0; punkty[ptr++] = 0;
+                    punkty[ptr++] = alpha;
+
+                    punkty[ptr++] = sizeX*i*j/2.0 + tposx;
+                    punkty[ptr++] = wysokosc;
+                    punkty[ptr++] = sizeX*i/2.0 + tposz;
+                    punkty[ptr++] = 0; punkty[ptr++] = 1; punkty[ptr++] = 0;
+                    punkty[ptr++] = 1; punkty[ptr++] = 1;
+                    punkty[ptr++] = alpha;
+            }
+        }
+    }
+    shape.init(punkty, ptr, RenderItem::VNTA, GL_TRIANGLES);
+    if(instanced)
+        shape.initInstances(trees.data(), count);
+    delete[] punkty;
+}
+
 void ForestObj::load(int x, int y) {
     this->x = x;
     this->y = y;
@@ -337,24 +415,15 @@ void ForestObj::drawShape(){
     }*/
 
     if (!init) {
-        if(!Game::ignoreLoadLimits){
-            if(Game::allowObjLag < 1)  return;
-            Game::allowObjLag-=2;
-        }
+        bool scheduled = !Game::ignoreLoadLimits;
+        if(scheduled && !InitScheduler::Allow(this, GLUU::get()->mvMatrix, qMax(areaX, areaZ) * 0.5f))
+            return;
         
         //qint64 timeNow = QDateTime::currentMSecsSinceEpoch();
             
-            int iloscv = population*24;
-            float* punkty = new float[iloscv*9];
-            int ptr = 0;
-            
-            GLUU* gluu = GLUU::get();
-            float alpha = -gluu->alphaTest;
-
             int seed = (int)(position[0] + position[1] + position[2]);
             //Random random = new Random(seed);
             std::srand(seed);
-            float treeSizeXt = treeSizeX*0.7;
             float posT[2];
             posT[0] = x;
             posT[1] = y;
@@ -405,62 +474,25 @@ void ForestObj::drawShape(){
                 if(Game::roadDB != NULL)
                     Game::roadDB->fillNearestSquaredDistanceToTDBXZ(posT, fpoints, bBox);
             }
+            // heights for all trees at once, terrain is looked up per tile
+            Game::terrainLib->fillHeights(x, y, fpoints);
+
+            // scale of each tree is drawn after the positions,
+            // so forests keep their trees where they were
+            QVector<float> trees;
+            trees.reserve(population*4);
             for(int uu = 0; uu < population; uu++){
+                float scale = 1;
+                if(scaleRangeX > 0 && scaleRangeZ > scaleRangeX)
+                    scale = scaleRangeX + ((float)((std::rand()%1000))/1000)*(scaleRangeZ - scaleRangeX);
                 if(ForestClearDistance > 0){
                     if(fpoints[uu].c < ForestClearDistance*ForestClearDistance)
                         continue;
                 }
-
-                float wysokosc = Game::terrainLib->getHeight(x, y, fpoints[uu].x, fpoints[uu].z);
-                
-                tposx = fpoints[uu].x - position[0];
-                tposz = fpoints[uu].z - position[2];
-                
-                for(int j = -1; j < 2; j+=2){
-                    for(int i = -1; i<2; i+=2){
-                            punkty[ptr++] = -treeSizeXt*i*j/2.0 + tposx;
-                            punkty[ptr++] = wysokosc+treeSizeZ;
-                            punkty[ptr++] = -treeSizeXt*i/2.0 + tposz;
-                            punkty[ptr++] = 0; punkty[ptr++] = 1; punkty[ptr++] = 0;
-                            punkty[ptr++] = 0; punkty[ptr++] = 0;
-                            punkty[ptr++] = alpha;
-                            
-                            punkty[ptr++] = treeSizeXt*i*j/2.0 + tposx;
-                            punkty[ptr++] = wysokosc+treeSizeZ;
-                            punkty[ptr++] = treeSizeXt*i/2.0 + tposz;
-                            punkty[ptr++] = 0; punkty[ptr++] = 1; punkty[ptr++] = 0;
-                            punkty[ptr++] = 1; punkty[ptr++] = 0;
-                            punkty[ptr++] = alpha;
-                            
-                            punkty[ptr++] = treeSizeXt*i*j/2.0 + tposx;
-                            punkty[ptr++] = wysokosc;
-                            punkty[ptr++] = treeSizeXt*i/2.0 + tposz;
-                            punkty[ptr++] = 0; punkty[ptr++] = 1; punkty[ptr++] = 0;
-                            punkty[ptr++] = 1; punkty[ptr++] = 1;
-                            punkty[ptr++] = alpha;
-                            
-                            punkty[ptr++] = -treeSizeXt*i*j/2.0 + tposx;
-                            punkty[ptr++] = wysokosc;
-                            punkty[ptr++] = -treeSizeXt*i/2.0 + tposz;
-                            punkty[ptr++] = 0; punkty[ptr++] = 1; punkty[ptr++] = 0;
-                            punkty[ptr++] = 0; punkty[ptr++] = 1;
-                            punkty[ptr++] = alpha;
-                            
-                            punkty[ptr++] = -treeSizeXt*i*j/2.0 + tposx;
-                            punkty[ptr++] = wysokosc+treeSizeZ;
-                            punkty[ptr++] = -treeSizeXt*i/2.0 + tposz;
-                            punkty[ptr++] = 0; punkty[ptr++] = 1; punkty[ptr++] = 0;
-                            punkty[ptr++] = 0; punkty[ptr++] = 0;
-                            punkty[ptr++] = alpha;
-                            
-                            punkty[ptr++] = treeSizeXt*i*j/2.0 + tposx;
-                            punkty[ptr++] = wysokosc;
-                            punkty[ptr++] = treeSizeXt*i/2.0 + tposz;
-                            punkty[ptr++] = 0; punkty[ptr++] = 1; punkty[ptr++] = 0;
-                            punkty[ptr++] = 1; punkty[ptr++] = 1;
-                            punkty[ptr++] = alpha;
-                    }
-                }
+                trees.push_back(fpoints[uu].x - position[0]);
+                trees.push_back(fpoints[uu].y);
+                trees.push_back(fpoints[uu].z - position[2]);
+                trees.push_back(scale);
             }
 
 
@@ -480,7 +512,7 @@ void ForestObj::drawShape(){
                         
         texturePath = new QString(resPath.toLower() + seasonPath +"/"+treeTexture.toLower());
         shape.setMaterial(texturePath);
-        shape.init(punkty, ptr, RenderItem::VNTA, GL_TRIANGLES);
+        InitTreeShape(shape, trees, treeSizeX, treeSizeZ);
         /*shape.VAO.create();
         QOpenGLVertexArrayObject::Binder vaoBinder(&shape.VAO);
 
@@ -495,7 +527,8 @@ void ForestObj::drawShape(){
         //shape.iloscv = ptr/8;
         //qint64 timeNow2 = QDateTime::currentMSecsSinceEpoch();
         //qDebug() << "forest gen time: " << (timeNow2 - timeNow);
-        delete[] punkty;
+        if(scheduled)
+            InitScheduler::Done();
         init = true;
     }
     shape.render();
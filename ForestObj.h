@@ -63,6 +63,7 @@ public:
     void render(GLUU* gluu, float lod, float posx, float posz, float* playerW, float* target, float fov, int selectionColor, int renderMode);
     static void LoadForestList();
     static int GetListIdByTexture(QString texture);
+    static void InitTreeShape(OglObj &shape, QVector<float> &trees, float treeSizeX, float treeSizeZ);
     virtual ~ForestObj();
 private:
     void drawShape();
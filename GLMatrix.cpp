@@ -16,6 +16,14 @@
 #include <math.h>
 #include <iostream>
 
+// Batch functions use SSE when the compiler targets it (always on x64).
+// Products are summed in the same order as the scalar versions, so both
+// give the same bits unless the compiler fuses multiply-adds.
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define GLMATRIX_SSE
+#include <xmmintrin.h>
+#endif
+
 /**
  * Creates a new, empty vec2
  * @returns {vec2} a new 2D vector
@@ -772,6 +780,44 @@ float* Vec3::transformQuat(float* out, float* a, float* q) {
     return out;
 };
 
+/**
+ * Transforms count vec3's with a mat4, 4th vector component implicitly '1'
+ * @param {vec3} out the receiving vectors
+ * @param {vec3} a the vectors to transform
+ * @param {Number} count number of vectors
+ * @param {Number} stride floats from one vector to the next
+ * @param {mat4} m matrix to transform with
+ */
+void Vec3::transformMat4Batch(float* out, float* a, int count, int stride, float* m) {
+#ifdef GLMATRIX_SSE
+    __m128 m0 = _mm_loadu_ps(m);
+    __m128 m1 = _mm_loadu_ps(m + 4);
+    __m128 m2 = _mm_loadu_ps(m + 8);
+    __m128 m3 = _mm_loadu_ps(m + 12);
+    for (int i = 0; i < count; i++) {
+        __m128 r = _mm_mul_ps(m0, _mm_set1_ps(a[0]));
+        r = _mm_add_ps(r, _mm_mul_ps(m1, _mm_set1_ps(a[1])));
+        r = _mm_add_ps(r, _mm_mul_ps(m2, _mm_set1_ps(a[2])));
+        r = _mm_add_ps(r, m3);
+        // three floats only, the next vector may follow directly
+        _mm_storel_pi((__m64*)out, r);
+        _mm_store_ss(out + 2, _mm_movehl_ps(r, r));
+        a += stride;
+        out += stride;
+    }
+#else
+    transformMat4BatchScalar(out, a, count, stride, m);
+#endif
+}
+
+void Vec3::transformMat4BatchScalar(float* out, float* a, int count, int stride, float* m) {
+    for (int i = 0; i < count; i++) {
+        transformMat4(out, a, m);
+        a += stride;
+        out += stride;
+    }
+}
+
 /**
  * Creates a new, empty vec4
  * @returns {vec4} a new 2D vector
@@ -1254,6 +1300,89 @@ float* Mat4::fromRotationTranslation(float* out, float* q, float* v) {
     return out;
 }
 
+/**
+ * Creates count matrices from quaternion rotations and vector translations
+ * @param {mat4} out count receiving matrices
+ * @param {quat4} q count rotation quaternions
+ * @param {vec3} v count translation vectors
+ * @param {Number} count number of matrices
+ */
+void Mat4::fromRotationTranslationBatch(float* out, float* q, float* v, int count) {
+#ifdef GLMATRIX_SSE
+    // four matrices at a time, quats transposed to x, y, z, w lanes
+    int i = 0;
+    __m128 one = _mm_set1_ps(1);
+    __m128 zero = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(q);
+        __m128 y = _mm_loadu_ps(q + 4);
+        __m128 z = _mm_loadu_ps(q + 8);
+        __m128 w = _mm_loadu_ps(q + 12);
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        __m128 x2 = _mm_add_ps(x, x);
+        __m128 y2 = _mm_add_ps(y, y);
+        __m128 z2 = _mm_add_ps(z, z);
+        __m128 xx = _mm_mul_ps(x, x2);
+        __m128 xy = _mm_mul_ps(x, y2);
+        __m128 xz = _mm_mul_ps(x, z2);
+        __m128 yy = _mm_mul_ps(y, y2);
+        __m128 yz = _mm_mul_ps(y, z2);
+        __m128 zz = _mm_mul_ps(z, z2);
+        __m128 wx = _mm_mul_ps(w, x2);
+        __m128 wy = _mm_mul_ps(w, y2);
+        __m128 wz = _mm_mul_ps(w, z2);
+
+        __m128 c[4][4];
+        c[0][0] = _mm_sub_ps(one, _mm_add_ps(yy, zz));
+        c[0][1] = _mm_add_ps(xy, wz);
+        c[0][2] = _mm_sub_ps(xz, wy);
+        c[0][3] = zero;
+        c[1][0] = _mm_sub_ps(xy, wz);
+        c[1][1] = _mm_sub_ps(one, _mm_add_ps(xx, zz));
+        c[1][2] = _mm_add_ps(yz, wx);
+        c[1][3] = zero;
+        c[2][0] = _mm_add_ps(xz, wy);
+        c[2][1] = _mm_sub_ps(yz, wx);
+        c[2][2] = _mm_sub_ps(one, _mm_add_ps(xx, yy));
+        c[2][3] = zero;
+        c[3][0] = _mm_set_ps(v[9], v[6], v[3], v[0]);
+        c[3][1] = _mm_set_ps(v[10], v[7], v[4], v[1]);
+        c[3][2] = _mm_set_ps(v[11], v[8], v[5], v[2]);
+        c[3][3] = one;
+
+        // back to one matrix per lane
+        for (int j = 0; j < 4; j++) {
+            _MM_TRANSPOSE4_PS(c[j][0], c[j][1], c[j][2], c[j][3]);
+            for (int k = 0; k < 4; k++)
+                _mm_storeu_ps(out + k*16 + j*4, c[j][k]);
+        }
+        q += 16;
+        v += 12;
+        out += 64;
+    }
+    fromRotationTranslationBatchScalar(out, q, v, count - i);
+#else
+    fromRotationTranslationBatchScalar(out, q, v, count);
+#endif
+}
+
+void Mat4::fromRotationTranslationBatchScalar(float* out, float* q, float* v, int count) {
+    for (int i = 0; i < count; i++)
+        fromRotationTranslation(out + i*16, q + i*4, v + i*3);
+}
+
+/**
+ * Name of the instruction set used by the batch functions
+ * @returns {String} "sse" or "scalar"
+ */
+const char* Mat4::BatchKernels() {
+#ifdef GLMATRIX_SSE
+    return "sse";
+#else
+    return "scalar";
+#endif
+}
+
 /**
  * Generates a orthogonal projection matrix with the given bounds
  *
@@ -1403,6 +1532,39 @@ float * Mat4::multiply(float *out, float *a, float *b) {
     return out;
 };
 
+/**
+ * Multiplies one mat4 by count others
+ * @param {mat4} out count receiving matrices
+ * @param {mat4} a the first operand
+ * @param {mat4} b count second operands
+ * @param {Number} count number of matrices
+ */
+void Mat4::multiplyBatch(float* out, float* a, float* b, int count) {
+#ifdef GLMATRIX_SSE
+    __m128 a0 = _mm_loadu_ps(a);
+    __m128 a1 = _mm_loadu_ps(a + 4);
+    __m128 a2 = _mm_loadu_ps(a + 8);
+    __m128 a3 = _mm_loadu_ps(a + 12);
+    for (int i = 0; i < count * 4; i++) {
+        // one column of b gives one column of out
+        __m128 r = _mm_mul_ps(_mm_set1_ps(b[0]), a0);
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(b[1]), a1));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(b[2]), a2));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(b[3]), a3));
+        _mm_storeu_ps(out, r);
+        b += 4;
+        out += 4;
+    }
+#else
+    multiplyBatchScalar(out, a, b, count);
+#endif
+}
+
+void Mat4::multiplyBatchScalar(float* out, float* a, float* b, int count) {
+    for (int i = 0; i < count; i++)
+        multiply(out + i*16, a, b + i*16);
+}
+
 float* Mat4::perspective(float* out, float fovy, float aspect, float near, float far) {
     float f = 1.0 / (float) tan(fovy / 2);
     float nf = 1.0 / (near - far);
@@ -83,6 +83,9 @@ public:
     static float* transformMat3(float* out, float* a, float* m);
     static float* transformMat4(float* out, float* a, float* m);
     static float* transformQuat(float* out, float* a, float* q);
+    // count points, stride floats apart, out may be a
+    static void transformMat4Batch(float* out, float* a, int count, int stride, float* m);
+    static void transformMat4BatchScalar(float* out, float* a, int count, int stride, float* m);
 };
 
 class Vec4 {
@@ -131,6 +134,13 @@ public:
     static float* translate(float* out, float* a, float* v);
     static float* translate(float* out, float* a,float x,float y,float z);
     static float* ortho(float *out, float left, float right, float bottom, float top, float near, float far);
+    // out[i] = a * b[i], out may be b
+    static void multiplyBatch(float* out, float* a, float* b, int count);
+    static void multiplyBatchScalar(float* out, float* a, float* b, int count);
+    // q holds count quats, v count vec3
+    static void fromRotationTranslationBatch(float* out, float* q, float* v, int count);
+    static void fromRotationTranslationBatchScalar(float* out, float* q, float* v, int count);
+    static const char* BatchKernels();
 private:
 
 };
@@ -79,6 +79,7 @@ void GLUU::initShader() {
         currentShader->bindAttributeLocation("aTextureCoord", 1);
         currentShader->bindAttributeLocation("normal", 2);
         currentShader->bindAttributeLocation("alpha", 3);
+        currentShader->bindAttributeLocation("instance", 4);
         if(!currentShader->link()){
             qDebug() << "Shader link failed.";
         }
@@ -113,6 +114,11 @@ void GLUU::initShader() {
         currentShader->shadow1Bias = currentShader->uniformLocation("shadow1Bias");
         currentShader->shadow2Res = currentShader->uniformLocation("shadow2Res");
         currentShader->shadow2Bias = currentShader->uniformLocation("shadow2Bias");
+        currentShader->patchLayers = currentShader->uniformLocation("patchLayers");
+        currentShader->patchVertices = currentShader->uniformLocation("patchVertices");
+        currentShader->textureArrayEnabled = currentShader->uniformLocation("textureArrayEnabled");
+        currentShader->textureArrays = currentShader->uniformLocation("textureArrayEnabled") >= 0
+                && currentShader->uniformLocation("patchLayers") >= 0;
 
         unsigned int tex1 = currentShader->uniformLocation("uSampler");
         currentShader->setUniformValue(tex1, 0);
@@ -122,6 +128,8 @@ void GLUU::initShader() {
         currentShader->setUniformValue(tex3, 2);
         unsigned int tex4 = currentShader->uniformLocation("shadow2");
         currentShader->setUniformValue(tex4, 3);
+        unsigned int tex5 = currentShader->uniformLocation("uSamplerArray");
+        currentShader->setUniformValue(tex5, 4);
         currentShader->release();
     }
     
@@ -162,6 +170,8 @@ void GLUU::setMatrixUniforms() {
     currentShader->setUniformValue(currentShader->shaderTextureEnabled, 1.0f);
     currentShader->setUniformValue(currentShader->shaderEnableNormals, 1.0f);
     currentShader->setUniformValue(currentShader->shaderSecondTexEnabled, 0.0f);
+    currentShader->setUniformValue(currentShader->textureArrayEnabled, 0.0f);
+    currentShader->setUniformValue(currentShader->patchVertices, 0.0f);
     currentShader->setUniformValue(currentShader->shaderShadowsEnabled, Game::shadowsEnabled);
     currentShader->setUniformValue(currentShader->shaderBrightness, currentBrightness);
     currentShader->setUniformValue(currentShader->shaderFogDensity, fogDensity);
@@ -64,8 +64,7 @@ bool Game::playerMode = false;
 bool Game::useNetworkEng = false;
 bool Game::useQuadTree = false;
 bool Game::useTdbEmptyItems = true;
-int Game::allowObjLag = 1000;
-int Game::maxObjLag = 10;
+float Game::objInitBudget = 4;
 bool Game::ignoreLoadLimits = false;
 int Game::startTileX = 0;
 int Game::startTileY = 0;
@@ -110,6 +109,15 @@ int Game::newRouteZ = 15000;
 bool Game::consoleOutput = false;
 int Game::fpsLimit = 0;
 bool Game::ortsEngEnable = true;
+bool Game::tdbBinaryCache = true;
+bool Game::instancedForests = true;
+bool Game::proceduralDiskCache = true;
+int Game::proceduralMemoryCache = 256;
+bool Game::staticBatching = false;
+bool Game::tileProxies = false;
+int Game::tileProxySize = 200;
+bool Game::terrainTextureArrays = false;
+bool Game::compressedTextures = false;
 bool Game::sortTileObjects = true;
 int Game::oglDefaultLineWidth = 1;
 bool Game::showWorldObjPivotPoints = false;
@@ -132,6 +140,9 @@ bool Game::autoFix = false;
 bool Game::gui = true;
 
 QString Game::geoPath = "hgst";
+int Game::geoCacheSize = 512;
+bool Game::geoBicubic = false;
+QString Game::osmFile = "";
 
 //RouteEditorWindow* Game::window = NULL;
 //LodWindow* Game::loadWindow = NULL;
@@ -158,6 +169,7 @@ bool Game::autoGeoTerrain = false;
 bool Game::useSuperelevation = false;
 
 bool Game::soundEnabled = false;
+int Game::soundVoices = 32;
 
 int Game::AASamples = 0;
 bool Game::AARemoveBorder = false;
@@ -371,11 +383,8 @@ void Game::load() {
             if(setname =="objectlod"){
                 objectLod = setval.toInt();
             }
-            if(setname =="maxobjlag"){
-                maxObjLag = setval.toInt();
-            }
-            if(setname =="allowobjlag"){
-                allowObjLag = setval.toInt();
+            if(setname =="objinitbudget"){
+                objInitBudget = setval.toFloat();
             }
             if(setname =="fpslimit"){
                 fpsLimit = setval.toInt();
@@ -617,6 +626,16 @@ void Game::load() {
         
         if(setname =="geopath")
             geoPath = setval;
+        if(setname =="geocachesize")
+            geoCacheSize = setval.toInt();
+        if(setname =="geobicubic"){
+            if((setval == "true") or (setval == "1") or (setval == "on"))
+                geoBicubic = true;
+            else
+                geoBicubic = false;
+        }
+        if(setname =="osmfile")
+            osmFile = args[1].trimmed();
         if(setname =="colorconview")
             colorConView = new QColor(setval);
         if(setname =="colorshapeview")
@@ -627,6 +646,54 @@ void Game::load() {
             else
                 ortsEngEnable = false;
         }
+        if(setname =="tdbbinarycache"){
+            if((setval == "true") or (setval == "1") or (setval == "on"))
+                tdbBinaryCache = true;
+            else
+                tdbBinaryCache = false;
+        }
+        if(setname =="instancedforests"){
+            if((setval == "true") or (setval == "1") or (setval == "on"))
+                instancedForests = true;
+            else
+                instancedForests = false;
+        }
+        if(setname =="proceduraldiskcache"){
+            if((setval == "true") or (setval == "1") or (setval == "on"))
+                proceduralDiskCache = true;
+            else
+                proceduralDiskCache = false;
+        }
+        if(setname =="proceduralmemorycache"){
+            proceduralMemoryCache = setval.toInt();
+        }
+        if(setname =="staticbatching"){
+            if((setval == "true") or (setval == "1") or (setval == "on"))
+                staticBatching = true;
+            else
+                staticBatching = false;
+        }
+        if(setname =="tileproxies"){
+            if((setval == "true") or (setval == "1") or (setval == "on"))
+                tileProxies = true;
+            else
+                tileProxies = false;
+        }
+        if(setname =="tileproxysize"){
+            tileProxySize = setval.toInt();
+        }
+        if(setname =="terraintexturearrays"){
+            if((setval == "true") or (setval == "1") or (setval == "on"))
+                terrainTextureArrays = true;
+            else
+                terrainTextureArrays = false;
+        }
+        if(setname =="compressedtextures"){
+            if((setval == "true") or (setval == "1") or (setval == "on"))
+                compressedTextures = true;
+            else
+                compressedTextures = false;
+        }
         if(setname =="sorttileobjects"){
             if((setval == "true") or (setval == "1") or (setval == "on"))
                 sortTileObjects = true;
@@ -701,6 +768,9 @@ void Game::load() {
             else
                 soundEnabled = false; 
         }
+        if(setname =="soundvoices"){
+            soundVoices = setval.toInt();
+        }
         
         if(setname =="cameraspeedmin"){
             cameraSpeedMin = setval.toFloat();
@@ -1088,13 +1158,21 @@ void Game::CreateNewSettingsFile(){
     out << "usenNumPad = true\n";
     out << "tileLod = 1\n";
     out << "objectLod = 4000\n";
-    out << "maxObjLag = 10\n";
-    out << "allowObjLag = 1000\n";
+    out << "objInitBudget = 4\n";
     out << "#cameraFov = 20.0\n";
     out << "leaveTrackShapeAfterDelete = false\n";
     out << "#renderTrItems = true\n";
     out << "#useImperial = false\n";
     out << "#ortsEngEnable = false\n";
+    out << "#tdbBinaryCache = false\n";
+    out << "#instancedForests = false\n";
+    out << "#proceduralDiskCache = false\n";
+    out << "#proceduralMemoryCache = 256\n";
+    out << "#staticBatching = true\n";
+    out << "#tileProxies = true\n";
+    out << "#tileProxySize = 200\n";
+    out << "#terrainTextureArrays = true\n";
+    out << "#compressedTextures = true\n";
     out << "#oglDefaultLineWidth = 2\n";
     out << "shadowsEnabled = 1\n";
     out << "#shadowMapSize = 8192\n";
@@ -1153,6 +1231,7 @@ void Game::CreateNewSettingsFile(){
     out << "#snapableRadius=20\n";
     out << "#sortTileObjects=true\n";
     out << "#soundEnabled=false\n";
+    out << "#soundVoices=32\n";
     out << "#statusWindow=0,100\n";
     out << "#terrainTools = \"1,5,5,9,1,10\"\n";
     out << "#trackElevationPm=700\n";
@@ -66,8 +66,7 @@ public:
     static float objectLod;
     static float distantLod;
     static int tileLod;
-    static int allowObjLag;
-    static int maxObjLag;
+    static float objInitBudget;
     static bool ignoreLoadLimits;
     static void load();
     static void InitAssets();
@@ -117,6 +116,9 @@ public:
     static int newRouteX;
     static int newRouteZ;
     static QString geoPath;
+    static int geoCacheSize;
+    static bool geoBicubic;
+    static QString osmFile;
     static ShapeLib *currentShapeLib;
     static EngLib *currentEngLib;
     static Route *currentRoute;
@@ -126,6 +128,15 @@ public:
     static bool consoleOutput;
     static int fpsLimit;
     static bool ortsEngEnable;
+    static bool tdbBinaryCache;
+    static bool instancedForests;
+    static bool proceduralDiskCache;
+    static int proceduralMemoryCache;
+    static bool staticBatching;
+    static bool tileProxies;
+    static int tileProxySize;
+    static bool terrainTextureArrays;
+    static bool compressedTextures;
     static bool sortTileObjects;
     static int oglDefaultLineWidth;
     static bool showWorldObjPivotPoints;
@@ -150,6 +161,7 @@ public:
     static bool autoGeoTerrain;
     static bool useSuperelevation;
     static bool soundEnabled;
+    static int soundVoices;
     static bool fullscreen;
             
     static float fogDensity;// = 0.7;
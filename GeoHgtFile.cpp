@@ -22,6 +22,8 @@ GeoHgtFile::GeoHgtFile() {
 }
 
 GeoHgtFile::~GeoHgtFile() {
+    delete file;
+    delete buffer;
 }
 
 bool GeoHgtFile::load(int lat, int lon){
@@ -47,28 +49,23 @@ bool GeoHgtFile::load(int lat, int lon){
     this->pathid.replace("//", "/");
     qDebug() << this->pathid;
     //qDebug() << "Wczytam teren RAW: " << fSfile;
-    QFile file(this->pathid);
-    if (!file.open(QIODevice::ReadOnly)){
+    file = new QFile(this->pathid);
+    if (!file->open(QIODevice::ReadOnly)){
         qDebug() <<"HGT not found: "<< this->pathid;
+        delete file;
+        file = NULL;
         return false;
     }
-    FileBuffer* data = ReadFile::readRAW(&file);
-    this->rowSize = sqrt(data->length/2);
+    this->rowSize = sqrt(file->size()/2);
     qDebug() << this->rowSize;
-    terrainData = new short int*[rowSize];
-    //int u = 0;
-    int avg = 0;
-    short int val;
-    for (int i = 0; i < rowSize; i++) {
-        terrainData[i] = new short int[rowSize];
-        for (int j = 0; j < rowSize; j++) {
-            val = (data->get() << 8) | (data->get());
-            terrainData[i][j] = val;
-            avg += terrainData[i][j];
-        }
+    terrainData.rowSize = rowSize;
+    // Map the file instead of copying it, pages are only read when sampled.
+    terrainData.data = file->map(0, file->size());
+    if(terrainData.data == NULL){
+        buffer = ReadFile::readRAW(file);
+        terrainData.data = buffer->data;
+        file->close();
     }
-    qDebug() << avg / (rowSize*rowSize);
-    delete data;
     loaded = true;
     return true;
 }
@@ -77,13 +74,17 @@ bool GeoHgtFile::isLoaded(){
     return loaded;
 }
 
+unsigned int GeoHgtFile::getMemorySize(){
+    return rowSize*rowSize*2;
+}
+
 void GeoHgtFile::draw(QImage* &image){
     qDebug() << this->rowSize;
     image = new QImage(this->rowSize, this->rowSize, QImage::Format_RGB888);
     short int val;
     for (int i = 0; i < rowSize; i++) {
         for (int j = 0; j < rowSize; j++) {
-            val = this->terrainData[j][i] * 4;
+            val = this->terrainData.at(j, i) * 4;
                 if(val < 0) val = 0;
                 if(val > 255) val = 255;
                 image->setPixel(i, j, qRgb(val,val,val));
@@ -92,33 +93,15 @@ void GeoHgtFile::draw(QImage* &image){
 }
 
 float GeoHgtFile::getHeight(float lat, float lon){
-    float latO = lat - floor(lat);
-    float lonO = lon - floor(lon);
-    int latI = rowSize*latO;
-    int lonI = rowSize*lonO;
+    return Interpolate(terrainData, rowSize, rowSize, lat, lon, Game::geoBicubic);
+}
 
-    //if(latI == 0 || lonI == 0){
-    //qDebug() << latI << ":" << lonI;
-    //    return this->terrainData[rowSize-latI][lonI];
-    //qDebug() << latO << ":" << lonO;
-    //} else {
-        float tx = (float)rowSize*latO - latI;
-        float tz = (float)(rowSize)*lonO - lonI;
-        
-        if(latI > rowSize - 1)
-            latI = rowSize - 1;
-        if(lonI > rowSize - 2)
-            lonI = rowSize - 2;
-        if(latI < 1)
-            latI = 1;
-        if(lonI < 0)
-            lonI = 0;
-        
-        return 
-            this->terrainData[rowSize-latI][lonI+1]*(1.0 - tx)*(tz) +
-            this->terrainData[rowSize-latI-1][lonI]*(tx)*(1.0 - tz) +
-            this->terrainData[rowSize-latI-1][lonI+1]*(tx)*(tz) +
-            this->terrainData[rowSize-latI][lonI]*(1.0 - tx)*(1.0 - tz) +
-                0;
-    //}
-}
\ No newline at end of file
+void GeoHgtFile::getHeights(const float* lat, const float* lon, int count, float* out){
+    if(Game::geoBicubic){
+        for(int i = 0; i < count; i++)
+            out[i] = Interpolate(terrainData, rowSize, rowSize, lat[i], lon[i], true);
+    } else {
+        for(int i = 0; i < count; i++)
+            out[i] = Interpolate(terrainData, rowSize, rowSize, lat[i], lon[i], false);
+    }
+}
@@ -13,6 +13,9 @@
 
 #include "GeoTerrainFile.h"
 
+class QFile;
+class FileBuffer;
+
 class GeoHgtFile : public GeoTerrainFile {
 public:
     GeoHgtFile();
@@ -21,9 +24,22 @@ public:
     void draw(QImage* &image);
     bool isLoaded();
     float getHeight(float lat, float lon);
+    void getHeights(const float* lat, const float* lon, int count, float* out);
+    unsigned int getMemorySize();
 private:
-    short int** terrainData;
-    int rowSize;
+    // Big endian samples, swapped on read.
+    struct Samples {
+        const unsigned char* data;
+        int rowSize;
+        inline float at(int row, int col) const {
+            const unsigned char* p = data + 2*(row*rowSize + col);
+            return (short int)((p[0] << 8) | p[1]);
+        }
+    };
+    QFile* file = NULL;
+    FileBuffer* buffer = NULL;
+    Samples terrainData = {NULL, 0};
+    int rowSize = 0;
     bool loaded = false;
 };
 
@@ -31,4 +31,13 @@ void GeoTerrainFile::draw(QImage* &image){
 
 float GeoTerrainFile::getHeight(float lat, float lon){
     return 0;
-}
\ No newline at end of file
+}
+
+void GeoTerrainFile::getHeights(const float* lat, const float* lon, int count, float* out){
+    for(int i = 0; i < count; i++)
+        out[i] = getHeight(lat[i], lon[i]);
+}
+
+unsigned int GeoTerrainFile::getMemorySize(){
+    return 0;
+}
@@ -12,6 +12,7 @@
 #define	GEOTERRAINFILE_H
 
 #include <QString>
+#include <math.h>
 
 class QImage;
 
@@ -24,10 +25,61 @@ public:
     virtual void draw(QImage* &image);
     virtual bool isLoaded();
     virtual float getHeight(float lat, float lon);
+    virtual void getHeights(const float* lat, const float* lon, int count, float* out);
+    virtual unsigned int getMemorySize();
     QString pathid;
+protected:
+    // Sampling kernel shared by file formats. T only has to provide
+    // float at(int row, int col) const, row 0 being the north edge.
+    template<class T>
+    static float Interpolate(const T &src, int rows, int cols, float lat, float lon, bool bicubic);
+    static float Cubic(float p0, float p1, float p2, float p3, float t);
 private:
 
 };
 
+inline float GeoTerrainFile::Cubic(float p0, float p1, float p2, float p3, float t){
+    return p1 + 0.5*t*(p2 - p0 + t*(2.0*p0 - 5.0*p1 + 4.0*p2 - p3 + t*(3.0*(p1 - p2) + p3 - p0)));
+}
+
+template<class T>
+inline float GeoTerrainFile::Interpolate(const T &src, int rows, int cols, float lat, float lon, bool bicubic){
+    float latO = lat - floor(lat);
+    float lonO = lon - floor(lon);
+    int latI = rows*latO;
+    int lonI = cols*lonO;
+    float tx = (float)rows*latO - latI;
+    float tz = (float)cols*lonO - lonI;
+
+    if(latI > rows - 1)
+        latI = rows - 1;
+    if(lonI > cols - 2)
+        lonI = cols - 2;
+    if(latI < 1)
+        latI = 1;
+    if(lonI < 0)
+        lonI = 0;
+    int r = rows - latI;
+
+    if(!bicubic)
+        return 
+            src.at(r, lonI+1)*(1.0 - tx)*(tz) +
+            src.at(r-1, lonI)*(tx)*(1.0 - tz) +
+            src.at(r-1, lonI+1)*(tx)*(tz) +
+            src.at(r, lonI)*(1.0 - tx)*(1.0 - tz) +
+                0;
+
+    int c0 = lonI > 0 ? lonI - 1 : 0;
+    int c3 = lonI + 2 < cols ? lonI + 2 : cols - 1;
+    float p[4];
+    for(int i = 0; i < 4; i++){
+        int rr = r + 1 - i;
+        if(rr < 0) rr = 0;
+        if(rr > rows - 1) rr = rows - 1;
+        p[i] = Cubic(src.at(rr, c0), src.at(rr, lonI), src.at(rr, lonI+1), src.at(rr, c3), tz);
+    }
+    return Cubic(p[0], p[1], p[2], p[3], tx);
+}
+
 #endif	/* GEOTERRAINFILE_H */
 
@@ -0,0 +1,69 @@
+/*  This file is part of TSRE5.
+ *
+ *  TSRE5 - train sim game engine and MSTS/OR Editors. 
+ *  Copyright (C) 2016 Piotr Gadecki <pgadecki@gmail.com>
+ *
+ *  Licensed under GNU General Public License 3.0 or later. 
+ *
+ *  See LICENSE.md or https://www.gnu.org/licenses/gpl.html
+ */
+
+#include "GeoTerrainLib.h"
+#include "GeoHgtFile.h"
+#include "GeoTiffFile.h"
+#include "Game.h"
+#include <QDebug>
+
+QHash<int, GeoTerrainFile*> GeoTerrainLib::files;
+QList<int> GeoTerrainLib::recent;
+unsigned long long GeoTerrainLib::memorySize = 0;
+
+GeoTerrainFile* GeoTerrainLib::getFile(int lat, int lon, QString* missingPath){
+    int id = lat*1000+lon;
+    GeoTerrainFile* file = files.value(id, NULL);
+    if(file != NULL){
+        if(recent.first() != id){
+            recent.removeOne(id);
+            recent.prepend(id);
+        }
+        return file;
+    }
+    
+    file = new GeoHgtFile();
+    if(!file->load(lat, lon)){
+        QString hgtPath = file->pathid;
+        delete file;
+        file = new GeoTiffFile();
+        if(!file->load(lat, lon)){
+            if(missingPath != NULL)
+                *missingPath = hgtPath;
+            delete file;
+            return NULL;
+        }
+    }
+    
+    files[id] = file;
+    recent.prepend(id);
+    memorySize += file->getMemorySize();
+    trim();
+    return file;
+}
+
+void GeoTerrainLib::trim(){
+    unsigned long long maxSize = (unsigned long long)Game::geoCacheSize*1024*1024;
+    // Keep at least the four cells a single tile can touch.
+    while(memorySize > maxSize && recent.size() > 4){
+        int id = recent.takeLast();
+        GeoTerrainFile* file = files.take(id);
+        if(Game::debugOutput) qDebug() << "geo cache release" << file->pathid;
+        memorySize -= file->getMemorySize();
+        delete file;
+    }
+}
+
+void GeoTerrainLib::reset(){
+    qDeleteAll(files);
+    files.clear();
+    recent.clear();
+    memorySize = 0;
+}
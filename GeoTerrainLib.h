@@ -0,0 +1,35 @@
+/*  This file is part of TSRE5.
+ *
+ *  TSRE5 - train sim game engine and MSTS/OR Editors. 
+ *  Copyright (C) 2016 Piotr Gadecki <pgadecki@gmail.com>
+ *
+ *  Licensed under GNU General Public License 3.0 or later. 
+ *
+ *  See LICENSE.md or https://www.gnu.org/licenses/gpl.html
+ */
+
+#ifndef GEOTERRAINLIB_H
+#define	GEOTERRAINLIB_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+class GeoTerrainFile;
+
+// Shared cache of open elevation sources (HGT, GeoTIFF), one per
+// 1x1 degree cell. Least recently used files are closed once the
+// mapped size goes over Game::geoCacheSize megabytes.
+class GeoTerrainLib {
+public:
+    static GeoTerrainFile* getFile(int lat, int lon, QString* missingPath = NULL);
+    static void reset();
+    static unsigned long long memorySize;
+private:
+    static QHash<int, GeoTerrainFile*> files;
+    static QList<int> recent;
+    static void trim();
+};
+
+#endif	/* GEOTERRAINLIB_H */
+
@@ -22,6 +22,7 @@ GeoTiffFile::GeoTiffFile() {
 }
 
 GeoTiffFile::~GeoTiffFile() {
+    delete file;
 }
 
 bool GeoTiffFile::load(int lat, int lon){
@@ -43,50 +44,134 @@ bool GeoTiffFile::load(int lat, int lon){
     while(slon.length() < 3)
         slon = "0"+slon;
     
-    this->pathid = Game::geoPath + "/" + plat + slat + plon + slon + ".tiff";
-    this->pathid.replace("//", "/");
+    QString name = Game::geoPath + "/" + plat + slat + plon + slon;
+    name.replace("//", "/");
+    this->pathid = name + ".tiff";
+    if(!QFile::exists(this->pathid) && QFile::exists(name + ".tif"))
+        this->pathid = name + ".tif";
     qDebug() << this->pathid;
-    //qDebug() << "Wczytam teren RAW: " << fSfile;
-    QFile file(this->pathid);
-    if (!file.open(QIODevice::ReadOnly)){
+    file = new QFile(this->pathid);
+    if (!file->open(QIODevice::ReadOnly)){
         qDebug() <<"TIFF not found: "<< this->pathid;
+        delete file;
+        file = NULL;
+        return false;
+    }
+    dataSize = file->size();
+    data = file->map(0, dataSize);
+    if(data == NULL || dataSize < 8){
+        qDebug() <<"TIFF map failed: "<< this->pathid;
         return false;
     }
-    return false;
     
-    FileBuffer* data = ReadFile::readRAW(&file);
-    this->rowSize = sqrt(data->length/2);
-    qDebug() << this->rowSize;
-    terrainData = new short int*[rowSize];
-    //int u = 0;
-    int avg = 0;
-    short int val;
-    for (int i = 0; i < rowSize; i++) {
-        terrainData[i] = new short int[rowSize];
-        for (int j = 0; j < rowSize; j++) {
-            val = (data->get() << 8) | (data->get());
-            terrainData[i][j] = val;
-            avg += terrainData[i][j];
+    terrainData.bigEndian = (data[0] == 'M');
+    if(readUint(2, 2) != 42){
+        qDebug() <<"Not a TIFF file: "<< this->pathid;
+        return false;
+    }
+    unsigned int ifd = readUint(4, 4);
+    int entries = readUint(ifd, 2);
+    int bits = 16;
+    int format = 1;
+    int compression = 1;
+    int samplesPerPixel = 1;
+    int rowsPerStrip = 0;
+    unsigned int stripEntry = 0;
+    bool tiled = false;
+    for(int i = 0; i < entries; i++){
+        unsigned int entry = ifd + 2 + i*12;
+        switch(readUint(entry, 2)){
+            case 256: width = readTagValue(entry, 0); break;
+            case 257: height = readTagValue(entry, 0); break;
+            case 258: bits = readTagValue(entry, 0); break;
+            case 259: compression = readTagValue(entry, 0); break;
+            case 273: stripEntry = entry; break;
+            case 277: samplesPerPixel = readTagValue(entry, 0); break;
+            case 278: rowsPerStrip = readTagValue(entry, 0); break;
+            case 322: tiled = true; break;
+            case 339: format = readTagValue(entry, 0); break;
+        }
+    }
+    if(compression != 1 || samplesPerPixel != 1 || tiled || stripEntry == 0 
+            || width < 2 || height < 2 || !((bits == 16 && format != 3) || bits == 32)){
+        qDebug() <<"Unsupported TIFF layout: "<< this->pathid << bits << format << compression << tiled;
+        return false;
+    }
+    if(rowsPerStrip <= 0 || rowsPerStrip > height)
+        rowsPerStrip = height;
+    
+    int strips = readUint(stripEntry + 4, 4);
+    int usedStrips = (height + rowsPerStrip - 1)/rowsPerStrip;
+    if(strips < usedStrips){
+        qDebug() <<"Broken TIFF strips: "<< this->pathid;
+        return false;
+    }
+    // only the strips covering the image are read, the last one holds
+    // just the remaining rows
+    stripOffsets.resize(usedStrips);
+    unsigned long long int rowSize = (unsigned long long int)width*(bits/8);
+    for(int i = 0; i < usedStrips; i++){
+        stripOffsets[i] = readTagValue(stripEntry, i);
+        int rows = i < usedStrips - 1 ? rowsPerStrip : height - (usedStrips - 1)*rowsPerStrip;
+        if(stripOffsets[i] + rows*rowSize > dataSize){
+            qDebug() <<"Broken TIFF strips: "<< this->pathid;
+            return false;
         }
     }
-    qDebug() << avg / (rowSize*rowSize);
-    delete data;
+    
+    terrainData.data = data;
+    terrainData.stripOffsets = stripOffsets.data();
+    terrainData.rowsPerStrip = rowsPerStrip;
+    terrainData.width = width;
+    terrainData.bytesPerSample = bits/8;
+    terrainData.isFloat = (format == 3);
+    qDebug() << width << height;
     loaded = true;
     return true;
 }
 
+unsigned int GeoTiffFile::readUint(unsigned int offset, int bytes){
+    if(offset + bytes > dataSize)
+        return 0;
+    const unsigned char* p = data + offset;
+    if(bytes == 1)
+        return p[0];
+    if(bytes == 2){
+        if(terrainData.bigEndian)
+            return (p[0] << 8) | p[1];
+        return (p[1] << 8) | p[0];
+    }
+    if(terrainData.bigEndian)
+        return (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+    return (p[3] << 24) | (p[2] << 16) | (p[1] << 8) | p[0];
+}
+
+unsigned int GeoTiffFile::readTagValue(unsigned int entry, int index){
+    unsigned int type = readUint(entry + 2, 2);
+    unsigned int count = readUint(entry + 4, 4);
+    int size = 4;
+    if(type == 1) size = 1;
+    if(type == 3) size = 2;
+    if(count*size <= 4)
+        return readUint(entry + 8 + index*size, size);
+    return readUint(readUint(entry + 8, 4) + index*size, size);
+}
+
 bool GeoTiffFile::isLoaded(){
     return loaded;
 }
 
+unsigned int GeoTiffFile::getMemorySize(){
+    return width*height*terrainData.bytesPerSample;
+}
+
 void GeoTiffFile::draw(QImage* &image){
-    qDebug() << this->rowSize;
-    return;
-    image = new QImage(this->rowSize, this->rowSize, QImage::Format_RGB888);
-    short int val;
-    for (int i = 0; i < rowSize; i++) {
-        for (int j = 0; j < rowSize; j++) {
-            val = this->terrainData[j][i] * 4;
+    qDebug() << this->width << this->height;
+    image = new QImage(this->width, this->height, QImage::Format_RGB888);
+    int val;
+    for (int i = 0; i < width; i++) {
+        for (int j = 0; j < height; j++) {
+            val = this->terrainData.at(j, i) * 4;
                 if(val < 0) val = 0;
                 if(val > 255) val = 255;
                 image->setPixel(i, j, qRgb(val,val,val));
@@ -95,28 +180,15 @@ void GeoTiffFile::draw(QImage* &image){
 }
 
 float GeoTiffFile::getHeight(float lat, float lon){
-    return 0;
-    float latO = lat - floor(lat);
-    float lonO = lon - floor(lon);
-    int latI = rowSize*latO;
-    int lonI = rowSize*lonO;
+    return Interpolate(terrainData, height, width, lat, lon, Game::geoBicubic);
+}
 
-        float tx = (float)rowSize*latO - latI;
-        float tz = (float)(rowSize)*lonO - lonI;
-        
-        if(latI > rowSize - 1)
-            latI = rowSize - 1;
-        if(lonI > rowSize - 2)
-            lonI = rowSize - 2;
-        if(latI < 1)
-            latI = 1;
-        if(lonI < 0)
-            lonI = 0;
-        
-        return 
-            this->terrainData[rowSize-latI][lonI+1]*(1.0 - tx)*(tz) +
-            this->terrainData[rowSize-latI-1][lonI]*(tx)*(1.0 - tz) +
-            this->terrainData[rowSize-latI-1][lonI+1]*(tx)*(tz) +
-            this->terrainData[rowSize-latI][lonI]*(1.0 - tx)*(1.0 - tz) +
-                0;
-}
\ No newline at end of file
+void GeoTiffFile::getHeights(const float* lat, const float* lon, int count, float* out){
+    if(Game::geoBicubic){
+        for(int i = 0; i < count; i++)
+            out[i] = Interpolate(terrainData, height, width, lat[i], lon[i], true);
+    } else {
+        for(int i = 0; i < count; i++)
+            out[i] = Interpolate(terrainData, height, width, lat[i], lon[i], false);
+    }
+}
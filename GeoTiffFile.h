@@ -12,6 +12,10 @@
 #define	GEOTIFFFILE_H
 
 #include "GeoTerrainFile.h"
+#include <QVector>
+#include <string.h>
+
+class QFile;
 
 class GeoTiffFile : public GeoTerrainFile {
 public:
@@ -21,10 +25,51 @@ public:
     void draw(QImage* &image);
     bool isLoaded();
     float getHeight(float lat, float lon);
+    void getHeights(const float* lat, const float* lon, int count, float* out);
+    unsigned int getMemorySize();
 private:
-    short int** terrainData;
-    int rowSize;
+    // Uncompressed, single band, stripped TIFF. Samples are 16 bit
+    // integers or 32 bit floats in the byte order of the file.
+    struct Samples {
+        const unsigned char* data;
+        const unsigned int* stripOffsets;
+        int rowsPerStrip;
+        int width;
+        int bytesPerSample;
+        bool isFloat;
+        bool bigEndian;
+        inline float at(int row, int col) const {
+            const unsigned char* p = data + stripOffsets[row / rowsPerStrip] 
+                    + ((row % rowsPerStrip)*width + col)*bytesPerSample;
+            if(bytesPerSample == 2){
+                if(bigEndian)
+                    return (short int)((p[0] << 8) | p[1]);
+                return (short int)((p[1] << 8) | p[0]);
+            }
+            unsigned int v;
+            if(bigEndian)
+                v = (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+            else
+                v = (p[3] << 24) | (p[2] << 16) | (p[1] << 8) | p[0];
+            if(isFloat){
+                float f;
+                memcpy(&f, &v, 4);
+                return f;
+            }
+            return (int)v;
+        }
+    };
+    QFile* file = NULL;
+    const unsigned char* data = NULL;
+    unsigned int dataSize = 0;
+    QVector<unsigned int> stripOffsets;
+    Samples terrainData = {NULL, NULL, 1, 0, 2, false, false};
+    int width = 0;
+    int height = 0;
     bool loaded = false;
+    
+    unsigned int readUint(unsigned int offset, int bytes);
+    unsigned int readTagValue(unsigned int entry, int index);
 
 };
 
@@ -87,6 +87,11 @@ GeoTools::GeoTools(QString name)
     QObject::connect(generateTiles, SIGNAL(released()),
                       this, SLOT(generateTilesEnabled()));
     vbox->addWidget(generateTiles);
+    
+    QPushButton * generateMapTextures = new QPushButton("Make tile textures from Map.", this);
+    QObject::connect(generateMapTextures, SIGNAL(released()),
+                      this, SLOT(generateMapTexturesEnabled()));
+    vbox->addWidget(generateMapTextures);
 
     label0 = new QLabel("Distant Terrain:");
     label0->setContentsMargins(3,0,0,0);
@@ -185,6 +190,20 @@ void GeoTools::generateTilesEnabled(){
     emit createNewTiles(tileList);
 }
 
+void GeoTools::generateMapTexturesEnabled(){
+    if(markerFiles.count() == 0)
+        return;
+    Coords* c = mkrFiles[markerFiles.currentText()];
+    if(c == NULL) 
+        return;
+    
+    QMap<int, QPair<int, int>*> tileList;
+    int radius = eRadius.value();
+    c->getTileList(tileList, radius);
+    
+    emit makeMapTextures(tileList);
+}
+
 void GeoTools::generateLoTilesEnabled(){
     if(markerFiles.count() == 0)
         return;
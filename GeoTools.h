@@ -36,6 +36,7 @@ public slots:
     void mkrList(QMap<QString, Coords*> list);
     void checkGeodataFilesEnabled();
     void generateTilesEnabled();
+    void generateMapTexturesEnabled();
     void generateLoTilesEnabled();
     void generateLoTilesFromTDBEnabled();
     
@@ -43,6 +44,7 @@ signals:
     void enableTool(QString name);
     void createNewTiles(QMap<int, QPair<int, int>*> list);
     void createNewLoTiles(QMap<int, QPair<int, int>*> list);
+    void makeMapTextures(QMap<int, QPair<int, int>*> list);
     
 private:
     QMap<QString, QPushButton*> buttonTools;
@@ -22,12 +22,10 @@
 #include <QUrlQuery>
 #include "CoordsMkr.h"
 #include "GeoCoordinates.h"
-#include "GeoHgtFile.h"
-#include "GeoTiffFile.h"
+#include "GeoTerrainLib.h"
+#include "GeoTerrainFile.h"
 #include "UnsavedDialog.h"
 
-std::unordered_map<int, GeoTerrainFile*> HeightWindow::hqtFiles;
-
 HeightWindow::HeightWindow() : QDialog() {
     QPushButton *loadButton = new QPushButton("Load", this);
     QImage myImage(800, 800, QImage::Format_RGB888);
@@ -79,7 +77,7 @@ void HeightWindow::CheckForMissingGeodataFiles(QMap<int,QPair<int,int>*>& tileLi
     QMapIterator<int, QPair<int, int>*> i(tileList);
     
     QMap<QString, bool> missingFiles;
-    bool fail = false;
+    QString missingPath;
     
     while (i.hasNext()) {
         i.next();
@@ -93,16 +91,8 @@ void HeightWindow::CheckForMissingGeodataFiles(QMap<int,QPair<int,int>*>& tileLi
         tLatlon = Game::GeoCoordConverter->ConvertToLatLon(tigh, tLatlon);
 
         //qDebug() << "lat " << itlat->first << " lon " << itlon->first;
-        if(hqtFiles[(int)floor(tLatlon->Latitude)*1000+(int)floor(tLatlon->Longitude)] == NULL){
-            hqtFiles[(int)floor(tLatlon->Latitude)*1000+(int)floor(tLatlon->Longitude)] = new GeoHgtFile();
-            //hqtFiles[tLatlon->Latitude*1000+tLatlon->Longitude] = new GeoTiffFile();
-            fail = hqtFiles[(int)floor(tLatlon->Latitude)*1000+(int)floor(tLatlon->Longitude)]->load((int)floor(tLatlon->Latitude), (int)floor(tLatlon->Longitude));
-        }
-        if(!hqtFiles[(int)floor(tLatlon->Latitude)*1000+(int)floor(tLatlon->Longitude)]->isLoaded())
-            fail = false;
-        //qDebug() << hqtFiles[tLatlon->Latitude*1000+tLatlon->Longitude]->pathid;
-        if(!fail) {
-            missingFiles[hqtFiles[(int)floor(tLatlon->Latitude)*1000+(int)floor(tLatlon->Longitude)]->pathid] = true;
+        if(GeoTerrainLib::getFile((int)floor(tLatlon->Latitude), (int)floor(tLatlon->Longitude), &missingPath) == NULL) {
+            missingFiles[missingPath] = true;
         }
     }
     
@@ -153,21 +143,14 @@ void HeightWindow::load(bool gui){
         }
     
     QImage* image = NULL;
-    bool fail;
+    QString missingPath;
     for (auto itlat = fileLat.begin(); itlat != fileLat.end(); ++itlat ){
         for (auto itlon = fileLon.begin(); itlon != fileLon.end(); ++itlon ){
             qDebug() << "lat " << itlat->first << " lon " << itlon->first;
-            if(this->hqtFiles[itlat->first*1000+itlon->first] == NULL){
-                this->hqtFiles[itlat->first*1000+itlon->first] = new GeoHgtFile();
-                //this->hqtFiles[itlat->first*1000+itlon->first] = new GeoTiffFile();
-                fail = this->hqtFiles[itlat->first*1000+itlon->first]->load(itlat->first, itlon->first);
-            }
-            if(!this->hqtFiles[itlat->first*1000+itlon->first]->isLoaded())
-                fail = false;
-            if(!fail) {
+            if(GeoTerrainLib::getFile(itlat->first, itlon->first, &missingPath) == NULL) {
                 if(gui){
                     QMessageBox msgBox;
-                    msgBox.setText("Failed to load "+this->hqtFiles[itlat->first*1000+itlon->first]->pathid);
+                    msgBox.setText("Failed to load "+missingPath);
                     msgBox.exec();
                 }
                 return;
@@ -206,6 +189,8 @@ void HeightWindow::drawTile(QImage* &image, bool gui){
     }*/
     
     terrainData = new float*[terrainResolution];
+    float* lat = new float[terrainResolution];
+    float* lon = new float[terrainResolution];
     minVal = 999;
     maxVal = -999;
     for (int i = 0; i < terrainResolution; i++) {
@@ -214,17 +199,36 @@ void HeightWindow::drawTile(QImage* &image, bool gui){
             aCoords->setWxyzU(i*step, 0, j*step);
             igh = Game::GeoCoordConverter->ConvertToInternal(aCoords, igh);
             mLatlon = Game::GeoCoordConverter->ConvertToLatLon(igh, mLatlon);
-            if(hqtFiles[(int)floor(mLatlon->Latitude)*1000+(int)floor(mLatlon->Longitude)] == NULL){
+            lat[j] = mLatlon->Latitude;
+            lon[j] = mLatlon->Longitude;
+        }
+        // Sample each run of the row that falls into one geodata file at once.
+        int j = 0;
+        while (j < terrainResolution) {
+            int fileLat = floor(lat[j]);
+            int fileLon = floor(lon[j]);
+            int k = j + 1;
+            while (k < terrainResolution && (int)floor(lat[k]) == fileLat && (int)floor(lon[k]) == fileLon)
+                k++;
+            GeoTerrainFile* file = GeoTerrainLib::getFile(fileLat, fileLon);
+            if(file == NULL){
                 qDebug() << "fail";
+                for (; j < k; j++)
+                    terrainData[i][j] = yOffset;
                 continue;
             }
-            terrainData[i][j] = hqtFiles[(int)floor(mLatlon->Latitude)*1000+(int)floor(mLatlon->Longitude)]->getHeight(mLatlon->Latitude, mLatlon->Longitude) + yOffset;
-            if(terrainData[i][j] < minVal)
-                minVal = terrainData[i][j];
-            if(terrainData[i][j] > maxVal)
-                maxVal = terrainData[i][j];
+            file->getHeights(lat + j, lon + j, k - j, terrainData[i] + j);
+            for (; j < k; j++) {
+                terrainData[i][j] += yOffset;
+                if(terrainData[i][j] < minVal)
+                    minVal = terrainData[i][j];
+                if(terrainData[i][j] > maxVal)
+                    maxVal = terrainData[i][j];
+            }
         }
     }
+    delete[] lat;
+    delete[] lon;
     qDebug() << "minmax" << minVal << " "<<maxVal;
     
     if(gui){
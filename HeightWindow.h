@@ -36,7 +36,6 @@ public:
     float** terrainData = NULL;
     
     static void CheckForMissingGeodataFiles(QMap<int, QPair<int, int>*> &tileList);
-    static std::unordered_map<int, GeoTerrainFile*> hqtFiles;
     int exec();
     
 public slots:
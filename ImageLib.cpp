@@ -14,6 +14,7 @@
 #include <QImage>
 #include <QOpenGLShaderProgram>
 #include "Game.h"
+#include "DxtLib.h"
 
 bool ImageLib::IsThread = true;
 
@@ -62,6 +63,8 @@ void ImageLib::run(){
     //    lineWidth = lineWidth + 4 - lineWidth%4;
     //memcpy(texture->imageData, img.bits(), texture->width*texture->height*texture->bytesPerPixel);
     
+    if(Game::compressedTextures)
+        DxtLib::Compress(texture);
     texture->loaded = true;
     texture->editable = true;
     
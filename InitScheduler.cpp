@@ -0,0 +1,101 @@
+/*  This file is part of TSRE5.
+ *
+ *  TSRE5 - train sim game engine and MSTS/OR Editors. 
+ *  Copyright (C) 2016 Piotr Gadecki <pgadecki@gmail.com>
+ *
+ *  Licensed under GNU General Public License 3.0 or later. 
+ *
+ *  See LICENSE.md or https://www.gnu.org/licenses/gpl.html
+ */
+
+#include "InitScheduler.h"
+#include "Game.h"
+#include <math.h>
+#include <algorithm>
+
+long long int InitScheduler::TotalUploadBytes = 0;
+InitScheduler* InitScheduler::Current = NULL;
+
+InitScheduler::~InitScheduler(){
+    if(Current == this)
+        Current = NULL;
+}
+
+void InitScheduler::beginFrame(){
+    Current = this;
+    // objects draw in more than one pass, each is counted once
+    QSet<void*> owners;
+    QVector<Request> queue;
+    for(int i = 0; i < requests.size(); i++){
+        if(owners.contains(requests[i].owner))
+            continue;
+        owners.insert(requests[i].owner);
+        queue.push_back(requests[i]);
+    }
+    requests.clear();
+    std::sort(queue.begin(), queue.end(), [](const Request &a, const Request &b){
+        return a.priority > b.priority;
+    });
+
+    // at least one init a frame, so a slow one can't stall loading
+    granted.clear();
+    float expected = 0;
+    for(int i = 0; i < queue.size(); i++){
+        if(i > 0 && expected + averageTime > Game::objInitBudget)
+            break;
+        granted.insert(queue[i].owner);
+        expected += averageTime;
+    }
+
+    frame.queued = queue.size();
+    lastFrame = frame;
+    frame = Stats();
+}
+
+void InitScheduler::endFrame(){
+    if(Current == this)
+        Current = NULL;
+}
+
+bool InitScheduler::Allow(void* owner, float* mvMatrix, float radius){
+    if(Current == NULL)
+        return true;
+    return Current->allow(owner, mvMatrix, radius);
+}
+
+void InitScheduler::Done(){
+    if(Current != NULL)
+        Current->done();
+}
+
+void InitScheduler::AddUploadBytes(long long int bytes){
+    if(Current != NULL)
+        Current->frame.uploadBytes += bytes;
+    TotalUploadBytes += bytes;
+}
+
+bool InitScheduler::allow(void* owner, float* mvMatrix, float radius){
+    if(granted.contains(owner) && (frame.done == 0 || frame.time < Game::objInitBudget)){
+        granted.remove(owner);
+        timer.start();
+        return true;
+    }
+    // radius over distance from the camera, near and big first
+    float distance = 1;
+    if(mvMatrix != NULL)
+        distance = sqrt(mvMatrix[12]*mvMatrix[12] + mvMatrix[13]*mvMatrix[13] + mvMatrix[14]*mvMatrix[14]);
+    if(distance < 1)
+        distance = 1;
+    Request r;
+    r.owner = owner;
+    r.priority = radius / distance;
+    requests.push_back(r);
+    return false;
+}
+
+void InitScheduler::done(){
+    float time = (float)timer.nsecsElapsed() / 1000000.0;
+    frame.time += time;
+    frame.done++;
+    averageTime = averageTime * 0.9 + time * 0.1;
+}
@@ -0,0 +1,61 @@
+/*  This file is part of TSRE5.
+ *
+ *  TSRE5 - train sim game engine and MSTS/OR Editors. 
+ *  Copyright (C) 2016 Piotr Gadecki <pgadecki@gmail.com>
+ *
+ *  Licensed under GNU General Public License 3.0 or later. 
+ *
+ *  See LICENSE.md or https://www.gnu.org/licenses/gpl.html
+ */
+
+#ifndef INITSCHEDULER_H
+#define	INITSCHEDULER_H
+
+#include <QVector>
+#include <QSet>
+#include <QElapsedTimer>
+
+// Rations lazy GPU initialization of shapes and world objects by time.
+// Objects that are not initialized ask Allow() each time they are drawn,
+// with the radius of what they will show. Requests of one frame are
+// sorted by how big they look from the camera; in the next frame the
+// biggest are let through while the average measured init time still
+// fits in Game::objInitBudget ms. An allowed init must call Done().
+// Every GL widget has its own scheduler, beginFrame() in its paintGL
+// makes it the one Allow() and Done() go to until endFrame(). Outside
+// of a frame everything is allowed.
+class InitScheduler {
+public:
+    struct Stats {
+        int queued = 0;
+        int done = 0;
+        float time = 0;
+        long long int uploadBytes = 0;
+    };
+    static long long int TotalUploadBytes;
+
+    static bool Allow(void* owner, float* mvMatrix, float radius);
+    static void Done();
+    static void AddUploadBytes(long long int bytes);
+
+    virtual ~InitScheduler();
+    void beginFrame();
+    void endFrame();
+    Stats lastFrame;
+
+private:
+    struct Request {
+        void* owner;
+        float priority;
+    };
+    static InitScheduler* Current;
+    QVector<Request> requests;
+    QSet<void*> granted;
+    QElapsedTimer timer;
+    Stats frame;
+    float averageTime = 1.0;
+    bool allow(void* owner, float* mvMatrix, float radius);
+    void done();
+};
+
+#endif	/* INITSCHEDULER_H */
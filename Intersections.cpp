@@ -121,6 +121,32 @@ bool Intersections::segmentIntersection(float &p0_x, float &p0_y, float &p1_x, f
     return false; // No collision
 }
 
+// False when all corners of the box are outside one plane of the view
+// volume, m is projection * modelview. Boxes that cross a plane corner
+// to corner may be reported as visible.
+bool Intersections::boxInFrustum(float *box, float *m){
+    int outside[6] = {0, 0, 0, 0, 0, 0};
+    for(int i = 0; i < 8; i++){
+        float x = box[(i & 1) ? 3 : 0];
+        float y = box[(i & 2) ? 4 : 1];
+        float z = box[(i & 4) ? 5 : 2];
+        float cx = m[0]*x + m[4]*y + m[8]*z + m[12];
+        float cy = m[1]*x + m[5]*y + m[9]*z + m[13];
+        float cz = m[2]*x + m[6]*y + m[10]*z + m[14];
+        float cw = m[3]*x + m[7]*y + m[11]*z + m[15];
+        if(cx > cw) outside[0]++;
+        if(-cx > cw) outside[1]++;
+        if(cy > cw) outside[2]++;
+        if(-cy > cw) outside[3]++;
+        if(cz > cw) outside[4]++;
+        if(-cz > cw) outside[5]++;
+    }
+    for(int i = 0; i < 6; i++)
+        if(outside[i] == 8)
+            return false;
+    return true;
+}
+
 int Intersections::shapeIntersectsShape(float *shape1, float *shape2, int count1, int count2, int size1, int size2, float *pos){
         float v0[3];
         float v1[3];
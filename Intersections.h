@@ -19,6 +19,7 @@ public:
                 float &p2_x, float &p2_y, float &p3_x, float &p3_y, float &i_x, float &i_y);
     static int segmentIntersectsTriangle(float *p, float *p2, float *v0, float *v1, float *v2);
     static int shapeIntersectsShape(float *shape1, float *shape2, int count1, int count2, int size1, int size2, float *pos);
+    static bool boxInFrustum(float *box, float *m);
 private:
     static void vector(float *a, float *b, float *c);
     static float dot(float *b, float *c);
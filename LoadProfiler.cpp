@@ -0,0 +1,112 @@
+/*  This file is part of TSRE5.
+ *
+ *  TSRE5 - train sim game engine and MSTS/OR Editors. 
+ *  Copyright (C) 2016 Piotr Gadecki <pgadecki@gmail.com>
+ *
+ *  Licensed under GNU General Public License 3.0 or later. 
+ *
+ *  See LICENSE.md or https://www.gnu.org/licenses/gpl.html
+ */
+
+#include "LoadProfiler.h"
+#include "ReadFile.h"
+#include <QDebug>
+#include <QFile>
+#include <QJsonObject>
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#include <time.h>
+#endif
+#ifdef Q_OS_WIN
+#include <windows.h>
+#endif
+
+bool LoadProfiler::Enabled = false;
+QVector<LoadProfiler::Phase> LoadProfiler::phases;
+int LoadProfiler::current = -1;
+
+void LoadProfiler::Begin(QString name){
+    if(!Enabled)
+        return;
+    End();
+    Phase p;
+    p.name = name;
+    p.wallTimer.start();
+    p.cpuStart = ProcessCpuTime();
+    p.bytesStart = ReadFile::BytesRead;
+    p.memoryStart = ResidentMemory();
+    phases.push_back(p);
+    current = phases.size() - 1;
+}
+
+void LoadProfiler::End(){
+    if(!Enabled)
+        return;
+    if(current < 0)
+        return;
+    Phase &p = phases[current];
+    p.wall = ((double)p.wallTimer.nsecsElapsed())/1000000000.0;
+    p.cpu = ProcessCpuTime() - p.cpuStart;
+    p.bytes = ReadFile::BytesRead - p.bytesStart;
+    p.memory = ResidentMemory() - p.memoryStart;
+    current = -1;
+    qDebug() << "#load" << p.name << "time" << p.wall << "cpu" << p.cpu << "bytes" << p.bytes;
+}
+
+void LoadProfiler::Clear(){
+    phases.clear();
+    current = -1;
+}
+
+QJsonArray LoadProfiler::Phases(){
+    QJsonArray list;
+    for(int i = 0; i < phases.size(); i++){
+        QJsonObject p;
+        p["name"] = phases[i].name;
+        p["wall"] = phases[i].wall;
+        p["cpu"] = phases[i].cpu;
+        p["bytesRead"] = (double)phases[i].bytes;
+        p["memory"] = (double)phases[i].memory;
+        list.push_back(p);
+    }
+    return list;
+}
+
+long long int LoadProfiler::ResidentMemory(){
+#ifdef Q_OS_LINUX
+    // second field is resident set size in pages
+    QFile file("/proc/self/statm");
+    if(!file.open(QIODevice::ReadOnly))
+        return 0;
+    QList<QByteArray> fields = file.readAll().split(' ');
+    if(fields.size() < 2)
+        return 0;
+    return fields[1].toLongLong() * sysconf(_SC_PAGESIZE);
+#else
+    return 0;
+#endif
+}
+
+// Seconds of cpu time used by all threads of the process. std::clock
+// gives wall time on Windows, so the system calls are used directly.
+double LoadProfiler::ProcessCpuTime(){
+#if defined(Q_OS_LINUX)
+    timespec t;
+    if(clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t) != 0)
+        return 0;
+    return t.tv_sec + t.tv_nsec / 1000000000.0;
+#elif defined(Q_OS_WIN)
+    FILETIME creation, exit, kernel, user;
+    if(!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+        return 0;
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    // 100 ns units
+    return (k.QuadPart + u.QuadPart) / 10000000.0;
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,48 @@
+/*  This file is part of TSRE5.
+ *
+ *  TSRE5 - train sim game engine and MSTS/OR Editors. 
+ *  Copyright (C) 2016 Piotr Gadecki <pgadecki@gmail.com>
+ *
+ *  Licensed under GNU General Public License 3.0 or later. 
+ *
+ *  See LICENSE.md or https://www.gnu.org/licenses/gpl.html
+ */
+
+#ifndef LOADPROFILER_H
+#define	LOADPROFILER_H
+
+#include <QString>
+#include <QVector>
+#include <QJsonArray>
+#include <QElapsedTimer>
+
+// Per phase wall time, cpu time, bytes read through ReadFile and
+// resident memory change. Phases follow each other, Begin() closes
+// the previous one. Does nothing until Enabled is set.
+class LoadProfiler {
+public:
+    static bool Enabled;
+    static void Begin(QString name);
+    static void End();
+    static void Clear();
+    static QJsonArray Phases();
+
+private:
+    struct Phase {
+        QString name;
+        QElapsedTimer wallTimer;
+        double cpuStart;
+        long long int bytesStart;
+        long long int memoryStart;
+        double wall = 0;
+        double cpu = 0;
+        long long int bytes = 0;
+        long long int memory = 0;
+    };
+    static QVector<Phase> phases;
+    static int current;
+    static long long int ResidentMemory();
+    static double ProcessCpuTime();
+};
+
+#endif	/* LOADPROFILER_H */
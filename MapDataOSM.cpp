@@ -26,6 +26,7 @@
 #include "CoordsMkr.h"
 #include "GeoCoordinates.h"
 #include "OSMFeatures.h"
+#include "OSMFeatureStore.h"
 #include <QTime>
 #include "MapWindow.h"
 
@@ -33,6 +34,68 @@ MapDataOSM::MapDataOSM() {
 }
 
 MapDataOSM::~MapDataOSM() {
+    clearData();
+    delete store;
+    delete igh;
+    delete latlon;
+    delete aCoords;
+}
+
+void MapDataOSM::clearData(){
+    for (auto it = nodes.begin(); it != nodes.end(); ++it)
+        delete it->second;
+    nodes.clear();
+    for(int layer = 0; layer < 10; layer++){
+        qDeleteAll(ways[layer]);
+        ways[layer].clear();
+        projected[layer].clear();
+        projectedBox[layer].clear();
+    }
+}
+
+void MapDataOSM::setSource(MapDataOSM* data){
+    source = data;
+}
+
+void MapDataOSM::project(int refX, int refZ){
+    if(igh == NULL) igh = new IghCoordinate();
+    if(aCoords == NULL) aCoords = new PreciseTileCoordinate();
+    refTileX = refX;
+    refTileZ = refZ;
+    
+    Way* w;
+    QVector<QPointF> pts;
+    for(int layer = 0; layer < 10; layer++){
+        projected[layer].resize(ways[layer].size());
+        projectedBox[layer].resize(ways[layer].size());
+        for (int i = 0; i < ways[layer].size(); i++) {
+            w = ways[layer][i];
+            pts.clear();
+            for (int j = 0; j < w->lat.size(); j++)
+                pts.push_back(projectPoint(w->lat[j], w->lon[j]));
+            for (int j = 0; j < w->ref.size(); j++) {
+                auto it = nodes.find(w->ref[j]);
+                if (it == nodes.end() || it->second == NULL)
+                    break;
+                pts.push_back(projectPoint(it->second->lat, it->second->lon));
+            }
+            float minX = 0, minZ = 0, maxX = 0, maxZ = 0;
+            for (int j = 0; j < pts.size(); j++) {
+                if(j == 0 || pts[j].x() < minX) minX = pts[j].x();
+                if(j == 0 || pts[j].y() < minZ) minZ = pts[j].y();
+                if(j == 0 || pts[j].x() > maxX) maxX = pts[j].x();
+                if(j == 0 || pts[j].y() > maxZ) maxZ = pts[j].y();
+            }
+            projected[layer][i] = pts;
+            projectedBox[layer][i] = QRectF(QPointF(minX, minZ), QPointF(maxX, maxZ));
+        }
+    }
+}
+
+QPointF MapDataOSM::projectPoint(float lat, float lon){
+    igh = Game::GeoCoordConverter->ConvertToInternal(lat, lon, igh);
+    aCoords = Game::GeoCoordConverter->ConvertToTile(igh, aCoords);
+    return QPointF(aCoords->X+1.0*(aCoords->TileX-refTileX), aCoords->Z-1.0*(aCoords->TileZ-refTileZ));
 }
 
 void MapDataOSM::setColor(QColor* color){
@@ -54,11 +117,19 @@ void MapDataOSM::setPenSettings(QPen* pen){
 }
 
 bool MapDataOSM::draw(QImage* myImage) {
-    if(nodes.size() == 0) return false;
+    // a batch worker draws the ways of a shared source
+    MapDataOSM* src = this;
+    if(source != NULL)
+        src = source;
+    bool empty = true;
+    for(int layer = 0; layer < 10; layer++)
+        if(src->ways[layer].size() > 0)
+            empty = false;
+    if(empty) return false;
     
-    igh = new IghCoordinate();
-    latlon = new LatitudeLongitudeCoordinate();
-    aCoords = new PreciseTileCoordinate();
+    if(igh == NULL) igh = new IghCoordinate();
+    if(latlon == NULL) latlon = new LatitudeLongitudeCoordinate();
+    if(aCoords == NULL) aCoords = new PreciseTileCoordinate();
     
     gg = new QPainter();
     gg->begin(myImage);
@@ -103,9 +174,21 @@ bool MapDataOSM::draw(QImage* myImage) {
     QPainterPath path;
     int drawX, drawY;
     
+    // visible range in projected units, with a margin for the widest pen
+    float ox = this->tileX - src->refTileX;
+    float oz = src->refTileZ - this->tileZ;
+    float margin = 16.0*level/height;
+    
     for(int layer = 0; layer < 10; layer++)
-    for (int i = 0; i < this->ways[layer].size(); i++) {
-        w = this->ways[layer][i];
+    for (int i = 0; i < src->ways[layer].size(); i++) {
+        w = src->ways[layer][i];
+        if(src->projected[layer].size() > 0){
+            const QRectF &box = src->projectedBox[layer][i];
+            if(box.right() < ox - margin || box.left() > ox + level + margin)
+                continue;
+            if(box.bottom() < oz - margin || box.top() > oz + level + margin)
+                continue;
+        }
         ww.clear();
         poly.clear();
         path = QPainterPath();
@@ -113,15 +196,31 @@ bool MapDataOSM::draw(QImage* myImage) {
         if (w->val2 == 7) roadBorder->setRgb(0, 0, 0);
         else roadBorder->setRgb(180, 180, 180);
 
-        for (int i = 0; i < w->ref.size(); i++) {
-            if (nodes[w->ref[i]] == NULL) {
-                fail++;
-                break;
+        if(src->projected[layer].size() > 0){
+            const QVector<QPointF> &pts = src->projected[layer][i];
+            for (int j = 0; j < pts.size(); j++) {
+                drawX = (pts[j].x() - ox)*height/level;
+                drawY = (pts[j].y() - oz)*height/level;
+                ww.push_back(QPoint(drawX, drawY));
+                poly.push_back(QPoint(drawX, drawY));
+            }
+        } else {
+            // ways from the feature store carry their coordinates
+            for (int i = 0; i < w->lat.size(); i++) {
+                r(drawX, drawY, w->lat[i], w->lon[i]);
+                ww.push_back(QPoint(drawX, drawY));
+                poly.push_back(QPoint(drawX, drawY));
+            }
+            for (int i = 0; i < w->ref.size(); i++) {
+                if (src->nodes[w->ref[i]] == NULL) {
+                    fail++;
+                    break;
+                }
+                r(drawX, drawY, src->nodes[w->ref[i]]->lat, src->nodes[w->ref[i]]->lon);
+                ww.push_back(QPoint(drawX, drawY));
+                poly.push_back(QPoint(drawX, drawY));
+                //ww.push_back(QPoint(rX(nodes[w->ref[i]]->lon), rY(nodes[w->ref[i]]->lat)));
             }
-            r(drawX, drawY, nodes[w->ref[i]]->lat, nodes[w->ref[i]]->lon);
-            ww.push_back(QPoint(drawX, drawY));
-            poly.push_back(QPoint(drawX, drawY));
-            //ww.push_back(QPoint(rX(nodes[w->ref[i]]->lon), rY(nodes[w->ref[i]]->lat)));
         }
         path.addPolygon(poly);
         
@@ -480,6 +579,11 @@ bool MapDataOSM::draw(QImage* myImage) {
     }
 
     gg->end();
+    delete gg;
+    delete p;
+    delete brush;
+    delete color;
+    delete roadBorder;
     qDebug() << "fail " << fail;
     return true;
 }
@@ -504,6 +608,11 @@ int MapDataOSM::rY(float tlat) {
 }
 
 void MapDataOSM::load(){
+    clearData();
+    if(Game::osmFile.length() > 0){
+        loadFromStore();
+        return;
+    }
 
     LatitudeLongitudeCoordinate p00;
     p00.Latitude = (maxlat + minlat)/2.0;
@@ -540,6 +649,31 @@ void MapDataOSM::load(){
     get(&p0m1, &p10);
 }
 
+void MapDataOSM::loadFromStore(){
+    if(!OSMFeatureStore::IsCurrent(Game::osmFile)){
+        emit statusInfo(QString("Import OSM ..."));
+        QCoreApplication::processEvents();
+        delete store;
+        store = NULL;
+        if(!OSMFeatureStore::Import(Game::osmFile)){
+            emit statusInfo(QString("OSM import failed"));
+            return;
+        }
+    }
+    if(store == NULL){
+        store = new OSMFeatureStore();
+        if(!store->open(Game::osmFile)){
+            delete store;
+            store = NULL;
+            emit statusInfo(QString("OSM store broken"));
+            return;
+        }
+    }
+    store->query(minlat, minlon, maxlat, maxlon, ways);
+    emit statusInfo(QString("Load"));
+    emit loaded();
+}
+
 void MapDataOSM::get(LatitudeLongitudeCoordinate* min, LatitudeLongitudeCoordinate* max){
     QNetworkAccessManager* mgr = new QNetworkAccessManager();
     connect(mgr, SIGNAL(finished(QNetworkReply*)), this, SLOT(isData(QNetworkReply*)));
@@ -602,6 +736,37 @@ void MapDataOSM::isData(QNetworkReply* r){
     }
 }
 
+void MapDataOSM::ClassifyTag(const QString &k, const QString &v, unsigned short &type, unsigned char &val2){
+    //adres, nazwa, drogi, miejsca, bariery, las, sport
+    if (k.startsWith("ADDR", Qt::CaseInsensitive)
+            || k.startsWith("NAME", Qt::CaseInsensitive)
+            || k.startsWith("ONEWAY", Qt::CaseInsensitive)
+            || k.startsWith("MAXSPEED", Qt::CaseInsensitive)
+            || k.startsWith("SURFACE", Qt::CaseInsensitive)
+            || k.startsWith("AMENITY", Qt::CaseInsensitive)
+            || k.startsWith("BARRIER", Qt::CaseInsensitive)
+            || k.startsWith("WOOD", Qt::CaseInsensitive)
+            || k.startsWith("SPORT", Qt::CaseInsensitive)) {
+        return;
+    }
+    if (k.startsWith("BRIDGE", Qt::CaseInsensitive)) {
+        val2 = 7;
+        return;
+    }
+    if (k.startsWith("TUNNEL", Qt::CaseInsensitive)) {
+        val2 = 6;
+        return;
+    }
+    //inne budynki 
+    if (k.startsWith("BUILDING", Qt::CaseInsensitive))
+        type = (short) OSMFeatures::LIST["BUILDING_YES"];
+    //inne -> enum
+    QString fname = k + "_" + v;
+    auto it = OSMFeatures::LIST.find(fname.toUpper().toStdString());
+    if (it != OSMFeatures::LIST.end() && it->second != 0)
+        type = (short) it->second;
+}
+
 void MapDataOSM::loadData(QByteArray* data){
     if(data == NULL){
         QFile file("F:/OSM/tczew.osm");
@@ -619,7 +784,6 @@ void MapDataOSM::loadData(QByteArray* data){
     bool node = true;
     bool way = false;
     bool bounds = false;
-    int iii = 0, uuu = 0;
     
     Node* tnode;
     Way* tway;
@@ -649,67 +813,10 @@ void MapDataOSM::loadData(QByteArray* data){
             } else if (name.toUpper() == ("ND") && way) {
                 tway->ref.push_back ((attr.value("ref").toLongLong()));
             } else if (name.toUpper() == ("TAG")&&(way || node)) {
-                //adres
-                if (attr.value("k").startsWith("ADDR", Qt::CaseInsensitive)) {
-                }
-                //nazwa
-                else if (attr.value("k").startsWith("NAME", Qt::CaseInsensitive)) {
-                }
-                //drogi
-                else if (attr.value("k").startsWith("ONEWAY", Qt::CaseInsensitive)) {}
-                else if (attr.value("k").startsWith("MAXSPEED", Qt::CaseInsensitive)) {}
-                else if (attr.value("k").startsWith("SURFACE", Qt::CaseInsensitive))  {}
-                else if (attr.value("k").startsWith("BRIDGE", Qt::CaseInsensitive)) {
-                    if (way) tway->val2 = 7;
-                }
-                else if (attr.value("k").startsWith("TUNNEL", Qt::CaseInsensitive)) {
-                    if (way) tway->val2 = 6;
-                }
-                //miejsca
-                else if (attr.value("k").startsWith("AMENITY", Qt::CaseInsensitive)) {
-                    //System.out.println(attr.getValue("v").toUpperCase());
-                    //if(node) {
-                    //    uuu++;
-                    //    dane.miejsca.add(new Miejsce(tnode.lat, tnode.lon, attr.getValue("v").toUpperCase().replace("_", "")));
-                    //}
-                }
-                //bariery
-                else if (attr.value("k").startsWith("BARRIER", Qt::CaseInsensitive)) {}
-                //las
-                else if (attr.value("k").startsWith("WOOD", Qt::CaseInsensitive)) {}
-                //sport
-                else if (attr.value("k").startsWith("SPORT", Qt::CaseInsensitive)) {}
-                else {
-                    //inne budynki 
-                    if (attr.value("k").startsWith("BUILDING", Qt::CaseInsensitive)) {
-                        if (way) tway->type = (short) OSMFeatures::LIST["BUILDING_YES"];
-                        iii++;
-                    }
-                    //jakies gowna co nie chce
-                    //if(attr.getValue("k").toUpperCase().startsWith("SOURCE", 0)) return;
-                    //if(attr.getValue("k").toUpperCase().startsWith("CREATED", 0)) return;
-                    //if(attr.getValue("k").toUpperCase().startsWith("EWMAPA", 0)) return;
-                    //if(attr.getValue("k").toUpperCase().startsWith("BUILDING:", 0)) return;
-                    //if(attr.getValue("k").toUpperCase().startsWith("REF", 0)) return;
-                    //if(attr.getValue("k").toUpperCase().startsWith("WIKI", 0)) return;
-                    //if(attr.getValue("k").toUpperCase().startsWith("ACCESS", 0)) return;
-                    //if(attr.getValue("k").toUpperCase().startsWith("NOTE", 0)) return;
-                    //if(attr.getValue("k").toUpperCase().startsWith("TRACKTYPE", 0)) return;
-                    //inne -> enum
-                    QString fname = "";
-                    fname += attr.value("k").toString() + "_" + attr.value("v").toString();
-                    fname = fname.toUpper();
-                    if (OSMFeatures::LIST[fname.toStdString()] != 0) {
-                        if (way) tway->type = (short) OSMFeatures::LIST[fname.toStdString()];
-                        if (node) tnode->type = (short) OSMFeatures::LIST[fname.toStdString()];
-                        iii++; //System.out.println(fname);
-                    } else {
-                        //if(!fname.startsWith("source", Qt::CaseInsensitive)
-                        //    && !fname.startsWith("created", Qt::CaseInsensitive)
-                        //    )
-                        //    qDebug() << "fail: " << fname;
-                    }
-                }
+                if (way)
+                    ClassifyTag(attr.value("k").toString(), attr.value("v").toString(), tway->type, tway->val2);
+                else
+                    ClassifyTag(attr.value("k").toString(), attr.value("v").toString(), tnode->type, tnode->val2);
             } else if (name.toUpper() == ("BOUNDS")) {
                 bounds = true;
                 //minlat = attr.value("minlat").toFloat();
@@ -15,6 +15,8 @@
 #include <unordered_map>
 #include <vector>
 #include <QVector>
+#include <QPointF>
+#include <QRectF>
 
 class IghCoordinate;
 class LatitudeLongitudeCoordinate;
@@ -26,6 +28,7 @@ class QPainter;
 class QBrush;
 class QByteArray;
 class QNetworkReply;
+class OSMFeatureStore;
 
 
 class MapDataOSM : public MapData {
@@ -87,6 +90,9 @@ public:
     virtual ~MapDataOSM();
     bool draw(QImage* myImage);
     void load();
+    void project(int refX, int refZ);
+    void setSource(MapDataOSM* data);
+    static void ClassifyTag(const QString &k, const QString &v, unsigned short &type, unsigned char &val2);
     
 signals:
     void loaded();
@@ -107,6 +113,12 @@ private:
     
     std::unordered_map<int64_t,Node*> nodes;
     QVector<Way*> ways[10];
+    OSMFeatureStore* store = NULL;
+    MapDataOSM* source = NULL;
+    // way points in tile units relative to refTileX/refTileZ, see project()
+    QVector<QVector<QPointF> > projected[10];
+    QVector<QRectF> projectedBox[10];
+    int refTileX = 0, refTileZ = 0;
     float height, width;
     
     int loadCount;
@@ -114,7 +126,10 @@ private:
     int rX(float tlon);
     int rY(float tlat);
     void r(int &x, int &y, float lat, float lon);
+    QPointF projectPoint(float lat, float lon);
     void loadData(QByteArray* data = NULL);
+    void loadFromStore();
+    void clearData();
     void setColor(int r, int g, int b);
     void setColor(QColor* color);
     void setPenSettings(QPen* pen);
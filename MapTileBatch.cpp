@@ -0,0 +1,193 @@
+/*  This file is part of TSRE5.
+ *
+ *  TSRE5 - train sim game engine and MSTS/OR Editors. 
+ *  Copyright (C) 2016 Piotr Gadecki <pgadecki@gmail.com>
+ *
+ *  Licensed under GNU General Public License 3.0 or later. 
+ *
+ *  See LICENSE.md or https://www.gnu.org/licenses/gpl.html
+ */
+
+#include "MapTileBatch.h"
+#include "MapDataOSM.h"
+#include "MapWindow.h"
+#include "GeoCoordinates.h"
+#include "Game.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QImage>
+#include <QMap>
+#include <QPair>
+#include <QRunnable>
+#include <QThreadPool>
+#include <math.h>
+
+int MapTileBatch::RegionSize = 8;
+
+class MapTileTask : public QRunnable {
+public:
+    MapDataOSM* source;
+    MapTileBatch::Tile tile;
+    QString cachePath;
+    bool invert;
+    QImage* image = NULL;
+
+    void run(){
+        int res = Game::mapImageResolution;
+        QImage* img = NULL;
+        if(MapWindow::isAlpha > 0)
+            img = new QImage(res, res, QImage::Format_RGBA8888);
+        else
+            img = new QImage(res, res, QImage::Format_RGB888);
+
+        MapDataOSM data;
+        data.setSource(source);
+        data.tileX = tile.x;
+        data.tileZ = -tile.z;
+        data.level = tile.tileSize/2048.0;
+        data.tileSize = tile.tileSize;
+        if(!data.draw(img)){
+            delete img;
+            return;
+        }
+        if(invert)
+            img->invertPixels(QImage::InvertRgba);
+        img->save(cachePath, "PNG", 80);
+        image = img;
+    }
+};
+
+QString MapTileBatch::CacheDir(){
+    QString path = Game::root + "/routes/" + Game::route + "/terrain_maps/cache/";
+    path.replace("//","/");
+    return path;
+}
+
+QString MapTileBatch::CachePath(Tile &t, QString style){
+    return CacheDir() + QString::number(t.x*10000+t.z) + "_" + QString::number(t.tileSize) + "_" + style + ".png";
+}
+
+QString MapTileBatch::StyleKey(bool invert){
+    // anything that changes the look of a tile goes here
+    QString style = QString::number(Game::mapImageResolution) + "_"
+            + QString::number(MapWindow::isAlpha) + "_"
+            + QString::number(invert ? 1 : 0) + "_"
+            + QString::number(QFileInfo(Game::osmFile).lastModified().toMSecsSinceEpoch());
+    return QString::number(qHash(style), 16);
+}
+
+void MapTileBatch::TileBounds(Tile &t, LatitudeLongitudeCoordinate &min, LatitudeLongitudeCoordinate &max){
+    PreciseTileCoordinate aCoords;
+    IghCoordinate igh;
+    LatitudeLongitudeCoordinate ll;
+    min.Latitude = 999; min.Longitude = 999;
+    max.Latitude = -999; max.Longitude = -999;
+    for(int i = 0; i < 4; i++){
+        aCoords.setTWxyzU(t.x, -t.z, (i & 1)*t.tileSize, 0, (i >> 1)*t.tileSize);
+        Game::GeoCoordConverter->ConvertToInternal(&aCoords, &igh);
+        Game::GeoCoordConverter->ConvertToLatLon(&igh, &ll);
+        if(ll.Latitude < min.Latitude) min.Latitude = ll.Latitude;
+        if(ll.Longitude < min.Longitude) min.Longitude = ll.Longitude;
+        if(ll.Latitude > max.Latitude) max.Latitude = ll.Latitude;
+        if(ll.Longitude > max.Longitude) max.Longitude = ll.Longitude;
+    }
+}
+
+int MapTileBatch::Render(QVector<Tile> &tiles, bool invert){
+    if(Game::osmFile.length() == 0){
+        qDebug() << "map batch: osmfile not set";
+        return 0;
+    }
+    unsigned long long int timeNow = QDateTime::currentMSecsSinceEpoch();
+    QString style = StyleKey(invert);
+    QDir().mkpath(CacheDir());
+
+    // tiles from the disk cache, the rest grouped in regions
+    QMap<QPair<int, int>, QVector<Tile> > regions;
+    int count = 0;
+    for(int i = 0; i < tiles.size(); i++){
+        int hash = tiles[i].x*10000+tiles[i].z;
+        QString path = CachePath(tiles[i], style);
+        if(QFile::exists(path)){
+            QImage image(path);
+            if(!image.isNull()){
+                if(MapWindow::mapTileImages[hash] != NULL)
+                    delete MapWindow::mapTileImages[hash];
+                if(MapWindow::isAlpha > 0)
+                    MapWindow::mapTileImages[hash] = new QImage(image.convertToFormat(QImage::Format_RGBA8888));
+                else
+                    MapWindow::mapTileImages[hash] = new QImage(image.convertToFormat(QImage::Format_RGB888));
+                count++;
+                continue;
+            }
+        }
+        QPair<int, int> region((int)floor((float)tiles[i].x/RegionSize), (int)floor((float)tiles[i].z/RegionSize));
+        regions[region].push_back(tiles[i]);
+    }
+    qDebug() << "map batch: cached" << count << "regions" << regions.size();
+
+    QMapIterator<QPair<int, int>, QVector<Tile> > it(regions);
+    while (it.hasNext()) {
+        it.next();
+        QVector<Tile> regionTiles = it.value();
+        count += RenderRegion(regionTiles, style, invert);
+    }
+    qDebug() << "#map batch time "<< ((float)(QDateTime::currentMSecsSinceEpoch() - timeNow))/1000.0 << count << "tiles";
+    return count;
+}
+
+int MapTileBatch::RenderRegion(QVector<Tile> &tiles, QString style, bool invert){
+    if(tiles.size() == 0)
+        return 0;
+    LatitudeLongitudeCoordinate min, max, tmin, tmax;
+    min.Latitude = 999; min.Longitude = 999;
+    max.Latitude = -999; max.Longitude = -999;
+    for(int i = 0; i < tiles.size(); i++){
+        TileBounds(tiles[i], tmin, tmax);
+        if(tmin.Latitude < min.Latitude) min.Latitude = tmin.Latitude;
+        if(tmin.Longitude < min.Longitude) min.Longitude = tmin.Longitude;
+        if(tmax.Latitude > max.Latitude) max.Latitude = tmax.Latitude;
+        if(tmax.Longitude > max.Longitude) max.Longitude = tmax.Longitude;
+    }
+
+    // read and project the region once, workers only translate
+    MapDataOSM source;
+    source.minlat = min.Latitude;
+    source.minlon = min.Longitude;
+    source.maxlat = max.Latitude;
+    source.maxlon = max.Longitude;
+    source.load();
+    source.project(tiles[0].x, -tiles[0].z);
+
+    // a pool of its own, waiting on the global one would wait for any
+    // unrelated work queued there too
+    QThreadPool pool;
+    QVector<MapTileTask*> tasks;
+    for(int i = 0; i < tiles.size(); i++){
+        MapTileTask* task = new MapTileTask();
+        task->setAutoDelete(false);
+        task->source = &source;
+        task->tile = tiles[i];
+        task->invert = invert;
+        task->cachePath = CachePath(tiles[i], style);
+        tasks.push_back(task);
+        pool.start(task);
+    }
+    pool.waitForDone();
+
+    int count = 0;
+    for(int i = 0; i < tasks.size(); i++){
+        int hash = tasks[i]->tile.x*10000+tasks[i]->tile.z;
+        if(tasks[i]->image != NULL){
+            if(MapWindow::mapTileImages[hash] != NULL)
+                delete MapWindow::mapTileImages[hash];
+            MapWindow::mapTileImages[hash] = tasks[i]->image;
+            count++;
+        }
+        delete tasks[i];
+    }
+    return count;
+}
@@ -0,0 +1,42 @@
+/*  This file is part of TSRE5.
+ *
+ *  TSRE5 - train sim game engine and MSTS/OR Editors. 
+ *  Copyright (C) 2016 Piotr Gadecki <pgadecki@gmail.com>
+ *
+ *  Licensed under GNU General Public License 3.0 or later. 
+ *
+ *  See LICENSE.md or https://www.gnu.org/licenses/gpl.html
+ */
+
+#ifndef MAPTILEBATCH_H
+#define	MAPTILEBATCH_H
+
+#include <QString>
+#include <QVector>
+
+class MapDataOSM;
+class LatitudeLongitudeCoordinate;
+
+// Renders map images for many terrain tiles at once. Features of a region
+// are read and projected once, tiles are drawn on a thread pool of the
+// batch and every result is cached in terrain_maps/cache by tile, tile
+// size and style.
+class MapTileBatch {
+public:
+    struct Tile {
+        int x;
+        int z;
+        int tileSize;
+    };
+    static int RegionSize;
+    static int Render(QVector<Tile> &tiles, bool invert = false);
+
+private:
+    static QString CacheDir();
+    static QString CachePath(Tile &t, QString style);
+    static QString StyleKey(bool invert);
+    static void TileBounds(Tile &t, LatitudeLongitudeCoordinate &min, LatitudeLongitudeCoordinate &max);
+    static int RenderRegion(QVector<Tile> &tiles, QString style, bool invert);
+};
+
+#endif	/* MAPTILEBATCH_H */
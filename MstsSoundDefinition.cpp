@@ -24,9 +24,13 @@
 #endif
 #include "SoundManager.h"
 #include "SoundSource.h"
+#include "SoundLib.h"
+#include <QDateTime>
+#include <math.h>
 
 int MstsSoundDefinition::jestsms = 0;
 QMap<int, MstsSoundDefinition*> MstsSoundDefinition::Definitions;
+QHash<QString, int> MstsSoundDefinition::DefinitionsByPathid;
 
 MstsSoundDefinition::MstsSoundDefinition() {
 }
@@ -91,6 +95,8 @@ QString SoundDefinitionGroup::Stream::Trigger::getFileName(){
 
 void SoundDefinitionGroup::Stream::setRelative(bool v){
     relative = v;
+    if(alSid < 0)
+        return;
     if(relative)
         alSourcei(alSid, AL_SOURCE_RELATIVE, AL_TRUE);
     else
@@ -471,20 +477,17 @@ int MstsSoundDefinition::AddDefinition(QString path, QString name){
     pathid.replace("\\", "/");
     pathid.replace("//", "/");
     //console.log(pathid);
-    QMapIterator<int, MstsSoundDefinition*> i(Definitions);
-    while (i.hasNext()) {
-        i.next();
-        if(i.value() == NULL) continue;
-        if (i.value()->pathid.length() == pathid.length())
-            if (i.value()->pathid == pathid) {
-                i.value()->ref++;
-                return (int)i.key();
-            }
+    // every .sms is parsed once, sources share the definition
+    int id = DefinitionsByPathid.value(pathid, -1);
+    if(id >= 0 && Definitions[id] != NULL){
+        Definitions[id]->ref++;
+        return id;
     }
     qDebug() << "Nowy " << jestsms << " sms: " << pathid;
 
     Definitions[jestsms] = new MstsSoundDefinition(path, name);
     Definitions[jestsms]->pathid = pathid;
+    DefinitionsByPathid[pathid] = jestsms;
 
     return jestsms++;
 }
@@ -514,6 +517,13 @@ SoundDefinitionGroup::Stream::Stream(){
     
 }
 
+SoundDefinitionGroup::Stream::~Stream(){
+    // the voice goes back to SoundManager before a stream is deleted
+    for(int i = 0; i < trigger.size(); i++)
+        if(trigger[i]->alBid >= 0)
+            SoundLib::DelRef(trigger[i]->alBid);
+}
+
 SoundDefinitionGroup::Stream::Stream(Stream *o){
     priority = o->priority;
     volume = o->volume;
@@ -536,30 +546,45 @@ void SoundDefinitionGroup::Stream::setPosition(int x, int y, float *pos){
     tilePos[1] = pos[1];
     tilePos[2] = pos[2];
     
-    alSource3f(alSid, AL_POSITION, tilePos[0] - 2048*(SoundManager::listenerX-x), tilePos[1], tilePos[2] - 2048*(SoundManager::listenerZ-y));
+    if(alSid >= 0)
+        alSource3f(alSid, AL_POSITION, tilePos[0] - 2048*(SoundManager::listenerX-x), tilePos[1], tilePos[2] - 2048*(SoundManager::listenerZ-y));
 }
 
 void SoundDefinitionGroup::Stream::update(SoundVariables *variables){
     for(int i = 0; i < trigger.size(); i++){
         if(trigger[i]->activate(variables)){
             if(trigger[i]->mode == Trigger::ONESHOT_MODE){
-                bindTo(trigger[i]->alBid);
-                qDebug() << "bind" << i << alSid << trigger[i]->alBid;
-                alSourcei(alSid, AL_LOOPING, AL_FALSE);
-                alSourcePlay(alSid);
+                buffer = trigger[i]->alBid;
+                looping = false;
+                playing = true;
+                playEnd = QDateTime::currentMSecsSinceEpoch() + 1000*SoundLib::Duration(buffer);
+                if(alSid >= 0){
+                    alSourceStop(alSid);
+                    bindTo(buffer);
+                    alSourcei(alSid, AL_LOOPING, AL_FALSE);
+                    alSourcePlay(alSid);
+                }
                 isInit = true;
             }
             if(trigger[i]->mode == Trigger::LOOPSTART_MODE){
-                bindTo(trigger[i]->alBid);
-                qDebug() << "bind" << i << alSid << trigger[i]->alBid;
-                alSourcei(alSid, AL_LOOPING, AL_TRUE);
-                alSourcePlay(alSid);
+                buffer = trigger[i]->alBid;
+                looping = true;
+                playing = true;
+                if(alSid >= 0){
+                    alSourceStop(alSid);
+                    bindTo(buffer);
+                    alSourcei(alSid, AL_LOOPING, AL_TRUE);
+                    alSourcePlay(alSid);
+                }
                 isInit = true;
             }
             if(trigger[i]->mode == Trigger::LOOPRELEASE_MODE){
-                bindTo(0);
-                qDebug() << "u-bind" << i << alSid << "NULL";
-                alSourceStop(alSid);
+                buffer = 0;
+                playing = false;
+                if(alSid >= 0){
+                    alSourceStop(alSid);
+                    bindTo(0);
+                }
                 isInit = true;
             }
         }
@@ -573,16 +598,20 @@ void SoundDefinitionGroup::Stream::update(SoundVariables *variables){
     }
 
     if(volumeCurve != NULL){
-        float newv = volumeCurve->getValue(variables);
-        alSourcef(alSid, AL_GAIN, newv);
+        gain = volumeCurve->getValue(variables);
+        if(alSid >= 0)
+            alSourcef(alSid, AL_GAIN, gain*fade);
     }
     if(freqCurve != NULL){
-        float newv = freqCurve->getValue(variables);
-        alSourcef(alSid, AL_PITCH, newv/12025.0);
+        pitch = freqCurve->getValue(variables)/12025.0;
+        if(alSid >= 0)
+            alSourcef(alSid, AL_PITCH, pitch);
     }
 }
 
 void SoundDefinitionGroup::Stream::updatePosition(){
+    if(alSid < 0)
+        return;
     if(relative)
         alSource3f(alSid, AL_POSITION, 0, 0, 0);    
     else
@@ -594,117 +623,78 @@ void SoundDefinitionGroup::Stream::bindTo(int i){
     ////qDebug("buffer binding");
 }
 
-void SoundDefinitionGroup::Stream::init(QString path, bool stereo){
-
-    alGenSources((ALuint)1, (ALuint*)&alSid);
-    ////qDebug("source generation");
-
-    float pitch = 1.0;
-    //if(stereo)
-    //    pitch = 2.0;
-        
+void SoundDefinitionGroup::Stream::bindVoice(int sid){
+    // a hardware source from SoundManager, set it up from the kept state
+    alSid = sid;
     alSourcef(alSid, AL_PITCH, pitch);
-    ////qDebug("source pitch");
-    alSourcef(alSid, AL_GAIN, 1.0);
-   // //qDebug("source gain");
-        
-    alSourcei(alSid, AL_SOURCE_RELATIVE, AL_FALSE);
-        
+    alSourcef(alSid, AL_GAIN, gain*fade);
     alSourcef(alSid, AL_REFERENCE_DISTANCE, 1);
-    alSourcef(alSid, AL_MAX_DISTANCE, 1000);
-    alDistanceModel(AL_LINEAR_DISTANCE_CLAMPED);
-        
-    alSource3f(alSid, AL_POSITION, 0, 0, 0);
-    ////qDebug("source position");
+    alSourcef(alSid, AL_MAX_DISTANCE, distance);
     alSource3f(alSid, AL_VELOCITY, 0, 0, 0);
-   // //qDebug("source velocity");
-    alSourcei(alSid, AL_LOOPING, AL_TRUE);
-  //  //qDebug("source looping");
+    setRelative(relative);
+    updatePosition();
+    alSourcei(alSid, AL_LOOPING, looping ? AL_TRUE : AL_FALSE);
+    bindTo(buffer);
+    if(buffer > 0 && isPlaying())
+        alSourcePlay(alSid);
+}
+
+void SoundDefinitionGroup::Stream::unbindVoice(){
+    if(alSid < 0)
+        return;
+    alSourceStop(alSid);
+    bindTo(0);
+    alSid = -1;
+    fade = 1.0;
+}
+
+void SoundDefinitionGroup::Stream::setFade(float f){
+    fade = f;
+    if(alSid >= 0)
+        alSourcef(alSid, AL_GAIN, gain*fade);
+}
 
+bool SoundDefinitionGroup::Stream::isPlaying(){
+    if(!playing)
+        return false;
+    if(looping)
+        return true;
+    if(alSid >= 0){
+        ALint state;
+        alGetSourcei(alSid, AL_SOURCE_STATE, &state);
+        if(state == AL_STOPPED)
+            playing = false;
+    } else if(QDateTime::currentMSecsSinceEpoch() > playEnd) {
+        playing = false;
+    }
+    return playing;
+}
 
+float SoundDefinitionGroup::Stream::audibility(){
+    // linear clamped, as the distance model set in SoundManager
+    if(relative)
+        return gain + 1.0;
+    float dx = tilePos[0] - 2048*(SoundManager::listenerX-X) - SoundManager::listenerPos[0];
+    float dy = tilePos[1] - SoundManager::listenerPos[1];
+    float dz = tilePos[2] - 2048*(SoundManager::listenerZ-Y) - SoundManager::listenerPos[2];
+    float d = sqrt(dx*dx + dy*dy + dz*dz);
+    if(d >= distance)
+        return 0;
+    return gain*(1.0 - d/distance);
+}
+
+void SoundDefinitionGroup::Stream::init(QString path, bool stereo){
+    // no AL source here, SoundManager binds one while the stream is audible
     for(int i = 0; i < trigger.size(); i++){
         if(trigger[i]->files.size() < 1)
             continue;
         if(trigger[i]->mode != Trigger::LOOPSTART_MODE && trigger[i]->mode != Trigger::ONESHOT_MODE )
             continue;
-        alGenBuffers(1, (ALuint*)&trigger[i]->alBid);
-      //  //qDebug("buffer generation");
+        // decoded once per file, the buffer is shared by all sources
         QString filepath = path + "/" + trigger[i]->files.first();
-        filepath.replace("//", "/");
-        QFile file(filepath);
-        qDebug()<< "vaw" << file.fileName();
-        if (!file.open(QIODevice::ReadOnly)){
-            qDebug() << "fail vaw file "<< file.fileName();
+        trigger[i]->alBid = SoundLib::AddBuffer(filepath);
+        if(trigger[i]->alBid < 0)
             return;
-        }
-        FileBuffer* filedata = ReadFile::read(&file);
-        
-        qDebug() << filedata->get();
-        qDebug() << filedata->get();
-        qDebug() << filedata->get();
-        qDebug() << filedata->get();
-        
-        qDebug() << filedata->getInt();
-
-        qDebug() << filedata->get();
-        qDebug() << filedata->get();
-        qDebug() << filedata->get();
-        qDebug() << filedata->get();
-
-        qDebug() << filedata->get();
-        qDebug() << filedata->get();
-        qDebug() << filedata->get();
-        qDebug() << filedata->get();
-
-        unsigned short chunkSize = filedata->getUint();
-        
-        unsigned short audioFormat = filedata->getShort();
-        qDebug() <<"audioFormat"<<audioFormat;
-        unsigned short channels = filedata->getShort();
-        qDebug() <<"channels"<<channels;
-        unsigned int sampleRate = filedata->getUint();
-        qDebug() <<"sampleRate"<<sampleRate;
-        unsigned int byteRate = filedata->getUint();
-        qDebug() <<"byteRate" << byteRate;
-        filedata->getSignedShort();
-        unsigned short bitsPerSample = filedata->getShort();
-        qDebug() <<"bitsPerSample"<<bitsPerSample;
-
-        if (chunkSize != 16) {
-                unsigned short extraParams = filedata->getShort();
-                filedata->off += extraParams;
-        }
-
-        qDebug() << filedata->get();
-        qDebug() << filedata->get();
-        qDebug() << filedata->get();
-        qDebug() << filedata->get();
-
-        unsigned int dataChunkSize = filedata->getUint();
-        qDebug() << "dataChunkSize" << dataChunkSize;
-        //dataChunkSize = dataChunkSize/channels;
-        unsigned char* bufferData = new unsigned char[dataChunkSize];
-        //if (channels == 1)
-            for(int ii = 0; ii < dataChunkSize; ii++)
-                bufferData[ii] = filedata->get();
-        /*if (channels == 2)
-            for(int ii = 0; ii < dataChunkSize; ii+=2){
-                filedata->get();
-                filedata->get();
-                bufferData[ii] = filedata->get();
-                bufferData[ii+1] = filedata->get();
-            }
-        */
-        float duration = float(dataChunkSize) / byteRate;
-        ALenum formatinfo = AL_FORMAT_STEREO16;
-        if (channels == 1)
-                formatinfo = AL_FORMAT_MONO16;
-        alBufferData(trigger[i]->alBid, formatinfo, bufferData, dataChunkSize, sampleRate);
-
-	////qDebug("loading wav file");
-
-	////qDebug("buffer copy");
-
     }
     
 
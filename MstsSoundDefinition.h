@@ -14,6 +14,7 @@
 #include <QString>
 #include <QVector>
 #include <QMap>
+#include <QHash>
 #include "Vector2f.h"
 #include "SoundVariables.h"
 
@@ -101,15 +102,25 @@ class SoundDefinitionGroup {
             
             Stream();
             Stream(Stream *o);
+            ~Stream();
             
-            float X;
-            float Y;
-            float tilePos[3];
+            float X = 0;
+            float Y = 0;
+            float tilePos[3] = {0, 0, 0};
             float distance = 1000;
             int alSid = -1;
             bool isInit = false;
             
             float lastVolume = -1;
+            
+            // state kept while the stream has no voice from SoundManager
+            int buffer = 0;
+            bool looping = true;
+            bool playing = false;
+            long long int playEnd = 0;
+            float gain = 1.0;
+            float pitch = 1.0;
+            float fade = 1.0;
         
             void load(FileBuffer* data);
             void setPosition(int x, int y, float *pos);
@@ -118,6 +129,11 @@ class SoundDefinitionGroup {
             void setRelative(bool v);
             void init(QString path, bool stereo);
             void bindTo(int i);
+            void bindVoice(int sid);
+            void unbindVoice();
+            void setFade(float f);
+            bool isPlaying();
+            float audibility();
         };
         
         Activation activation;
@@ -152,6 +168,7 @@ public:
     virtual ~MstsSoundDefinition();
 private:
     static int jestsms;
+    static QHash<QString, int> DefinitionsByPathid;
     bool loaded = false;
     
 };
@@ -0,0 +1,744 @@
+/*  This file is part of TSRE5.
+ *
+ *  TSRE5 - train sim game engine and MSTS/OR Editors. 
+ *  Copyright (C) 2016 Piotr Gadecki <pgadecki@gmail.com>
+ *
+ *  Licensed under GNU General Public License 3.0 or later. 
+ *
+ *  See LICENSE.md or https://www.gnu.org/licenses/gpl.html
+ */
+
+#include "OSMFeatureStore.h"
+#include "OSMFeatures.h"
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QXmlStreamReader>
+#include <QSet>
+#include <QDateTime>
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+const quint32 StoreMagic = 0x4D534F54; // "TOSM"
+const quint32 StoreVersion = 2;
+
+// Sort runs and merge buffers of the import; peak memory stays at about
+// these sizes whatever the size of the extract.
+const qint64 SortRunBytes = 64*1024*1024;
+const qint64 MergeBufferBytes = 16*1024*1024;
+
+struct NodeRecord {
+    qint64 id;
+    float lat;
+    float lon;
+};
+
+bool NodeLess(const NodeRecord &a, const NodeRecord &b){
+    return a.id < b.id;
+}
+
+struct IndexEntry {
+    qint64 cell;
+    quint64 offset;
+};
+
+bool IndexLess(const IndexEntry &a, const IndexEntry &b){
+    return a.cell < b.cell || (a.cell == b.cell && a.offset < b.offset);
+}
+
+struct IndexHeader {
+    quint32 magic;
+    quint32 version;
+    qint64 count;
+};
+
+struct WayHeader {
+    qint64 id;
+    quint16 type;
+    quint8 val2;
+    quint8 layer;
+    quint32 count;
+};
+
+// Sorts a file of fixed size records in place: runs of SortRunBytes are
+// sorted in memory and written back, then merged into a new file through
+// one small read buffer per run.
+template<class T>
+bool ExternalSort(QFile &file, qint64 count, bool (*less)(const T&, const T&)){
+    const qint64 runSize = SortRunBytes/sizeof(T);
+    QVector<T> buffer;
+    for(qint64 start = 0; start < count; start += runSize){
+        qint64 n = qMin(runSize, count - start);
+        buffer.resize(n);
+        if(!file.seek(start*sizeof(T)) || file.read((char*)buffer.data(), n*sizeof(T)) != n*(qint64)sizeof(T))
+            return false;
+        std::sort(buffer.begin(), buffer.end(), less);
+        file.seek(start*sizeof(T));
+        if(file.write((const char*)buffer.constData(), n*sizeof(T)) != n*(qint64)sizeof(T))
+            return false;
+    }
+    buffer = QVector<T>();
+    if(!file.flush())
+        return false;
+    int runs = (count + runSize - 1)/runSize;
+    if(runs <= 1)
+        return true;
+
+    struct Run {
+        qint64 next;
+        qint64 end;
+        QVector<T> data;
+        int pos;
+    };
+    const qint64 bufferSize = qMax((qint64)1024, MergeBufferBytes/(qint64)sizeof(T)/(runs + 1));
+    QVector<Run> run(runs);
+    auto refill = [&](Run &r) -> bool {
+        qint64 n = qMin(bufferSize, r.end - r.next);
+        r.data.resize(n);
+        r.pos = 0;
+        if(n == 0)
+            return true;
+        if(!file.seek(r.next*sizeof(T)) || file.read((char*)r.data.data(), n*sizeof(T)) != n*(qint64)sizeof(T))
+            return false;
+        r.next += n;
+        return true;
+    };
+    // min-heap of the runs by their current record
+    auto after = [&](int a, int b){
+        return less(run[b].data[run[b].pos], run[a].data[run[a].pos]);
+    };
+    std::vector<int> heap;
+    for(int i = 0; i < runs; i++){
+        run[i].next = i*runSize;
+        run[i].end = qMin(count, (i + 1)*runSize);
+        if(!refill(run[i]))
+            return false;
+        heap.push_back(i);
+    }
+    std::make_heap(heap.begin(), heap.end(), after);
+
+    QFile out(file.fileName() + ".sort");
+    if(!out.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    QVector<T> outData;
+    outData.reserve(bufferSize);
+    while(heap.size() > 0){
+        std::pop_heap(heap.begin(), heap.end(), after);
+        Run &r = run[heap.back()];
+        outData.push_back(r.data[r.pos++]);
+        if(outData.size() == bufferSize){
+            out.write((const char*)outData.constData(), outData.size()*sizeof(T));
+            outData.clear();
+        }
+        if(r.pos == r.data.size() && !refill(r))
+            return false;
+        if(r.data.size() == 0)
+            heap.pop_back();
+        else
+            std::push_heap(heap.begin(), heap.end(), after);
+    }
+    out.write((const char*)outData.constData(), outData.size()*sizeof(T));
+    if(out.size() != count*(qint64)sizeof(T))
+        return false;
+    out.close();
+
+    QString name = file.fileName();
+    file.close();
+    QFile::remove(name);
+    if(!QFile::rename(out.fileName(), name))
+        return false;
+    return file.open(QIODevice::ReadWrite);
+}
+
+// Streams nodes to a temporary file and ways to ways.dat. Nodes come before
+// ways in both formats, so node coordinates are resolved from the memory
+// mapped, id-sorted node file and never held in memory. Grid cell entries
+// of the ways go to a temporary file too and are sorted by cell at the end.
+class OSMImporter {
+public:
+    QString path;
+    QFile nodeFile;
+    QFile waysFile;
+    QFile indexTmpFile;
+    const NodeRecord* nodes = NULL;
+    qint64 nodeCount = 0;
+    qint64 lastNodeId = 0;
+    bool nodesSorted = true;
+    bool nodesDone = false;
+    qint64 wayCount = 0;
+    qint64 indexCount = 0;
+    QVector<float> lat;
+    QVector<float> lon;
+
+    bool begin(QString storePath){
+        path = storePath;
+        QDir().mkpath(path);
+        nodeFile.setFileName(path + "/nodes.tmp");
+        waysFile.setFileName(path + "/ways.dat");
+        indexTmpFile.setFileName(path + "/index.tmp");
+        return nodeFile.open(QIODevice::ReadWrite | QIODevice::Truncate)
+                && waysFile.open(QIODevice::WriteOnly | QIODevice::Truncate)
+                && indexTmpFile.open(QIODevice::ReadWrite | QIODevice::Truncate);
+    }
+
+    void addNode(qint64 id, float nlat, float nlon){
+        if(nodesDone)
+            return;
+        NodeRecord n;
+        n.id = id;
+        n.lat = nlat;
+        n.lon = nlon;
+        if(id < lastNodeId)
+            nodesSorted = false;
+        lastNodeId = id;
+        nodeFile.write((const char*)&n, sizeof(NodeRecord));
+        nodeCount++;
+    }
+
+    void finishNodes(){
+        if(nodesDone)
+            return;
+        nodesDone = true;
+        nodeFile.flush();
+        if(nodeCount == 0)
+            return;
+        if(!nodesSorted){
+            qDebug() << "OSM nodes are not sorted by id, sorting" << nodeCount;
+            if(!ExternalSort(nodeFile, nodeCount, NodeLess)){
+                qDebug() << "OSM node sort failed";
+                return;
+            }
+        }
+        nodes = (const NodeRecord*)nodeFile.map(0, nodeCount*sizeof(NodeRecord));
+        if(nodes == NULL)
+            qDebug() << "OSM node file map failed";
+    }
+
+    bool findNode(qint64 id, float &nlat, float &nlon){
+        if(nodes == NULL)
+            return false;
+        NodeRecord key;
+        key.id = id;
+        const NodeRecord* n = std::lower_bound(nodes, nodes + nodeCount, key, NodeLess);
+        if(n == nodes + nodeCount || n->id != id)
+            return false;
+        nlat = n->lat;
+        nlon = n->lon;
+        return true;
+    }
+
+    void addWay(qint64 id, unsigned short type, unsigned char val2, const QVector<qint64> &refs){
+        finishNodes();
+        lat.clear();
+        lon.clear();
+        float nlat, nlon;
+        // Same as drawing from the API response: stop at the first missing node.
+        for(int i = 0; i < refs.size(); i++){
+            if(!findNode(refs[i], nlat, nlon))
+                break;
+            lat.push_back(nlat);
+            lon.push_back(nlon);
+        }
+        if(lat.size() == 0)
+            return;
+
+        int tlayer = OSMFeatures::LAYER[type];
+        if(tlayer > 9) tlayer = 9;
+        WayHeader h;
+        h.id = id;
+        h.type = type;
+        h.val2 = val2;
+        h.layer = val2 == 7 ? 9 : 9 - tlayer;
+        h.count = lat.size();
+
+        quint64 offset = waysFile.pos();
+        waysFile.write((const char*)&h, sizeof(WayHeader));
+        for(int i = 0; i < lat.size(); i++){
+            waysFile.write((const char*)&lat[i], sizeof(float));
+            waysFile.write((const char*)&lon[i], sizeof(float));
+        }
+
+        float minlat = lat[0], maxlat = lat[0], minlon = lon[0], maxlon = lon[0];
+        for(int i = 1; i < lat.size(); i++){
+            if(lat[i] < minlat) minlat = lat[i];
+            if(lat[i] > maxlat) maxlat = lat[i];
+            if(lon[i] < minlon) minlon = lon[i];
+            if(lon[i] > maxlon) maxlon = lon[i];
+        }
+        int la0 = floor(minlat*OSMFeatureStore::CellsPerDegree);
+        int la1 = floor(maxlat*OSMFeatureStore::CellsPerDegree);
+        int lo0 = floor(minlon*OSMFeatureStore::CellsPerDegree);
+        int lo1 = floor(maxlon*OSMFeatureStore::CellsPerDegree);
+        IndexEntry e;
+        e.offset = offset;
+        for(int i = la0; i <= la1; i++)
+            for(int j = lo0; j <= lo1; j++){
+                e.cell = OSMFeatureStore::CellId(i, j);
+                indexTmpFile.write((const char*)&e, sizeof(IndexEntry));
+                indexCount++;
+            }
+
+        if(wayCount++ % 100000 == 0) qDebug() << "w " << wayCount;
+    }
+
+    bool end(){
+        finishNodes();
+        waysFile.close();
+        if(nodes != NULL)
+            nodeFile.unmap((uchar*)nodes);
+        nodeFile.close();
+        nodeFile.remove();
+
+        bool ok = indexTmpFile.flush() && ExternalSort(indexTmpFile, indexCount, IndexLess);
+        QFile indexFile(path + "/index.dat");
+        if(ok && indexFile.open(QIODevice::WriteOnly | QIODevice::Truncate)){
+            IndexHeader header;
+            header.magic = StoreMagic;
+            header.version = StoreVersion;
+            header.count = indexCount;
+            indexFile.write((const char*)&header, sizeof(IndexHeader));
+            indexTmpFile.seek(0);
+            while(ok && !indexTmpFile.atEnd()){
+                QByteArray data = indexTmpFile.read(MergeBufferBytes);
+                ok = data.size() > 0 && indexFile.write(data) == data.size();
+            }
+            ok = ok && indexFile.size() == (qint64)sizeof(IndexHeader) + indexCount*(qint64)sizeof(IndexEntry);
+            indexFile.close();
+        } else {
+            ok = false;
+        }
+        indexTmpFile.close();
+        indexTmpFile.remove();
+        qDebug() << "node/way: " << nodeCount << "/" << wayCount << "cell entries" << indexCount;
+        return ok;
+    }
+};
+
+bool ImportXml(QFile &file, OSMImporter &importer){
+    QXmlStreamReader reader(&file);
+    bool way = false;
+    qint64 wayId = 0;
+    unsigned short type = 0;
+    unsigned char val2 = 0;
+    QVector<qint64> refs;
+    QXmlStreamAttributes attr;
+    while (!reader.atEnd()) {
+        reader.readNext();
+        if (reader.isStartElement()) {
+            QStringRef name = reader.name();
+            if (name == QLatin1String("node")) {
+                attr = reader.attributes();
+                importer.addNode(attr.value("id").toLongLong(), attr.value("lat").toFloat(), attr.value("lon").toFloat());
+            } else if (name == QLatin1String("way")) {
+                attr = reader.attributes();
+                way = true;
+                wayId = attr.value("id").toLongLong();
+                type = 0;
+                val2 = 0;
+                refs.clear();
+            } else if (name == QLatin1String("nd") && way) {
+                refs.push_back(reader.attributes().value("ref").toLongLong());
+            } else if (name == QLatin1String("tag") && way) {
+                attr = reader.attributes();
+                MapDataOSM::ClassifyTag(attr.value("k").toString(), attr.value("v").toString(), type, val2);
+            } else if (name == QLatin1String("relation")) {
+                // relations are not drawn, nodes and ways are done
+                importer.finishNodes();
+            }
+        } else if (reader.isEndElement()) {
+            if (way && reader.name() == QLatin1String("way")) {
+                importer.addWay(wayId, type, val2, refs);
+                way = false;
+            }
+        }
+    }
+    if (reader.hasError()) {
+        qDebug() << "OSM XML error" << reader.errorString();
+        return false;
+    }
+    return true;
+}
+
+// Minimal protocol buffers reader, enough for the OSM PBF format.
+struct PbfReader {
+    const unsigned char* p;
+    const unsigned char* end;
+
+    PbfReader(const char* data, int length){
+        p = (const unsigned char*)data;
+        end = p + length;
+    }
+    bool atEnd(){
+        return p >= end;
+    }
+    quint64 varint(){
+        quint64 v = 0;
+        int shift = 0;
+        while(p < end){
+            unsigned char b = *p++;
+            v |= (quint64)(b & 0x7F) << shift;
+            if((b & 0x80) == 0)
+                break;
+            shift += 7;
+        }
+        return v;
+    }
+    qint64 svarint(){
+        quint64 v = varint();
+        return (qint64)(v >> 1) ^ -(qint64)(v & 1);
+    }
+    bool key(int &field, int &wire){
+        if(p >= end)
+            return false;
+        quint64 k = varint();
+        field = k >> 3;
+        wire = k & 7;
+        return true;
+    }
+    PbfReader bytes(){
+        int length = varint();
+        if(length > end - p)
+            length = end - p;
+        PbfReader r((const char*)p, length);
+        p += length;
+        return r;
+    }
+    void skip(int wire){
+        if(wire == 0) varint();
+        else if(wire == 1) p += 8;
+        else if(wire == 2) bytes();
+        else if(wire == 5) p += 4;
+        else p = end;
+    }
+};
+
+void PbfDenseNodes(PbfReader r, OSMImporter &importer, qint64 granularity, qint64 latOffset, qint64 lonOffset){
+    QVector<qint64> ids, lats, lons;
+    int field, wire;
+    while(r.key(field, wire)){
+        QVector<qint64>* target = NULL;
+        if(field == 1) target = &ids;
+        else if(field == 8) target = &lats;
+        else if(field == 9) target = &lons;
+        if(target == NULL || wire != 2){
+            r.skip(wire);
+            continue;
+        }
+        PbfReader packed = r.bytes();
+        qint64 v = 0;
+        while(!packed.atEnd()){
+            v += packed.svarint();
+            target->push_back(v);
+        }
+    }
+    int count = std::min(ids.size(), std::min(lats.size(), lons.size()));
+    for(int i = 0; i < count; i++)
+        importer.addNode(ids[i],
+                0.000000001*(latOffset + granularity*lats[i]),
+                0.000000001*(lonOffset + granularity*lons[i]));
+}
+
+void PbfNode(PbfReader r, OSMImporter &importer, qint64 granularity, qint64 latOffset, qint64 lonOffset){
+    qint64 id = 0, nlat = 0, nlon = 0;
+    int field, wire;
+    while(r.key(field, wire)){
+        if(field == 1) id = r.svarint();
+        else if(field == 8) nlat = r.svarint();
+        else if(field == 9) nlon = r.svarint();
+        else r.skip(wire);
+    }
+    importer.addNode(id, 0.000000001*(latOffset + granularity*nlat), 0.000000001*(lonOffset + granularity*nlon));
+}
+
+void PbfWay(PbfReader r, OSMImporter &importer, const QVector<QString> &strings){
+    qint64 id = 0;
+    QVector<quint32> keys, vals;
+    QVector<qint64> refs;
+    int field, wire;
+    while(r.key(field, wire)){
+        if(field == 1){
+            id = r.varint();
+        } else if((field == 2 || field == 3) && wire == 2){
+            PbfReader packed = r.bytes();
+            while(!packed.atEnd())
+                (field == 2 ? keys : vals).push_back(packed.varint());
+        } else if(field == 8 && wire == 2){
+            PbfReader packed = r.bytes();
+            qint64 v = 0;
+            while(!packed.atEnd()){
+                v += packed.svarint();
+                refs.push_back(v);
+            }
+        } else {
+            r.skip(wire);
+        }
+    }
+    unsigned short type = 0;
+    unsigned char val2 = 0;
+    for(int i = 0; i < keys.size() && i < vals.size(); i++){
+        if(keys[i] < (quint32)strings.size() && vals[i] < (quint32)strings.size())
+            MapDataOSM::ClassifyTag(strings[keys[i]], strings[vals[i]], type, val2);
+    }
+    importer.addWay(id, type, val2, refs);
+}
+
+void PbfPrimitiveBlock(const QByteArray &data, OSMImporter &importer){
+    QVector<QString> strings;
+    QVector<PbfReader> groups;
+    qint64 granularity = 100;
+    qint64 latOffset = 0;
+    qint64 lonOffset = 0;
+
+    // Groups are written before granularity and offsets, collect them first.
+    PbfReader r(data.constData(), data.size());
+    int field, wire;
+    while(r.key(field, wire)){
+        if(field == 1 && wire == 2){
+            PbfReader table = r.bytes();
+            int f, w;
+            while(table.key(f, w)){
+                if(f == 1 && w == 2){
+                    PbfReader s = table.bytes();
+                    strings.push_back(QString::fromUtf8((const char*)s.p, s.end - s.p));
+                } else {
+                    table.skip(w);
+                }
+            }
+        } else if(field == 2 && wire == 2){
+            groups.push_back(r.bytes());
+        } else if(field == 17){
+            granularity = r.varint();
+        } else if(field == 19){
+            latOffset = r.varint();
+        } else if(field == 20){
+            lonOffset = r.varint();
+        } else {
+            r.skip(wire);
+        }
+    }
+
+    for(int i = 0; i < groups.size(); i++){
+        PbfReader g = groups[i];
+        while(g.key(field, wire)){
+            if(field == 1 && wire == 2)
+                PbfNode(g.bytes(), importer, granularity, latOffset, lonOffset);
+            else if(field == 2 && wire == 2)
+                PbfDenseNodes(g.bytes(), importer, granularity, latOffset, lonOffset);
+            else if(field == 3 && wire == 2)
+                PbfWay(g.bytes(), importer, strings);
+            else if(field == 4){
+                // relations are not drawn, nodes and ways are done
+                importer.finishNodes();
+                g.skip(wire);
+            } else
+                g.skip(wire);
+        }
+    }
+}
+
+bool ImportPbf(QFile &file, OSMImporter &importer){
+    while(!file.atEnd()){
+        QByteArray sizeData = file.read(4);
+        if(sizeData.size() < 4)
+            break;
+        const unsigned char* s = (const unsigned char*)sizeData.constData();
+        int headerSize = (s[0] << 24) | (s[1] << 16) | (s[2] << 8) | s[3];
+        QByteArray header = file.read(headerSize);
+
+        QString blobType;
+        int blobSize = 0;
+        PbfReader h(header.constData(), header.size());
+        int field, wire;
+        while(h.key(field, wire)){
+            if(field == 1 && wire == 2){
+                PbfReader t = h.bytes();
+                blobType = QString::fromLatin1((const char*)t.p, t.end - t.p);
+            } else if(field == 3) {
+                blobSize = h.varint();
+            } else {
+                h.skip(wire);
+            }
+        }
+        QByteArray blob = file.read(blobSize);
+        if(blob.size() < blobSize){
+            qDebug() << "OSM PBF truncated";
+            return false;
+        }
+        if(blobType != "OSMData")
+            continue;
+
+        QByteArray data;
+        int rawSize = 0;
+        PbfReader b(blob.constData(), blob.size());
+        while(b.key(field, wire)){
+            if(field == 1 && wire == 2){
+                PbfReader raw = b.bytes();
+                data = QByteArray((const char*)raw.p, raw.end - raw.p);
+            } else if(field == 2){
+                rawSize = b.varint();
+            } else if(field == 3 && wire == 2){
+                PbfReader zlib = b.bytes();
+                // qUncompress wants the expected size in front of the zlib stream
+                QByteArray compressed;
+                compressed.reserve(4 + (zlib.end - zlib.p));
+                compressed.append((char)((rawSize >> 24) & 0xFF));
+                compressed.append((char)((rawSize >> 16) & 0xFF));
+                compressed.append((char)((rawSize >> 8) & 0xFF));
+                compressed.append((char)(rawSize & 0xFF));
+                compressed.append((const char*)zlib.p, zlib.end - zlib.p);
+                data = qUncompress(compressed);
+            } else {
+                b.skip(wire);
+            }
+        }
+        if(data.size() == 0){
+            qDebug() << "OSM PBF unsupported blob compression";
+            return false;
+        }
+        PbfPrimitiveBlock(data, importer);
+    }
+    return true;
+}
+
+}
+
+OSMFeatureStore::OSMFeatureStore() {
+}
+
+OSMFeatureStore::~OSMFeatureStore() {
+    delete waysFile;
+    delete indexFile;
+}
+
+QString OSMFeatureStore::StorePath(QString osmPath){
+    return osmPath + ".store";
+}
+
+qint64 OSMFeatureStore::CellId(int latCell, int lonCell){
+    return (qint64)(latCell + 100000)*1000000 + (lonCell + 100000);
+}
+
+bool OSMFeatureStore::IsCurrent(QString osmPath){
+    QFileInfo source(osmPath);
+    QFileInfo indexFile(StorePath(osmPath) + "/index.dat");
+    if(!indexFile.exists())
+        return false;
+    // stores of an older layout are imported again
+    QFile file(indexFile.filePath());
+    IndexHeader header;
+    if(!file.open(QIODevice::ReadOnly) || file.read((char*)&header, sizeof(IndexHeader)) != sizeof(IndexHeader))
+        return false;
+    if(header.magic != StoreMagic || header.version != StoreVersion)
+        return false;
+    return indexFile.lastModified() >= source.lastModified();
+}
+
+bool OSMFeatureStore::Import(QString osmPath){
+    QFile file(osmPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "OSM file not found" << osmPath;
+        return false;
+    }
+    unsigned long long int timeNow = QDateTime::currentMSecsSinceEpoch();
+    OSMImporter importer;
+    if(!importer.begin(StorePath(osmPath))){
+        qDebug() << "OSM store not writable" << StorePath(osmPath);
+        return false;
+    }
+    bool ok;
+    if(osmPath.endsWith(".pbf", Qt::CaseInsensitive))
+        ok = ImportPbf(file, importer);
+    else
+        ok = ImportXml(file, importer);
+    ok = importer.end() && ok;
+    if(!ok)
+        QFile::remove(StorePath(osmPath) + "/index.dat");
+    qDebug() << "#osm import time "<< ((float)(QDateTime::currentMSecsSinceEpoch() - timeNow))/1000.0;
+    return ok;
+}
+
+bool OSMFeatureStore::open(QString osmPath){
+    delete waysFile;
+    waysFile = NULL;
+    waysData = NULL;
+    delete indexFile;
+    indexFile = NULL;
+    indexData = NULL;
+    indexCount = 0;
+
+    QString path = StorePath(osmPath);
+    indexFile = new QFile(path + "/index.dat");
+    if(!indexFile->open(QIODevice::ReadOnly))
+        return false;
+    IndexHeader header;
+    if(indexFile->size() < (qint64)sizeof(IndexHeader))
+        return false;
+    indexData = indexFile->map(0, indexFile->size());
+    if(indexData == NULL)
+        return false;
+    memcpy(&header, indexData, sizeof(IndexHeader));
+    if(header.magic != StoreMagic || header.version != StoreVersion)
+        return false;
+    if(indexFile->size() != (qint64)sizeof(IndexHeader) + header.count*(qint64)sizeof(IndexEntry))
+        return false;
+    indexCount = header.count;
+
+    waysFile = new QFile(path + "/ways.dat");
+    if(!waysFile->open(QIODevice::ReadOnly))
+        return false;
+    waysSize = waysFile->size();
+    if(waysSize > 0)
+        waysData = waysFile->map(0, waysSize);
+    return waysData != NULL || waysSize == 0;
+}
+
+bool OSMFeatureStore::isOpen(){
+    return waysFile != NULL && (waysData != NULL || waysSize == 0) && indexData != NULL;
+}
+
+void OSMFeatureStore::query(float minlat, float minlon, float maxlat, float maxlon, QVector<MapDataOSM::Way*>* ways){
+    if(!isOpen())
+        return;
+    QSet<quint64> offsets;
+    int la0 = floor(minlat*CellsPerDegree);
+    int la1 = floor(maxlat*CellsPerDegree);
+    int lo0 = floor(minlon*CellsPerDegree);
+    int lo1 = floor(maxlon*CellsPerDegree);
+    const IndexEntry* entries = (const IndexEntry*)(indexData + sizeof(IndexHeader));
+    IndexEntry key;
+    key.offset = 0;
+    for(int i = la0; i <= la1; i++)
+        for(int j = lo0; j <= lo1; j++){
+            key.cell = CellId(i, j);
+            const IndexEntry* e = std::lower_bound(entries, entries + indexCount, key, IndexLess);
+            for(; e != entries + indexCount && e->cell == key.cell; e++)
+                offsets.insert(e->offset);
+        }
+
+    WayHeader h;
+    QList<quint64> sorted = offsets.values();
+    std::sort(sorted.begin(), sorted.end());
+    for(int i = 0; i < sorted.size(); i++){
+        if(sorted[i] + sizeof(WayHeader) > (quint64)waysSize)
+            continue;
+        memcpy(&h, waysData + sorted[i], sizeof(WayHeader));
+        if(sorted[i] + sizeof(WayHeader) + h.count*2*sizeof(float) > (quint64)waysSize)
+            continue;
+        const float* p = (const float*)(waysData + sorted[i] + sizeof(WayHeader));
+        MapDataOSM::Way* w = new MapDataOSM::Way(h.id);
+        w->type = h.type;
+        w->val2 = h.val2;
+        w->lat.resize(h.count);
+        w->lon.resize(h.count);
+        for(quint32 j = 0; j < h.count; j++){
+            w->lat[j] = p[j*2];
+            w->lon[j] = p[j*2+1];
+        }
+        ways[h.layer].push_back(w);
+    }
+}
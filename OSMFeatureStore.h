@@ -0,0 +1,54 @@
+/*  This file is part of TSRE5.
+ *
+ *  TSRE5 - train sim game engine and MSTS/OR Editors. 
+ *  Copyright (C) 2016 Piotr Gadecki <pgadecki@gmail.com>
+ *
+ *  Licensed under GNU General Public License 3.0 or later. 
+ *
+ *  See LICENSE.md or https://www.gnu.org/licenses/gpl.html
+ */
+
+#ifndef OSMFEATURESTORE_H
+#define	OSMFEATURESTORE_H
+
+#include <QString>
+#include <QHash>
+#include <QVector>
+#include "MapDataOSM.h"
+
+class QFile;
+
+// On-disk store of OSM ways, built once from a local .osm or .osm.pbf
+// extract and indexed by a lat/lon grid, so map textures only read the
+// features of the requested area.
+//
+// Store layout (directory next to the extract, "<file>.store"):
+//   ways.dat   - way records: id, type, val2, draw layer, point count, lat/lon pairs
+//   index.dat  - header, then (grid cell, way record offset) pairs sorted by
+//                cell; memory mapped and binary searched
+class OSMFeatureStore {
+public:
+    static const int CellsPerDegree = 50;
+    
+    OSMFeatureStore();
+    virtual ~OSMFeatureStore();
+    bool open(QString osmPath);
+    bool isOpen();
+    void query(float minlat, float minlon, float maxlat, float maxlon, QVector<MapDataOSM::Way*>* ways);
+    
+    static QString StorePath(QString osmPath);
+    static bool IsCurrent(QString osmPath);
+    static bool Import(QString osmPath);
+    static qint64 CellId(int latCell, int lonCell);
+    
+private:
+    QFile* waysFile = NULL;
+    const unsigned char* waysData = NULL;
+    qint64 waysSize = 0;
+    QFile* indexFile = NULL;
+    const unsigned char* indexData = NULL;
+    qint64 indexCount = 0;
+};
+
+#endif	/* OSMFEATURESTORE_H */
+
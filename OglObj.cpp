@@ -15,6 +15,8 @@
 #include "RenderItem.h"
 #include "Renderer.h"
 #include "Vector4f.h"
+#include "InitScheduler.h"
+#include <QOpenGLExtraFunctions>
 
 OglObj::OglObj() {
     loaded = false;
@@ -52,7 +54,10 @@ void OglObj::deleteVBO(){
     if(loaded){
         VBO.destroy();
         VAO.destroy();
+        if(instanceVBO.isCreated())
+            instanceVBO.destroy();
     }
+    instanceCount = -1;
     loaded = false;
 }
 
@@ -88,6 +93,7 @@ void OglObj::init(float* punkty, int ptr, enum RenderItem::VertexAttr v, int typ
     //VBO.setUsagePattern(QOpenGLBuffer::DynamicDraw);
     VBO.bind();
     VBO.allocate(punkty, ptr * sizeof (GLfloat));
+    InitScheduler::AddUploadBytes(ptr * sizeof (GLfloat));
     
     if (v == RenderItem::V) {
         f->glEnableVertexAttribArray(0);
@@ -115,6 +121,29 @@ void OglObj::init(float* punkty, int ptr, enum RenderItem::VertexAttr v, int typ
     loaded = true;
 }
 
+bool OglObj::InstancingSupported(){
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    if(context == NULL)
+        return false;
+    return context->format().version() >= qMakePair(3, 3);
+}
+
+// Draws the vertices once per instance. Each instance is 4 floats:
+// offset x, y, z and scale, applied to "vertex" by the vertex shader.
+void OglObj::initInstances(float* instances, int count) {
+    QOpenGLExtraFunctions *f = QOpenGLContext::currentContext()->extraFunctions();
+    QOpenGLVertexArrayObject::Binder vaoBinder(&VAO);
+    if(!instanceVBO.isCreated())
+        instanceVBO.create();
+    instanceVBO.bind();
+    instanceVBO.allocate(instances, count * 4 * sizeof (GLfloat));
+    f->glEnableVertexAttribArray(4);
+    f->glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, 4 * sizeof (GLfloat), 0);
+    f->glVertexAttribDivisor(4, 1);
+    instanceVBO.release();
+    instanceCount = count;
+}
+
 void OglObj::setLineWidth(int val){
     lineWidth = val;
 }
@@ -225,7 +254,10 @@ void OglObj::render(int selectionColor, float lod) {
     gluu->currentShader->setUniformValue(gluu->currentShader->msMatrixUniform, *reinterpret_cast<float(*)[4][4]>(gluu->objStrMatrix));
     gluu->currentMsMatrinxHash = 0;//gluu->getMatrixHash(gluu->objStrMatrix);
     QOpenGLVertexArrayObject::Binder vaoBinder(&VAO);
-    f->glDrawArrays(shapeType, 0, length); /**/
+    if(instanceCount > 0)
+        QOpenGLContext::currentContext()->extraFunctions()->glDrawArraysInstanced(shapeType, 0, length, instanceCount);
+    else if(instanceCount < 0)
+        f->glDrawArrays(shapeType, 0, length); /**/
     
     if(lineWidth > 0 && lineWidth != Game::oglDefaultLineWidth)
         f->glLineWidth(Game::oglDefaultLineWidth);
@@ -24,6 +24,8 @@ public:
     OglObj(const OglObj& orig);
     virtual ~OglObj();
     void init(float* punkty, int ptr, enum RenderItem::VertexAttr v, int type);
+    void initInstances(float* instances, int count);
+    static bool InstancingSupported();
     virtual void pushRenderItem();
     virtual void pushRenderItem(int selectionColor, float lod = 0);
     virtual void render();
@@ -41,6 +43,8 @@ public:
 private:
     QOpenGLBuffer VBO;
     QOpenGLVertexArrayObject VAO;
+    QOpenGLBuffer instanceVBO;
+    int instanceCount = -1;
     int length; 
     int shapeType;
     int texId;
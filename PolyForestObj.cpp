@@ -10,6 +10,7 @@
 
 #include <QFile>
 #include "PolyForestObj.h"
+#include "ForestObj.h"
 #include "GLMatrix.h"
 #include <math.h>
 #include "ParserX.h"
@@ -21,6 +22,7 @@
 #include "TerrainLib.h"
 #include "TS.h"
 #include "Game.h"
+#include "InitScheduler.h"
 #include "FileFunctions.h"
 #include "ReadFile.h"
 #include "TDB.h"
@@ -338,24 +340,15 @@ void PolyForestObj::drawShape(){
     }*/
 
     if (!init) {
-        if(!Game::ignoreLoadLimits){
-            if(Game::allowObjLag < 1)  return;
-            Game::allowObjLag-=2;
-        }
+        bool scheduled = !Game::ignoreLoadLimits;
+        if(scheduled && !InitScheduler::Allow(this, GLUU::get()->mvMatrix, qMax(areaX, areaZ) * 0.5f))
+            return;
         
         //qint64 timeNow = QDateTime::currentMSecsSinceEpoch();
             
-            int iloscv = population*24;
-            float* punkty = new float[iloscv*9];
-            int ptr = 0;
-            
-            GLUU* gluu = GLUU::get();
-            float alpha = -gluu->alphaTest;
-
             int seed = (int)(position[0] + position[1] + position[2]);
             //Random random = new Random(seed);
             std::srand(seed);
-            float treeSizeXt = treeSizeX*0.7;
             float posT[2];
             posT[0] = x;
             posT[1] = y;
@@ -406,67 +399,30 @@ void PolyForestObj::drawShape(){
                 if(Game::roadDB != NULL)
                     Game::roadDB->fillNearestSquaredDistanceToTDBXZ(posT, fpoints, bBox);
             }
+            // heights for all trees at once, terrain is looked up per tile
+            Game::terrainLib->fillHeights(x, y, fpoints);
+
+            // scale of each tree is drawn after the positions,
+            // so forests keep their trees where they were
+            QVector<float> trees;
+            trees.reserve(population*4);
             for(int uu = 0; uu < population; uu++){
+                float scale = 1;
+                if(scaleRangeX > 0 && scaleRangeZ > scaleRangeX)
+                    scale = scaleRangeX + ((float)((std::rand()%1000))/1000)*(scaleRangeZ - scaleRangeX);
                 if(ForestClearDistance > 0){
                     if(fpoints[uu].c < ForestClearDistance*ForestClearDistance)
                         continue;
                 }
-
-                float wysokosc = Game::terrainLib->getHeight(x, y, fpoints[uu].x, fpoints[uu].z);
-                
-                tposx = fpoints[uu].x - position[0];
-                tposz = fpoints[uu].z - position[2];
-                
-                for(int j = -1; j < 2; j+=2){
-                    for(int i = -1; i<2; i+=2){
-                            punkty[ptr++] = -treeSizeXt*i*j/2.0 + tposx;
-                            punkty[ptr++] = wysokosc+treeSizeZ;
-                            punkty[ptr++] = -treeSizeXt*i/2.0 + tposz;
-                            punkty[ptr++] = 0; punkty[ptr++] = 1; punkty[ptr++] = 0;
-                            punkty[ptr++] = 0; punkty[ptr++] = 0;
-                            punkty[ptr++] = alpha;
-                            
-                            punkty[ptr++] = treeSizeXt*i*j/2.0 + tposx;
-                            punkty[ptr++] = wysokosc+treeSizeZ;
-                            punkty[ptr++] = treeSizeXt*i/2.0 + tposz;
-                            punkty[ptr++] = 0; punkty[ptr++] = 1; punkty[ptr++] = 0;
-                            punkty[ptr++] = 1; punkty[ptr++] = 0;
-                            punkty[ptr++] = alpha;
-                            
-                            punkty[ptr++] = treeSizeXt*i*j/2.0 + tposx;
-                            punkty[ptr++] = wysokosc;
-                            punkty[ptr++] = treeSizeXt*i/2.0 + tposz;
-                            punkty[ptr++] = 0; punkty[ptr++] = 1; punkty[ptr++] = 0;
-                            punkty[ptr++] = 1; punkty[ptr++] = 1;
-                            punkty[ptr++] = alpha;
-                            
-                            punkty[ptr++] = -treeSizeXt*i*j/2.0 + tposx;
-                            punkty[ptr++] = wysokosc;
-                            punkty[ptr++] = -treeSizeXt*i/2.0 + tposz;
-                            punkty[ptr++] = 0; punkty[ptr++] = 1; punkty[ptr++] = 0;
-                            punkty[ptr++] = 0; punkty[ptr++] = 1;
-                            punkty[ptr++] = alpha;
-                            
-                            punkty[ptr++] = -treeSizeXt*i*j/2.0 + tposx;
-                            punkty[ptr++] = wysokosc+treeSizeZ;
-                            punkty[ptr++] = -treeSizeXt*i/2.0 + tposz;
-                            punkty[ptr++] = 0; punkty[ptr++] = 1; punkty[ptr++] = 0;
-                            punkty[ptr++] = 0; punkty[ptr++] = 0;
-                            punkty[ptr++] = alpha;
-                            
-                            punkty[ptr++] = treeSizeXt*i*j/2.0 + tposx;
-                            punkty[ptr++] = wysokosc;
-                            punkty[ptr++] = treeSizeXt*i/2.0 + tposz;
-                            punkty[ptr++] = 0; punkty[ptr++] = 1; punkty[ptr++] = 0;
-                            punkty[ptr++] = 1; punkty[ptr++] = 1;
-                            punkty[ptr++] = alpha;
-                    }
-                }
+                trees.push_back(fpoints[uu].x - position[0]);
+                trees.push_back(fpoints[uu].y);
+                trees.push_back(fpoints[uu].z - position[2]);
+                trees.push_back(scale);
             }
             
         texturePath = new QString(resPath.toLower()+"/"+treeTexture.toLower());
         shape.setMaterial(texturePath);
-        shape.init(punkty, ptr, RenderItem::VNTA, GL_TRIANGLES);
+        ForestObj::InitTreeShape(shape, trees, treeSizeX, treeSizeZ);
         /*shape.VAO.create();
         QOpenGLVertexArrayObject::Binder vaoBinder(&shape.VAO);
 
@@ -481,7 +437,8 @@ void PolyForestObj::drawShape(){
         //shape.iloscv = ptr/8;
         //qint64 timeNow2 = QDateTime::currentMSecsSinceEpoch();
         //qDebug() << "polyForest gen time: " << (timeNow2 - timeNow);
-        delete[] punkty;
+        if(scheduled)
+            InitScheduler::Done();
         init = true;
     }
     shape.render();
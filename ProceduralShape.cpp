@@ -21,8 +21,60 @@
 #include "Intersections.h"
 #include "ComplexLine.h"
 #include "ShapeTemplates.h"
+#include "ProceduralShapeCache.h"
+#include <QAtomicInt>
+#include <QMutex>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+// Generates one shape on a worker thread. Inputs are copies, TSections
+// are collected on the GL thread; the result is plain vertex data that
+// TakeShape turns into OglObjs. Shapes in the disk cache are read from
+// there instead.
+class ProceduralShapeTask : public QRunnable {
+public:
+    QString hash;
+    bool bake = false;
+    QString templateName;
+    TrackShape *tsh = NULL;
+    QVector<QVector<TSection>> paths;
+    QMap<int, float> angles;
+    ComplexLine line;
+    int shapeOffset = 0;
+    QVector<ShapePart> parts;
+    QAtomicInt cancelled;
+    QAtomicInt done;
+
+    void run(){
+        if(cancelled.loadAcquire()){
+            done.storeRelease(1);
+            return;
+        }
+        if(bake || !ProceduralShapeCache::Read(hash, parts)){
+            if(tsh != NULL)
+                ProceduralShape::GenShape(templateName, parts, tsh, paths, angles);
+            else
+                ProceduralShape::GenShape(templateName, parts, line, shapeOffset);
+            ProceduralShapeCache::Write(hash, parts);
+        }
+        done.storeRelease(1);
+    }
+};
+
+// vertex data of one generated part is written here before it is copied
+// out at its real size; each worker keeps its own between shapes
+static thread_local QVector<float> Scratch;
+static QMutex FilesLock;
 
 QHash<QString, QVector<OglObj*>> ProceduralShape::Shapes;
+QHash<QString, ProceduralShapeTask*> ProceduralShape::Pending;
+QHash<QString, int> ProceduralShape::Refs;
+QHash<QString, qint64> ProceduralShape::Bytes;
+QHash<OglObj*, QString> ProceduralShape::Owners;
+QList<QString> ProceduralShape::Unused;
+qint64 ProceduralShape::UnusedBytes = 0;
+QSet<QString> ProceduralShape::Baked;
 ShapeTemplates *ProceduralShape::ShapeTemplateFile = NULL;
 GlobalDefinitions *ProceduralShape::GlobalDefinitionFile = NULL;
 
@@ -42,6 +94,7 @@ ObjFile* ProceduralShape::GetObjFile(QString name) {
     if(file.exists())
         path = pathRoute;
 
+    QMutexLocker lock(&FilesLock);
     if (Files[path] == NULL)
         Files[path] = new ObjFile(path);
     return Files[path];
@@ -64,6 +117,7 @@ void ProceduralShape::Load() {
         return;
     // Load Templates
     ShapeTemplateFile = new ShapeTemplates();
+    ProceduralShapeCache::Init();
 
     Alpha = -0.3;
     Loaded = true;
@@ -76,10 +130,35 @@ QString ProceduralShape::GetShapeHash(QString templateName, TrackShape* tsh, QMa
         i.next();
         angless += QString::number(i.key(), 16) + QString::number((int)(i.value()*100), 16) + "_";
     }
-    return tsh->getHashString() + QString::number(shapeOffset, 16) + angless + templateName;
+    return GetGeometryHash(tsh) + QString::number(shapeOffset, 16) + angless + templateName;
     //return QString::number(QTime::currentTime().msecsSinceStartOfDay());
 }
 
+// Track shape ids and section ids are route-local and are renumbered or
+// reused, so shapes are keyed by the path placement and section geometry
+// the ids stand for, plus the path layout fields GenShape and
+// GenAdvancedTie branch on. The key is kept in the disk cache across sessions.
+QString ProceduralShape::GetGeometryHash(TrackShape* tsh){
+    QString hash = "n" + QString::number(tsh->numpaths) + "m" + QString::number(tsh->mainroute)
+            + "x" + QString::number(tsh->xoverpts);
+    for (int j = 0; j < tsh->numpaths; j++) {
+        TrackShape::SectionIdx *section = &tsh->path[j];
+        hash += "p" + QString::number(section->pos[0], 'g', 9) + "," + QString::number(section->pos[1], 'g', 9)
+                + "," + QString::number(section->pos[2], 'g', 9) + "," + QString::number(section->rotDeg, 'g', 9);
+        for (int i = 0; i < section->n; i++) {
+            auto it = Game::currentRoute->tsection->sekcja.find((int) section->sect[i]);
+            TSection *sect = it == Game::currentRoute->tsection->sekcja.end() ? NULL : it->second;
+            if (sect == NULL) {
+                hash += "s-";
+                continue;
+            }
+            hash += "s" + QString::number(sect->type) + "," + QString::number(sect->size, 'g', 9)
+                    + "," + QString::number(sect->radius, 'g', 9) + "," + QString::number(sect->angle, 'g', 9);
+        }
+    }
+    return hash;
+}
+
 QString ProceduralShape::GetShapeHash(QString templateName, QVector<TSection> &sections, int shapeOffset){
     QString sectionHash; 
     for(int i = 0; i < sections.size(); i++)
@@ -94,19 +173,20 @@ QString ProceduralShape::GetShapeHash(QString templateName, ComplexLine &line, i
     //return QString::number(QTime::currentTime().msecsSinceStartOfDay());
 }
 
-void ProceduralShape::GetShape(QString templateName, QVector<OglObj*>& shape, TrackShape* tsh, QMap<int, float> &angles) {
+bool ProceduralShape::GetShape(QString templateName, QVector<OglObj*>& shape, TrackShape* tsh, QMap<int, float> &angles) {
     QString hash = ProceduralShape::GetShapeHash(templateName, tsh, angles, 0);
-    if(ProceduralShape::Shapes[hash].size() == 0){
-        qDebug() << "New Procedural Shape: "<< ShapeCount++ << hash;
-        ProceduralShape::GenShape(templateName, ProceduralShape::Shapes[hash], tsh, angles);
+    if(!Shapes.contains(hash) && !Pending.contains(hash)){
+        ProceduralShapeTask *task = new ProceduralShapeTask();
+        task->templateName = templateName;
+        task->tsh = tsh;
+        task->angles = angles;
+        GetPathSections(tsh, task->paths);
+        StartTask(hash, task);
     }
-    shape.append(ProceduralShape::Shapes[hash]);
+    return TakeShape(hash, shape);
 }
 
-void ProceduralShape::GenShape(QString templateName, QVector<OglObj*>& shape, TrackShape* tsh, QMap<int, float> &angles) {
-    if (!Loaded)
-        Load();
-
+void ProceduralShape::GenShape(QString templateName, QVector<ShapePart>& shape, TrackShape* tsh, QVector<QVector<TSection>> &paths, QMap<int, float> &angles) {
     if (tsh == NULL)
         return;
 
@@ -119,22 +199,13 @@ void ProceduralShape::GenShape(QString templateName, QVector<OglObj*>& shape, Tr
     if(templateName == "" || templateName == "DEFAULT")
         templateName = "DefaultTrack";
     
-    if(ShapeTemplateFile->templates[templateName] == NULL)
+    ShapeTemplate *sTemplate = ShapeTemplateFile->templates.value(templateName, NULL);
+    if(sTemplate == NULL)
         return;
     
-    ShapeTemplate *sTemplate = ShapeTemplateFile->templates[templateName];
-    
     ComplexLine *line = new ComplexLine[tsh->numpaths];
-    for (int j = 0; j < tsh->numpaths; j++) {
-        TrackShape::SectionIdx *section = &tsh->path[j];
-
-        QVector<TSection> sections;
-        for (int i = 0; i < section->n; i++) {
-            if (Game::currentRoute->tsection->sekcja[(int) section->sect[i]] != NULL)
-                sections.push_back(*Game::currentRoute->tsection->sekcja[(int) section->sect[i]]);
-        }
-        line[j].init(sections);
-    }
+    for (int j = 0; j < tsh->numpaths; j++)
+        line[j].init(paths[j]);
     
     QHashIterator<QString, ShapeTemplateElement*> i(sTemplate->elements);
     while (i.hasNext()) {
@@ -143,9 +214,9 @@ void ProceduralShape::GenShape(QString templateName, QVector<OglObj*>& shape, Tr
             continue;
         if(i.value()->type == ShapeTemplateElement::TIE){
             if(tsh->numpaths == 2 && tsh->xoverpts > 0){
-                GenAdvancedTie(i.value(), shape, tsh, angles);
+                GenAdvancedTie(i.value(), shape, tsh, paths, angles);
             } else if(tsh->numpaths == 2 && tsh->mainroute > -1){
-                GenAdvancedTie(i.value(), shape, tsh, angles);
+                GenAdvancedTie(i.value(), shape, tsh, paths, angles);
             } else {
                 for (int j = 0; j < tsh->numpaths; j++) {
                     GenTie(i.value(), shape, line[j], tsh->path[j].pos, -tsh->path[j].rotDeg, angles[j * 2], angles[j * 2 + 1]);
@@ -168,47 +239,169 @@ void ProceduralShape::GenShape(QString templateName, QVector<OglObj*>& shape, Tr
     return;
 }
 
-void ProceduralShape::GetShape(QString templateName, QVector<OglObj*>& shape, QVector<TSection> &sections, int shapeOffset) {
+bool ProceduralShape::GetShape(QString templateName, QVector<OglObj*>& shape, QVector<TSection> &sections, int shapeOffset) {
     QString hash = ProceduralShape::GetShapeHash(templateName, sections, shapeOffset);
-    if(ProceduralShape::Shapes[hash].size() == 0){
-        qDebug() << "New Procedural Shape: "<< ShapeCount++ << hash;
-        ProceduralShape::GenShape(templateName, ProceduralShape::Shapes[hash], sections, shapeOffset);
+    if(!Shapes.contains(hash) && !Pending.contains(hash)){
+        ProceduralShapeTask *task = new ProceduralShapeTask();
+        task->templateName = templateName;
+        task->line.init(sections);
+        task->shapeOffset = shapeOffset;
+        StartTask(hash, task);
+    }
+    return TakeShape(hash, shape);
+}
+
+bool ProceduralShape::GetShape(QString templateName, QVector<OglObj*>& shape, ComplexLine& line, int shapeOffset) {
+    QString hash = ProceduralShape::GetShapeHash(templateName, line, shapeOffset);
+    if(!Shapes.contains(hash) && !Pending.contains(hash)){
+        ProceduralShapeTask *task = new ProceduralShapeTask();
+        task->templateName = templateName;
+        task->line = line;
+        task->shapeOffset = shapeOffset;
+        StartTask(hash, task);
     }
-    shape.append(ProceduralShape::Shapes[hash]);
+    return TakeShape(hash, shape);
 }
 
-void ProceduralShape::GenShape(QString templateName, QVector<OglObj*>& shape, QVector<TSection> &sections, int shapeOffset) {
+void ProceduralShape::StartTask(QString hash, ProceduralShapeTask *task) {
     if (!Loaded)
         Load();
+    if(Game::debugOutput) qDebug() << "New Procedural Shape: "<< ShapeCount++ << hash;
+    task->hash = hash;
+    Pending[hash] = task;
+    task->setAutoDelete(false);
+    QThreadPool::globalInstance()->start(task);
+}
 
-    ComplexLine line;
-    line.init(sections);
+bool ProceduralShape::TakeShape(QString hash, QVector<OglObj*> &shape) {
+    ProceduralShapeTask *task = Pending.value(hash, NULL);
+    if(task != NULL){
+        if(!task->done.loadAcquire())
+            return false;
+        // buffers are made here, on the GL thread
+        QVector<OglObj*> &objects = Shapes[hash];
+        qint64 bytes = 0;
+        for(int i = 0; i < task->parts.size(); i++){
+            ShapePart &part = task->parts[i];
+            objects.push_back(new OglObj());
+            objects.back()->setMaterial(new QString(part.texture));
+            objects.back()->init(part.data.data(), part.data.size(), RenderItem::VNTA, GL_TRIANGLES);
+            objects.back()->setDistanceRange(part.minDistance, part.maxDistance);
+            Owners[objects.back()] = hash;
+            bytes += part.data.size() * sizeof (float);
+        }
+        Bytes[hash] = bytes;
+        Pending.remove(hash);
+        delete task;
+        Trim();
+    }
+    if(Refs[hash]++ == 0 && Unused.removeOne(hash))
+        UnusedBytes -= Bytes[hash];
+    shape.append(Shapes[hash]);
+    return true;
+}
 
-    ProceduralShape::GenShape(templateName, shape, line, shapeOffset);
+// Tasks not started yet return at once, running ones finish their shape;
+// only the tasks of Pending are waited for, not the whole pool.
+void ProceduralShape::CancelPending() {
+    foreach(ProceduralShapeTask *task, Pending)
+        task->cancelled.storeRelease(1);
+    foreach(ProceduralShapeTask *task, Pending){
+        while(!task->done.loadAcquire())
+            QThread::msleep(1);
+        delete task;
+    }
+    Pending.clear();
 }
-    
 
-void ProceduralShape::GetShape(QString templateName, QVector<OglObj*>& shape, ComplexLine& line, int shapeOffset) {
-    QString hash = ProceduralShape::GetShapeHash(templateName, line, shapeOffset);
-    if(ProceduralShape::Shapes[hash].size() == 0){
-        qDebug() << "New Procedural Shape: "<< ShapeCount++ << hash;
-        ProceduralShape::GenShape(templateName, ProceduralShape::Shapes[hash], line, shapeOffset);
+void ProceduralShape::Release(QVector<OglObj*> &shape) {
+    if(shape.size() > 0){
+        QString hash = Owners.value(shape[0]);
+        if(Refs.contains(hash) && --Refs[hash] == 0){
+            Unused.push_back(hash);
+            UnusedBytes += Bytes[hash];
+        }
+    }
+    shape.clear();
+}
+
+// Deletes least recently used shapes no object draws until the rest fits
+// in proceduralMemoryCache MB. Runs on the GL thread only, Release may not.
+void ProceduralShape::Trim() {
+    qint64 budget = (qint64)Game::proceduralMemoryCache * 1024 * 1024;
+    while(UnusedBytes > budget && Unused.size() > 0){
+        QString hash = Unused.takeFirst();
+        QVector<OglObj*> &objects = Shapes[hash];
+        for(int i = 0; i < objects.size(); i++){
+            Owners.remove(objects[i]);
+            objects[i]->deleteVBO();
+            delete objects[i];
+        }
+        UnusedBytes -= Bytes[hash];
+        Shapes.remove(hash);
+        Refs.remove(hash);
+        Bytes.remove(hash);
+    }
+}
+
+bool ProceduralShape::Bake(QString templateName, TrackShape* tsh, QMap<int, float> &angles) {
+    if (!Loaded)
+        Load();
+    if (tsh == NULL)
+        return false;
+    QString hash = ProceduralShape::GetShapeHash(templateName, tsh, angles, 0);
+    if(Baked.contains(hash) || ProceduralShapeCache::Contains(hash))
+        return false;
+    Baked.insert(hash);
+    ProceduralShapeTask *task = new ProceduralShapeTask();
+    task->hash = hash;
+    task->bake = true;
+    task->templateName = templateName;
+    task->tsh = tsh;
+    task->angles = angles;
+    GetPathSections(tsh, task->paths);
+    QThreadPool::globalInstance()->start(task);
+    return true;
+}
+
+void ProceduralShape::GetPathSections(TrackShape* tsh, QVector<QVector<TSection>> &paths) {
+    if (tsh == NULL)
+        return;
+    for (int j = 0; j < tsh->numpaths; j++) {
+        TrackShape::SectionIdx *section = &tsh->path[j];
+        paths.push_back(QVector<TSection>());
+        for (int i = 0; i < section->n; i++) {
+            TSection *sect = Game::currentRoute->tsection->sekcja[(int) section->sect[i]];
+            if (sect != NULL)
+                paths.back().push_back(*sect);
+        }
     }
-    shape.append(ProceduralShape::Shapes[hash]);
 }
 
-void ProceduralShape::GenShape(QString templateName, QVector<OglObj*>& shape, ComplexLine& line, int shapeOffset){
+float* ProceduralShape::GetScratch(int length) {
+    if (Scratch.size() < length)
+        Scratch.resize(length);
+    return Scratch.data();
+}
+
+void ProceduralShape::PushPart(QVector<ShapePart> &shape, ShapeTemplateElement *stemplate, float *p, int length) {
+    shape.push_back(ShapePart());
+    shape.back().texture = ProceduralShape::GetTexturePath(stemplate->texture);
+    shape.back().minDistance = stemplate->minDistance;
+    shape.back().maxDistance = stemplate->maxDistance;
+    shape.back().data = QVector<float>(length);
+    memcpy(shape.back().data.data(), p, length * sizeof (float));
+}
+
+void ProceduralShape::GenShape(QString templateName, QVector<ShapePart>& shape, ComplexLine& line, int shapeOffset){
     //unsigned long long int timeNow = QDateTime::currentMSecsSinceEpoch();
-    Alpha = -0.3;
-    
     if(templateName == "" || templateName == "DEFAULT")
         templateName = "DefaultTrack";
     
-    if(ShapeTemplateFile->templates[templateName] == NULL)
+    ShapeTemplate *sTemplate = ShapeTemplateFile->templates.value(templateName, NULL);
+    if(sTemplate == NULL)
         return;
     
-    ShapeTemplate *sTemplate = ShapeTemplateFile->templates[templateName];
-    
     QHashIterator<QString, ShapeTemplateElement*> i(sTemplate->elements);
     while (i.hasNext()) {
         i.next();
@@ -232,9 +425,7 @@ void ProceduralShape::GenShape(QString templateName, QVector<OglObj*>& shape, Co
 
 }
 
-void ProceduralShape::GenRails(ShapeTemplateElement *stemplate, QVector<OglObj*> &shape, ComplexLine &line) {
-    float* p = new float[2000000];
-    float* ptr = p;
+void ProceduralShape::GenRails(ShapeTemplateElement *stemplate, QVector<ShapePart> &shape, ComplexLine &line) {
 
     float q[4];
     float posRot[6];
@@ -243,10 +434,11 @@ void ProceduralShape::GenRails(ShapeTemplateElement *stemplate, QVector<OglObj*>
     float vOffset[3];
     ObjFile *tFile;
 
-    QString* texturePath;
 
     tFile = GetObjFile(stemplate->shape.first());
     float step = 3;
+    float* p = GetScratch(((int)(line.length/step) + 2) * tFile->count * 9);
+    float* ptr = p;
     for (float i = 0; i < line.length; i += step) {
         line.getDrawPosition(posRot, i, stemplate->xOffset);
         Quat::fromRotationXYZ(q, (float*) (posRot + 3));
@@ -263,19 +455,11 @@ void ProceduralShape::GenRails(ShapeTemplateElement *stemplate, QVector<OglObj*>
         PushShapePartExpand(ptr, tFile, stemplate->yOffset, matrix1, matrix2, q, i, i + step);
     }
 
-    texturePath = new QString(ProceduralShape::GetTexturePath(stemplate->texture));
-    shape.push_back(new OglObj());
-    shape.back()->setMaterial(texturePath);
-    shape.back()->init(p, ptr - p, RenderItem::VNTA, GL_TRIANGLES);
-    shape.back()->setDistanceRange(stemplate->minDistance, stemplate->maxDistance);
-    
-    delete[] p;
+    PushPart(shape, stemplate, p, ptr - p);
 }
 
-void ProceduralShape::GenRails(ShapeTemplateElement *stemplate, QVector<OglObj*>& shape, ComplexLine& line, float* sPos, float sAngle, float angleB, float angleE) {
+void ProceduralShape::GenRails(ShapeTemplateElement *stemplate, QVector<ShapePart>& shape, ComplexLine& line, float* sPos, float sAngle, float angleB, float angleE) {
     float matrixS[16];
-    float* p = new float[4000000];
-    float* ptr = p;
 
     float q[4];
     float qr[4];
@@ -284,7 +468,6 @@ void ProceduralShape::GenRails(ShapeTemplateElement *stemplate, QVector<OglObj*>
     float matrix2[16];
     ObjFile *tFile;
 
-    QString* texturePath;
 
 
     float pp[3];
@@ -298,6 +481,8 @@ void ProceduralShape::GenRails(ShapeTemplateElement *stemplate, QVector<OglObj*>
 
     tFile = GetObjFile(stemplate->shape.first());
     float step = 3;
+    float* p = GetScratch(((int)(line.length/step) + 2) * tFile->count * 9);
+    float* ptr = p;
     for (float i = 0; i < line.length; i += step) {
         line.getDrawPosition(posRot, i, stemplate->xOffset);
         Quat::fill(qr);
@@ -323,18 +508,10 @@ void ProceduralShape::GenRails(ShapeTemplateElement *stemplate, QVector<OglObj*>
         PushShapePartExpand(ptr, tFile, stemplate->yOffset, matrix1, matrix2, qr, i, i + step);
     }
 
-    texturePath = new QString(ProceduralShape::GetTexturePath(stemplate->texture));
-    shape.push_back(new OglObj());
-    shape.back()->setMaterial(texturePath);
-    shape.back()->init(p, ptr - p, RenderItem::VNTA, GL_TRIANGLES);
-    shape.back()->setDistanceRange(stemplate->minDistance, stemplate->maxDistance);
-    
-    delete[] p;
+    PushPart(shape, stemplate, p, ptr - p);
 }
 
-void ProceduralShape::GenPointShape(ShapeTemplateElement *stemplate, QVector<OglObj*> &shape, ComplexLine &line, int shapeOffset) {
-    float* p = new float[2000000];
-    float* ptr = p;
+void ProceduralShape::GenPointShape(ShapeTemplateElement *stemplate, QVector<ShapePart> &shape, ComplexLine &line, int shapeOffset) {
 
     float q[4];
     float posRot[6];
@@ -342,30 +519,21 @@ void ProceduralShape::GenPointShape(ShapeTemplateElement *stemplate, QVector<Ogl
     float matrix2[16];
     ObjFile *tFile;
 
-    QString* texturePath;
 
     shapeOffset = shapeOffset % stemplate->shape.size();
     tFile = GetObjFile(stemplate->shape[shapeOffset]);
+    float* p = GetScratch(tFile->count * 9);
+    float* ptr = p;
 
     line.getDrawPosition(posRot, 0);
     Quat::fromRotationXYZ(q, (float*) (posRot + 3));
     Mat4::fromRotationTranslation(matrix1, q, posRot);
     //PushShapePart(ptr, tFile, 0.0, matrix1, q, line.length);
     PushShapePart(ptr, tFile, 0.0, matrix1, q);
-    texturePath = new QString(ProceduralShape::GetTexturePath(stemplate->texture));
-    shape.push_back(new OglObj());
-    shape.back()->setMaterial(texturePath);
-    shape.back()->init(p, ptr - p, RenderItem::VNTA, GL_TRIANGLES);
-    shape.back()->setDistanceRange(stemplate->minDistance, stemplate->maxDistance);
-    
-    ptr = p;
-
-    delete[] p;
+    PushPart(shape, stemplate, p, ptr - p);
 }
 
-void ProceduralShape::GenStretch(ShapeTemplateElement *stemplate, QVector<OglObj*> &shape, ComplexLine &line, int shapeOffset) {
-    float* p = new float[2000000];
-    float* ptr = p;
+void ProceduralShape::GenStretch(ShapeTemplateElement *stemplate, QVector<ShapePart> &shape, ComplexLine &line, int shapeOffset) {
 
     float q[4];
     float posRot[6];
@@ -373,30 +541,21 @@ void ProceduralShape::GenStretch(ShapeTemplateElement *stemplate, QVector<OglObj
     float matrix2[16];
     ObjFile *tFile;
 
-    QString* texturePath;
 
     shapeOffset = shapeOffset % stemplate->shape.size();
     tFile = GetObjFile(stemplate->shape[shapeOffset]);
+    float* p = GetScratch(tFile->count * 9);
+    float* ptr = p;
 
     line.getDrawPosition(posRot, 0);
     Quat::fromRotationXYZ(q, (float*) (posRot + 3));
     Mat4::fromRotationTranslation(matrix1, q, posRot);
     PushShapePartStretch(ptr, tFile, 0.0, matrix1, q, line.length);
 
-    texturePath = new QString(ProceduralShape::GetTexturePath(stemplate->texture));
-    shape.push_back(new OglObj());
-    shape.back()->setMaterial(texturePath);
-    shape.back()->init(p, ptr - p, RenderItem::VNTA, GL_TRIANGLES);
-    shape.back()->setDistanceRange(stemplate->minDistance, stemplate->maxDistance);
-    
-    ptr = p;
-
-    delete[] p;
+    PushPart(shape, stemplate, p, ptr - p);
 }
 
-void ProceduralShape::GenBallast(ShapeTemplateElement *stemplate, QVector<OglObj*> &shape, ComplexLine &line) {
-    float* p = new float[2000000];
-    float* ptr = p;
+void ProceduralShape::GenBallast(ShapeTemplateElement *stemplate, QVector<ShapePart> &shape, ComplexLine &line) {
 
     float q[4];
     float posRot[6];
@@ -404,10 +563,11 @@ void ProceduralShape::GenBallast(ShapeTemplateElement *stemplate, QVector<OglObj
     float matrix2[16];
     ObjFile *tFile;
 
-    QString* texturePath;
 
     tFile = GetObjFile(stemplate->shape.first());
     float step = 4;
+    float* p = GetScratch(((int)(line.length/step) + 2) * tFile->count * 9);
+    float* ptr = p;
     for (float i = 0; i < line.length; i += step) {
         line.getDrawPosition(posRot, i);
         Quat::fromRotationXYZ(q, (float*) (posRot + 3));
@@ -418,21 +578,11 @@ void ProceduralShape::GenBallast(ShapeTemplateElement *stemplate, QVector<OglObj
         PushShapePartExpand(ptr, tFile, stemplate->yOffset, matrix1, matrix2, q, i, i + step);
     }
 
-    texturePath = new QString(ProceduralShape::GetTexturePath(stemplate->texture));
-    shape.push_back(new OglObj());
-    shape.back()->setMaterial(texturePath);
-    shape.back()->init(p, ptr - p, RenderItem::VNTA, GL_TRIANGLES);
-    shape.back()->setDistanceRange(stemplate->minDistance, stemplate->maxDistance);
-
-    ptr = p;
-
-    delete[] p;
+    PushPart(shape, stemplate, p, ptr - p);
 }
 
-void ProceduralShape::GenBallast(ShapeTemplateElement *stemplate, QVector<OglObj*>& shape, ComplexLine& line, float* sPos, float sAngle, float angleB, float angleE) {
+void ProceduralShape::GenBallast(ShapeTemplateElement *stemplate, QVector<ShapePart>& shape, ComplexLine& line, float* sPos, float sAngle, float angleB, float angleE) {
     float matrixS[16];
-    float* p = new float[4000000];
-    float* ptr = p;
 
     float q[4];
     float qr[4];
@@ -441,7 +591,6 @@ void ProceduralShape::GenBallast(ShapeTemplateElement *stemplate, QVector<OglObj
     float matrix2[16];
     ObjFile *tFile;
 
-    QString* texturePath;
 
     float pp[3];
     float zangle;
@@ -453,6 +602,8 @@ void ProceduralShape::GenBallast(ShapeTemplateElement *stemplate, QVector<OglObj
 
     tFile = GetObjFile(stemplate->shape.first());
     float step = 4;
+    float* p = GetScratch(((int)(line.length/step) + 2) * tFile->count * 9);
+    float* ptr = p;
     for (float i = 0; i < line.length; i += step) {
         line.getDrawPosition(posRot, i);
         Quat::fill(qr);
@@ -472,18 +623,10 @@ void ProceduralShape::GenBallast(ShapeTemplateElement *stemplate, QVector<OglObj
         PushShapePartExpand(ptr, tFile, stemplate->yOffset, matrix1, matrix2, qr, i, i + step);
     }
 
-    texturePath = new QString(ProceduralShape::GetTexturePath(stemplate->texture));
-    shape.push_back(new OglObj());
-    shape.back()->setMaterial(texturePath);
-    shape.back()->init(p, ptr - p, RenderItem::VNTA, GL_TRIANGLES);
-    shape.back()->setDistanceRange(stemplate->minDistance, stemplate->maxDistance);
-
-    delete[] p;
+    PushPart(shape, stemplate, p, ptr - p);
 }
 
-void ProceduralShape::GenTie(ShapeTemplateElement *stemplate, QVector<OglObj*> &shape, ComplexLine &line) {
-    float* p = new float[2000000];
-    float* ptr = p;
+void ProceduralShape::GenTie(ShapeTemplateElement *stemplate, QVector<ShapePart> &shape, ComplexLine &line) {
 
     float q[4];
     float posRot[6];
@@ -491,29 +634,30 @@ void ProceduralShape::GenTie(ShapeTemplateElement *stemplate, QVector<OglObj*> &
     float matrix2[16];
     ObjFile *tFile;
 
-    QString* texturePath;
 
     tFile = GetObjFile(stemplate->shape.first());
+    float* p = GetScratch(((int)(line.length/0.65) + 2) * tFile->count * 9);
+    float* ptr = p;
+    // tie matrices are made all at once
+    QVector<float> quats;
+    QVector<float> positions;
     for (float i = 0; i < line.length; i += 0.65) {
         line.getDrawPosition(posRot, i);
         Quat::fromRotationXYZ(q, (float*) (posRot + 3));
-        Mat4::fromRotationTranslation(matrix1, q, posRot);
-        PushShapePart(ptr, tFile, 0.155, matrix1, q);
+        quats << q[0] << q[1] << q[2] << q[3];
+        positions << posRot[0] << posRot[1] << posRot[2];
     }
+    int ties = quats.size() / 4;
+    QVector<float> matrices(ties * 16);
+    Mat4::fromRotationTranslationBatch(matrices.data(), quats.data(), positions.data(), ties);
+    for (int i = 0; i < ties; i++)
+        PushShapePart(ptr, tFile, 0.155, matrices.data() + i * 16, quats.data() + i * 4);
 
-    texturePath = new QString(ProceduralShape::GetTexturePath(stemplate->texture));
-    shape.push_back(new OglObj());
-    shape.back()->setMaterial(texturePath);
-    shape.back()->init(p, ptr - p, RenderItem::VNTA, GL_TRIANGLES);
-    shape.back()->setDistanceRange(stemplate->minDistance, stemplate->maxDistance);
-
-    delete[] p;
+    PushPart(shape, stemplate, p, ptr - p);
 }
 
-void ProceduralShape::GenTie(ShapeTemplateElement *stemplate, QVector<OglObj*> &shape, ComplexLine &line, float *sPos, float sAngle, float angleB, float angleE) {
+void ProceduralShape::GenTie(ShapeTemplateElement *stemplate, QVector<ShapePart> &shape, ComplexLine &line, float *sPos, float sAngle, float angleB, float angleE) {
     float matrixS[16];
-    float* p = new float[4000000];
-    float* ptr = p;
 
     float q[4];
     float qr[4];
@@ -522,7 +666,6 @@ void ProceduralShape::GenTie(ShapeTemplateElement *stemplate, QVector<OglObj*> &
     float matrix2[16];
     ObjFile *tFile;
 
-    QString* texturePath;
 
 
     float pp[3];
@@ -535,6 +678,12 @@ void ProceduralShape::GenTie(ShapeTemplateElement *stemplate, QVector<OglObj*> &
 
 
     tFile = GetObjFile(stemplate->shape.first());
+    float* p = GetScratch(((int)(line.length/0.65) + 2) * tFile->count * 9);
+    float* ptr = p;
+    // tie matrices are made all at once
+    QVector<float> quats;
+    QVector<float> positions;
+    QVector<float> rotations;
     for (float i = 0; i < line.length; i += 0.65) {
         line.getDrawPosition(posRot, i);
         Quat::fill(qr);
@@ -542,22 +691,22 @@ void ProceduralShape::GenTie(ShapeTemplateElement *stemplate, QVector<OglObj*> &
         Quat::fromRotationXYZ(q, (float*) (posRot + 3));
         zangle = angleB * (1.0 - i / line.length) + angleE * (i / line.length);
         Quat::rotateZ(q, q, zangle);
-        Mat4::fromRotationTranslation(matrix1, q, posRot);
         Quat::multiply(qr, qr, q);
-        Mat4::multiply(matrix1, matrixS, matrix1);
-        PushShapePart(ptr, tFile, 0.155, matrix1, qr);
+        quats << q[0] << q[1] << q[2] << q[3];
+        positions << posRot[0] << posRot[1] << posRot[2];
+        rotations << qr[0] << qr[1] << qr[2] << qr[3];
     }
-
-    texturePath = new QString(ProceduralShape::GetTexturePath(stemplate->texture));
-    shape.push_back(new OglObj());
-    shape.back()->setMaterial(texturePath);
-    shape.back()->init(p, ptr - p, RenderItem::VNTA, GL_TRIANGLES);
-    shape.back()->setDistanceRange(stemplate->minDistance, stemplate->maxDistance);
-
-    delete[] p;
+    int ties = quats.size() / 4;
+    QVector<float> matrices(ties * 16);
+    Mat4::fromRotationTranslationBatch(matrices.data(), quats.data(), positions.data(), ties);
+    Mat4::multiplyBatch(matrices.data(), matrixS, matrices.data(), ties);
+    for (int i = 0; i < ties; i++)
+        PushShapePart(ptr, tFile, 0.155, matrices.data() + i * 16, rotations.data() + i * 4);
+
+    PushPart(shape, stemplate, p, ptr - p);
 }
 
-void ProceduralShape::GenAdvancedTie(ShapeTemplateElement *stemplate, QVector<OglObj*>& shape, TrackShape* tsh, QMap<int, float>& angles) {
+void ProceduralShape::GenAdvancedTie(ShapeTemplateElement *stemplate, QVector<ShapePart>& shape, TrackShape* tsh, QVector<QVector<TSection>> &paths, QMap<int, float>& angles) {
 
     float matrixS[16];
     float matrixS1[16];
@@ -566,19 +715,8 @@ void ProceduralShape::GenAdvancedTie(ShapeTemplateElement *stemplate, QVector<Og
 
     if (tsh->numpaths == 2) {
         //for(int j = 0; j < tsh->numpaths; j++){
-        TrackShape::SectionIdx *section = &tsh->path[0];
-
-        QVector<TSection> sections1;
-        QVector<TSection> sections2;
-        for (int i = 0; i < section->n; i++) {
-            if (Game::currentRoute->tsection->sekcja[(int) section->sect[i]] != NULL)
-                sections1.push_back(*Game::currentRoute->tsection->sekcja[(int) section->sect[i]]);
-        }
-        section = &tsh->path[1];
-        for (int i = 0; i < section->n; i++) {
-            if (Game::currentRoute->tsection->sekcja[(int) section->sect[i]] != NULL)
-                sections2.push_back(*Game::currentRoute->tsection->sekcja[(int) section->sect[i]]);
-        }
+        QVector<TSection> &sections1 = paths[0];
+        QVector<TSection> &sections2 = paths[1];
         //float* p = new float[4000000];
         //float* ptr = p;
 
@@ -820,31 +958,31 @@ void ProceduralShape::GenAdvancedTie(ShapeTemplateElement *stemplate, QVector<Og
     //}
     //}*/
 
-    float* p = new float[4000000];
+    int length = 0;
+    for (int i = 0; i < primitives.count(); i++)
+        for (int j = 0; j < (primitives[i]).count(); j++)
+            if (!(primitives[i])[j].disabled)
+                length += (primitives[i])[j].count * 9;
+    float* p = GetScratch(length);
     float* ptr = p;
-    QString* texturePath;
 
     for (int i = 0; i < primitives.count(); i++) {
         for (int j = 0; j < (primitives[i]).count(); j++) {
-            if ((primitives[i])[j].disabled)
-                continue;
-            memcpy(ptr, (primitives[i])[j].data, (primitives[i])[j].count * 9 * 4);
-            ptr += (primitives[i])[j].count * 9;
+            if (!(primitives[i])[j].disabled){
+                memcpy(ptr, (primitives[i])[j].data, (primitives[i])[j].count * 9 * 4);
+                ptr += (primitives[i])[j].count * 9;
+            }
+            delete[] (primitives[i])[j].data;
         }
     }
 
-    texturePath = new QString(ProceduralShape::GetTexturePath(stemplate->texture));
-    shape.push_back(new OglObj());
-    shape.back()->setMaterial(texturePath);
-    shape.back()->init(p, ptr - p, RenderItem::VNTA, GL_TRIANGLES);
-    shape.back()->setDistanceRange(stemplate->minDistance, stemplate->maxDistance);
-    
-    delete[] p;
+    PushPart(shape, stemplate, p, ptr - p);
 }
 
 void ProceduralShape::PushShapePart(float* &ptr, ObjFile* tFile, float offsetY, float* matrix, float* qrot, float distance) {
     int j = 0;
     float p[3];
+    float* start = ptr;
     for (int i = 0; i < tFile->count; i++) {
         p[0] = tFile->points[j++];
         p[1] = tFile->points[j++];
@@ -855,9 +993,9 @@ void ProceduralShape::PushShapePart(float* &ptr, ObjFile* tFile, float offsetY,
             if (p[0] < 0)
                 p[0] -= distance;
         }
-        Vec3::transformMat4(p, p, matrix);
+        // positions are transformed below, all at once
         *ptr++ = p[0];
-        *ptr++ = p[1] + offsetY;
+        *ptr++ = p[1];
         *ptr++ = p[2];
         p[0] = tFile->points[j++];
         p[1] = tFile->points[j++];
@@ -870,6 +1008,7 @@ void ProceduralShape::PushShapePart(float* &ptr, ObjFile* tFile, float offsetY,
         *ptr++ = tFile->points[j++];
         *ptr++ = Alpha;
     }
+    TransformPositions(start, tFile->count, offsetY, matrix);
 }
 
 void ProceduralShape::PushShapePartExpand(float* &ptr, ObjFile* tFile, float offsetY, float* matrix1, float* matrix2, float* qrot, float dist1, float dist2) {
@@ -912,15 +1051,11 @@ void ProceduralShape::PushShapePartExpand(float* &ptr, ObjFile* tFile, float off
 void ProceduralShape::PushShapePartStretch(float* &ptr, ObjFile* tFile, float offsetY, float* matrix, float* qrot, float length) {
     int j = 0;
     float p[3];
+    float* start = ptr;
     for (int i = 0; i < tFile->count; i++) {
-        p[0] = tFile->points[j++];
-        p[1] = tFile->points[j++];
-        p[2] = tFile->points[j++]*length;
-
-        Vec3::transformMat4(p, p, matrix);
-        *ptr++ = p[0];
-        *ptr++ = p[1] + offsetY;
-        *ptr++ = p[2];
+        *ptr++ = tFile->points[j++];
+        *ptr++ = tFile->points[j++];
+        *ptr++ = tFile->points[j++]*length;
         p[0] = tFile->points[j++];
         p[1] = tFile->points[j++];
         p[2] = tFile->points[j++];
@@ -932,5 +1067,12 @@ void ProceduralShape::PushShapePartStretch(float* &ptr, ObjFile* tFile, float of
         *ptr++ = tFile->points[j++];
         *ptr++ = Alpha;
     }
+    TransformPositions(start, tFile->count, offsetY, matrix);
+}
+
+void ProceduralShape::TransformPositions(float* ptr, int count, float offsetY, float* matrix) {
+    Vec3::transformMat4Batch(ptr, ptr, count, 9, matrix);
+    for (int i = 0; i < count; i++)
+        ptr[i*9 + 1] += offsetY;
 }
 
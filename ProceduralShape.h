@@ -12,6 +12,7 @@
 #define	PROCEDURALSHAPE_H
 
 #include <QMap>
+#include <QSet>
 #include <QString>
 #include "OglObj.h"
 #include "TSection.h"
@@ -22,6 +23,7 @@ class GlobalDefinitions;
 class ComplexLine;
 class ShapeTemplates;
 class ShapeTemplateElement;
+class ProceduralShapeTask;
 
 struct ShapePrimitive {
     float *data;
@@ -36,7 +38,17 @@ struct ShapePrimitive {
     float rotZ = 0;
 };
 
+// Vertex data of one generated part, made on a worker thread and turned
+// into an OglObj on the GL thread.
+struct ShapePart {
+    QString texture;
+    float minDistance = -1;
+    float maxDistance = 999999;
+    QVector<float> data;
+};
+
 class ProceduralShape {
+    friend class ProceduralShapeTask;
 public:
     static ShapeTemplates *ShapeTemplateFile;
     static GlobalDefinitions* GlobalDefinitionFile;
@@ -47,13 +59,41 @@ public:
     
     static void Load();
     
-    static void GetShape(QString templateName, QVector<OglObj*> &shape, QVector<TSection> &sections, int shapeOffset = 0);
-    static void GetShape(QString templateName, QVector<OglObj*> &shape, TrackShape* tsh, QMap<int, float> &angles);
-    static void GetShape(QString templateName, QVector<OglObj*> &shape, ComplexLine &line, int shapeOffset = 0);
+    // Shapes are generated on the global thread pool. While a shape is
+    // still being made nothing is added to shape and false is returned,
+    // callers draw something else and ask again next frame.
+    static bool GetShape(QString templateName, QVector<OglObj*> &shape, QVector<TSection> &sections, int shapeOffset = 0);
+    static bool GetShape(QString templateName, QVector<OglObj*> &shape, TrackShape* tsh, QMap<int, float> &angles);
+    static bool GetShape(QString templateName, QVector<OglObj*> &shape, ComplexLine &line, int shapeOffset = 0);
+    // Gives back a shape taken by GetShape and clears shape. Shapes no
+    // object uses are kept up to proceduralMemoryCache MB, the least
+    // recently used are deleted first.
+    static void Release(QVector<OglObj*> &shape);
+    // Drops the shapes still being generated, called when the route is
+    // closed as the tasks read its track shapes.
+    static void CancelPending();
+    // Generates a shape into the disk cache on the global thread pool,
+    // false if it is there already. Used to pre-bake whole routes.
+    static bool Bake(QString templateName, TrackShape* tsh, QMap<int, float> &angles);
 
 private:
     static float Alpha;
     static unsigned int ShapeCount;
+    static QHash<QString, ProceduralShapeTask*> Pending;
+    static QHash<QString, int> Refs;
+    static QHash<QString, qint64> Bytes;
+    static QHash<OglObj*, QString> Owners;
+    static QList<QString> Unused;
+    static qint64 UnusedBytes;
+    static QSet<QString> Baked;
+    
+    static void StartTask(QString hash, ProceduralShapeTask *task);
+    static QString GetGeometryHash(TrackShape* tsh);
+    static bool TakeShape(QString hash, QVector<OglObj*> &shape);
+    static void Trim();
+    static void GetPathSections(TrackShape* tsh, QVector<QVector<TSection>> &paths);
+    static float* GetScratch(int length);
+    static void PushPart(QVector<ShapePart> &shape, ShapeTemplateElement *stemplate, float *p, int length);
     
     static ObjFile* GetObjFile(QString name);
     static QString GetTexturePath(QString textureName);
@@ -61,27 +101,27 @@ private:
     static QString GetShapeHash(QString templateName, QVector<TSection> &sections, int shapeOffset);
     static QString GetShapeHash(QString templateName, ComplexLine &line, int shapeOffset);
     
-    static void GenShape(QString templateName, QVector<OglObj*> &shape, QVector<TSection> &sections, int shapeOffset);
-    static void GenShape(QString templateName, QVector<OglObj*> &shape, TrackShape* tsh, QMap<int, float> &angles);
-    static void GenShape(QString templateName, QVector<OglObj*> &shape, ComplexLine &line, int shapeOffset);
+    static void GenShape(QString templateName, QVector<ShapePart> &shape, TrackShape* tsh, QVector<QVector<TSection>> &paths, QMap<int, float> &angles);
+    static void GenShape(QString templateName, QVector<ShapePart> &shape, ComplexLine &line, int shapeOffset);
     
-    static void GenRails(ShapeTemplateElement *stemplate, QVector<OglObj*> &shape, ComplexLine &line);
-    static void GenRails(ShapeTemplateElement *stemplate, QVector<OglObj*> &shape, ComplexLine &line, float *sPos, float sAngle, float angleB, float angleE);
+    static void GenRails(ShapeTemplateElement *stemplate, QVector<ShapePart> &shape, ComplexLine &line);
+    static void GenRails(ShapeTemplateElement *stemplate, QVector<ShapePart> &shape, ComplexLine &line, float *sPos, float sAngle, float angleB, float angleE);
     
-    static void GenBallast(ShapeTemplateElement *stemplate, QVector<OglObj*> &shape, ComplexLine &line);
-    static void GenBallast(ShapeTemplateElement *stemplate, QVector<OglObj*> &shape, ComplexLine &line, float *sPos, float sAngle, float angleB, float angleE);
+    static void GenBallast(ShapeTemplateElement *stemplate, QVector<ShapePart> &shape, ComplexLine &line);
+    static void GenBallast(ShapeTemplateElement *stemplate, QVector<ShapePart> &shape, ComplexLine &line, float *sPos, float sAngle, float angleB, float angleE);
     
-    static void GenTie(ShapeTemplateElement *stemplate, QVector<OglObj*> &shape, ComplexLine &line);
-    static void GenTie(ShapeTemplateElement *stemplate, QVector<OglObj*> &shape, ComplexLine &line, float *sPos, float sAngle, float angleB, float angleE);
+    static void GenTie(ShapeTemplateElement *stemplate, QVector<ShapePart> &shape, ComplexLine &line);
+    static void GenTie(ShapeTemplateElement *stemplate, QVector<ShapePart> &shape, ComplexLine &line, float *sPos, float sAngle, float angleB, float angleE);
     
-    static void GenStretch(ShapeTemplateElement *stemplate, QVector<OglObj*> &shape, ComplexLine &line, int shapeOffset = 0);
-    static void GenPointShape(ShapeTemplateElement *stemplate, QVector<OglObj*> &shape, ComplexLine &line, int shapeOffset = 0);
+    static void GenStretch(ShapeTemplateElement *stemplate, QVector<ShapePart> &shape, ComplexLine &line, int shapeOffset = 0);
+    static void GenPointShape(ShapeTemplateElement *stemplate, QVector<ShapePart> &shape, ComplexLine &line, int shapeOffset = 0);
     
-    static void GenAdvancedTie(ShapeTemplateElement *stemplate, QVector<OglObj*> &shape, TrackShape* tsh, QMap<int, float> &angles);
+    static void GenAdvancedTie(ShapeTemplateElement *stemplate, QVector<ShapePart> &shape, TrackShape* tsh, QVector<QVector<TSection>> &paths, QMap<int, float> &angles);
     
     static void PushShapePart(float* &ptr, ObjFile* tFile, float offsetY, float* matrix, float* qrot, float distance = 0);
     static void PushShapePartExpand(float* &ptr, ObjFile* tFile, float offsetY, float* matrix1, float* matrix2, float* qrot, float dist1, float dist2);
     static void PushShapePartStretch(float* &ptr, ObjFile* tFile, float offsetY, float* matrix, float* qrot, float length);
+    static void TransformPositions(float* ptr, int count, float offsetY, float* matrix);
     
 };
 
@@ -0,0 +1,180 @@
+/*  This file is part of TSRE5.
+ *
+ *  TSRE5 - train sim game engine and MSTS/OR Editors. 
+ *  Copyright (C) 2016 Piotr Gadecki <pgadecki@gmail.com>
+ *
+ *  Licensed under GNU General Public License 3.0 or later. 
+ *
+ *  See LICENSE.md or https://www.gnu.org/licenses/gpl.html
+ */
+
+#include "ProceduralShapeCache.h"
+#include "ProceduralShape.h"
+#include "Game.h"
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDateTime>
+#include <QCryptographicHash>
+
+const quint32 ProceduralShapeCache::Magic = 0x50534843;
+const quint32 ProceduralShapeCache::Version = 3;
+QByteArray ProceduralShapeCache::Key;
+QString ProceduralShapeCache::Dir;
+
+// Files are written in machine byte order and read back with memcpy:
+//   magic, version, byte order, hash length, hash (utf8), part count,
+//   per part: texture length, texture (utf8), min and max distance,
+//   float count, floats.
+void ProceduralShapeCache::Init(){
+    Dir = Game::root + "/routes/" + Game::route + "/cache/procedural/";
+    Dir.replace("//", "/");
+
+    // templates are read from the app folder only, OBJ files and textures
+    // from the route folder first
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData((const char*)&Version, sizeof(Version));
+    QStringList folders;
+    folders.push_back(QString("tsre_appdata/") + Game::AppDataVersion + "/procedural/");
+    folders.push_back(Game::root + "/routes/" + Game::route + "/procedural/");
+    for(int i = 0; i < folders.size(); i++){
+        QStringList files;
+        QDirIterator it(folders[i], QDir::Files, QDirIterator::Subdirectories);
+        while(it.hasNext())
+            files.push_back(it.next());
+        files.sort();
+        for(int j = 0; j < files.size(); j++){
+            QFileInfo info(files[j]);
+            hash.addData(files[j].toUtf8());
+            hash.addData(QByteArray::number(info.size()));
+            hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+        }
+    }
+    Key = hash.result();
+    if(Game::debugOutput) qDebug() << "Procedural cache:" << Dir << Key.toHex();
+}
+
+QString ProceduralShapeCache::FilePath(QString hash){
+    QByteArray name = QCryptographicHash::hash(Key + hash.toUtf8(), QCryptographicHash::Md5).toHex();
+    return Dir + QString::fromLatin1(name) + ".bin";
+}
+
+bool ProceduralShapeCache::Contains(QString hash){
+    if(!Game::proceduralDiskCache) return false;
+    return QFile::exists(FilePath(hash));
+}
+
+bool ProceduralShapeCache::Read(QString hash, QVector<ShapePart> &parts){
+    if(!Game::proceduralDiskCache) return false;
+    QFile file(FilePath(hash));
+    if(!file.open(QIODevice::ReadOnly))
+        return false;
+    qint64 size = file.size();
+    uchar *data = file.map(0, size);
+    if(data == NULL)
+        return false;
+
+    const uchar *ptr = data;
+    const uchar *end = data + size;
+    bool ok = true;
+    auto take = [&](void *dst, qint64 length){
+        if(!ok || end - ptr < length){
+            ok = false;
+            return;
+        }
+        memcpy(dst, ptr, length);
+        ptr += length;
+    };
+    auto takeString = [&](){
+        quint32 length = 0;
+        take(&length, sizeof(length));
+        if(!ok || end - ptr < length){
+            ok = false;
+            return QString();
+        }
+        QString s = QString::fromUtf8((const char*)ptr, length);
+        ptr += length;
+        return s;
+    };
+
+    quint32 magic = 0, version = 0, count = 0;
+    qint32 byteOrder = 0;
+    take(&magic, sizeof(magic));
+    take(&version, sizeof(version));
+    take(&byteOrder, sizeof(byteOrder));
+    if(!ok || magic != Magic || version != Version || byteOrder != (qint32)QSysInfo::ByteOrder){
+        file.unmap(data);
+        return false;
+    }
+    // two hashes in one file name are unlikely, not impossible
+    if(takeString() != hash){
+        file.unmap(data);
+        return false;
+    }
+    take(&count, sizeof(count));
+    QVector<ShapePart> read;
+    for(quint32 i = 0; i < count && ok; i++){
+        read.push_back(ShapePart());
+        ShapePart &part = read.back();
+        part.texture = takeString();
+        take(&part.minDistance, sizeof(float));
+        take(&part.maxDistance, sizeof(float));
+        quint32 floats = 0;
+        take(&floats, sizeof(floats));
+        if(!ok || (quint64)(end - ptr) < (quint64)floats * sizeof(float)){
+            ok = false;
+            break;
+        }
+        part.data.resize(floats);
+        take(part.data.data(), (qint64)floats * sizeof(float));
+    }
+    file.unmap(data);
+    if(!ok){
+        if(Game::debugOutput) qDebug() << "Procedural cache: broken file" << file.fileName();
+        return false;
+    }
+    parts += read;
+    return true;
+}
+
+void ProceduralShapeCache::Write(QString hash, QVector<ShapePart> &parts){
+    if(!Game::writeEnabled) return;
+    if(!Game::proceduralDiskCache) return;
+    QString path = FilePath(hash);
+    QDir().mkpath(Dir);
+    // written to a temporary file and renamed, readers never see half a file
+    QSaveFile file(path);
+    if(!file.open(QIODevice::WriteOnly)){
+        if(Game::debugOutput) qDebug() << "Procedural cache: failed to write" << path;
+        return;
+    }
+    auto put = [&](const void *src, qint64 length){
+        file.write((const char*)src, length);
+    };
+    auto putString = [&](QString s){
+        QByteArray utf8 = s.toUtf8();
+        quint32 length = utf8.size();
+        put(&length, sizeof(length));
+        put(utf8.constData(), length);
+    };
+    qint32 byteOrder = QSysInfo::ByteOrder;
+    quint32 count = parts.size();
+    put(&Magic, sizeof(Magic));
+    put(&Version, sizeof(Version));
+    put(&byteOrder, sizeof(byteOrder));
+    putString(hash);
+    put(&count, sizeof(count));
+    for(int i = 0; i < parts.size(); i++){
+        quint32 floats = parts[i].data.size();
+        putString(parts[i].texture);
+        put(&parts[i].minDistance, sizeof(float));
+        put(&parts[i].maxDistance, sizeof(float));
+        put(&floats, sizeof(floats));
+        put(parts[i].data.constData(), (qint64)floats * sizeof(float));
+    }
+    if(!file.commit())
+        if(Game::debugOutput) qDebug() << "Procedural cache: failed to write" << path;
+}
@@ -0,0 +1,40 @@
+/*  This file is part of TSRE5.
+ *
+ *  TSRE5 - train sim game engine and MSTS/OR Editors. 
+ *  Copyright (C) 2016 Piotr Gadecki <pgadecki@gmail.com>
+ *
+ *  Licensed under GNU General Public License 3.0 or later. 
+ *
+ *  See LICENSE.md or https://www.gnu.org/licenses/gpl.html
+ */
+
+#ifndef PROCEDURALSHAPECACHE_H
+#define PROCEDURALSHAPECACHE_H
+
+#include <QString>
+#include <QVector>
+#include <QByteArray>
+
+struct ShapePart;
+
+// Generated procedural shapes on disk, one file per shape hash in the
+// route cache folder. File names are made from the shape hash and a key
+// of the templates and OBJ files, so editing either of them leaves old
+// files unused. Read and Write are safe to call from worker threads once
+// Init has been called.
+class ProceduralShapeCache {
+public:
+    static void Init();
+    static bool Contains(QString hash);
+    static bool Read(QString hash, QVector<ShapePart> &parts);
+    static void Write(QString hash, QVector<ShapePart> &parts);
+
+private:
+    static const quint32 Magic;
+    static const quint32 Version;
+    static QByteArray Key;
+    static QString Dir;
+    static QString FilePath(QString hash);
+};
+
+#endif /* PROCEDURALSHAPECACHE_H */
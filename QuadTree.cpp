@@ -69,7 +69,10 @@ void QuadTree::load(FileBuffer *data, bool loadtd){
                                 int x = ParserX::GetNumber(data);
                                 int y = ParserX::GetNumber(data);
                                 if(Game::debugOutput) qDebug() << sh << " " << x << " " << y;
-                                loadTD(x, y);
+                                TdFile* ttd = new TdFile();
+                                ttd->x = x*512;
+                                ttd->y = y*512;
+                                td[ttd->x * 100000 + ttd->y] = ttd;
                                 ParserX::SkipToken(data);
                             }
                         }
@@ -97,6 +100,7 @@ void QuadTree::createNew(int tileX, int tileY) {
     TdFile* ttd = new TdFile();
     ttd->x = tx;
     ttd->y = ty;
+    ttd->loaded = true;
     td[ttd->x * 100000 + ttd->y] = ttd;
     ttd->qt = new QuadTile(256, 1, tx, ty);
     int dLevel = 1;
@@ -104,6 +108,7 @@ void QuadTree::createNew(int tileX, int tileY) {
         dLevel = 16;
     ttd->qt->addTile(tileX, tileY, dLevel);
     ttd->modified = true;
+    directory.clear();
     save();
 }
 
@@ -112,7 +117,9 @@ void QuadTree::listNames() {
     QHashIterator<int, TdFile*> i2(td);
     while (i2.hasNext()) {
         i2.next();
-        i2.value()->qt->listNames();
+        TdFile* ttd = getTD(i2.value()->x, i2.value()->y);
+        if(ttd != NULL)
+            ttd->qt->listNames();
     }
 }
 
@@ -120,40 +127,64 @@ bool QuadTree::isLow(){
     return low;
 }
 
-QString QuadTree::getMyName(int tileX, int tileY) {
+QuadTree::TdFile* QuadTree::getTD(int tileX, int tileY) {
     int qx = floor((float) tileX / 512.0);
     int qy = floor((float) tileY / 512.0);
     int tx = qx * 512;
     int ty = qy * 512;
 
-    if (td[tx * 100000 + ty] == NULL) {
-        return "";
+    TdFile* ttd = td.value(tx * 100000 + ty, NULL);
+    if (ttd == NULL)
+        return NULL;
+    if (!ttd->loaded) {
+        ttd->loaded = true;
+        loadTD(qx, qy);
     }
-    return td[tx * 100000 + ty]->qt->getMyName(tileX, tileY);
+    if (ttd->qt == NULL)
+        return NULL;
+    return ttd;
 }
 
-unsigned int QuadTree::getMyNameId(int tileX, int tileY) {
-    int qx = floor((float) tileX / 512.0);
-    int qy = floor((float) tileY / 512.0);
-    int tx = qx * 512;
-    int ty = qy * 512;
-
-    if (td[tx * 100000 + ty] == NULL) {
-        return 0;
+QuadTree::TileEntry QuadTree::findTile(int tileX, int tileY) {
+    // brush and import loops ask for the same tiles over and over,
+    // the tree is only walked once per tile
+    qint64 key = ((qint64)tileX << 32) | (quint32)tileY;
+    QHash<qint64, TileEntry>::const_iterator it = directory.constFind(key);
+    if (it != directory.constEnd())
+        return it.value();
+
+    TileEntry entry;
+    TdFile* ttd = getTD(tileX, tileY);
+    if (ttd != NULL) {
+        TerrainInfo info;
+        if (ttd->qt->fillTerrainInfo(tileX, tileY, &info)) {
+            entry.nameId = ttd->qt->getMyNameId(tileX, tileY);
+            entry.name = info.name;
+            entry.cx = info.cx;
+            entry.cy = info.cy;
+            entry.level = info.level;
+        }
     }
-    return td[tx * 100000 + ty]->qt->getMyNameId(tileX, tileY);
+    directory[key] = entry;
+    return entry;
 }
 
-void QuadTree::fillTerrainInfo(int tileX, int tileY, TerrainInfo* info) {
-    int qx = floor((float) tileX / 512.0);
-    int qy = floor((float) tileY / 512.0);
-    int tx = qx * 512;
-    int ty = qy * 512;
+QString QuadTree::getMyName(int tileX, int tileY) {
+    return findTile(tileX, tileY).name;
+}
+
+unsigned int QuadTree::getMyNameId(int tileX, int tileY) {
+    return findTile(tileX, tileY).nameId;
+}
 
-    if (td[tx * 100000 + ty] == NULL) {
+void QuadTree::fillTerrainInfo(int tileX, int tileY, TerrainInfo* info) {
+    TileEntry entry = findTile(tileX, tileY);
+    if (entry.name.length() == 0)
         return;
-    }
-    td[tx * 100000 + ty]->qt->fillTerrainInfo(tileX, tileY, info);
+    info->name = entry.name;
+    info->cx = entry.cx;
+    info->cy = entry.cy;
+    info->level = entry.level;
     info->low = low;
 }
 
@@ -164,18 +195,25 @@ void QuadTree::addTile(int tileX, int tileY) {
     int tx = qx * 512;
     int ty = qy * 512;
 
-    if (td[tx * 100000 + ty] == NULL) {
-        td[tx * 100000 + ty] = new TdFile();
-        td[tx * 100000 + ty]->x = tx;
-        td[tx * 100000 + ty]->y = ty;
-        td[tx * 100000 + ty]->qt = new QuadTile(256, 1, tx, ty);
+    TdFile* ttd = getTD(tileX, tileY);
+    if (ttd == NULL) {
+        ttd = td.value(tx * 100000 + ty, NULL);
+        if (ttd == NULL) {
+            ttd = new TdFile();
+            ttd->x = tx;
+            ttd->y = ty;
+            ttd->loaded = true;
+            td[tx * 100000 + ty] = ttd;
+        }
+        ttd->qt = new QuadTile(256, 1, tx, ty);
     }
     int dLevel = 1;
     if(low)
         dLevel = 16;
     if(Game::debugOutput) qDebug() << "dLevel" << dLevel;
-    td[tx * 100000 + ty]->qt->addTile(tileX, tileY, dLevel);
-    td[tx * 100000 + ty]->modified = true;
+    ttd->qt->addTile(tileX, tileY, dLevel);
+    ttd->modified = true;
+    directory.clear();
     save();
 }
 
@@ -475,13 +513,18 @@ void QuadTree::loadTD(int x, int y) {
 }
 
 void QuadTree::loadTD(int x, int y, FileBuffer* data){
-    TdFile* ttd = new TdFile();
-    ttd->x = x;
-    ttd->y = y;
-    td[ttd->x * 100000 + ttd->y] = ttd;
+    TdFile* ttd = td.value(x * 100000 + y, NULL);
+    if (ttd == NULL) {
+        ttd = new TdFile();
+        ttd->x = x;
+        ttd->y = y;
+        td[ttd->x * 100000 + ttd->y] = ttd;
+    }
+    ttd->loaded = true;
     data->off += 38 + 16;
     ttd->qt = new QuadTile(256, 1, ttd->x, ttd->y);
     ttd->qt->load(data);
+    directory.clear();
     //saveTD(x, y);
 }
 
@@ -519,8 +562,9 @@ void QuadTree::saveTD(int x, int y, QDataStream* out){
     };
     out->writeRawData(header, 32);
     QVector<unsigned char> treeData;
-    int id = x * 100000 + y;
-    td[id]->qt->save(treeData);
+    TdFile* ttd = getTD(x, y);
+    if (ttd != NULL)
+        ttd->qt->save(treeData);
 
     *out << (qint32) 0x84;
     *out << (qint32) treeData.size() + 14;
@@ -529,7 +573,7 @@ void QuadTree::saveTD(int x, int y, QDataStream* out){
     *out << (qint32) treeData.size() + 5;
     *out << (qint8) 0;
     *out << (qint32) treeData.size();
-    out->writeRawData((char*) &treeData[0], treeData.size());
+    out->writeRawData((char*) treeData.data(), treeData.size());
 }
 
 QChar QuadTree::QuadTile::PrefixString[2] = {'_', '-'};
@@ -59,8 +59,18 @@ public:
         int y;
         QuadTile* qt = NULL;
         bool modified = false;
+        bool loaded = false;
         //unsigned char data[512][512];
     };
+    // what the tree says about one tile, kept after the first lookup
+    struct TileEntry {
+        unsigned int nameId = 0;
+        QString name;
+        int cx = 0;
+        int cy = 0;
+        int level = 0;
+    };
+    // .td files are listed by td_idx.dat and read on first use
     QHash<int, TdFile*> td;
     QuadTree(bool l = false);
     virtual ~QuadTree();
@@ -83,7 +93,10 @@ private:
     int terrainDescSize = 67108864;
     int depth = 6;
     bool low = false;
+    QHash<qint64, TileEntry> directory;
     QString getNameXY(int e);
+    TdFile* getTD(int tileX, int tileY);
+    TileEntry findTile(int tileX, int tileY);
 };
 
 #endif	/* QUADTREE_H */
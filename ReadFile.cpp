@@ -12,11 +12,13 @@
 //#include "zlib.h"
 
 //unsigned char* ReadFile::out = new unsigned char[10000000];
+std::atomic<long long int> ReadFile::BytesRead(0);
 
 FileBuffer* ReadFile::read(QFile* file) {
     int size = file->size();
     unsigned char* in = new unsigned char[size];
     file->read((char*)in, size);
+    BytesRead += size;
     //QByteArray fileData = file->readAll();
     //unsigned char* in = (unsigned char*)fileData.data();
     //unsigned char* out = NULL;
@@ -66,6 +68,7 @@ FileBuffer* ReadFile::readRAW(QFile* file) {
     QByteArray fileData = file->readAll();
     unsigned char* in = (unsigned char*)fileData.data();
     int nLength = fileData.length();
+    BytesRead += nLength;
     
     unsigned char* data = new unsigned char[nLength+1];
     data[nLength] = 0;
@@ -12,12 +12,15 @@
 #define	READFILE_H
 #include <QtCore>
 #include <iostream>
+#include <atomic>
 #include "FileBuffer.h"
 
 class ReadFile {
 public:
     static FileBuffer* read(QFile* file);
     static FileBuffer* readRAW(QFile* file);
+    // total of all reads, for load profiling
+    static std::atomic<long long int> BytesRead;
 private:
     
 };
@@ -11,6 +11,8 @@
 #include <QDebug>
 #include <QFile>
 #include <QDir>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
 #include "Route.h"
 #include "TSectionDAT.h"
 #include "GLUU.h"
@@ -21,6 +23,7 @@
 #include "TerrainLibQt.h"
 #include "Game.h"
 #include "TrackObj.h"
+#include "TRnode.h"
 #include "Path.h"
 #include "Terrain.h"
 #include "FileFunctions.h"
@@ -65,6 +68,8 @@
 #include "SigCfg.h"
 #include "TDBClient.h"
 #include "RouteEditorWindow.h"
+#include "LoadProfiler.h"
+#include "RouteChecker.h"
 
 Route::Route() {
 
@@ -104,6 +109,7 @@ void Route::load(){
         }
     }
 
+    LoadProfiler::Begin("trk");
     trk = new Trk();
     trk->load();
     Game::useSuperelevation = trk->tsreSuperelevation;
@@ -120,50 +126,68 @@ void Route::load(){
     routeName = Game::routeName;
     if(Game::debugOutput) qDebug() << Game::routeName;
 
+    LoadProfiler::Begin("tsection");
     this->tsection = new TSectionDAT();
     // Check Track Section Databaase
-    if(!checkTrackSectionDatabase())
+    if(!checkTrackSectionDatabase()){
+        LoadProfiler::End();
         return;
+    }
     
     if(Game::loadAllWFiles){
+        LoadProfiler::Begin("preloadWFiles");
         preloadWFiles(Game::gui);
     }
+    LoadProfiler::Begin("trackDB");
     this->trackDB = new TDB(tsection, false); 
     this->trackDB->loadTdb(); 
+    LoadProfiler::Begin("roadDB");
     this->roadDB = new TDB(tsection, true); 
     this->roadDB->loadTdb(); 
     Game::trackDB = this->trackDB;
     Game::roadDB = this->roadDB;  
+    LoadProfiler::Begin("addons");
     loadAddons();
     
+    LoadProfiler::Begin("markers");
     loadMkrList();        
     createMkrPlaces();
+    LoadProfiler::Begin("services");
     loadServices();
     loadTraffic();
+    LoadProfiler::Begin("paths");
     loadPaths();
+    LoadProfiler::Begin("activities");
     loadActivities();
 
+    LoadProfiler::Begin("sounds");
     soundList = new SoundList();
     soundList->loadSoundSources(Game::root + "/routes/" + Game::route + "/ssource.dat");
     soundList->loadSoundRegions(Game::root + "/routes/" + Game::route + "/ttype.dat");
     Game::soundList = soundList;
     
+    LoadProfiler::Begin("quadTree");
     Game::terrainLib->loadQuadTree();
+    LoadProfiler::Begin("objectLists");
     OrtsWeatherChange::LoadList();
     ForestObj::LoadForestList();
     ForestObj::ForestClearDistance = trk->forestClearDistance;
     CarSpawnerObj::LoadCarSpawnerList();
 
     if(Game::loadAllWFiles){
+        LoadProfiler::Begin("preloadWFilesInit");
         preloadWFilesInit();
     }
+    LoadProfiler::Begin("checkRouteDatabase");
     checkRouteDatabase();
     loaded = true;
     
     Vec3::set(placementAutoTranslationOffset, 0, 0, 0);
     Vec3::set(placementAutoRotationOffset, 0, 0, 0);
     
+    LoadProfiler::Begin("skydome");
     skydome = new Skydome();
+    LoadProfiler::End();
  
     // Route Merge. 
     if(Game::routeMergeString.length() > 0){
@@ -475,6 +499,11 @@ void Route::loadAddons(){
 }
 
 void Route::checkRouteDatabase(){
+    // auto fix edits the route, so it can't work on a copy
+    if(RouteChecker::Enabled && !Game::autoFix){
+        RouteChecker::Instance()->start(this, false);
+        return;
+    }
     trackDB->checkDatabase();
     roadDB->checkDatabase();
     
@@ -493,18 +522,23 @@ bool Route::checkTrackSectionDatabase(){
         return true;
     
     // Edit mode. Make an action regarding not synced tsection data
-    ActionChooseDialog dialog(4);
-    dialog.setWindowTitle("TDB Error");
-    dialog.setInfoText("Route Track Section database is out of sync with your Global database.\n"
-                       "Choose action:");
-    dialog.pushAction("FIX", "Convert route database to current Global now");
-    dialog.pushAction("VIEW", "Disable writing to TDB - avoid editing tracks and interactives");
-    dialog.pushAction("IGNORE", "Ignore and continue - saving route may destroy your route");
-    dialog.pushAction("EXIT", "Quit TSRE now");
-    dialog.exec();
-    if(Game::debugOutput)  qDebug() << __FILE__ << " " << __LINE__ << ":" << dialog.actionChoosen;
-    
-    if(dialog.actionChoosen == "FIX"){
+    // Without gui there is no one to ask, keep TDB read only.
+    QString actionChoosen = "VIEW";
+    if(Game::gui){
+        ActionChooseDialog dialog(4);
+        dialog.setWindowTitle("TDB Error");
+        dialog.setInfoText("Route Track Section database is out of sync with your Global database.\n"
+                           "Choose action:");
+        dialog.pushAction("FIX", "Convert route database to current Global now");
+        dialog.pushAction("VIEW", "Disable writing to TDB - avoid editing tracks and interactives");
+        dialog.pushAction("IGNORE", "Ignore and continue - saving route may destroy your route");
+        dialog.pushAction("EXIT", "Quit TSRE now");
+        dialog.exec();
+        actionChoosen = dialog.actionChoosen;
+    }
+    if(Game::debugOutput)  qDebug() << __FILE__ << " " << __LINE__ << ":" << actionChoosen;
+    
+    if(actionChoosen == "FIX"){
         Game::loadAllWFiles = true;
         preloadWFiles(true);
         // load tsection with autofix
@@ -536,15 +570,15 @@ bool Route::checkTrackSectionDatabase(){
             "Editing route may cause fatal errors. Make sure that writing to TDB is disabled."
         );
     ErrorMessagesLib::PushErrorMessage(e);
-    if(dialog.actionChoosen == "VIEW"){
+    if(actionChoosen == "VIEW"){
         Game::writeTDB = false;
         return true;
     }
-    if(dialog.actionChoosen == "IGNORE"){
+    if(actionChoosen == "IGNORE"){
         // just do nothing
         return true;
     } 
-    if(dialog.actionChoosen == "EXIT"){
+    if(actionChoosen == "EXIT"){
         loaded = false;
         return false;
     }
@@ -1050,6 +1084,15 @@ void Route::render(GLUU *gluu, float * playerT, float* playerW, float* target, f
         maxtile = 1;
     }
 
+    // pixels per unit of size at distance 1, for the screen size of tiles
+    float pixelScale = 0;
+    float pv[16];
+    if(renderMode == gluu->RENDER_DEFAULT){
+        int viewport[4];
+        QOpenGLContext::currentContext()->functions()->glGetIntegerv(GL_VIEWPORT, viewport);
+        pixelScale = viewport[3] / (2.0 * tan(Game::cameraFov * M_PI / 360.0));
+    }
+
     Tile *tTile;
     for (int i = mintile; i <= maxtile; i++) {
         for (int j = maxtile; j >= mintile; j--) {
@@ -1066,7 +1109,13 @@ void Route::render(GLUU *gluu, float * playerT, float* playerW, float* target, f
             if (tTile->loaded == 1) {
                 gluu->mvPushMatrix();
                 Mat4::translate(gluu->mvMatrix, gluu->mvMatrix, 2048 * i, 0, 2048 * j);
-                tTile->render(playerT, playerW, target, fov, renderMode);
+                int visibility = Tile::Near;
+                if(renderMode == gluu->RENDER_DEFAULT){
+                    Mat4::multiply(pv, gluu->pMatrix, gluu->mvMatrix);
+                    visibility = tTile->getVisibility(pv, playerT, playerW, pixelScale);
+                }
+                if(visibility != Tile::Hidden)
+                    tTile->render(playerT, playerW, target, fov, renderMode, visibility == Tile::Far);
                 gluu->mvPopMatrix();
             }
         }
@@ -1241,6 +1290,43 @@ void Route::setTerrainToTrackObj(WorldObj* obj, Brush* brush){
     }
 }
 
+void Route::setTerrainToTrackNode(WorldObj* obj, Brush* brush){
+    if(obj == NULL) return;
+    if(obj->typeObj != WorldObj::worldobj)
+        return;
+    if(obj->type != "trackobj" && obj->type != "dyntrack")
+        return;
+    TDB *tdb = this->trackDB;
+    if(this->tsection->isRoadShape(obj->sectionIdx))
+        tdb = this->roadDB;
+    int nodeId = tdb->findVectorNodeByUiD(obj->x, obj->y, obj->UiD);
+    if(nodeId < 1)
+        return;
+    setTerrainToTrackCorridor(tdb, nodeId, 0, -1, brush);
+}
+
+void Route::setTerrainToTrackCorridor(TDB* tdb, int nodeId, int fromSection, int toSection, Brush* brush){
+    // centreline of the vector sections from..to, all relative to the first one
+    if(tdb == NULL) return;
+    TRnode *n = tdb->trackNodes[nodeId];
+    if(n == NULL) return;
+    if(n->typ != 1) return;
+    if(toSection < 0 || toSection >= n->iTrv)
+        toSection = n->iTrv - 1;
+    if(fromSection < 0 || fromSection > toSection)
+        return;
+    int x = n->trVectorSection[fromSection].param[8];
+    int y = n->trVectorSection[fromSection].param[9];
+    QVector<float> punkty;
+    punkty.reserve(10000);
+    for(int i = fromSection; i <= toSection; i++)
+        tdb->getVectorSectionPoints(x, y, nodeId, i, punkty);
+    if(Game::debugOutput)  qDebug() << __FILE__ << " " << __LINE__ << ":" << "l "<<punkty.length();
+    if(punkty.length() < 6)
+        return;
+    Game::terrainLib->setTerrainToTrackCorridor(brush, punkty.data(), punkty.length(), x, -y);
+}
+
 ActivityObject* Route::getActivityObject(int id){
     if(currentActivity == NULL)
         return NULL;
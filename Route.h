@@ -104,6 +104,8 @@ public:
     void setTerrainTextureToObj(int x, int y, float *pos, Brush* brush, WorldObj* obj = NULL);
     void setTerrainTextureToTrack(int x, int y, float *pos, Brush* brush, int mode = 0);
     void setTerrainToTrackObj(WorldObj* obj, Brush* brush);
+    void setTerrainToTrackNode(WorldObj* obj, Brush* brush);
+    void setTerrainToTrackCorridor(TDB* tdb, int nodeId, int fromSection, int toSection, Brush* brush);
     int getTileObjCount(int x, int z);
     int getTileHiddenObjCount(int x, int z);
     int getStartTileX();
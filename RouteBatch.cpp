@@ -0,0 +1,461 @@
+/*  This file is part of TSRE5.
+ *
+ *  TSRE5 - train sim game engine and MSTS/OR Editors. 
+ *  Copyright (C) 2016 Piotr Gadecki <pgadecki@gmail.com>
+ *
+ *  Licensed under GNU General Public License 3.0 or later. 
+ *
+ *  See LICENSE.md or https://www.gnu.org/licenses/gpl.html
+ */
+
+#include "RouteBatch.h"
+#include "Game.h"
+#include "Route.h"
+#include "Tile.h"
+#include "TDB.h"
+#include "Terrain.h"
+#include "TerrainLib.h"
+#include "ShapeLib.h"
+#include "EngLib.h"
+#include "ErrorMessagesLib.h"
+#include "ErrorMessage.h"
+#include "GeoCoordinates.h"
+#include "LoadProfiler.h"
+#include "SFile.h"
+#include "TexLib.h"
+#include "ReadFile.h"
+#include "WorldObj.h"
+#include "TrackObj.h"
+#include "DynTrackObj.h"
+#include "ProceduralShape.h"
+#include "GLMatrix.h"
+#include <QDebug>
+#include <QFile>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QSet>
+#include <QTextStream>
+#include <QElapsedTimer>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <cstring>
+#include <cstdlib>
+
+#define S_OUT QTextStream(stdout)
+
+// One tile of a parallel job. Tiles don't share data, so tiles are
+// saved or renumbered side by side.
+class RouteBatchTask : public QRunnable {
+public:
+    enum Job {
+        Job_SaveTile,
+        Job_RenumberTile,
+        Job_SaveTerrain
+    };
+    Job job;
+    Tile *tile = NULL;
+    Terrain *terrain = NULL;
+    QVector<int*> trackObjUpdates;
+    int changed = 0;
+
+    void run(){
+        if(job == Job_SaveTile){
+            tile->save();
+        } else if(job == Job_RenumberTile){
+            changed = tile->renumberUiDs(trackObjUpdates);
+        } else if(job == Job_SaveTerrain){
+            terrain->save();
+        }
+    }
+};
+
+RouteBatch::RouteBatch() {
+}
+
+RouteBatch::~RouteBatch() {
+    ProceduralShape::CancelPending();
+    if(context != NULL)
+        context->doneCurrent();
+    delete context;
+    delete surface;
+}
+
+int RouteBatch::run(QStringList jobs, QString reportPath){
+    unsigned long long int timeStart = QDateTime::currentMSecsSinceEpoch();
+    report["route"] = Game::route;
+    report["jobs"] = QJsonArray::fromStringList(jobs);
+    report["threads"] = QThreadPool::globalInstance()->maxThreadCount();
+
+    if(jobs.contains("benchmark", Qt::CaseInsensitive)){
+        LoadProfiler::Clear();
+        LoadProfiler::Enabled = true;
+    }
+    createContext();
+    if(!loadRoute()){
+        report["loaded"] = false;
+        writeReport(reportPath);
+        return 1;
+    }
+    report["loaded"] = true;
+
+    foreach(QString job, jobs){
+        job = job.trimmed().toLower();
+        if(job == "check")
+            jobCheck();
+        else if(job == "resave")
+            jobResave();
+        else if(job == "renumber")
+            jobRenumber();
+        else if(job == "terrain")
+            jobTerrain();
+        else if(job == "benchmark")
+            jobBenchmark();
+        else if(job == "bake")
+            jobBake();
+        else
+            qDebug() << "batch: unknown job" << job;
+    }
+
+    if(modified){
+        unsigned long long int timeNow = QDateTime::currentMSecsSinceEpoch();
+        route->save();
+        addTiming("save", timeNow);
+    }
+    addTiming("total", timeStart);
+    return writeReport(reportPath);
+}
+
+// Shapes and terrain create their buffers while loading, so a context
+// is made current before the route is loaded. Without a display it
+// comes from the offscreen platform.
+void RouteBatch::createContext(){
+    surface = new QOffscreenSurface();
+    surface->create();
+    context = new QOpenGLContext();
+    if(context->create() && context->makeCurrent(surface)){
+        report["openGL"] = true;
+        return;
+    }
+    delete context;
+    context = NULL;
+    report["openGL"] = false;
+}
+
+bool RouteBatch::loadRoute(){
+    unsigned long long int timeNow = QDateTime::currentMSecsSinceEpoch();
+    Game::currentShapeLib = new ShapeLib();
+    Game::currentEngLib = new EngLib();
+
+    route = new Route();
+    route->load();
+    addTiming("load", timeNow);
+    if (!route->loaded)
+        return false;
+
+    int objects = 0;
+    foreach (Tile* tTile, route->tile){
+        if (tTile == NULL) continue;
+        if (tTile->loaded != 1) continue;
+        objects += tTile->jestObiektow;
+    }
+    report["tiles"] = route->tile.size();
+    report["objects"] = objects;
+    return true;
+}
+
+void RouteBatch::jobCheck(){
+    // W files and TDB are validated while loading, signals are not.
+    unsigned long long int timeNow = QDateTime::currentMSecsSinceEpoch();
+    if(Game::trackDB != NULL)
+        Game::trackDB->checkSignals();
+    if(Game::roadDB != NULL)
+        Game::roadDB->checkSignals();
+    addTiming("check", timeNow);
+}
+
+void RouteBatch::jobResave(){
+    if(!Game::writeEnabled){
+        qDebug() << "batch: writing disabled, resave skipped";
+        return;
+    }
+    unsigned long long int timeNow = QDateTime::currentMSecsSinceEpoch();
+    QVector<RouteBatchTask*> tasks;
+    foreach (Tile* tTile, route->tile){
+        if (tTile == NULL) continue;
+        if (tTile->loaded != 1) continue;
+        RouteBatchTask *task = new RouteBatchTask();
+        task->setAutoDelete(false);
+        task->job = RouteBatchTask::Job_SaveTile;
+        task->tile = tTile;
+        tasks.push_back(task);
+        QThreadPool::globalInstance()->start(task);
+    }
+    QThreadPool::globalInstance()->waitForDone();
+    for(int i = 0; i < tasks.size(); i++){
+        tasks[i]->tile->setModified(false);
+        delete tasks[i];
+    }
+    report["resaved"] = tasks.size();
+    modified = true;
+    addTiming("resave", timeNow);
+}
+
+void RouteBatch::jobRenumber(){
+    if(!Game::writeEnabled || !Game::writeTDB){
+        qDebug() << "batch: writing disabled, renumber skipped";
+        return;
+    }
+    unsigned long long int timeNow = QDateTime::currentMSecsSinceEpoch();
+    QVector<RouteBatchTask*> tasks;
+    foreach (Tile* tTile, route->tile){
+        if (tTile == NULL) continue;
+        if (tTile->loaded != 1) continue;
+        RouteBatchTask *task = new RouteBatchTask();
+        task->setAutoDelete(false);
+        task->job = RouteBatchTask::Job_RenumberTile;
+        task->tile = tTile;
+        tasks.push_back(task);
+        QThreadPool::globalInstance()->start(task);
+    }
+    QThreadPool::globalInstance()->waitForDone();
+
+    QVector<int*> trackObjUpdates;
+    int changed = 0;
+    for(int i = 0; i < tasks.size(); i++){
+        trackObjUpdates += tasks[i]->trackObjUpdates;
+        changed += tasks[i]->changed;
+        delete tasks[i];
+    }
+    if(Game::trackDB != NULL)
+        Game::trackDB->updateUiDs(trackObjUpdates, 1);
+    if(Game::roadDB != NULL)
+        Game::roadDB->updateUiDs(trackObjUpdates, 1);
+    for(int i = 0; i < trackObjUpdates.size(); i++)
+        delete[] trackObjUpdates[i];
+
+    report["renumbered"] = changed;
+    report["renumberedTrackObj"] = trackObjUpdates.size();
+    modified = true;
+    addTiming("renumber", timeNow);
+}
+
+void RouteBatch::jobTerrain(){
+    if(!Game::writeEnabled){
+        qDebug() << "batch: writing disabled, terrain skipped";
+        return;
+    }
+    // loading goes through TerrainLib, only writing is parallel
+    unsigned long long int timeNow = QDateTime::currentMSecsSinceEpoch();
+    QVector<RouteBatchTask*> tasks;
+    foreach (Tile* tTile, route->tile){
+        if (tTile == NULL) continue;
+        Terrain *terr = Game::terrainLib->getTerrainByXY(tTile->x, tTile->z, true);
+        if (terr == NULL) continue;
+        if (!terr->loaded) continue;
+        RouteBatchTask *task = new RouteBatchTask();
+        task->setAutoDelete(false);
+        task->job = RouteBatchTask::Job_SaveTerrain;
+        task->terrain = terr;
+        tasks.push_back(task);
+    }
+    addTiming("terrainLoad", timeNow);
+
+    timeNow = QDateTime::currentMSecsSinceEpoch();
+    for(int i = 0; i < tasks.size(); i++)
+        QThreadPool::globalInstance()->start(tasks[i]);
+    QThreadPool::globalInstance()->waitForDone();
+    for(int i = 0; i < tasks.size(); i++){
+        tasks[i]->terrain->setModified(false);
+        delete tasks[i];
+    }
+    report["terrain"] = tasks.size();
+    modified = true;
+    addTiming("terrain", timeNow);
+}
+
+void RouteBatch::jobBenchmark(){
+    report["kernels"] = benchmarkKernels();
+    if(context == NULL){
+        qDebug() << "batch: no OpenGL context, shapes and textures not benchmarked";
+        LoadProfiler::End();
+        report["phases"] = LoadProfiler::Phases();
+        report["shapesSkipped"] = true;
+        return;
+    }
+
+    // load phases are recorded by Route::load, shapes and textures
+    // are left to the renderer so they are loaded here
+    LoadProfiler::Begin("shapes");
+    int shapes = 0;
+    for(auto it = Game::currentShapeLib->shape.begin(); it != Game::currentShapeLib->shape.end(); ++it){
+        SFile *s = it->second;
+        if(s == NULL) continue;
+        if(s->loaded != 0) continue;
+        s->load();
+        if(s->loaded == 1)
+            shapes++;
+    }
+
+    LoadProfiler::Begin("textures");
+    QSet<QString> loadedTex;
+    for(auto it = Game::currentShapeLib->shape.begin(); it != Game::currentShapeLib->shape.end(); ++it){
+        SFile *s = it->second;
+        if(s == NULL) continue;
+        if(s->loaded != 1) continue;
+        for(int i = 0; i < s->ilosci; i++){
+            if(s->image[i].tex != -1) continue;
+            QString pathid = (s->texPath + "/" + s->image[i].name).toLower();
+            // first use loads in this thread, the rest only take a ref
+            s->image[i].tex = TexLib::addTex(s->texPath, s->image[i].name, !loadedTex.contains(pathid));
+            loadedTex.insert(pathid);
+        }
+    }
+    LoadProfiler::End();
+
+    report["phases"] = LoadProfiler::Phases();
+    report["shapes"] = shapes;
+    report["textures"] = loadedTex.size();
+    report["bytesRead"] = (double)ReadFile::BytesRead;
+}
+
+QJsonObject RouteBatch::benchmarkKernels(){
+    // batch math against the scalar versions, time of each; results are
+    // checked by the kernel test in tests/
+    const int count = 100000;
+    QVector<float> q(count*4), v(count*3), m(16), out1(count*16), out2(count*16), out3(count*16);
+    std::srand(1);
+    for(int i = 0; i < count; i++){
+        float *qq = &q[i*4];
+        Vec3::set(qq, std::rand()%200 - 100, std::rand()%200 - 100, std::rand()%200 - 100);
+        qq[3] = std::rand()%200 - 100 + 0.5;
+        Vec4::normalize(qq, qq);
+        Vec3::set(&v[i*3], (std::rand()%20000)*0.1, (std::rand()%2000)*0.1, (std::rand()%20000)*0.1);
+    }
+    Mat4::fromRotationTranslation(m.data(), &q[0], &v[0]);
+
+    QJsonObject result;
+    result["instructions"] = QString(Mat4::BatchKernels());
+    QElapsedTimer timer;
+    auto add = [&](QString name, qint64 scalar, qint64 batch){
+        QJsonObject o;
+        o["scalarMs"] = scalar/1000000.0;
+        o["batchMs"] = batch/1000000.0;
+        result[name] = o;
+    };
+    qint64 scalar, batch;
+
+    timer.start();
+    Mat4::fromRotationTranslationBatchScalar(out1.data(), q.data(), v.data(), count);
+    scalar = timer.nsecsElapsed();
+    timer.restart();
+    Mat4::fromRotationTranslationBatch(out2.data(), q.data(), v.data(), count);
+    batch = timer.nsecsElapsed();
+    add("fromRotationTranslation", scalar, batch);
+
+    timer.restart();
+    Mat4::multiplyBatchScalar(out3.data(), m.data(), out1.data(), count);
+    scalar = timer.nsecsElapsed();
+    timer.restart();
+    Mat4::multiplyBatch(out2.data(), m.data(), out1.data(), count);
+    batch = timer.nsecsElapsed();
+    add("multiply", scalar, batch);
+
+    // matrices reused as points, 16 floats apart
+    timer.restart();
+    Vec3::transformMat4BatchScalar(out3.data(), out1.data(), count, 16, m.data());
+    scalar = timer.nsecsElapsed();
+    timer.restart();
+    Vec3::transformMat4Batch(out2.data(), out1.data(), count, 16, m.data());
+    batch = timer.nsecsElapsed();
+    add("transformMat4", scalar, batch);
+    return result;
+}
+
+void RouteBatch::jobBake(){
+    if(!Game::writeEnabled || !Game::proceduralDiskCache){
+        qDebug() << "batch: writing or procedural disk cache disabled, bake skipped";
+        return;
+    }
+    // shapes are generated on the thread pool, each hash once
+    unsigned long long int timeNow = QDateTime::currentMSecsSinceEpoch();
+    int baked = 0;
+    foreach (Tile* tTile, route->tile){
+        if (tTile == NULL) continue;
+        if (tTile->loaded != 1) continue;
+        for (auto it = tTile->obiekty.begin(); it != tTile->obiekty.end(); ++it) {
+            WorldObj* obj = it->second;
+            if(obj == NULL || !obj->loaded)
+                continue;
+            if(obj->typeID == WorldObj::trackobj)
+                baked += ((TrackObj*)obj)->bakeProceduralShape();
+            else if(obj->typeID == WorldObj::dyntrack)
+                baked += ((DynTrackObj*)obj)->bakeProceduralShape();
+        }
+    }
+    QThreadPool::globalInstance()->waitForDone();
+    report["baked"] = baked;
+    addTiming("bake", timeNow);
+}
+
+void RouteBatch::addTiming(QString name, unsigned long long int startTime){
+    QJsonObject t;
+    t["name"] = name;
+    t["time"] = ((double)(QDateTime::currentMSecsSinceEpoch() - startTime))/1000.0;
+    timings.push_back(t);
+    qDebug() << "#batch" << name << "time" << t["time"].toDouble();
+}
+
+int RouteBatch::writeReport(QString reportPath){
+    QJsonArray messages;
+    QHash<QString, int> counts;
+    int errors = 0;
+    for(int i = 0; i < ErrorMessagesLib::ErrorMessages.size(); i++){
+        ErrorMessage *e = ErrorMessagesLib::ErrorMessages[i];
+        if(e == NULL)
+            continue;
+        QJsonObject m;
+        m["type"] = ErrorMessage::TypeNames[e->type];
+        m["source"] = ErrorMessage::SourceNames[e->source];
+        m["description"] = e->description;
+        m["action"] = e->action;
+        if(e->coords != NULL){
+            m["tileX"] = e->coords->TileX;
+            m["tileZ"] = e->coords->TileZ;
+            m["x"] = e->coords->wX;
+            m["y"] = e->coords->wY;
+            m["z"] = e->coords->wZ;
+        }
+        messages.push_back(m);
+        counts[m["type"].toString()]++;
+        if(e->type == ErrorMessage::Type_Error)
+            errors++;
+    }
+    QJsonObject c;
+    QHashIterator<QString, int> it(counts);
+    while (it.hasNext()) {
+        it.next();
+        c[it.key()] = it.value();
+    }
+    report["counts"] = c;
+    report["messages"] = messages;
+    report["timings"] = timings;
+
+    QByteArray json = QJsonDocument(report).toJson();
+    if(reportPath.length() > 0){
+        QFile file(reportPath);
+        if(file.open(QIODevice::WriteOnly)){
+            file.write(json);
+            file.close();
+        } else {
+            qDebug() << "batch: report file failed to open" << reportPath;
+        }
+    } else {
+        S_OUT << json;
+    }
+    // nightly checks fail on route errors
+    if(errors > 0)
+        return 2;
+    return 0;
+}
@@ -0,0 +1,58 @@
+/*  This file is part of TSRE5.
+ *
+ *  TSRE5 - train sim game engine and MSTS/OR Editors. 
+ *  Copyright (C) 2016 Piotr Gadecki <pgadecki@gmail.com>
+ *
+ *  Licensed under GNU General Public License 3.0 or later. 
+ *
+ *  See LICENSE.md or https://www.gnu.org/licenses/gpl.html
+ */
+
+#ifndef ROUTEBATCH_H
+#define ROUTEBATCH_H
+
+#include <QString>
+#include <QStringList>
+#include <QJsonObject>
+#include <QJsonArray>
+
+class Route;
+class QOffscreenSurface;
+class QOpenGLContext;
+
+// Headless jobs on a route, run from the command line:
+//   check    - route, TDB and world file validation
+//   resave   - write all world files again
+//   renumber - consecutive UiDs in every world file, TDB updated
+//   terrain  - load and write all terrain tiles again
+//   benchmark - time every phase of route loading, shapes, textures
+//               and the batch math kernels
+//   bake     - generate procedural track shapes into the disk cache
+// Results and timings are written as a JSON report.
+class RouteBatch {
+public:
+    RouteBatch();
+    virtual ~RouteBatch();
+    int run(QStringList jobs, QString reportPath);
+
+private:
+    Route *route = NULL;
+    QOffscreenSurface *surface = NULL;
+    QOpenGLContext *context = NULL;
+    QJsonObject report;
+    QJsonArray timings;
+    bool modified = false;
+    void createContext();
+    bool loadRoute();
+    void jobCheck();
+    void jobResave();
+    void jobRenumber();
+    void jobTerrain();
+    void jobBenchmark();
+    QJsonObject benchmarkKernels();
+    void jobBake();
+    void addTiming(QString name, unsigned long long int startTime);
+    int writeReport(QString reportPath);
+};
+
+#endif /* ROUTEBATCH_H */
@@ -0,0 +1,256 @@
+/*  This file is part of TSRE5.
+ *
+ *  TSRE5 - train sim game engine and MSTS/OR Editors. 
+ *  Copyright (C) 2016 Piotr Gadecki <pgadecki@gmail.com>
+ *
+ *  Licensed under GNU General Public License 3.0 or later. 
+ *
+ *  See LICENSE.md or https://www.gnu.org/licenses/gpl.html
+ */
+
+#include "RouteChecker.h"
+#include "Route.h"
+#include "Tile.h"
+#include "TDB.h"
+#include "TRitem.h"
+#include "WorldObj.h"
+#include "ShapeLib.h"
+#include "SFile.h"
+#include "TexLib.h"
+#include "Texture.h"
+#include "Game.h"
+#include "ErrorMessagesLib.h"
+#include "ErrorMessage.h"
+#include <QDebug>
+#include <QFile>
+#include <QTimer>
+#include <QRunnable>
+#include <QThreadPool>
+
+bool RouteChecker::Enabled = false;
+RouteChecker* RouteChecker::Checker = NULL;
+
+// One background check. Each check only reads its own copy of the data,
+// the TDB copy is shared by checks of one task, so they run in sequence.
+class RouteCheckTask : public QRunnable {
+public:
+    enum Job {
+        Job_Database,
+        Job_Files
+    };
+    struct Result {
+        QString name;
+        qint64 time;
+        QVector<ErrorMessage*> messages;
+    };
+    Job job;
+    int id;
+    RouteChecker *checker;
+    TDB *snapshot = NULL;
+    TDB *tdb = NULL;
+    QHash<int, QVector<WorldObj*>> objects;
+    QStringList shapes;
+    QStringList textures;
+    QVector<Result> results;
+
+    void run(){
+        if(job == Job_Database){
+            QString name = tdb->isRoad() ? "RDB" : "TDB";
+            runCheck(name + " items and topology", [this](){ snapshot->checkDatabase(objects, false); });
+            runCheck(name + " signal directions", [this](){ snapshot->checkSignals(); });
+        } else if(job == Job_Files){
+            runCheck("shape files", [this](){
+                foreach(QString path, shapes){
+                    if(QFile::exists(path))
+                        continue;
+                    ErrorMessage *e = new ErrorMessage(
+                            ErrorMessage::Type_Warning,
+                            ErrorMessage::Source_World,
+                            QString("Shape file not found: ") + path,
+                            "Objects using this shape are not rendered.");
+                    ErrorMessagesLib::PushErrorMessage(e);
+                }
+            });
+            runCheck("texture files", [this](){
+                foreach(QString path, textures){
+                    ErrorMessage *e = new ErrorMessage(
+                            ErrorMessage::Type_Warning,
+                            ErrorMessage::Source_World,
+                            QString("Texture file not found: ") + path,
+                            "Shapes using this texture are rendered without it.");
+                    ErrorMessagesLib::PushErrorMessage(e);
+                }
+            });
+        }
+        QMetaObject::invokeMethod(checker, "taskDone", Qt::QueuedConnection, Q_ARG(int, id));
+    }
+
+private:
+    template<typename F>
+    void runCheck(QString name, F check){
+        Result r;
+        r.name = name;
+        QElapsedTimer timer;
+        timer.start();
+        ErrorMessagesLib::BeginCollect(&r.messages);
+        check();
+        ErrorMessagesLib::EndCollect();
+        r.time = timer.elapsed();
+        results.push_back(r);
+    }
+};
+
+RouteChecker* RouteChecker::Instance(){
+    if(Checker == NULL)
+        Checker = new RouteChecker();
+    return Checker;
+}
+
+RouteChecker::RouteChecker() {
+}
+
+bool RouteChecker::isRunning(){
+    return tasksLeft > 0 || nextTile < tiles.size();
+}
+
+void RouteChecker::start(Route *route, bool world){
+    if(route == NULL || route->trackDB == NULL || route->roadDB == NULL)
+        return;
+    if(isRunning()){
+        qDebug() << "route check: already running";
+        return;
+    }
+    this->route = route;
+    qDebug() << "route check: started";
+
+    // copies are made here, on the GUI thread, editing goes on meanwhile
+    TDB* dbs[2] = { route->trackDB, route->roadDB };
+    for(int i = 0; i < 2; i++){
+        RouteCheckTask *task = new RouteCheckTask();
+        task->setAutoDelete(false);
+        task->job = RouteCheckTask::Job_Database;
+        task->id = tasks.size();
+        task->checker = this;
+        task->tdb = dbs[i];
+        task->snapshot = new TDB(*dbs[i]);
+        if(Game::loadAllWFiles)
+            route->fillWorldObjectsByTrackItemIds(task->objects, i);
+        tasks.push_back(task);
+    }
+
+    if(world){
+        RouteCheckTask *task = new RouteCheckTask();
+        task->setAutoDelete(false);
+        task->job = RouteCheckTask::Job_Files;
+        task->id = tasks.size();
+        task->checker = this;
+        if(Game::currentShapeLib != NULL){
+            for(auto it = Game::currentShapeLib->shape.begin(); it != Game::currentShapeLib->shape.end(); ++it){
+                if(it->second == NULL) continue;
+                task->shapes.push_back(it->second->pathid);
+            }
+        }
+        for(auto it = TexLib::mtex.begin(); it != TexLib::mtex.end(); ++it){
+            if(it->second == NULL) continue;
+            if(it->second->missing)
+                task->textures.push_back(it->second->pathid);
+        }
+        tasks.push_back(task);
+
+        tiles.clear();
+        QHashIterator<int, Tile*> it(route->tile);
+        while (it.hasNext()) {
+            it.next();
+            if(it.value() != NULL)
+                tiles.push_back(it.key());
+        }
+        nextTile = 0;
+        tileMessages = 0;
+        tileTime = 0;
+        QTimer::singleShot(0, this, SLOT(checkNextTiles()));
+    }
+
+    tasksLeft = tasks.size();
+    for(int i = 0; i < tasks.size(); i++)
+        QThreadPool::globalInstance()->start(tasks[i]);
+}
+
+void RouteChecker::taskDone(int id){
+    RouteCheckTask *task = tasks[id];
+    for(int i = 0; i < task->results.size(); i++){
+        QVector<ErrorMessage*> &messages = task->results[i].messages;
+        // messages point at items of the copy, the editor needs its own
+        for(int j = 0; j < messages.size() && task->snapshot != NULL; j++){
+            GameObj *o = messages[j]->obj;
+            if(o == NULL || o->typeObj != GameObj::tritemobj)
+                continue;
+            TRitem *item = (TRitem*)o;
+            if(task->snapshot->trackItems.value(item->trItemId) == item)
+                messages[j]->obj = (GameObj*)task->tdb->trackItems.value(item->trItemId);
+        }
+        ErrorMessagesLib::PushErrorMessages(messages);
+        finishTask(task->results[i].name, task->results[i].time, messages.size());
+    }
+    tasksLeft--;
+    checkFinished();
+}
+
+void RouteChecker::checkNextTiles(){
+    if(Game::currentRoute != route){
+        // route changed, world objects of the old one are gone
+        nextTile = tiles.size();
+        checkFinished();
+        return;
+    }
+    QElapsedTimer timer;
+    timer.start();
+    QVector<ErrorMessage*> messages;
+    ErrorMessagesLib::BeginCollect(&messages);
+    while(nextTile < tiles.size() && timer.elapsed() < 10){
+        Tile *tTile = route->tile.value(tiles[nextTile++], NULL);
+        if(tTile == NULL || tTile->loaded != 1)
+            continue;
+        for (auto it = tTile->obiekty.begin(); it != tTile->obiekty.end(); ++it) {
+            WorldObj* obj = it->second;
+            if(obj == NULL || !obj->loaded)
+                continue;
+            obj->checkForErrors();
+        }
+    }
+    ErrorMessagesLib::EndCollect();
+    tileTime += timer.elapsed();
+    tileMessages += messages.size();
+    ErrorMessagesLib::PushErrorMessages(messages);
+
+    if(nextTile < tiles.size()){
+        QTimer::singleShot(0, this, SLOT(checkNextTiles()));
+        return;
+    }
+    finishTask("world objects", tileTime, tileMessages);
+    checkFinished();
+}
+
+void RouteChecker::finishTask(QString name, qint64 ms, int count){
+    qDebug() << "#route check" << name << "time" << ms/1000.0 << "messages" << count;
+    ErrorMessage *e = new ErrorMessage(
+            ErrorMessage::Type_Info,
+            ErrorMessage::Source_Editor,
+            QString("Check '") + name + "' done in " + QString::number(ms/1000.0, 'f', 2) + " s. Messages: " + QString::number(count));
+    QVector<ErrorMessage*> list;
+    list.push_back(e);
+    ErrorMessagesLib::PushErrorMessages(list);
+}
+
+void RouteChecker::checkFinished(){
+    if(isRunning())
+        return;
+    for(int i = 0; i < tasks.size(); i++){
+        delete tasks[i]->snapshot;
+        delete tasks[i];
+    }
+    tasks.clear();
+    tiles.clear();
+    nextTile = 0;
+    qDebug() << "route check: finished";
+    emit finished();
+}
@@ -0,0 +1,55 @@
+/*  This file is part of TSRE5.
+ *
+ *  TSRE5 - train sim game engine and MSTS/OR Editors. 
+ *  Copyright (C) 2016 Piotr Gadecki <pgadecki@gmail.com>
+ *
+ *  Licensed under GNU General Public License 3.0 or later. 
+ *
+ *  See LICENSE.md or https://www.gnu.org/licenses/gpl.html
+ */
+
+#ifndef ROUTECHECKER_H
+#define ROUTECHECKER_H
+
+#include <QObject>
+#include <QVector>
+#include <QElapsedTimer>
+
+class Route;
+class RouteCheckTask;
+
+// Route validation in the background. TDB and RDB are copied when a run
+// starts and checked on the global thread pool, file checks run there too.
+// World objects are checked on the GUI thread a few tiles per event loop
+// pass. Messages reach ErrorMessagesLib as each check finishes, followed
+// by an info message with the time the check took.
+class RouteChecker : public QObject {
+    Q_OBJECT
+public:
+    static bool Enabled;
+    static RouteChecker* Instance();
+    bool isRunning();
+    void start(Route *route, bool world);
+
+signals:
+    void finished();
+
+private slots:
+    void taskDone(int id);
+    void checkNextTiles();
+
+private:
+    RouteChecker();
+    static RouteChecker* Checker;
+    Route *route = NULL;
+    QVector<RouteCheckTask*> tasks;
+    int tasksLeft = 0;
+    QVector<int> tiles;
+    int nextTile = 0;
+    int tileMessages = 0;
+    qint64 tileTime = 0;
+    void finishTask(QString name, qint64 ms, int count);
+    void checkFinished();
+};
+
+#endif /* ROUTECHECKER_H */
@@ -215,6 +215,19 @@ void RouteEditorClient::readBinaryMessage(QWebSocket *client, FileBuffer* data)
             t->loadRAWFile(data);
             t->refresh();
             break;
+        case TS::TSRE_Terrain_RawRect:
+            data->getInt();
+            data->get();
+            x = data->getInt();
+            z = data->getInt();
+            t = Game::terrainLib->getTerrainByXY(x, z);
+            if (t == NULL) {
+                qDebug() << "fail, terrain null";
+                break;
+            }
+            t->loadRAWRect(data);
+            t->refreshDirty(true);
+            break;
         default:
             qDebug() << "undefined token";
             break;
@@ -487,6 +500,24 @@ void RouteEditorClient::updateTerrainHeightmap(Terrain *t) {
     }
 }
 
+void RouteEditorClient::updateTerrainHeightmap(Terrain *t, int x0, int z0, int x1, int z1) {
+    if (t != NULL) {
+        QByteArray outd;
+        QDataStream out(&outd, QIODevice::WriteOnly);
+        out.setByteOrder(QDataStream::LittleEndian);
+        out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+        out << (qint8) 'B';
+        out << TS::TSRE_Terrain_RawRect;
+        out << (qint32) 0; //should be size in bytes;
+        out << (qint8) 0;
+        out << (qint32) t->mojex;
+        out << (qint32) t->mojez;
+        t->saveRAWRectToStream(out, x0, z0, x1, z1);
+        out.unsetDevice();
+        m_webSocket->sendBinaryMessage(outd);
+    }
+}
+
 void RouteEditorClient::updateTerrainTFile(Terrain *t) {
     if (t != NULL) {
         qDebug() << "send terrain tfile";
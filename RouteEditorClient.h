@@ -44,6 +44,7 @@ public:
     void updateTrackSectionData(TSection *s);
     void updateTrackShapeData(TrackShape *s);
     void updateTerrainHeightmap(Terrain *t);
+    void updateTerrainHeightmap(Terrain *t, int x0, int z0, int x1, int z1);
     void updateTerrainTFile(Terrain *t);
     void updatePointerPosition(int X, int Z, float x, float y, float z);
     void connectNow();
@@ -29,11 +29,13 @@
 #include "Brush.h"
 #include "GeoCoordinates.h"
 #include "MapWindow.h"
+#include "MapTileBatch.h"
 #include "TerrainTreeWindow.h"
 #include "ShapeLib.h"
 #include "EngLib.h"
 #include "QOpenGLFunctions_3_3_Core"
 #include "Undo.h"
+#include "ProceduralShape.h"
 #include "Environment.h"
 #include "Terrain.h"
 #include "ActivityObject.h"
@@ -51,6 +53,7 @@
 #include "ClientInfo.h"
 #include "StatusWindow.h"
 #include "Texture.h"
+#include "InitScheduler.h"
 
 
 RouteEditorGLWidget::RouteEditorGLWidget(QWidget *parent)
@@ -87,6 +90,7 @@ QSize RouteEditorGLWidget::sizeHint() const {
 }
 
 void RouteEditorGLWidget::cleanup() {
+    ProceduralShape::CancelPending();
     makeCurrent();
     //delete gluu->m_program;
     //gluu->m_program = 0;
@@ -132,6 +136,11 @@ void RouteEditorGLWidget::timerEvent(QTimerEvent * event) {
         
         if(defaultPaintBrush->direction == 1) emit updStatus(QString("brushdir"), QString("Terrain Brush: +")); else emit updStatus(QString("brush"), QString("Terrain Brush: -"));  /// EFO Added to 
 
+        // objects waiting for init, time they took last frame and uploaded MB
+        emit updStatus(QString("objinit"), QString("Init: ") + QString::number(initScheduler.lastFrame.queued) + " queued, "
+                + QString::number(initScheduler.lastFrame.time, 'f', 1) + " ms, "
+                + QString::number(InitScheduler::TotalUploadBytes/1048576) + " MB");
+
         //        if(resizeTool == true)  reloadRefFile updStatus(QString("resize"), QString("Resize: ON")); else emit updStatus(QString("resize"), QString("Resize: OFF"));  /// EFO Added to 
         //        emit updStatus(QString("Stat3"), QString(""));           
     }
@@ -159,9 +168,6 @@ void RouteEditorGLWidget::timerEvent(QTimerEvent * event) {
 
     lastTime = timeNow;
 
-    if (Game::allowObjLag < Game::maxObjLag)
-        Game::allowObjLag += 2;
-
     camera->update(fps);
     
     update();   
@@ -367,7 +373,9 @@ void RouteEditorGLWidget::setMoveStep(float val){
 }
 
 void RouteEditorGLWidget::paintGL(){
+    initScheduler.beginFrame();
     paintGL2();
+    initScheduler.endFrame();
     return;
     
     // Here is not finishes, future version of TSRE renderer.
@@ -1863,6 +1871,15 @@ void RouteEditorGLWidget::setTerrainToObj(){
     Undo::StateEnd();
 }
 
+void RouteEditorGLWidget::setTerrainToTrackNode(){
+    Undo::StateBegin();
+    if (selectedObj != NULL)
+        route->setTerrainToTrackNode((WorldObj*)selectedObj, defaultPaintBrush);
+    else
+        route->setTerrainToTrackNode((WorldObj*)lastSelectedObj, defaultPaintBrush);
+    Undo::StateEnd();
+}
+
 void RouteEditorGLWidget::adjustObjPositionToTerrainMenu(){
     Undo::StateBeginIfNotExist();
     Undo::PushGameObjData(selectedObj);
@@ -2125,6 +2142,10 @@ void RouteEditorGLWidget::showContextMenu(const QPoint & point) {
         defaultMenuActions["setTerrToObj"] = new QAction(tr("&Set Terrain to Object")); 
         QObject::connect(defaultMenuActions["setTerrToObj"], SIGNAL(triggered()), this, SLOT(setTerrainToObj()));
     }
+    if(defaultMenuActions["setTerrToTrackNode"] == NULL){
+        defaultMenuActions["setTerrToTrackNode"] = new QAction(tr("&Set Terrain to whole Track")); 
+        QObject::connect(defaultMenuActions["setTerrToTrackNode"], SIGNAL(triggered()), this, SLOT(setTerrainToTrackNode()));
+    }
     if(defaultMenuActions["setPosToTerr"] == NULL){
         defaultMenuActions["setPosToTerr"] = new QAction(tr("&Set position to Terrain")); 
         QObject::connect(defaultMenuActions["setPosToTerr"], SIGNAL(triggered()), this, SLOT(adjustObjPositionToTerrainMenu()));
@@ -2211,6 +2232,8 @@ void RouteEditorGLWidget::showContextMenu(const QPoint & point) {
         
         if(selectedObj->typeObj == selectedObj->worldobj){
             menu.addAction(defaultMenuActions["setTerrToObj"]);
+            if(((WorldObj*)selectedObj)->type == "trackobj" || ((WorldObj*)selectedObj)->type == "dyntrack")
+                menu.addAction(defaultMenuActions["setTerrToTrackNode"]);
             menu.addAction(defaultMenuActions["setPosToTerr"]);
             menu.addAction(defaultMenuActions["setRotToTerr"]);
             menu.addAction(defaultMenuActions["pickObj"]);
@@ -2435,6 +2458,33 @@ void RouteEditorGLWidget::createNewTiles(QMap<int, QPair<int, int>*> list){
     }
 }
 
+void RouteEditorGLWidget::makeMapTextures(QMap<int, QPair<int, int>*> list){
+    int x, z;
+    QMapIterator<int, QPair<int, int>*> i2(list);
+    QVector<Terrain*> terrains;
+    QVector<MapTileBatch::Tile> tiles;
+    while (i2.hasNext()) {
+        i2.next();
+        if(i2.value() == NULL)
+            continue;
+        x = i2.value()->first;
+        z = i2.value()->second;
+        Terrain *t = Game::terrainLib->getTerrainByXY(x, -z, true);
+        if(t == NULL)
+            continue;
+        if(!t->loaded)
+            continue;
+        MapTileBatch::Tile tile;
+        t->getLowCornerTileXY(tile.x, tile.z);
+        tile.tileSize = t->getSampleCount()*t->getSampleSize();
+        tiles.push_back(tile);
+        terrains.push_back(t);
+    }
+    MapTileBatch::Render(tiles);
+    for(int i = 0; i < terrains.size(); i++)
+        terrains[i]->makeTextureFromMap();
+}
+
 void RouteEditorGLWidget::createNewLoTiles(QMap<int, QPair<int, int>*> list){
     int x, z;
     QMapIterator<int, QPair<int, int>*> i2(list);
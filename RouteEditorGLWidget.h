@@ -24,6 +24,7 @@
 #include "GroupObj.h"
 #include "Pointer3d.h"
 #include "Ref.h"
+#include "InitScheduler.h"
 #include <unordered_map>
 
 class Tile;
@@ -87,6 +88,7 @@ public slots:
     void showContextMenu(const QPoint & point);
     void createNewTiles(QMap<int, QPair<int, int>*> list);
     void createNewLoTiles(QMap<int, QPair<int, int>*> list);
+    void makeMapTextures(QMap<int, QPair<int, int>*> list);
     void objectSelected(GameObj* obj);
     void objectSelected(QVector<GameObj*> obj);
     
@@ -115,6 +117,7 @@ public slots:
     void paintToolTDB();
     void paintToolTDBVector();
     void setTerrainToObj();
+    void setTerrainToTrackNode();
     void adjustObjPositionToTerrainMenu();
     void adjustObjRotationToTerrainMenu();
     void pickObjForPlacement();
@@ -174,6 +177,7 @@ private:
     void setupVertexAttribs();
     void setSelectedObj(GameObj* o);
     QBasicTimer timer;
+    InitScheduler initScheduler;
     unsigned long long int lastTime;
     unsigned long long int timeNow;
     unsigned long long int timeSaved;
@@ -680,6 +680,22 @@ void RouteEditorServer::readBinaryMessage(QWebSocket *client, QByteArray &messag
             t->setModified();
             sendMessageToClients(client, message);
             break;
+        case TS::TSRE_Terrain_RawRect:
+            S_OUT << TS::IdName[TS::TSRE_Terrain_RawRect] << " ";
+            data->getInt();
+            data->get();
+            x = data->getInt();
+            z = data->getInt();
+            S_OUT << x << "_" << z << " ";
+            t = Game::terrainLib->getTerrainByXY(x, z);
+            if (t == NULL) {
+                S_OUT << " Fail, NULL Terrain!";
+                break;
+            }
+            t->loadRAWRect(data);
+            t->setModified();
+            sendMessageToClients(client, message);
+            break;
         case TS::TSRE_Terrain_FtFile:
             S_OUT << TS::IdName[TS::TSRE_Terrain_FtFile];
             data->getInt();
@@ -63,12 +63,15 @@
 #include "ActivityTimetableProperties.h"
 #include "RouteEditorClient.h"
 #include "Route.h"
+#include "RouteChecker.h"
 #include "LoadWindow.h"
 #include "CELoadWindow.h"
 
 
 
 RouteEditorWindow::RouteEditorWindow() {
+    // the editor shows check results as they come, no need to wait at load
+    RouteChecker::Enabled = true;
 
     objTools = new ObjTools("ObjTools");
     terrainTools = new TerrainTools("TerrainTools");
@@ -464,6 +467,9 @@ RouteEditorWindow::RouteEditorWindow() {
     QObject::connect(geoTools, SIGNAL(createNewLoTiles(QMap<int, QPair<int, int>*>)),
                       glWidget, SLOT(createNewLoTiles(QMap<int, QPair<int, int>*>)));
     
+    QObject::connect(geoTools, SIGNAL(makeMapTextures(QMap<int, QPair<int, int>*>)),
+                      glWidget, SLOT(makeMapTextures(QMap<int, QPair<int, int>*>)));
+    
     QObject::connect(glWidget, SIGNAL(routeLoaded(Route*)),
                       objTools, SLOT(routeLoaded(Route*)));
 
@@ -58,6 +58,8 @@ WorldObj* RulerObj::clone(){
 }
 
 RulerObj::~RulerObj() {
+    for(int j = 0; j < points.size(); j++)
+        ProceduralShape::Release(points[j].procShape);
 }
 
 void RulerObj::load(int x, int y) {
@@ -121,7 +123,7 @@ void RulerObj::set(QString sh, FileBuffer* data) {
 void RulerObj::reload(){
     proceduralShapeInit = false;
     for(int j = 0; j < points.size() - 1; j++){
-        points[j].procShape.clear();
+        ProceduralShape::Release(points[j].procShape);
     }
 }
 
@@ -255,7 +257,7 @@ void RulerObj::render(GLUU* gluu, float lod, float posx, float posz, float* pos,
             }
         } else {
             //templateName = "Siec1";
-            qDebug() << templateName;
+            bool ready = true;
             for(int i = 0; i < points.size() - 1; i++){
                 float tlength = Vec3::distance(points[i].position, points[i+1].position);
                 int someval = (((points[i+1].position[2]-points[i].position[2])+0.00001f)/fabs((points[i+1].position[2]-points[i].position[2])+0.00001f));
@@ -269,9 +271,11 @@ void RulerObj::render(GLUU* gluu, float lod, float posx, float posz, float* pos,
                 QVector<TSection> sections;
                 sections.push_back(TSection());
                 sections.back().size = floor((tlength * 10 ) + 0.5) / 10;
-                ProceduralShape::GetShape(templateName, points[i].procShape, sections, i);
+                ProceduralShape::Release(points[i].procShape);
+                ready = ProceduralShape::GetShape(templateName, points[i].procShape, sections, i) && ready;
             }
-            proceduralShapeInit = true;
+            // until all parts are generated only the ruler lines are drawn
+            proceduralShapeInit = ready;
         }
     }
     
@@ -28,6 +28,8 @@
 #include "ContentHierarchyInfo.h"
 #include "RenderItem.h"
 #include "Renderer.h"
+#include "InitScheduler.h"
+#include "StaticBatch.h"
 
 SFile::SFile() {
     pathid = "";
@@ -840,6 +842,8 @@ void SFile::addSnapablePoints(QVector<float> &out){
 
 void SFile::reload() {
     loaded = 0;
+    batchVertices.clear();
+    StaticBatch::InvalidateAll();
     if(Game::debugOutput) qDebug() << "reload";
     QStringList list;
     
@@ -957,11 +961,12 @@ void SFile::pushRenderItem(int selectionColor, unsigned int stateId){
     if (isinit != 1 || loaded == 2)
         return;
     if (loaded == 0) {
-        if(Game::allowObjLag < 1) return;
+        // size is not known before loading, distance decides
+        if(!InitScheduler::Allow(this, Game::currentRenderer->mvMatrix, 10)) return;
         
-        Game::allowObjLag-=2;
         loaded = 2;
         load();
+        InitScheduler::Done();
         return;
     }
     
@@ -1072,11 +1077,11 @@ void SFile::render(int selectionColor, unsigned int stateId) {
     if (isinit != 1 || loaded == 2)
         return;
     if (loaded == 0) {
-        if(Game::allowObjLag < 1)  return;
+        if(!InitScheduler::Allow(this, GLUU::get()->mvMatrix, 10)) return;
         
-        Game::allowObjLag-=2;
         loaded = 2;
         load();
+        InitScheduler::Done();
         return;
     }
     
@@ -1207,6 +1212,95 @@ void SFile::render(int selectionColor, unsigned int stateId) {
     gluu->setBrightness(1.0);
 }
 
+// Parts of a distance level as render() would draw them, for merging into
+// a static batch. BATCH_LOADING while the shape or its textures are not
+// ready, BATCH_NEVER when it has to be drawn on its own: animated, parts
+// or sub objects switched off, textures missing.
+SFile::BatchState SFile::getBatchParts(QVector<BatchPart> &parts, unsigned int stateId, int level) {
+    if (isinit != 1)
+        return BATCH_NEVER;
+    if (loaded != 1)
+        return BATCH_LOADING;
+    if (level < 0 || level >= iloscd)
+        return BATCH_NEVER;
+    if (animated || state[stateId].animated || state[stateId].distanceLevel != 0)
+        return BATCH_NEVER;
+    if (state[stateId].enableSubObjQueue.size() > 0)
+        return BATCH_LOADING;
+
+    GLUU *gluu = GLUU::get();
+    float m[16];
+    if (!batchVertices.contains(level)) {
+        // reading a buffer back is desktop GL only
+        QVector<QVector<float>> vertices(distancelevel[level].iloscs);
+        for (int i = 0; i < distancelevel[level].iloscs; i++) {
+            sub &s = distancelevel[level].subobiekty[i];
+            int count = 0;
+            for (int j = 0; j < s.iloscc; j++)
+                count = qMax(count, s.czesci[j].offset + s.czesci[j].iloscv);
+            vertices[i].resize(count * 9);
+            if (count == 0)
+                continue;
+            s.VBO.bind();
+            bool ok = s.VBO.read(0, vertices[i].data(), count * 9 * sizeof(GLfloat));
+            s.VBO.release();
+            if (!ok)
+                return BATCH_NEVER;
+        }
+        batchVertices[level] = vertices;
+    }
+
+    for (int i = 0; i < distancelevel[level].iloscs; i++) {
+        if(((state[stateId].enabledSubObjs >> i) & 1) == 0)
+            return BATCH_NEVER;
+        for (int j = 0; j < distancelevel[level].subobiekty[i].iloscc; j++) {
+            czes &c = distancelevel[level].subobiekty[i].czesci[j];
+            if (!c.enabled)
+                return BATCH_NEVER;
+            int prim_state = c.prim_state_idx;
+            int vtx_state = primstate[prim_state].vtx_state;
+            int matrix = vtxstate[vtx_state].matrix;
+
+            BatchPart part;
+            if (primstate[prim_state].arg4 != -1) {
+                int img = texture[primstate[prim_state].arg4].image;
+                part.texAddr = image[img].texAddr;
+                if (part.texAddr < 0) {
+                    // requested by render(), drawn untextured when missing
+                    if (image[img].tex == -2)
+                        return BATCH_NEVER;
+                    if (image[img].tex >= 0) {
+                        Texture *t = TexLib::mtex[image[img].tex];
+                        if (t == NULL || t->missing || t->error)
+                            return BATCH_NEVER;
+                    }
+                    return BATCH_LOADING;
+                }
+            }
+            part.normals = vtxstate[vtx_state].arg2 >= -7;
+            part.brightness = vtxstate[vtx_state].arg2 == -12 ? 0.5 : 1.0;
+            if (level != 0) {
+                // the fixed matrix cache is kept for level 0 only
+                Mat4::identity(m);
+                memcpy(part.matrix, getPmatrix(level, m, matrix), sizeof (float) * 16);
+            } else {
+                if (!macierz[matrix].isFixed) {
+                    Mat4::identity(m);
+                    memcpy(macierz[matrix].fixed, getPmatrix(0, m, matrix), sizeof (float) * 16);
+                    macierz[matrix].isFixed = true;
+                    macierz[matrix].hash = gluu->getMatrixHash(macierz[matrix].fixed);
+                }
+                memcpy(part.matrix, macierz[matrix].fixed, sizeof (float) * 16);
+            }
+            part.vertices = batchVertices[level][i];
+            part.offset = c.offset;
+            part.count = c.iloscv;
+            parts.push_back(part);
+        }
+    }
+    return BATCH_READY;
+}
+
 void SFile::fillContentHierarchyInfo(QVector<ContentHierarchyInfo*>& list, int parent){
     if (isinit != 1 || loaded != 1)
         return;
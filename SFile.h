@@ -19,6 +19,7 @@
 #include <QMatrix4x4>
 #include <QString>
 #include <QVector>
+#include <QHash>
 
 class FileBuffer;
 class ShapeTextureInfo;
@@ -123,6 +124,24 @@ public:
         }
     };
     
+    // One drawn part for static batching: count vertices from offset in
+    // the sub object data (9 floats each, as in the VBO), the matrix from
+    // the shape hierarchy and its material.
+    enum BatchState {
+        BATCH_READY = 0,
+        BATCH_LOADING = 1,
+        BATCH_NEVER = 2
+    };
+    struct BatchPart {
+        int texAddr = -1;
+        bool normals = true;
+        float brightness = 1.0;
+        float matrix[16];
+        QVector<float> vertices;
+        int offset = 0;
+        int count = 0;
+    };
+    
     struct AnimFrameId {
         unsigned int id1 = 0;
         unsigned int id2 = 0;
@@ -212,6 +231,7 @@ public:
     void render(int selectionColor, unsigned int stateId);
     void pushRenderItem();
     void pushRenderItem(int selectionColor, unsigned int stateId);
+    BatchState getBatchParts(QVector<BatchPart> &parts, unsigned int stateId, int level = 0);
     void getSize();
     bool getBoxPoints(QVector<float> &points);
     void getFloorBorderLinePoints(float *&punkty);
@@ -248,6 +268,8 @@ private:
     //float *mvMatrix = NULL;
     bool requiresUpdate = false;
     QHash<unsigned int, QVector<RenderItem *>> renderItems;
+    // VBO contents of distance level 0, read back for static batching
+    QHash<int, QVector<QVector<float>>> batchVertices;
 };
 
 #endif	/* SFILE_H */
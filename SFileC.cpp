@@ -17,6 +17,7 @@
 #include <QOpenGLBuffer>
 #include "GLUU.h"
 #include "TS.h"
+#include "InitScheduler.h"
 
     void SFileC::odczytajshaders(FileBuffer* bufor, SFile* pliks) {
         int temp;
@@ -493,6 +494,7 @@
                 pliks->distancelevel[j].subobiekty[ii].VBO.create();
                 pliks->distancelevel[j].subobiekty[ii].VBO.bind();
                 pliks->distancelevel[j].subobiekty[ii].VBO.allocate(iloscv * 9 * sizeof(GLfloat));
+                InitScheduler::AddUploadBytes(iloscv * 9 * sizeof(GLfloat));
                 f->glEnableVertexAttribArray(0);
                 f->glEnableVertexAttribArray(1);
                 f->glEnableVertexAttribArray(2);
@@ -18,6 +18,7 @@
 #include <QtCore>
 #include "ParserX.h"
 #include "GLUU.h"
+#include "InitScheduler.h"
 
 void SFileX::odczytajshaders(FileBuffer* bufor, SFile* pliks) {
     pliks->ishaders = ParserX::GetNumber(bufor);
@@ -449,6 +450,7 @@ void SFileX::odczytajlodd(FileBuffer* bufor, SFile* pliks) {
                     pliks->distancelevel[j].subobiekty[ii].VBO.create();
                     pliks->distancelevel[j].subobiekty[ii].VBO.bind();
                     pliks->distancelevel[j].subobiekty[ii].VBO.allocate(iloscv * 9 * sizeof(GLfloat));
+                    InitScheduler::AddUploadBytes(iloscv * 9 * sizeof(GLfloat));
                     f->glEnableVertexAttribArray(0);
                     f->glEnableVertexAttribArray(1);
                     f->glEnableVertexAttribArray(2);
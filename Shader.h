@@ -49,6 +49,10 @@ public:
     unsigned int shadow1Bias;
     unsigned int shadow2Res;
     unsigned int shadow2Bias;
+    unsigned int patchLayers;
+    unsigned int patchVertices;
+    unsigned int textureArrayEnabled;
+    bool textureArrays = false;
 private:
 
 };
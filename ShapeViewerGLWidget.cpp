@@ -34,6 +34,7 @@
 #include "ActLib.h"
 #include "Activity.h"
 #include "ShapeTextureInfo.h"
+#include "InitScheduler.h"
 
 ShapeViewerGLWidget::ShapeViewerGLWidget(QWidget *parent)
 : QOpenGLWidget(parent),
@@ -73,10 +74,6 @@ void ShapeViewerGLWidget::timerEvent(QTimerEvent * event) {
     if (fps < 10) fps = 10;
     lastTime = timeNow;
 
-
-    if (Game::allowObjLag < Game::maxObjLag)
-        Game::allowObjLag += 2;
-
     camera->update(fps);
     update();
     
@@ -180,6 +177,7 @@ void ShapeViewerGLWidget::fillCurrentContentHierarchyInfo(QVector<ContentHierarc
 }
 
 void ShapeViewerGLWidget::paintGL() {
+    initScheduler.beginFrame();
     Game::currentShapeLib = currentShapeLib;
     //Game::currentEngLib = currentEngLib;
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -292,6 +290,7 @@ void ShapeViewerGLWidget::paintGL() {
     
     gluu->currentShader->release();
     Game::shadowsEnabled = shadowsState;
+    initScheduler.endFrame();
 }
 
 void ShapeViewerGLWidget::getImg() {
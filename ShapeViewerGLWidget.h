@@ -18,6 +18,7 @@
 #include <QMatrix4x4>
 #include <QBasicTimer>
 #include <math.h>
+#include "InitScheduler.h"
 
 class SFile;
 class Eng;
@@ -93,6 +94,7 @@ protected:
 private:
     void setupVertexAttribs();
     QBasicTimer timer;
+    InitScheduler initScheduler;
     unsigned long long int lastTime;
     unsigned long long int timeNow;
     bool m_core;
@@ -9,6 +9,20 @@
  */
 
 #include "SoundLib.h"
+#include <QDebug>
+#include <QFile>
+#ifdef __APPLE__
+#include <OpenAL/al.h>
+#else
+#include <AL/al.h>
+#endif
+#include "ReadFile.h"
+#include "FileBuffer.h"
+#include "Game.h"
+
+long long int SoundLib::MemoryUsed = 0;
+QHash<QString, SoundLib::Buffer*> SoundLib::Buffers;
+QHash<int, SoundLib::Buffer*> SoundLib::BuffersById;
 
 SoundLib::SoundLib() {
 }
@@ -19,3 +33,107 @@ SoundLib::SoundLib(const SoundLib& orig) {
 SoundLib::~SoundLib() {
 }
 
+int SoundLib::AddBuffer(QString path){
+    QString pathid = path.toLower();
+    pathid.replace("\\", "/");
+    pathid.replace("//", "/");
+    Buffer *b = Buffers.value(pathid, NULL);
+    if(b != NULL){
+        b->ref++;
+        return b->alBid;
+    }
+    
+    b = new Buffer();
+    b->pathid = pathid;
+    alGenBuffers(1, (ALuint*)&b->alBid);
+    if(!LoadWav(path, b->alBid, b->bytes, b->duration)){
+        alDeleteBuffers(1, (ALuint*)&b->alBid);
+        delete b;
+        return -1;
+    }
+    b->ref = 1;
+    Buffers[pathid] = b;
+    BuffersById[b->alBid] = b;
+    MemoryUsed += b->bytes;
+    if(Game::debugOutput) qDebug() << "wav" << pathid << b->bytes << "total" << MemoryUsed;
+    return b->alBid;
+}
+
+void SoundLib::DelRef(int alBid){
+    Buffer *b = BuffersById.value(alBid, NULL);
+    if(b == NULL)
+        return;
+    if(--b->ref > 0)
+        return;
+    alDeleteBuffers(1, (ALuint*)&b->alBid);
+    MemoryUsed -= b->bytes;
+    Buffers.remove(b->pathid);
+    BuffersById.remove(alBid);
+    delete b;
+}
+
+int SoundLib::BuffersCount(){
+    return BuffersById.size();
+}
+
+float SoundLib::Duration(int alBid){
+    Buffer *b = BuffersById.value(alBid, NULL);
+    if(b == NULL)
+        return 0;
+    return b->duration;
+}
+
+bool SoundLib::LoadWav(QString path, int alBid, int &bytes, float &duration){
+    path.replace("//", "/");
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)){
+        qDebug() << "fail vaw file "<< file.fileName();
+        return false;
+    }
+    FileBuffer* filedata = ReadFile::read(&file);
+    file.close();
+    
+    // RIFF, size, WAVE, fmt, fmt size and the 16 bytes every fmt has
+    if(filedata->length < 20 + 16){
+        qDebug() << "broken vaw file" << path;
+        delete filedata;
+        return false;
+    }
+    filedata->off += 16;
+    unsigned int chunkSize = filedata->getUint();
+    unsigned short audioFormat = filedata->getShort();
+    unsigned short channels = filedata->getShort();
+    unsigned int sampleRate = filedata->getUint();
+    unsigned int byteRate = filedata->getUint();
+    filedata->getSignedShort();
+    unsigned short bitsPerSample = filedata->getShort();
+    if (chunkSize != 16) {
+        unsigned short extraParams = 0;
+        if(filedata->off + 2 <= filedata->length)
+            extraParams = filedata->getShort();
+        filedata->off += extraParams;
+    }
+    // data, its size must fit in what is left of the file
+    if((long long int)filedata->off + 8 > filedata->length){
+        qDebug() << "broken vaw file" << path << audioFormat << bitsPerSample;
+        delete filedata;
+        return false;
+    }
+    filedata->off += 4;
+    unsigned int dataChunkSize = filedata->getUint();
+    if(filedata->off + (long long int)dataChunkSize > filedata->length){
+        qDebug() << "broken vaw file" << path << audioFormat << bitsPerSample;
+        delete filedata;
+        return false;
+    }
+    
+    ALenum formatinfo = AL_FORMAT_STEREO16;
+    if (channels == 1)
+        formatinfo = AL_FORMAT_MONO16;
+    alBufferData(alBid, formatinfo, filedata->data + filedata->off, dataChunkSize, sampleRate);
+    bytes = dataChunkSize;
+    if(byteRate > 0)
+        duration = float(dataChunkSize) / byteRate;
+    delete filedata;
+    return true;
+}
@@ -11,14 +11,33 @@
 #ifndef SOUNDLIB_H
 #define	SOUNDLIB_H
 
+#include <QString>
+#include <QHash>
+
+// Decoded wav files as AL buffers, one per file for all sources
+// that play it. Buffers are deleted when the last user lets go.
 class SoundLib {
 public:
+    static long long int MemoryUsed;
+    static int AddBuffer(QString path);
+    static void DelRef(int alBid);
+    static int BuffersCount();
+    static float Duration(int alBid);
+    
     SoundLib();
     SoundLib(const SoundLib& orig);
     virtual ~SoundLib();
 private:
-
+    struct Buffer {
+        QString pathid;
+        int alBid = -1;
+        int ref = 0;
+        int bytes = 0;
+        float duration = 0;
+    };
+    static QHash<QString, Buffer*> Buffers;
+    static QHash<int, Buffer*> BuffersById;
+    static bool LoadWav(QString path, int alBid, int &bytes, float &duration);
 };
 
 #endif	/* SOUNDLIB_H */
-
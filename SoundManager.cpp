@@ -22,6 +22,10 @@
 #include "ReadFile.h"
 #include "FileBuffer.h"
 #include "GLMatrix.h"
+#include "Game.h"
+#include <QSet>
+#include <QDebug>
+#include <algorithm>
 
 QMap<int, SoundSource*> SoundManager::Sources;
 int SoundManager::SourcesCount;
@@ -30,6 +34,10 @@ ALCcontext *SoundManager::context = NULL;
 float SoundManager::listenerPos[3] = {0,0,0};
 int SoundManager::listenerX = 0;
 int SoundManager::listenerZ = 0;
+QVector<SoundManager::Voice> SoundManager::Voices;
+QHash<int, QVector<SoundSource*>> SoundManager::Grid;
+QVector<SoundSource*> SoundManager::Unplaced;
+float SoundManager::FadeStep = 0.2;
 
 void SoundManager::InitAl() {
     ALboolean enumeration;
@@ -72,6 +80,7 @@ void SoundManager::InitAl() {
 	//qDebug("listener velocity");
 	alListenerfv(AL_ORIENTATION, listenerOri);
 	//qDebug("listener orientation");
+        alDistanceModel(AL_LINEAR_DISTANCE_CLAMPED);
 
         
                 
@@ -79,16 +88,110 @@ void SoundManager::InitAl() {
 }
 
 void SoundManager::UpdateAll(){
-    QMapIterator<int, SoundSource*> i(Sources);
-        while (i.hasNext()) {
-            i.next();
-            if(i.value() == NULL) continue;
-            i.value()->update();
+    // max distance of a stream is well below a tile
+    QVector<SoundSource*> active = Unplaced;
+    for(int i = -1; i <= 1; i++)
+        for(int j = -1; j <= 1; j++)
+            active += Grid.value((listenerX + i)*10000 + listenerZ + j);
+    
+    for(int i = 0; i < active.size(); i++)
+        active[i]->update();
+    AssignVoices(active);
+}
+
+void SoundManager::AssignVoices(QVector<SoundSource*> &active){
+    QVector<QPair<float, SoundDefinitionGroup::Stream*>> audible;
+    for(int i = 0; i < active.size(); i++)
+        for(int j = 0; j < active[i]->stream.size(); j++){
+            SoundDefinitionGroup::Stream *s = active[i]->stream[j];
+            if(!s->isPlaying())
+                continue;
+            float a = s->audibility();
+            if(a <= 0)
+                continue;
+            audible.push_back(QPair<float, SoundDefinitionGroup::Stream*>(-a, s));
+        }
+    std::sort(audible.begin(), audible.end());
+    
+    QSet<SoundDefinitionGroup::Stream*> wanted;
+    for(int i = 0; i < audible.size() && i < Game::soundVoices; i++)
+        wanted.insert(audible[i].second);
+    
+    // free voices of silent streams, fade out the ones that lost
+    for(int i = 0; i < Voices.size(); i++){
+        SoundDefinitionGroup::Stream *s = Voices[i].owner;
+        if(s == NULL)
+            continue;
+        if(wanted.contains(s)){
+            wanted.remove(s);
+            if(s->fade < 1.0)
+                s->setFade(std::min(1.0f, s->fade + FadeStep));
+            continue;
         }
+        if(s->isPlaying() && s->fade > FadeStep){
+            s->setFade(s->fade - FadeStep);
+            continue;
+        }
+        s->unbindVoice();
+        Voices[i].owner = NULL;
+    }
+    
+    // the rest wait for a voice while others fade
+    for(int i = 0; i < audible.size(); i++){
+        SoundDefinitionGroup::Stream *s = audible[i].second;
+        if(!wanted.contains(s))
+            continue;
+        int v = NewVoice();
+        if(v < 0)
+            break;
+        Voices[v].owner = s;
+        s->fade = FadeStep;
+        s->bindVoice(Voices[v].alSid);
+    }
+}
+
+int SoundManager::NewVoice(){
+    for(int i = 0; i < Voices.size(); i++)
+        if(Voices[i].owner == NULL)
+            return i;
+    if(Voices.size() >= Game::soundVoices)
+        return -1;
+    Voice v;
+    alGetError();
+    alGenSources((ALuint)1, (ALuint*)&v.alSid);
+    if(alGetError() != AL_NO_ERROR){
+        // driver limit, stay below it from now on
+        qDebug() << "sound voices limit" << Voices.size();
+        Game::soundVoices = Voices.size();
+        return -1;
+    }
+    Voices.push_back(v);
+    return Voices.size() - 1;
+}
+
+int SoundManager::VoicesUsed(){
+    int count = 0;
+    for(int i = 0; i < Voices.size(); i++)
+        if(Voices[i].owner != NULL)
+            count++;
+    return count;
+}
+
+void SoundManager::PlaceSource(SoundSource *s, int x, int y){
+    int hash = x*10000 + y;
+    if(s->tileHash == hash)
+        return;
+    if(s->tileHash == -1)
+        Unplaced.removeOne(s);
+    else
+        Grid[s->tileHash].removeOne(s);
+    s->tileHash = hash;
+    Grid[hash].push_back(s);
 }
 
 void SoundManager::UpdateListenerPos(int x, int y, float* pos, float* target, float* up){
     alListener3f(AL_POSITION, pos[0], pos[1], pos[2]);
+    Vec3::copy(listenerPos, pos);
     float o[6];
     o[0] = target[0] - pos[0];
     o[1] = target[1] - pos[1];
@@ -102,18 +205,17 @@ void SoundManager::UpdateListenerPos(int x, int y, float* pos, float* target, fl
     if(listenerX != x || listenerZ != y){
         listenerX = x;
         listenerZ = y;
-        QMapIterator<int, SoundSource*> i(Sources);
-        while (i.hasNext()) {
-            i.next();
-            if(i.value() == NULL) continue;
-            i.value()->updatePosition();
-        }
+        // only streams with a voice have AL positions to move
+        for(int i = 0; i < Voices.size(); i++)
+            if(Voices[i].owner != NULL)
+                Voices[i].owner->updatePosition();
     }
 }
 
 int SoundManager::AddSoundSource(QString resPath, QString name){
     // simple source
     Sources[SourcesCount] = new SoundSource(resPath, name);
+    Unplaced.push_back(Sources[SourcesCount]);
     return SourcesCount++;
 }
 
@@ -122,13 +224,19 @@ int SoundManager::AddSoundSource(SoundDefinitionGroup* g){
         return -1;
     
     Sources[SourcesCount] = new SoundSource(g);
+    Unplaced.push_back(Sources[SourcesCount]);
     return SourcesCount++;
 }
 
 
 
 void SoundManager::CloseAl(){
-    //alDeleteSources(1, &source);
+    for(int i = 0; i < Voices.size(); i++){
+        if(Voices[i].owner != NULL)
+            Voices[i].owner->unbindVoice();
+        alDeleteSources(1, (ALuint*)&Voices[i].alSid);
+    }
+    Voices.clear();
     //alDeleteBuffers(1, &buffer);
     device = alcGetContextsDevice(context);
     alcMakeContextCurrent(NULL);
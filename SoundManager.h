@@ -20,16 +20,24 @@
 #endif
 #include <QString>
 #include <QMap>
+#include <QHash>
+#include <QVector>
+#include "MstsSoundDefinition.h"
 
 class SoundSource;
 class SoundDefinitionGroup;
 
+// Sources are virtual and kept in a grid by tile. Only sources in the
+// tiles around the listener are updated, and only the most audible
+// streams get one of Game::soundVoices AL sources. A stream losing its
+// voice is faded out first.
 class SoundManager {
 public:
     static QMap<int, SoundSource*> Sources;
     static int SourcesCount;
     static int listenerX;
     static int listenerZ;
+    static float listenerPos[3];
     
     static void InitAl();
     static void CloseAl();
@@ -39,16 +47,26 @@ public:
     static int AddSoundSource(QString resPath, QString name);
     static int AddSoundSource(SoundDefinitionGroup* g);
     static int InitSource(QString path);
+    static void PlaceSource(SoundSource *s, int x, int y);
+    static int VoicesUsed();
     
 private:
+    struct Voice {
+        int alSid = -1;
+        SoundDefinitionGroup::Stream *owner = NULL;
+    };
 
     static ALCdevice *device;
     static ALCcontext *context;
+    static QVector<Voice> Voices;
+    static QHash<int, QVector<SoundSource*>> Grid;
+    static QVector<SoundSource*> Unplaced;
+    static float FadeStep;
     
     static void list_audio_devices(const ALCchar *devices);
     //static ALenum to_al_format(short channels, short samples);
-
-    static float listenerPos[3];
+    static void AssignVoices(QVector<SoundSource*> &active);
+    static int NewVoice();
 };
 
 #endif	/* SOUNDMANAGER_H */
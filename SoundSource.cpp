@@ -48,6 +48,7 @@ SoundSource::~SoundSource() {
 void SoundSource::setPosition(int x, int y, float *pos){
     for(int i = 0; i < stream.size(); i++)
         stream[i]->setPosition(x, y, pos);
+    SoundManager::PlaceSource(this, x, y);
 }
 
 void SoundSource::updatePosition(){
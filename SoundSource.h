@@ -19,6 +19,8 @@ class SoundSource {
 public:
     QVector<SoundDefinitionGroup::Stream*> stream;
     SoundVariables *variables = NULL;
+    // grid cell in SoundManager, -1 until placed
+    int tileHash = -1;
     void setPosition(int x, int y, float *pos);
     void update();
     void updatePosition();
@@ -0,0 +1,331 @@
+/*  This file is part of TSRE5.
+ *
+ *  TSRE5 - train sim game engine and MSTS/OR Editors. 
+ *  Copyright (C) 2016 Piotr Gadecki <pgadecki@gmail.com>
+ *
+ *  Licensed under GNU General Public License 3.0 or later. 
+ *
+ *  See LICENSE.md or https://www.gnu.org/licenses/gpl.html
+ */
+
+#include "StaticBatch.h"
+#include "Tile.h"
+#include "WorldObj.h"
+#include "SFile.h"
+#include "GLUU.h"
+#include "GLMatrix.h"
+#include "TexLib.h"
+#include "Game.h"
+#include "InitScheduler.h"
+#include <QDebug>
+#include <QDateTime>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QMap>
+#include <QAtomicInt>
+#include <QRunnable>
+#include <QThreadPool>
+#include <math.h>
+#include <string.h>
+
+static const int CellCount = 8;
+// objects smaller than this are not seen from a far tile
+static const float ProxyMinSize = 15.0;
+
+// Objects copied on the GL thread and the merged cells made from them.
+// The task only holds this, so the batch may be deleted while it runs.
+struct StaticBatchResult {
+    struct Object {
+        int cell;
+        float position[3];
+        float size;
+        float matrix[16];
+        QVector<SFile::BatchPart> parts;
+    };
+    struct CellData {
+        int id;
+        float radius = 0;
+        QVector<float> vertices;
+        QVector<StaticBatch::Range> ranges;
+    };
+    int generation;
+    int changes;
+    int cellCount;
+    int missing = 0;
+    QVector<Object> objects;
+    QHash<WorldObj*, StaticBatch::Entry> entries;
+    QSet<WorldObj*> dropped;
+    QVector<CellData> cells;
+    QAtomicInt done;
+};
+
+class StaticBatchTask : public QRunnable {
+public:
+    QSharedPointer<StaticBatchResult> result;
+
+    void run(){
+        // parts of a cell grouped by texture, normals and brightness
+        int cellCount = result->cellCount;
+        float cellSize = 2048.0 / cellCount;
+        QVector<QMap<qint64, QVector<float>>> materials(cellCount*cellCount);
+        QVector<float> radius(cellCount*cellCount, 0);
+        float m[16];
+        float n[9];
+        for(int i = 0; i < result->objects.size(); i++){
+            StaticBatchResult::Object &o = result->objects[i];
+            float cx = -1024 + ((o.cell % cellCount) + 0.5) * cellSize;
+            float cz = -1024 + ((o.cell / cellCount) + 0.5) * cellSize;
+            float dist = sqrt((o.position[0] - cx)*(o.position[0] - cx) + (o.position[2] - cz)*(o.position[2] - cz));
+            radius[o.cell] = qMax(radius[o.cell], dist + o.size);
+
+            for(int j = 0; j < o.parts.size(); j++){
+                SFile::BatchPart &p = o.parts[j];
+                qint64 key = ((qint64)(p.texAddr + 1) << 2) | (p.normals ? 2 : 0) | (p.brightness < 1.0 ? 1 : 0);
+                QVector<float> &out = materials[o.cell][key];
+                int start = out.size();
+                out.resize(start + p.count*9);
+                memcpy(out.data() + start, p.vertices.constData() + p.offset*9, p.count*9*sizeof(float));
+                Mat4::multiply(m, o.matrix, p.matrix);
+                Vec3::transformMat4Batch(out.data() + start, out.data() + start, p.count, 9, m);
+                // normals too, the batch is drawn with an identity shape
+                // matrix and the shader only normalizes them
+                n[0] = m[0]; n[1] = m[1]; n[2] = m[2];
+                n[3] = m[4]; n[4] = m[5]; n[5] = m[6];
+                n[6] = m[8]; n[7] = m[9]; n[8] = m[10];
+                for(int k = 0; k < p.count; k++){
+                    float *normal = out.data() + start + k*9 + 3;
+                    Vec3::transformMat3(normal, normal, n);
+                    Vec3::normalize(normal, normal);
+                }
+            }
+        }
+        result->objects.clear();
+
+        for(int i = 0; i < materials.size(); i++){
+            if(materials[i].size() == 0)
+                continue;
+            StaticBatchResult::CellData c;
+            c.id = i;
+            c.radius = radius[i];
+            for(auto it = materials[i].begin(); it != materials[i].end(); ++it){
+                StaticBatch::Range r;
+                r.texAddr = (it.key() >> 2) - 1;
+                r.normals = (it.key() & 2) != 0;
+                r.brightness = (it.key() & 1) != 0 ? 0.5 : 1.0;
+                r.offset = c.vertices.size() / 9;
+                r.count = it.value().size() / 9;
+                c.vertices += it.value();
+                c.ranges.push_back(r);
+            }
+            result->cells.push_back(c);
+        }
+        result->done.storeRelease(1);
+    }
+};
+
+int StaticBatch::Generation = 0;
+
+// Shapes or textures were reloaded, every batch has to be made again.
+void StaticBatch::InvalidateAll(){
+    Generation++;
+}
+
+StaticBatch::StaticBatch(Tile *tile, bool proxy) {
+    this->tile = tile;
+    this->proxy = proxy;
+}
+
+StaticBatch::~StaticBatch() {
+    clearCells();
+}
+
+void StaticBatch::invalidate(){
+    valid = false;
+    dirty = true;
+    changes++;
+    retryDelay = 0;
+    // edits come in bursts while objects are dragged
+    buildTime = QDateTime::currentMSecsSinceEpoch() + 500;
+}
+
+bool StaticBatch::render(GLUU *gluu, float* playerT, float* playerW){
+    if(generation != Generation){
+        generation = Generation;
+        invalidate();
+    }
+    if(!pending.isNull() && pending->done.loadAcquire() == 1)
+        finish();
+    if(dirty && pending.isNull() && QDateTime::currentMSecsSinceEpoch() >= buildTime)
+        start();
+    seen = 0;
+    if(!valid)
+        return false;
+
+    QOpenGLFunctions *f = QOpenGLContext::currentContext()->functions();
+    float identity[16];
+    Mat4::identity(identity);
+    gluu->currentShader->setUniformValue(gluu->currentShader->mvMatrixUniform, *reinterpret_cast<float(*)[4][4]> (gluu->mvMatrix));
+    gluu->currentShader->setUniformValue(gluu->currentShader->msMatrixUniform, *reinterpret_cast<float(*)[4][4]> (&identity));
+    gluu->currentMsMatrinxHash = gluu->getMatrixHash(identity);
+    gluu->enableTextures();
+
+    for(int i = 0; i < cells.size(); i++){
+        Cell *c = cells[i];
+        float lodx = (tile->x - playerT[0])*2048 + c->center[0] - playerW[0];
+        float lodz = (tile->z - playerT[1])*2048 + c->center[2] - playerW[2];
+        if(sqrt(lodx * lodx + lodz * lodz) - c->radius > Game::objectLod)
+            continue;
+        QOpenGLVertexArrayObject::Binder vaoBinder(&c->VAO);
+        for(int j = 0; j < c->ranges.size(); j++){
+            Range &r = c->ranges[j];
+            if(r.normals)
+                gluu->enableNormals();
+            else
+                gluu->disableNormals();
+            gluu->setBrightness(r.brightness);
+            if(r.texAddr < 0 || TexLib::disabledTextures.value(r.texAddr) == 1)
+                gluu->disableTextures(1.0, 0.0, 1.0, 1.0);
+            else
+                gluu->bindTexture(f, r.texAddr);
+            f->glDrawArrays(GL_TRIANGLES, r.offset, r.count);
+            gluu->enableTextures();
+        }
+    }
+    gluu->setBrightness(1.0);
+    return true;
+}
+
+// True when the object is drawn by the batch. A batched object that was
+// moved, selected or got another shape drops the batch.
+bool StaticBatch::skip(WorldObj *obj){
+    if(!valid)
+        return false;
+    if(dropped.contains(obj))
+        return true;
+    auto it = entries.constFind(obj);
+    if(it == entries.constEnd())
+        return false;
+    SFile *sfile = NULL;
+    unsigned int stateId = 0;
+    if(!obj->getStaticBatchShape(sfile, stateId) || sfile != it->shape
+            || memcmp(obj->matrix, it->matrix, sizeof(float) * 16) != 0){
+        invalidate();
+        return false;
+    }
+    seen++;
+    return true;
+}
+
+void StaticBatch::endFrame(){
+    // a batched object was deleted or replaced
+    if(valid && seen < entries.size())
+        invalidate();
+}
+
+void StaticBatch::start(){
+    dirty = false;
+    QSharedPointer<StaticBatchResult> result(new StaticBatchResult());
+    result->generation = generation;
+    result->changes = changes;
+    result->cellCount = proxy ? 1 : CellCount;
+    float cellSize = 2048.0 / result->cellCount;
+    for (auto it = tile->obiekty.begin(); it != tile->obiekty.end(); ++it) {
+        WorldObj* obj = it->second;
+        if(obj == NULL || !obj->loaded)
+            continue;
+        SFile *sfile = NULL;
+        unsigned int stateId = 0;
+        if(!obj->getStaticBatchShape(sfile, stateId))
+            continue;
+        if(proxy && sfile->isinit == 1 && sfile->loaded == 1 && sfile->size < ProxyMinSize){
+            result->dropped.insert(obj);
+            continue;
+        }
+        StaticBatchResult::Object o;
+        SFile::BatchState state = sfile->getBatchParts(o.parts, stateId, proxy ? sfile->iloscd - 1 : 0);
+        if(state == SFile::BATCH_LOADING)
+            result->missing++;
+        // objects that can never be batched are drawn one by one
+        if(state != SFile::BATCH_READY)
+            continue;
+        int cx = qBound(0, (int)((obj->position[0] + 1024) / cellSize), result->cellCount - 1);
+        int cz = qBound(0, (int)((obj->position[2] + 1024) / cellSize), result->cellCount - 1);
+        o.cell = cz*result->cellCount + cx;
+        Vec3::copy(o.position, obj->position);
+        o.size = qMax(sfile->size, 0.0f);
+        memcpy(o.matrix, obj->matrix, sizeof(float) * 16);
+        result->objects.push_back(o);
+
+        Entry e;
+        e.shape = sfile;
+        memcpy(e.matrix, obj->matrix, sizeof(float) * 16);
+        result->entries[obj] = e;
+    }
+
+    StaticBatchTask *task = new StaticBatchTask();
+    task->result = result;
+    pending = result;
+    QThreadPool::globalInstance()->start(task);
+}
+
+void StaticBatch::finish(){
+    QSharedPointer<StaticBatchResult> result = pending;
+    pending.clear();
+    if(result->generation != Generation || result->changes != changes){
+        // changed while it was built
+        dirty = true;
+        return;
+    }
+
+    clearCells();
+    QOpenGLFunctions *f = QOpenGLContext::currentContext()->functions();
+    int draws = 0;
+    float cellSize = 2048.0 / result->cellCount;
+    for(int i = 0; i < result->cells.size(); i++){
+        StaticBatchResult::CellData &d = result->cells[i];
+        Cell *c = new Cell();
+        c->center[0] = -1024 + ((d.id % result->cellCount) + 0.5) * cellSize;
+        c->center[1] = 0;
+        c->center[2] = -1024 + ((d.id / result->cellCount) + 0.5) * cellSize;
+        c->radius = d.radius;
+        c->ranges = d.ranges;
+        draws += d.ranges.size();
+
+        c->VAO.create();
+        QOpenGLVertexArrayObject::Binder vaoBinder(&c->VAO);
+        c->VBO.create();
+        c->VBO.bind();
+        c->VBO.allocate(d.vertices.constData(), d.vertices.size() * sizeof(GLfloat));
+        InitScheduler::AddUploadBytes(d.vertices.size() * sizeof(GLfloat));
+        f->glEnableVertexAttribArray(0);
+        f->glEnableVertexAttribArray(1);
+        f->glEnableVertexAttribArray(2);
+        f->glEnableVertexAttribArray(3);
+        f->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(GLfloat), 0);
+        f->glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(GLfloat), reinterpret_cast<void *>(3 * sizeof(GLfloat)));
+        f->glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 9 * sizeof(GLfloat), reinterpret_cast<void *>(6 * sizeof(GLfloat)));
+        f->glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, 9 * sizeof(GLfloat), reinterpret_cast<void *>(8 * sizeof(GLfloat)));
+        c->VBO.release();
+        cells.push_back(c);
+    }
+    entries = result->entries;
+    dropped = result->dropped;
+    valid = true;
+
+    if(result->missing > 0){
+        // shapes or textures still loading, those objects are added later
+        retryDelay = retryDelay == 0 ? 2000 : qMin(retryDelay * 2, 60000);
+        dirty = true;
+        buildTime = QDateTime::currentMSecsSinceEpoch() + retryDelay;
+    }
+    if(Game::debugOutput) qDebug() << (proxy ? "tile proxy" : "static batch") << tile->x << tile->z << "objects" << entries.size() << "draws" << draws << "waiting" << result->missing;
+}
+
+void StaticBatch::clearCells(){
+    for(int i = 0; i < cells.size(); i++){
+        cells[i]->VBO.destroy();
+        cells[i]->VAO.destroy();
+        delete cells[i];
+    }
+    cells.clear();
+}
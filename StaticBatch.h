@@ -0,0 +1,83 @@
+/*  This file is part of TSRE5.
+ *
+ *  TSRE5 - train sim game engine and MSTS/OR Editors. 
+ *  Copyright (C) 2016 Piotr Gadecki <pgadecki@gmail.com>
+ *
+ *  Licensed under GNU General Public License 3.0 or later. 
+ *
+ *  See LICENSE.md or https://www.gnu.org/licenses/gpl.html
+ */
+
+#ifndef STATICBATCH_H
+#define STATICBATCH_H
+
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QSharedPointer>
+#include <QOpenGLBuffer>
+#include <QOpenGLVertexArrayObject>
+
+class Tile;
+class WorldObj;
+class SFile;
+class GLUU;
+struct StaticBatchResult;
+
+// Static scenery of one tile merged into one vertex buffer per 256 m
+// cell, drawn with one call per material. Objects that are selected,
+// animated or drawn in their own way stay out and are drawn one by one.
+// A change to a batched object drops the batch, the tile is drawn object
+// by object until a new one is built on the thread pool.
+// A proxy batch stands in for a far tile: lowest distance levels in one
+// cell, small objects left out.
+class StaticBatch {
+public:
+    struct Range {
+        int texAddr;
+        bool normals;
+        float brightness;
+        int offset;
+        int count;
+    };
+    struct Entry {
+        SFile *shape;
+        float matrix[16];
+    };
+
+    static void InvalidateAll();
+    StaticBatch(Tile *tile, bool proxy = false);
+    virtual ~StaticBatch();
+    bool render(GLUU *gluu, float* playerT, float* playerW);
+    bool skip(WorldObj *obj);
+    void endFrame();
+    void invalidate();
+
+private:
+    struct Cell {
+        float center[3];
+        float radius;
+        QOpenGLBuffer VBO;
+        QOpenGLVertexArrayObject VAO;
+        QVector<Range> ranges;
+    };
+    static int Generation;
+    Tile *tile;
+    bool proxy;
+    QVector<Cell*> cells;
+    QHash<WorldObj*, Entry> entries;
+    QSet<WorldObj*> dropped;
+    QSharedPointer<StaticBatchResult> pending;
+    int generation = -1;
+    int changes = 0;
+    bool valid = false;
+    bool dirty = true;
+    unsigned long long int buildTime = 0;
+    int retryDelay = 0;
+    int seen = 0;
+    void start();
+    void finish();
+    void clearCells();
+};
+
+#endif /* STATICBATCH_H */
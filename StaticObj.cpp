@@ -275,6 +275,16 @@ void StaticObj::render(GLUU* gluu, float lod, float posx, float posz, float* pos
     }
 };
 
+bool StaticObj::getStaticBatchShape(SFile *&sfile, unsigned int &stateId){
+    if (!loaded || shape < 0 || jestPQ < 2 || shapePointer == NULL)
+        return false;
+    if (selected || isAnimated())
+        return false;
+    sfile = shapePointer;
+    stateId = shapeState;
+    return true;
+}
+
 void StaticObj::snapped(int side){
     if(side > -1){
         QVector<float> points;
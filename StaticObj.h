@@ -43,6 +43,7 @@ public:
     ErrorMessage* checkForErrors();
     void pushRenderItems(float lod, float posx, float posz, float* playerW, float* target, float fov, int selectionColor);
     void render(GLUU* gluu, float lod, float posx, float posz, float* playerW, float* target, float fov, int selectionColor, int renderMode);
+    bool getStaticBatchShape(SFile *&sfile, unsigned int &stateId);
     void updateSim(float deltaTime);
     void pushContextMenuActions(QMenu *menu);
     
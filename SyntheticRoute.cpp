@@ -0,0 +1,123 @@
+/*  This file is part of TSRE5.
+ *
+ *  TSRE5 - train sim game engine and MSTS/OR Editors. 
+ *  Copyright (C) 2016 Piotr Gadecki <pgadecki@gmail.com>
+ *
+ *  Licensed under GNU General Public License 3.0 or later. 
+ *
+ *  See LICENSE.md or https://www.gnu.org/licenses/gpl.html
+ */
+
+#include "SyntheticRoute.h"
+#include "Game.h"
+#include "Trk.h"
+#include "TDB.h"
+#include "Tile.h"
+#include "Terrain.h"
+#include "QuadTree.h"
+#include "FileFunctions.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QDateTime>
+#include <QTextStream>
+
+bool SyntheticRoute::Create(int size, int objectsPerTile){
+    if(size < 1)
+        return false;
+    QString path = Game::root + "/routes/" + Game::route;
+    if(QDir(path).exists()){
+        qDebug() << "synthetic route: folder exist - using it" << path;
+        return true;
+    }
+    unsigned long long int timeNow = QDateTime::currentMSecsSinceEpoch();
+    bool writeEnabled = Game::writeEnabled;
+    Game::writeEnabled = true;
+
+    QDir().mkpath(Game::root + "/global");
+    QDir().mkpath(path);
+    QDir().mkdir(path + "/envfiles");
+    QDir().mkdir(path + "/paths");
+    QDir().mkdir(path + "/shapes");
+    QDir().mkdir(path + "/textures");
+    QDir().mkdir(path + "/terrtex");
+    QDir().mkdir(path + "/tiles");
+    QDir().mkdir(path + "/td");
+    QDir().mkdir(path + "/world");
+
+    QString res = QString("tsre_assets/templateroute_0.6/");
+    FileFunctions::copyFiles(res + "shapes", path + "/shapes");
+    FileFunctions::copyFiles(res + "textures", path + "/textures");
+    QDir shapeDir(path + "/shapes");
+    QStringList shapes = shapeDir.entryList(QStringList() << "*.s", QDir::Files);
+    if(shapes.size() == 0)
+        shapes.push_back("synthetic.s");
+
+    Game::trkName = Game::route;
+    Game::routeName = Game::route;
+    Trk *trk = new Trk();
+    trk->idName = Game::route;
+    trk->routeName = Game::route;
+    trk->displayName = Game::route;
+    trk->startTileX = Game::newRouteX;
+    trk->startTileZ = Game::newRouteZ;
+    trk->modified = true;
+    trk->save();
+    delete trk;
+
+    TDB::saveEmpty(false);
+    TDB::saveEmpty(true);
+
+    // td index is written on every addTile, so keep the count sane
+    QuadTree *quadTree = new QuadTree();
+    int uid = 1;
+    for(int i = 0; i < size; i++)
+        for(int j = 0; j < size; j++){
+            int x = Game::newRouteX + i;
+            int z = Game::newRouteZ + j;
+            if(i == 0 && j == 0)
+                quadTree->createNew(x, z);
+            else
+                quadTree->addTile(x, z);
+            Terrain::SaveEmpty(quadTree->getMyName(x, z));
+            SaveWorldFile(x, z, objectsPerTile, uid, shapes);
+        }
+    delete quadTree;
+
+    Game::writeEnabled = writeEnabled;
+    qDebug() << "#synthetic route time "<< ((float)(QDateTime::currentMSecsSinceEpoch() - timeNow))/1000.0 << size*size << "tiles";
+    return true;
+}
+
+void SyntheticRoute::SaveWorldFile(int x, int z, int count, int &uid, QStringList &shapes){
+    QString path = Game::root + "/routes/" + Game::route + "/world/w" + Tile::getNameXY(x) + "" + Tile::getNameXY(z) + ".w";
+    path.replace("//", "/");
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        return;
+    QTextStream out(&file);
+    out.setCodec("UTF-16");
+    out.setGenerateByteOrderMark(true);
+    out << "SIMISA@@@@@@@@@@JINX0w0t______\n";
+    out << "\n";
+    out << "Tr_Worldfile (\n";
+    // same seed for every run, objects on a grid inside the tile
+    int side = 1;
+    while(side*side < count)
+        side++;
+    float step = 2048.0/side;
+    for(int i = 0; i < count; i++){
+        float px = -1024.0 + step*(i % side) + step*0.5;
+        float pz = -1024.0 + step*(i / side) + step*0.5;
+        out << "	Static (\n";
+        out << "		UiD ( " << uid++ << " )\n";
+        out << "		FileName ( " << shapes[i % shapes.size()] << " )\n";
+        out << "		Position ( " << px << " 0 " << pz << " )\n";
+        out << "		QDirection ( 0 0 0 1 )\n";
+        out << "		VDbId ( 4294967294 )\n";
+        out << "		StaticDetailLevel ( 0 )\n";
+        out << "	)\n";
+    }
+    out << ")";
+    file.close();
+}
@@ -0,0 +1,29 @@
+/*  This file is part of TSRE5.
+ *
+ *  TSRE5 - train sim game engine and MSTS/OR Editors. 
+ *  Copyright (C) 2016 Piotr Gadecki <pgadecki@gmail.com>
+ *
+ *  Licensed under GNU General Public License 3.0 or later. 
+ *
+ *  See LICENSE.md or https://www.gnu.org/licenses/gpl.html
+ */
+
+#ifndef SYNTHETICROUTE_H
+#define	SYNTHETICROUTE_H
+
+#include <QString>
+#include <QStringList>
+
+// Writes a route of size x size tiles around Game::newRouteX/Z, every
+// world file filled with static objects. Used to benchmark route loading
+// without any third party content. Shapes are taken from the template
+// route if it is there, missing shapes are only looked up.
+class SyntheticRoute {
+public:
+    static bool Create(int size, int objectsPerTile = 200);
+
+private:
+    static void SaveWorldFile(int x, int z, int count, int &uid, QStringList &shapes);
+};
+
+#endif	/* SYNTHETICROUTE_H */
@@ -10,6 +10,10 @@
 
 #include "TDB.h"
 #include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QDataStream>
+#include <QCryptographicHash>
 #include <functional>
 #include "Game.h"
 #include "ParserX.h"
@@ -32,7 +36,9 @@
 #include "ErrorMessage.h"
 #include "Route.h"
 
-std::unordered_map<int, TRitem*>* TDB::StaticTrackItems;
+TDBTable<TRitem>* TDB::StaticTrackItems;
+const quint32 TDB::BinaryMagic = 0x54444253;
+const quint32 TDB::BinaryVersion = 1;
 
 TDB::TDB(TSectionDAT* tsection, bool road) {
     loaded = false;
@@ -64,30 +70,39 @@ void TDB::loadTdb(){
     if(this->road) extension = "rdb";
     QString path = Game::root + "/routes/" + Game::route + "/" + Game::routeName + "." + extension;
     path.replace("//", "/");
-    if(Game::debugOutput) qDebug() << "Loading TDB File: " << path;
-    QFile file(path);
-    if (!file.open(QIODevice::ReadOnly))
-        return;
-    FileBuffer* data = ReadFile::read(&file);
-    file.close();
-    data->toUtf16();
-    data->skipBOM();
-    ParserX::NextLine(data);
-    iTRnodes = 0;
-  
+    
     // EFO Adds
     lwireLineHeight = Game::wireLineHeight;
     lsectionLineHeight = Game::sectionLineHeight;
     if(Game::debugOutput) qDebug() << "Line Heights set" << lsectionLineHeight << " " << lwireLineHeight;
-    while (!((sh = ParserX::NextTokenInside(data).toLower()) == "")) {
-        if (sh == "trackdb") {
-            loadUtf16Data(data);
+    
+    bool binary = Game::tdbBinaryCache && loadBinary();
+    if(!binary){
+        if(Game::debugOutput) qDebug() << "Loading TDB File: " << path;
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly))
+            return;
+        FileBuffer* data = ReadFile::read(&file);
+        file.close();
+        data->toUtf16();
+        data->skipBOM();
+        ParserX::NextLine(data);
+        iTRnodes = 0;
+
+        while (!((sh = ParserX::NextTokenInside(data).toLower()) == "")) {
+            if (sh == "trackdb") {
+                loadUtf16Data(data);
+                ParserX::SkipToken(data);
+                continue;
+
+            }
+            if(Game::debugOutput) qDebug() << "#TDB undefined token " << sh;
             ParserX::SkipToken(data);
-            continue;
-            
         }
-        if(Game::debugOutput) qDebug() << "#TDB undefined token " << sh;
-        ParserX::SkipToken(data);
+        if(!this->road)
+            loadTit();
+        // snapshot of the files as they are, fixes below run on every load
+        saveBinary();
     }
     
     if(tsection->updateSectionDataRequired){
@@ -102,7 +117,6 @@ void TDB::loadTdb(){
         }
     }*/
     if(!this->road){      
-        loadTit();       
         checkTrSignalRDirs();     
         this->speedPostDAT = new SpeedPostDAT(); 
         this->sigCfg = new SigCfg(); 
@@ -143,7 +157,7 @@ void TDB::loadUtf16Data(FileBuffer *data){
                                             uu = (int) ParserX::GetNumberInside(data, &ok);
                                             if(ok){
                                                 trackNodes[t]->iTrv = uu;
-                                                trackNodes[t]->trVectorSection = new TRnode::TRSect[uu]; // przydzielenie pamieci dla sciezki
+                                                trackNodes[t]->trVectorSection = TRnode::NewSections(uu); // przydzielenie pamieci dla sciezki
                                                 for (j = 0; j < uu; j++) {
                                                     for (ii = 0; ii < 16; ii++) {
                                                         xx = ParserX::GetNumber(data);
@@ -258,36 +272,44 @@ void TDB::loadUtf16Data(FileBuffer *data){
 }
 
 void TDB::updateUiDs(QVector<int*> &trackObjUpdates, int startNode){
+        // old x, z, UiD -> update, so every node is visited only once
+        QHash<qint64, int*> updates;
+        for(int j = 0; j < trackObjUpdates.size(); j++)
+            updates[UiDKey(trackObjUpdates[j][0], trackObjUpdates[j][1], trackObjUpdates[j][2])] = trackObjUpdates[j];
+        if(updates.size() == 0)
+            return;
+        
+        int *u;
         for(int i = startNode; i <= iTRnodes; i++){
             TRnode *n = trackNodes[i];
             if(n == NULL)
                 continue;
             
-            for(int j = 0; j < trackObjUpdates.size(); j++){
-                if(n->typ == 2){
-                    if(n->UiD[0] == trackObjUpdates[j][0]) 
-                        if(n->UiD[1] == -trackObjUpdates[j][1])
-                            if(n->UiD[2] == trackObjUpdates[j][2]){
-                                n->UiD[0] = trackObjUpdates[j][3];
-                                n->UiD[1] = -trackObjUpdates[j][4];
-                                n->UiD[2] = trackObjUpdates[j][5];
-                    }
+            if(n->typ == 2){
+                u = updates.value(UiDKey((int)n->UiD[0], -(int)n->UiD[1], (int)n->UiD[2]), NULL);
+                if(u != NULL){
+                    n->UiD[0] = u[3];
+                    n->UiD[1] = -u[4];
+                    n->UiD[2] = u[5];
                 }
-                if(n->typ == 1){
-                    for(int jj = 0; jj < n->iTrv; jj++){
-                        if(n->trVectorSection[jj].param[2] == trackObjUpdates[j][0])
-                            if(n->trVectorSection[jj].param[3] == -trackObjUpdates[j][1])
-                                if(n->trVectorSection[jj].param[4] == trackObjUpdates[j][2]){
-                                    n->trVectorSection[jj].param[2] = trackObjUpdates[j][3];
-                                    n->trVectorSection[jj].param[3] = -trackObjUpdates[j][4];
-                                    n->trVectorSection[jj].param[4] = trackObjUpdates[j][5];
-                        }
+            }
+            if(n->typ == 1){
+                for(int jj = 0; jj < n->iTrv; jj++){
+                    u = updates.value(UiDKey((int)n->trVectorSection[jj].param[2], -(int)n->trVectorSection[jj].param[3], (int)n->trVectorSection[jj].param[4]), NULL);
+                    if(u != NULL){
+                        n->trVectorSection[jj].param[2] = u[3];
+                        n->trVectorSection[jj].param[3] = -u[4];
+                        n->trVectorSection[jj].param[4] = u[5];
                     }
                 }
             }
         }
 }
 
+qint64 TDB::UiDKey(int x, int z, int uid){
+    return ((qint64)(x & 0xFFFF) << 48) | ((qint64)(z & 0xFFFF) << 32) | (quint32)uid;
+}
+
 void TDB::updateSectionAndShapeIds(QHash<unsigned int,unsigned int>& fixedSectionIds, QHash<unsigned int,unsigned int>& fixedShapeIds){
         for(int i = 1; i <= iTRnodes; i++){
             TRnode *n = trackNodes[i];
@@ -361,7 +383,218 @@ void TDB::loadTit(){
     return;
 }
 
-void TDB::mergeTDB(TDB *secondTDB, float offsetXYZ[3], unsigned int& trackNodeOffset, unsigned int& trackItemOffset, QHash<unsigned int,unsigned int>& fixedSectionIds, QHash<unsigned int,unsigned int>& fixedShapeIds){
+QString TDB::routeFilePath(QString extension){
+    QString path = Game::root + "/routes/" + Game::route + "/" + Game::routeName + "." + extension;
+    path.replace("//", "/");
+    return path;
+}
+
+// The binary snapshot lives in the route cache folder and is only used
+// while the text files it was made from are unchanged.
+QString TDB::binaryPath(){
+    QString path = Game::root + "/routes/" + Game::route + "/cache/" + Game::routeName + (road ? ".rdb.bin" : ".tdb.bin");
+    path.replace("//", "/");
+    return path;
+}
+
+void TDB::WriteFileStamp(QDataStream &out, QString path){
+    QFileInfo info(path);
+    if(!info.exists()){
+        out << (qint64)-1 << (qint64)-1 << QByteArray();
+        return;
+    }
+    QByteArray hash;
+    QFile file(path);
+    if(file.open(QIODevice::ReadOnly))
+        hash = QCryptographicHash::hash(file.readAll(), QCryptographicHash::Md5);
+    out << (qint64)info.size() << (qint64)info.lastModified().toMSecsSinceEpoch() << hash;
+}
+
+bool TDB::CheckFileStamp(QDataStream &in, QString path){
+    qint64 size, time;
+    QByteArray hash;
+    in >> size >> time >> hash;
+    if(in.status() != QDataStream::Ok)
+        return false;
+    QFileInfo info(path);
+    if(!info.exists())
+        return size == -1;
+    if(info.size() != size)
+        return false;
+    if(info.lastModified().toMSecsSinceEpoch() == time)
+        return true;
+    // touched or copied, the content decides
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly))
+        return false;
+    return QCryptographicHash::hash(file.readAll(), QCryptographicHash::Md5) == hash;
+}
+
+void TDB::saveBinary(){
+    if(!Game::writeEnabled) return;
+    if(!Game::tdbBinaryCache) return;
+    QString path = binaryPath();
+    QDir().mkpath(QFileInfo(path).path());
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly)){
+        if(Game::debugOutput) qDebug() << "TDB binary: failed to write" << path;
+        return;
+    }
+    QDataStream out(&file);
+    out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    out << BinaryMagic << BinaryVersion << (qint32)QSysInfo::ByteOrder << road;
+    WriteFileStamp(out, routeFilePath(road ? "rdb" : "tdb"));
+    WriteFileStamp(out, routeFilePath(road ? "rit" : "tit"));
+    out << (qint32)serial << (qint32)iTRnodes << (qint32)iTRitems;
+
+    // node headers, then sections and item refs of all nodes as one block each
+    QVector<TRnode*> nodes;
+    qint32 sections = 0;
+    qint32 refs = 0;
+    for(auto it = trackNodes.begin(); it != trackNodes.end(); ++it){
+        TRnode *n = it->second;
+        if(n == NULL) continue;
+        nodes.push_back(n);
+        out << (qint32)it->first << (qint32)n->typ << (qint32)n->args[0] << (qint32)n->args[1] << (qint32)n->args[2];
+        out.writeRawData((const char*)n->UiD, sizeof(float[12]));
+        out << (qint32)n->TrP1 << (qint32)n->TrP2;
+        out.writeRawData((const char*)n->TrPinS, sizeof(int[3]));
+        out.writeRawData((const char*)n->TrPinK, sizeof(int[3]));
+        out << (qint32)n->iTrv << (qint32)n->iTri;
+        sections += n->iTrv;
+        refs += n->iTri;
+    }
+    out << (qint32)-1 << sections << refs;
+    for(int i = 0; i < nodes.size(); i++)
+        if(nodes[i]->iTrv > 0)
+            out.writeRawData((const char*)nodes[i]->trVectorSection, sizeof(TRnode::TRSect)*nodes[i]->iTrv);
+    for(int i = 0; i < nodes.size(); i++)
+        if(nodes[i]->iTri > 0)
+            out.writeRawData((const char*)nodes[i]->trItemRef, sizeof(int)*nodes[i]->iTri);
+
+    for(auto it = trackItems.begin(); it != trackItems.end(); ++it){
+        if(it->second == NULL) continue;
+        out << (qint32)it->first;
+        it->second->saveBinary(out);
+    }
+    out << (qint32)-1;
+    file.close();
+    if(out.status() != QDataStream::Ok)
+        QFile::remove(path);
+}
+
+bool TDB::loadBinary(){
+    QFile file(binaryPath());
+    if(!file.open(QIODevice::ReadOnly))
+        return false;
+    QDataStream in(&file);
+    in.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    quint32 magic, version;
+    qint32 byteOrder;
+    bool isRoad;
+    in >> magic >> version >> byteOrder >> isRoad;
+    if(magic != BinaryMagic || version != BinaryVersion || byteOrder != (qint32)QSysInfo::ByteOrder || isRoad != road)
+        return false;
+    if(!CheckFileStamp(in, routeFilePath(road ? "rdb" : "tdb")))
+        return false;
+    if(!CheckFileStamp(in, routeFilePath(road ? "rit" : "tit")))
+        return false;
+    
+    qint32 bSerial, bNodes, bItems;
+    in >> bSerial >> bNodes >> bItems;
+    
+    // nothing is replaced until the whole file is read
+    TDBTable<TRnode> nodes;
+    TDBTable<TRitem> items;
+    QVector<TRnode*> order;
+    qint32 id, val[5];
+    bool ok = true;
+    while(ok){
+        in >> id;
+        if(id < 0 || in.status() != QDataStream::Ok)
+            break;
+        TRnode *n = new TRnode();
+        nodes[id] = n;
+        order.push_back(n);
+        in >> val[0] >> val[1] >> val[2] >> val[3];
+        n->typ = val[0];
+        n->args[0] = val[1];
+        n->args[1] = val[2];
+        n->args[2] = val[3];
+        ok &= in.readRawData((char*)n->UiD, sizeof(float[12])) == sizeof(float[12]);
+        in >> val[0] >> val[1];
+        n->TrP1 = val[0];
+        n->TrP2 = val[1];
+        ok &= in.readRawData((char*)n->TrPinS, sizeof(int[3])) == sizeof(int[3]);
+        ok &= in.readRawData((char*)n->TrPinK, sizeof(int[3])) == sizeof(int[3]);
+        in >> val[0] >> val[1];
+        n->iTrv = val[0];
+        n->iTri = val[1];
+    }
+    qint32 sections = 0, refs = 0;
+    in >> sections >> refs;
+    ok &= in.status() == QDataStream::Ok && sections >= 0 && refs >= 0;
+    
+    int s = 0, r = 0;
+    for(int i = 0; ok && i < order.size(); i++){
+        ok &= order[i]->iTrv >= 0 && order[i]->iTri >= 0;
+        s += order[i]->iTrv;
+        r += order[i]->iTri;
+    }
+    ok &= s == sections && r == refs;
+    
+    if(ok){
+        // sections go straight into one span of the section pool
+        TRnode::TRSect *sectionData = TRnode::NewSections(sections);
+        QVector<int> refData(refs);
+        ok &= in.readRawData((char*)sectionData, sizeof(TRnode::TRSect)*sections) == (int)sizeof(TRnode::TRSect)*sections;
+        ok &= in.readRawData((char*)refData.data(), sizeof(int)*refs) == (int)sizeof(int)*refs;
+        s = 0;
+        r = 0;
+        for(int i = 0; i < order.size(); i++){
+            TRnode *n = order[i];
+            if(n->iTrv > 0){
+                n->trVectorSection = sectionData + s;
+                s += n->iTrv;
+            }
+            if(n->iTri > 0){
+                n->trItemRef = new int[n->iTri];
+                memcpy(n->trItemRef, refData.data() + r, sizeof(int)*n->iTri);
+                r += n->iTri;
+            }
+        }
+    }
+    
+    while(ok){
+        in >> id;
+        if(id < 0 || in.status() != QDataStream::Ok)
+            break;
+        TRitem *item = new TRitem();
+        items[id] = item;
+        item->loadBinary(in);
+    }
+    ok &= in.status() == QDataStream::Ok;
+    file.close();
+    
+    if(!ok){
+        if(Game::debugOutput) qDebug() << "TDB binary: broken snapshot" << binaryPath();
+        for(auto it = nodes.begin(); it != nodes.end(); ++it)
+            delete it->second;
+        for(auto it = items.begin(); it != items.end(); ++it)
+            delete it->second;
+        return false;
+    }
+    trackNodes = nodes;
+    trackItems = items;
+    serial = bSerial;
+    iTRnodes = bNodes;
+    iTRitems = bItems;
+    if(Game::debugOutput) qDebug() << "TDB binary: loaded" << binaryPath();
+    return true;
+}
+
+void TDB::mergeTDB(
+TDB *secondTDB, float offsetXYZ[3], unsigned int& trackNodeOffset, unsigned int& trackItemOffset, QHash<unsigned int,unsigned int>& fixedSectionIds, QHash<unsigned int,unsigned int>& fixedShapeIds){
     trackNodeOffset = this->iTRnodes;
     trackItemOffset = this->iTRitems;
     
@@ -645,14 +878,14 @@ int TDB::appendTrack(int id, int* ends, int r, int sect, int uid) {
 
         if(Game::debugOutput) qDebug() << "TDB646: " << kierunek;
         n->iTrv++;
-        TRnode::TRSect *newV = new TRnode::TRSect[n->iTrv];
+        TRnode::TRSect *newV = TRnode::NewSections(n->iTrv);
 
         if (kierunek == 1) {
             std::copy(n->trVectorSection, n->trVectorSection + n->iTrv - 1, newV + 1);
         } else {
             std::copy(n->trVectorSection, n->trVectorSection + n->iTrv - 1, newV);
         }
-        delete n->trVectorSection;
+        TRnode::FreeSections(n->trVectorSection, n->iTrv - 1);
         n->trVectorSection = newV;
         //qDebug() <<"sect"<< sect;
         float dlugosc = this->tsection->sekcja[sect]->getDlugosc();
@@ -775,7 +1008,7 @@ int TDB::newTrack(int x, int z, float* p, float* qe, int* ends, int r, int sect,
     if(Game::debugOutput) qDebug() << "TDB775: New VectorID " << vecId;
     newNode->typ = 1;
     newNode->iTrv = 1;
-    newNode->trVectorSection = new TRnode::TRSect[newNode->iTrv];
+    newNode->trVectorSection = TRnode::NewSections(newNode->iTrv);
     newNode->trVectorSection[0].param[0] = sect;
     newNode->trVectorSection[0].param[1] = r;
     newNode->trVectorSection[0].param[2] = x;
@@ -990,14 +1223,15 @@ int TDB::joinVectorSections(int id1, int id2) {
     }
     moveItemsFrom2to1(id2, id1);
     
-    TRnode::TRSect *newV = new TRnode::TRSect[section1->iTrv + section2->iTrv];
+    TRnode::TRSect *newV = TRnode::NewSections(section1->iTrv + section2->iTrv);
 
     std::copy(section1->trVectorSection, section1->trVectorSection + section1->iTrv, newV);
     std::copy(section2->trVectorSection, section2->trVectorSection + section2->iTrv, newV + section1->iTrv);
+    TRnode::FreeSections(section1->trVectorSection, section1->iTrv);
+    TRnode::FreeSections(section2->trVectorSection, section2->iTrv);
     section1->iTrv = section1->iTrv + section2->iTrv;
-    
-    delete section1->trVectorSection;
-    delete section2->trVectorSection;
+    section2->trVectorSection = NULL;
+    section2->iTrv = 0;
     
     
     section1->trVectorSection = newV;
@@ -1125,7 +1359,7 @@ int TDB::splitVectorSection(int id, int j){
         newNode->trItemRef = newItems;
     }
     
-    TRnode::TRSect *newV = new TRnode::TRSect[newNode->iTrv];
+    TRnode::TRSect *newV = TRnode::NewSections(newNode->iTrv);
     std::copy(vect->trVectorSection + j, vect->trVectorSection + vect->iTrv, newV);
     newNode->trVectorSection = newV;
     
@@ -1136,9 +1370,10 @@ int TDB::splitVectorSection(int id, int j){
     newNode->TrPinS[1] = vect->TrPinS[1];
     newNode->TrPinK[1] = vect->TrPinK[1];
     
-    newV = new TRnode::TRSect[j];
+    newV = TRnode::NewSections(j);
     std::copy(vect->trVectorSection, vect->trVectorSection + j, newV);
     
+    int oldTrv = vect->iTrv;
     vect->iTrv = j;
     vect->TrPinS[1] = end1Id;
     vect->TrPinK[1] = 1;
@@ -1185,7 +1420,7 @@ int TDB::splitVectorSection(int id, int j){
     newNode->TrPinS[0] = vecId;
     newNode->TrPinK[0] = 1;
     
-    delete vect->trVectorSection;
+    TRnode::FreeSections(vect->trVectorSection, oldTrv);
     vect->trVectorSection = newV;
     
     updateTrNode(id);
@@ -1324,7 +1559,7 @@ bool TDB::deleteFromVectorSection(int id, int j){
     TRnode* end1 = trackNodes[vect->TrPinS[0]];
     TRnode* end2 = trackNodes[vect->TrPinS[1]];
     //deleteAllTrItemsFromVectorSection(id);
-    TRnode::TRSect *newV = new TRnode::TRSect[vect->iTrv - 1];
+    TRnode::TRSect *newV = TRnode::NewSections(vect->iTrv - 1);
     if(j == 0){
         // move & check items
         if(vect->iTri > 0){
@@ -1429,8 +1664,8 @@ bool TDB::deleteFromVectorSection(int id, int j){
             updateTrNode(endNId2);
     }
     
+    TRnode::FreeSections(vect->trVectorSection, vect->iTrv);
     vect->iTrv -= 1;
-    delete vect->trVectorSection;
     vect->trVectorSection = newV;
     updateTrNode(id);
     if(vid >= 0)
@@ -1923,6 +2158,22 @@ bool TDB::ifTrackExist(int x, int y, int UiD){
     return false;
 }
 
+int TDB::findVectorNodeByUiD(int x, int y, int UiD){
+    y = -y;
+    TRnode *n;
+    for (int i = 1; i <= iTRnodes; i++) {
+        n = trackNodes[i];
+        if (n == NULL) continue;
+        if (n->typ != 1) continue;
+        for(int j = 0; j < n->iTrv; j++)
+            if(n->trVectorSection[j].param[2] == x)
+                if(n->trVectorSection[j].param[3] == y)
+                    if(n->trVectorSection[j].param[4] == UiD)
+                        return i;
+    }
+    return -1;
+}
+
 int TDB::getNextItrNode(){
     return ++this->iTRnodes;
 }
@@ -3366,39 +3617,40 @@ void TDB::addToDeletedTree(int* drzewo, int d){
     }
 
 bool TDB::deleteNulls() {
-    int counter = 0;
-        
-        for(int i = 1; i <= iTRnodes; i++){            
-            if(trackNodes[i] == NULL){
-                qDebug() << "Removing NULL TrackNode "<<i;
-                int stare = findBiggest();
-                if(stare <= i) {
-                    qDebug() << "Nodes counter: " << counter;
-                    qDebug() << "There is no more NULL TrackNodes.";
-                    iTRnodes = stare;
-                    return false;
-                }
-                qDebug() << "TrackNode " << stare << " moved to TrackNode " << i;
-                trackNodes[i] = trackNodes[stare];
-                trackNodes[stare] = NULL;
-                
-                for(int j = 0; j < 3; j++){
-                    if(trackNodes[i]->TrPinS[j] == 0) 
-                        continue;
-                    if(trackNodes[trackNodes[i]->TrPinS[j]] == NULL)
-                        qDebug() << "Fail, unexpected NULL TrackNode found!" << trackNodes[i]->TrPinS[j];
-                    else
-                        trackNodes[trackNodes[i]->TrPinS[j]]->podmienTrPin(stare, i);
-                }
-                replaceSignalDirJunctionId(stare, i);
-                return true;
-            }
-            counter++;
-        }
-        qDebug() << "Nodes counter: " << counter;
+    // all free ids are filled in one pass, the biggest node goes to the
+    // lowest free id, signal directions are renumbered once at the end
+    QVector<int> freeIds = trackNodes.freeIds(1, iTRnodes);
+    if(freeIds.size() == 0){
         qDebug() << "There is no more NULL TrackNodes.";
         return false;
     }
+    QHash<int, int> moved;
+    for(int k = 0; k < freeIds.size(); k++){
+        int i = freeIds[k];
+        int stare = findBiggest();
+        if(stare <= i)
+            break;
+        if(Game::debugOutput) qDebug() << "TrackNode " << stare << " moved to TrackNode " << i;
+        trackNodes[i] = trackNodes[stare];
+        trackNodes[stare] = NULL;
+        iTRnodes = stare;
+
+        for(int j = 0; j < 3; j++){
+            if(trackNodes[i]->TrPinS[j] == 0) 
+                continue;
+            if(trackNodes[trackNodes[i]->TrPinS[j]] == NULL)
+                qDebug() << "Fail, unexpected NULL TrackNode found!" << trackNodes[i]->TrPinS[j];
+            else
+                trackNodes[trackNodes[i]->TrPinS[j]]->podmienTrPin(stare, i);
+        }
+        moved[stare] = i;
+    }
+    iTRnodes = findBiggest();
+    replaceSignalDirJunctionIds(moved);
+    qDebug() << "Moved TrackNodes: " << moved.size();
+    qDebug() << "There is no more NULL TrackNodes.";
+    return false;
+}
 
 void TDB::sortItemRefs(){
     StaticTrackItems = &trackItems;
@@ -3417,14 +3669,17 @@ bool TDB::SortItemRefsCompare(int a, int b){
     return TDB::StaticTrackItems[0][a]->getTrackPosition() < TDB::StaticTrackItems[0][b]->getTrackPosition();
 }
 
-void TDB::replaceSignalDirJunctionId(int oldId, int newId){
+void TDB::replaceSignalDirJunctionIds(QHash<int, int> &ids){
+    if(ids.size() == 0)
+        return;
     for (int i = 0; i <= this->iTRitems; i++) {
         if(trackItems[i] == NULL) continue;
         if(trackItems[i]->trSignalDir != NULL){
             for(int j = 0; j < trackItems[i]->trSignalDirs*4; j+=4){
-                if(trackItems[i]->trSignalDir[j+0] == oldId){
+                int newId = ids.value(trackItems[i]->trSignalDir[j+0], -1);
+                if(newId >= 0){
+                    if(Game::debugOutput) qDebug() << "trSignalDir trndoe id replaced: "<<trackItems[i]->trSignalDir[j+0]<<" "<<newId;
                     trackItems[i]->trSignalDir[j+0] = newId;
-                    if(Game::debugOutput) qDebug() << "trSignalDir trndoe id replaced: "<<oldId<<" "<<newId;
                 }
             }
         }
@@ -3505,6 +3760,7 @@ void TDB::save() {
     file.close();
     qDebug() << "TDB Complete";
     saveTit();
+    saveBinary();
     if(!this->road) 
         this->tsection->saveRoute();
     qDebug() << "Route Saved";
@@ -3770,6 +4026,14 @@ void TDB::checkSignals(){
         }
     }
     if(Game::debugOutput) qDebug() << "suma: "<<trtype[0]<<" "<<trtype[1]<<" "<<trtype[2]<<" "<<trtype[3];
+    if(trtype[3] > 0){
+        ErrorMessage *e = new ErrorMessage(
+                ErrorMessage::Type_Warning, 
+                tdbName, 
+                QString("Signal directions pointing to missing trackNodes: ") + QString::number(trtype[3]),
+                "Signals may not work in game. Check signal links.");
+        ErrorMessagesLib::PushErrorMessage(e);
+    }
 }
 
 TDB::TDB(const TDB& o) {
@@ -3795,6 +4059,8 @@ TDB::TDB(const TDB& o) {
     // EFO Adds
     lwireLineHeight = o.lwireLineHeight;
     road = o.road;
+    tdbId = o.tdbId;
+    tdbName = o.tdbName;
     
     for (auto it = o.trackItems.begin(); it != o.trackItems.end(); ++it ){
         if(it->second == NULL)
@@ -3856,17 +4122,31 @@ void TDB::getUsedTileList(QMap<int, QPair<int, int>*> &tileList, int radius, int
 }
 
 void TDB::checkDatabase(){
-    // Variables
     QHash<int, QVector<WorldObj*>> objects;
 
-    float *drawPosition = new float[7];
-    bool isPosition = false;
-
     // Build WorldFile data
     if(Game::loadAllWFiles){
         Game::currentRoute->fillWorldObjectsByTrackItemIds(objects, tdbId);
     }
-        
+    checkDatabase(objects, Game::autoFix);
+}
+
+// Only reads W file data through objects, so it can run on a copy of the
+// TDB off the GUI thread when autoFix is false.
+void TDB::checkDatabase(QHash<int, QVector<WorldObj*>> &objects, bool autoFix){
+    float *drawPosition = new float[7];
+    bool isPosition = false;
+
+    // nodes of every item, instead of a scan of all nodes per item
+    QHash<int, QVector<int>> itemNodes;
+    for (int j = 1; j <= iTRnodes; j++) {
+        TRnode* n = trackNodes[j];
+        if (n == NULL) continue;
+        if (n->typ != 1) continue;
+        for (int i = 0; i < n->iTri; i++)
+            itemNodes[n->trItemRef[i]].push_back(j);
+    }
+
 
     for (int i = 0; i < this->iTRitems; i++) {
         if(trackItems[i] == NULL) 
@@ -3875,8 +4155,8 @@ void TDB::checkDatabase(){
         isPosition = false;
         
         if (trackItems[i]->type != "emptyitem"){
-            QVector<int> ids;
-            int id = findTrItemNodeIds(i, ids);
+            QVector<int> ids = itemNodes.value(i);
+            int id = ids.size() > 0 ? ids[0] : -1;
             if (ids.size() == 0) {
                 ErrorMessage *e = new ErrorMessage(
                         ErrorMessage::Type_Error, 
@@ -3885,7 +4165,7 @@ void TDB::checkDatabase(){
                         "Interactive item is not placed on any track. Should it be removed?");
                 e->setObject((GameObj*)trackItems[i]);
                 ErrorMessagesLib::PushErrorMessage(e);
-                if(Game::autoFix){
+                if(autoFix){
                     e->type = ErrorMessage::Type_AutoFix;
                     e->action += "\nAutoFix: Item removed by TSRE.";
                     this->deleteTrItem(i);
@@ -3898,7 +4178,7 @@ void TDB::checkDatabase(){
                         "Interactive item is placed on more than one track.\nMay cause fatal errors and Open Rails crash. ");
                 e->setObject((GameObj*)trackItems[i]);
                 ErrorMessagesLib::PushErrorMessage(e);
-                if(Game::autoFix){
+                if(autoFix){
                     e->type = ErrorMessage::Type_AutoFix;
                     e->action += "\nAutoFix: Item removed by TSRE.";
                     this->deleteTrItem(i);
@@ -3915,7 +4195,7 @@ void TDB::checkDatabase(){
                             "Item is placed on a track but at incorrect position. Should it be removed?");
                     e->setObject((GameObj*)trackItems[i]);
                     ErrorMessagesLib::PushErrorMessage(e);
-                    if(Game::autoFix){
+                    if(autoFix){
                         e->type = ErrorMessage::Type_AutoFix;
                         e->action += "\nAutoFix: Item removed by TSRE.";
                         this->deleteTrItem(i);
@@ -3938,7 +4218,7 @@ void TDB::checkDatabase(){
                     if(isPosition)
                         e->setLocationXYZ(drawPosition[5], drawPosition[6], drawPosition[0], drawPosition[1], drawPosition[2]);
                     ErrorMessagesLib::PushErrorMessage(e);
-                    if(Game::autoFix){
+                    if(autoFix){
                         e->type = ErrorMessage::Type_AutoFix;
                         e->action += "\nAutoFix: Broken Signal Link removed by TSRE.";
                         trackItems[i]->trSignalDirs = 0;
@@ -3957,7 +4237,7 @@ void TDB::checkDatabase(){
                     if(isPosition)
                         e->setLocationXYZ(drawPosition[5], drawPosition[6], drawPosition[0], drawPosition[1], drawPosition[2]);
                     ErrorMessagesLib::PushErrorMessage(e);
-                    if(Game::autoFix){
+                    if(autoFix){
                         e->type = ErrorMessage::Type_AutoFix;
                         e->action += "\nAutoFix: Broken Signal Link removed by TSRE.";
                         trackItems[i]->trSignalDirs = 0;
@@ -3980,7 +4260,7 @@ void TDB::checkDatabase(){
                     if(isPosition)
                         e->setLocationXYZ(drawPosition[5], drawPosition[6], drawPosition[0], drawPosition[1], drawPosition[2]);
                     ErrorMessagesLib::PushErrorMessage(e);
-                    if(Game::autoFix){
+                    if(autoFix){
                         e->type = ErrorMessage::Type_AutoFix;
                         e->action += "\nAutoFix: Item removed by TSRE.";
                         this->deleteTrItem(i);
@@ -3997,7 +4277,7 @@ void TDB::checkDatabase(){
                         if(isPosition)
                             e->setLocationXYZ(drawPosition[5], drawPosition[6], drawPosition[0], drawPosition[1], drawPosition[2]);
                         ErrorMessagesLib::PushErrorMessage(e);
-                    if(Game::autoFix){
+                    if(autoFix){
                         e->type = ErrorMessage::Type_AutoFix;
                         e->action += "\nAutoFix: Item removed by TSRE.";
                         this->deleteTrItem(i);
@@ -4014,7 +4294,7 @@ void TDB::checkDatabase(){
                         if(isPosition)
                             e->setLocationXYZ(drawPosition[5], drawPosition[6], drawPosition[0], drawPosition[1], drawPosition[2]);
                         ErrorMessagesLib::PushErrorMessage(e);
-                    if(Game::autoFix){
+                    if(autoFix){
                         e->type = ErrorMessage::Type_AutoFix;
                         e->action += "\nAutoFix: Item removed by TSRE.";
                         this->deleteTrItem(i);
@@ -4039,7 +4319,7 @@ void TDB::checkDatabase(){
                     if(isPosition)
                         e->setLocationXYZ(drawPosition[5], drawPosition[6], drawPosition[0], drawPosition[1], drawPosition[2]);
                     ErrorMessagesLib::PushErrorMessage(e);
-                    if(Game::autoFix){
+                    if(autoFix){
                         e->type = ErrorMessage::Type_AutoFix;
                         e->action += "\nAutoFix: Item removed by TSRE.";
                         this->deleteTrItem(i);
@@ -4060,7 +4340,7 @@ void TDB::checkDatabase(){
                     if(isPosition)
                         e->setLocationXYZ(drawPosition[5], drawPosition[6], drawPosition[0], drawPosition[1], drawPosition[2]);
                     ErrorMessagesLib::PushErrorMessage(e);
-                    if(Game::autoFix){
+                    if(autoFix){
                         e->type = ErrorMessage::Type_AutoFix;
                         e->action += "\nAutoFix: Item removed by TSRE.";
                         this->deleteTrItem(i);
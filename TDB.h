@@ -22,6 +22,7 @@
 #include "SignalObj.h"
 #include "Vector4f.h"
 #include "ErrorMessage.h"
+#include "TDBTable.h"
 
 class TRnode;
 class TRitem;
@@ -32,6 +33,7 @@ class Ref;
 class GLUU;
 class FileBuffer;
 class SpeedPostDAT;
+class QDataStream;
 
 class TDB {
 public:
@@ -50,8 +52,8 @@ public:
     SigCfg* sigCfg;
     SpeedPostDAT* speedPostDAT;
     //TRnode *trackNodes;
-    std::unordered_map<int, TRitem*> trackItems;
-    std::unordered_map<int, TRnode*> trackNodes;
+    TDBTable<TRitem> trackItems;
+    TDBTable<TRnode> trackNodes;
     //std::vector<TRnode> trackNodes;
     int iTRnodes = 0;
     int iTRitems = 0;
@@ -75,15 +77,21 @@ public:
     void loadTdb();
     void loadUtf16Data(FileBuffer *data);
     void loadTit();
+    void saveBinary();
+    bool loadBinary();
     void updateUiDs(QVector<int*> &trackObjUpdates, int startNode);
+    static qint64 UiDKey(int x, int z, int uid);
     void updateSectionAndShapeIds( QHash<unsigned int,unsigned int>& fixedSectionIds, QHash<unsigned int,unsigned int>& fixedShapeIds );
     void mergeTDB(TDB *secondTDB, float offsetXYZ[3], unsigned int &trackNodeOffset, unsigned int &trackItemOffset, QHash<unsigned int,unsigned int>& fixedSectionIds, QHash<unsigned int,unsigned int>& fixedShapeIds);
     void checkTrSignalRDirs();
+    void checkSignals();
     void checkDatabase();
+    void checkDatabase(QHash<int, QVector<WorldObj*>> &objects, bool autoFix);
     virtual int getNewTRitemId();
     static void saveEmpty(bool road);
     void fillTrackAngles(int x, int z, int UiD, QMap<int, float>& angles);
     bool ifTrackExist(int x, int y, int UiD);
+    int findVectorNodeByUiD(int x, int y, int UiD);
     bool removeTrackFromTDB(int x, int y, int UiD);
     int findNearestNode(int &x, int &z, float* p, float* q, float maxD = 4, bool updatePosition = true);
     int findVectorNodeBetweenTwoNodes(int first, int second);
@@ -152,11 +160,10 @@ protected:
     int findBiggest();
     void addToDeletedTree(int* drzewo, int d);
     int getLineBufferSize(int idx, int pointSize, int offset, int step = 0);
-    void checkSignals();
     void drawLine(GLUU *gluu, float* &ptr, Vector3f p, Vector3f o, int idx);
     void getLine(float* &ptr, Vector3f p, Vector3f o, int idx, int id, int vid, float offset = 0, int step = 0);
     void addItemToTrNode(int tid, int iid);
-    void replaceSignalDirJunctionId(int oldId, int newId);
+    void replaceSignalDirJunctionIds(QHash<int, int> &ids);
     void deleteItemFromTrNode(int tid, int iid);
     OglObj linieSieci;
     OglObj konceSieci;
@@ -184,8 +191,14 @@ protected:
     std::unordered_map<int, TextObj*> endIdObj;
     std::unordered_map<int, TextObj*> junctIdObj;
     
+    QString routeFilePath(QString extension);
+    QString binaryPath();
+    static const quint32 BinaryMagic;
+    static const quint32 BinaryVersion;
+    static void WriteFileStamp(QDataStream &out, QString path);
+    static bool CheckFileStamp(QDataStream &in, QString path);
     static bool SortItemRefsCompare(int a, int b);
-    static std::unordered_map<int, TRitem*>* StaticTrackItems;
+    static TDBTable<TRitem>* StaticTrackItems;
 };
 
 #endif	/* TDB_H */
@@ -0,0 +1,111 @@
+/*  This file is part of TSRE5.
+ *
+ *  TSRE5 - train sim game engine and MSTS/OR Editors. 
+ *  Copyright (C) 2016 Piotr Gadecki <pgadecki@gmail.com>
+ *
+ *  Licensed under GNU General Public License 3.0 or later. 
+ *
+ *  See LICENSE.md or https://www.gnu.org/licenses/gpl.html
+ */
+
+#ifndef TDBTABLE_H
+#define	TDBTABLE_H
+
+#include <deque>
+#include <QVector>
+
+// Track nodes and items by id. Ids are dense from 0 up, so slots are kept
+// in id order instead of a hash map. Reading past the end adds NULL slots
+// like the map did; a deque keeps references to slots valid while it grows,
+// so trackNodes[a] = trackNodes[b] is safe for any a and b.
+template<class T>
+class TDBTable {
+public:
+    struct Entry {
+        int first;
+        T* second;
+    };
+
+    // visits slots that are not NULL, in id order
+    class iterator {
+    public:
+        iterator(const std::deque<T*>* slots, int id) : slots(slots) {
+            e.first = id;
+            skipNulls();
+        }
+        Entry* operator->() {
+            e.second = (*slots)[e.first];
+            return &e;
+        }
+        Entry& operator*() {
+            e.second = (*slots)[e.first];
+            return e;
+        }
+        iterator& operator++() {
+            e.first++;
+            skipNulls();
+            return *this;
+        }
+        bool operator==(const iterator& o) const {
+            return e.first == o.e.first;
+        }
+        bool operator!=(const iterator& o) const {
+            return e.first != o.e.first;
+        }
+    private:
+        const std::deque<T*>* slots;
+        Entry e;
+        void skipNulls() {
+            while(e.first < (int)slots->size() && (*slots)[e.first] == NULL)
+                e.first++;
+        }
+    };
+
+    T*& operator[](int id) {
+        if(id < 0){
+            none = NULL;
+            return none;
+        }
+        if(id >= (int)slots.size())
+            slots.resize(id + 1, NULL);
+        return slots[id];
+    }
+
+    T* value(int id) const {
+        if(id < 0 || id >= (int)slots.size())
+            return NULL;
+        return slots[id];
+    }
+
+    // one past the biggest id
+    int size() const {
+        return slots.size();
+    }
+
+    void clear() {
+        slots.clear();
+    }
+
+    // ids of deleted entries between first and last, lowest first
+    QVector<int> freeIds(int first, int last) const {
+        QVector<int> ids;
+        for(int i = first; i <= last; i++)
+            if(value(i) == NULL)
+                ids.push_back(i);
+        return ids;
+    }
+
+    iterator begin() const {
+        return iterator(&slots, 0);
+    }
+
+    iterator end() const {
+        return iterator(&slots, slots.size());
+    }
+
+private:
+    std::deque<T*> slots;
+    T* none = NULL;
+};
+
+#endif	/* TDBTABLE_H */
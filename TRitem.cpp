@@ -20,11 +20,33 @@
 #include "SignalShape.h"
 #include <QString>
 #include <QDebug>
+#include <QDataStream>
 #include "TrackItemObj.h"
 #include "TRnode.h"
 
 TrackItemObj* TRitem::pointer3d = NULL;
 
+// optional arrays of the binary snapshot, -1 for NULL
+static void WriteArray(QDataStream &out, const void* data, int bytes){
+    if(data == NULL){
+        out << (qint32)-1;
+        return;
+    }
+    out << (qint32)bytes;
+    out.writeRawData((const char*)data, bytes);
+}
+
+template<typename T>
+static T* ReadArray(QDataStream &in){
+    qint32 bytes;
+    in >> bytes;
+    if(bytes < 0 || in.status() != QDataStream::Ok)
+        return NULL;
+    T* data = new T[bytes/sizeof(T)];
+    in.readRawData((char*)data, bytes);
+    return data;
+}
+
 TRitem* TRitem::newPlatformItem(int trItemId, float metry) {
     TRitem* trit = new TRitem(trItemId);
     if (!trit->init("platformitem")) return NULL;
@@ -903,6 +925,40 @@ void TRitem::save(QTextStream* out) {
     save(out, false);
 }
 
+void TRitem::saveBinary(QDataStream &out) {
+    out << type << tdbId << trItemId << trItemSData1 << trItemSData2;
+    WriteArray(out, trItemPData, sizeof(float[4]));
+    WriteArray(out, trItemRData, sizeof(float[5]));
+    WriteArray(out, crossoverTrItemData, sizeof(int[2]));
+    WriteArray(out, platformTrItemData, sizeof(unsigned int[2]));
+    out << platformName << stationName << platformMinWaitingTime << platformNumPassengersWaiting;
+    WriteArray(out, trItemSRData, sizeof(float[3]));
+    WriteArray(out, speedpostTrItemData, sizeof(float[4]));
+    out << speedpostTrItemDataLength;
+    out << trSignalType1 << trSignalType2 << trSignalType3 << trSignalType4;
+    out << trSignalDirs;
+    WriteArray(out, trSignalDir, sizeof(int)*trSignalDirs*4);
+    WriteArray(out, trSignalRDir, sizeof(float)*trSignalDirs*6);
+    out << pickupTrItemData1 << pickupTrItemData2;
+}
+
+void TRitem::loadBinary(QDataStream &in) {
+    in >> type >> tdbId >> trItemId >> trItemSData1 >> trItemSData2;
+    trItemPData = ReadArray<float>(in);
+    trItemRData = ReadArray<float>(in);
+    crossoverTrItemData = ReadArray<int>(in);
+    platformTrItemData = ReadArray<unsigned int>(in);
+    in >> platformName >> stationName >> platformMinWaitingTime >> platformNumPassengersWaiting;
+    trItemSRData = ReadArray<float>(in);
+    speedpostTrItemData = ReadArray<float>(in);
+    in >> speedpostTrItemDataLength;
+    in >> trSignalType1 >> trSignalType2 >> trSignalType3 >> trSignalType4;
+    in >> trSignalDirs;
+    trSignalDir = ReadArray<int>(in);
+    trSignalRDir = ReadArray<float>(in);
+    in >> pickupTrItemData1 >> pickupTrItemData2;
+}
+
 void TRitem::save(QTextStream* out, bool tit) {
 
     int l;
@@ -21,6 +21,7 @@
 
 class FileBuffer;
 class QTextStream;
+class QDataStream;
 class TDB;
 class TrackItemObj;
 
@@ -84,6 +85,8 @@ public:
     void set(QString sh, FileBuffer* data);
     void save(QTextStream* out);
     void save(QTextStream* out, bool tit);
+    void saveBinary(QDataStream &out);
+    void loadBinary(QDataStream &in);
     void addToTrackPos(float d);
     void flipTrackPos(float d);
     void setTrItemRData(float* posT, float*pos);
@@ -17,6 +17,42 @@
 #include "FileBuffer.h"
 #include "ParserX.h"
 
+QVector<TRnode::TRSect*> TRnode::SectionBlocks;
+int TRnode::SectionBlockUsed = 0;
+QHash<int, QVector<TRnode::TRSect*>> TRnode::FreeSectionSpans;
+
+// Vector sections of all nodes are cut from a few large blocks instead of
+// one heap array per node, so a scan over the TDB walks mostly contiguous
+// memory. Freed spans are kept by length and handed out again.
+TRnode::TRSect* TRnode::NewSections(int count){
+    if(count <= 0)
+        return NULL;
+    auto spans = FreeSectionSpans.find(count);
+    if(spans != FreeSectionSpans.end() && spans.value().size() > 0){
+        TRSect *s = spans.value().last();
+        spans.value().pop_back();
+        return s;
+    }
+    if(count > SectionBlockSize){
+        TRSect *s = new TRSect[count];
+        SectionBlocks.prepend(s);
+        return s;
+    }
+    if(SectionBlocks.size() == 0 || SectionBlockUsed + count > SectionBlockSize){
+        SectionBlocks.push_back(new TRSect[SectionBlockSize]);
+        SectionBlockUsed = 0;
+    }
+    TRSect *s = SectionBlocks.last() + SectionBlockUsed;
+    SectionBlockUsed += count;
+    return s;
+}
+
+void TRnode::FreeSections(TRSect* sections, int count){
+    if(sections == NULL || count <= 0)
+        return;
+    FreeSectionSpans[count].push_back(sections);
+}
+
 TRnode::TRnode() {
     typ = -1;
     TrP1 = 0;
@@ -34,7 +70,7 @@ TRnode::TRnode(const TRnode& o) {
     memcpy(UiD, o.UiD, sizeof(float[12]));
     iTrv = o.iTrv;
     if(iTrv > 0){
-        trVectorSection = new TRSect[iTrv];
+        trVectorSection = NewSections(iTrv);
         for(int i = 0; i < iTrv; i++){
             memcpy(trVectorSection[i].param, o.trVectorSection[i].param, sizeof(float[16]));
         }
@@ -51,8 +87,7 @@ TRnode::TRnode(const TRnode& o) {
 }
 
 TRnode::~TRnode() {
-    if(trVectorSection != NULL)
-        delete[] trVectorSection;
+    FreeSections(trVectorSection, iTrv);
         
     if(trItemRef != NULL)
         delete[] trItemRef;
@@ -77,7 +112,7 @@ void TRnode::loadUtf16Data(FileBuffer *data){
                                             int uu = (int) ParserX::GetNumberInside(data, &ok);
                                             if(ok){
                                                 iTrv = uu;
-                                                trVectorSection = new TRnode::TRSect[uu]; // przydzielenie pamieci dla sciezki
+                                                trVectorSection = NewSections(uu); // przydzielenie pamieci dla sciezki
                                                 for (j = 0; j < uu; j++) {
                                                     for (ii = 0; ii < 16; ii++) {
                                                         xx = ParserX::GetNumber(data);
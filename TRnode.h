@@ -13,6 +13,8 @@
 
 #include "Vector2i.h"
 #include <QString>
+#include <QVector>
+#include <QHash>
 
 class QTextStream;
 class FileBuffer;
@@ -33,6 +35,8 @@ public:
     int TrP2 = 0;
     int TrPinS[3];
     int TrPinK[3];
+    static TRSect* NewSections(int count);
+    static void FreeSections(TRSect* sections, int count);
     
     TRnode();
     TRnode(const TRnode& orig);
@@ -50,6 +54,10 @@ public:
     void addPositionOffset(float offsetXYZ[3]);
     void addTrackNodeItemOffset(unsigned int trackNodeOffset, unsigned int trackItemOffset);
 private:
+    static const int SectionBlockSize = 16384;
+    static QVector<TRSect*> SectionBlocks;
+    static int SectionBlockUsed;
+    static QHash<int, QVector<TRSect*>> FreeSectionSpans;
 
 };
 
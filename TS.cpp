@@ -1465,5 +1465,6 @@ std::unordered_map< int, const char* > TS::IdName = {
     { TSRE_Terrain_RawFile, "TSRE_Terrain_RawFile"},
     { TSRE_Terrain_FtFile, "TSRE_Terrain_FtFile"},
     { TSRE_Requested_TD_File, "TSRE_Requested_TD_File"},
-    { TSRE_Requested_TD_Lo_File, "TSRE_Requested_TD_Lo_File"}
+    { TSRE_Requested_TD_Lo_File, "TSRE_Requested_TD_Lo_File"},
+    { TSRE_Terrain_RawRect, "TSRE_Terrain_RawRect"}
 };       
\ No newline at end of file
@@ -1471,7 +1471,8 @@ public:
         TSRE_Terrain_RawFile = 100005,
         TSRE_Terrain_FtFile = 100006,
         TSRE_Requested_TD_File = 100007,
-        TSRE_Requested_TD_Lo_File = 100008
+        TSRE_Requested_TD_Lo_File = 100008,
+        TSRE_Terrain_RawRect = 100009
     };
     static std::unordered_map< int, const char* > IdName;
 };
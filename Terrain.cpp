@@ -14,6 +14,7 @@
 #include <QFile>
 #include "ReadFile.h"
 #include "TexLib.h"
+#include "TerrainTexArray.h"
 #include "TerrainLib.h"
 #include "GLMatrix.h"
 #include "Brush.h"
@@ -161,6 +162,7 @@ float Terrain::setHeight(int x, int z, float posx, float posz, float val, bool a
     else
         terrainData[(int) (posz) / sampleSize][(int) (posx) / sampleSize] = val;
 
+    markDirty((int) (posx) / sampleSize, (int) (posz) / sampleSize);
     setModified(true);
     return terrainData[(int) (posz) / sampleSize][(int) (posx) / sampleSize];
 }
@@ -259,6 +261,63 @@ void Terrain::setFixedHeight(float val){
     setModified(true);
 }
 
+void Terrain::fitToCorridor(QVector<float> &segments, float halfWidth, float cut, float emb, float radius){
+    // segments are x1 z1 h1 x2 z2 h2 in samples of this tile, every sample
+    // takes the height of the nearest one. Inside halfWidth the height is
+    // set, outside the terrain is only cut or filled up to the slopes.
+    if (loaded == false)
+        return;
+    int samples = *tfile->nsamples;
+    int patches = tfile->patchsetNpatches;
+    int patchRes = samples/patches;
+    QVector<float> dist(samples*samples, radius + 1);
+    QVector<float> height(samples*samples, 0);
+
+    for(int s = 0; s + 5 < segments.size(); s += 6){
+        float x1 = segments[s], z1 = segments[s+1], h1 = segments[s+2];
+        float x2 = segments[s+3], z2 = segments[s+4], h2 = segments[s+5];
+        int j0 = qMax(0, (int)floor(qMin(x1, x2) - radius));
+        int j1 = qMin(samples - 1, (int)ceil(qMax(x1, x2) + radius));
+        int i0 = qMax(0, (int)floor(qMin(z1, z2) - radius));
+        int i1 = qMin(samples - 1, (int)ceil(qMax(z1, z2) + radius));
+        float dx = x2 - x1, dz = z2 - z1;
+        float len2 = dx*dx + dz*dz;
+        for(int i = i0; i <= i1; i++)
+            for(int j = j0; j <= j1; j++){
+                float t = 0;
+                if(len2 > 0)
+                    t = qBound(0.0f, ((j - x1)*dx + (i - z1)*dz)/len2, 1.0f);
+                float ex = j - x1 - t*dx;
+                float ez = i - z1 - t*dz;
+                float d = sqrt(ex*ex + ez*ez);
+                if(d >= dist[i*samples + j])
+                    continue;
+                dist[i*samples + j] = d;
+                height[i*samples + j] = h1 + t*(h2 - h1);
+            }
+    }
+
+    for(int i = 0; i < samples; i++)
+        for(int j = 0; j < samples; j++){
+            float d = dist[i*samples + j];
+            if(d > radius)
+                continue;
+            float h = height[i*samples + j];
+            float dd = d - halfWidth;
+            if(dd <= 0){
+                terrainData[i][j] = h;
+            } else {
+                if(terrainData[i][j] < h - dd*emb)
+                    terrainData[i][j] = h - dd*emb;
+                if(terrainData[i][j] > h + dd*cut)
+                    terrainData[i][j] = h + dd*cut;
+            }
+            if(tfile->errorBias != NULL)
+                tfile->errorBias[(i/patchRes)*patches + j/patchRes] = 0;
+            markDirty(j, i);
+        }
+}
+
 Terrain::Terrain(const Terrain& orig) {
 }
 
@@ -298,6 +357,37 @@ void Terrain::loadRAWFile(FileBuffer *data){
     this->readRAWFloat(data);
 }
 
+void Terrain::saveRAWRectToStream(QDataStream &out, int x0, int z0, int x1, int z1){
+    // the last row and column are copies of the adjacent tiles
+    int samples = *tfile->nsamples;
+    x1 = qMin(x1, samples - 1);
+    z1 = qMin(z1, samples - 1);
+    out << (qint32) x0;
+    out << (qint32) z0;
+    out << (qint32) x1;
+    out << (qint32) z1;
+    for (int i = z0; i <= z1; i++)
+        for (int j = x0; j <= x1; j++)
+            out << terrainData[i][j];
+}
+
+void Terrain::loadRAWRect(FileBuffer *data){
+    int samples = *tfile->nsamples;
+    int x0 = data->getInt();
+    int z0 = data->getInt();
+    int x1 = data->getInt();
+    int z1 = data->getInt();
+    if(x0 < 0 || z0 < 0 || x1 >= samples || z1 >= samples)
+        return;
+    if(x1 < x0 || z1 < z0)
+        return;
+    for (int i = z0; i <= z1; i++)
+        for (int j = x0; j <= x1; j++)
+            terrainData[i][j] = data->getFloat();
+    markDirty(x0, z0);
+    markDirty(x1, z1);
+}
+
 void Terrain::loadFFile(FileBuffer *data){
     if(data->off == data->length)
         return;
@@ -308,6 +398,7 @@ void Terrain::loadFFile(FileBuffer *data){
 Terrain::~Terrain() {
     long timeNow1 = QDateTime::currentMSecsSinceEpoch();
     if (this->loaded) {
+        freeVertexData();
         for (int i = 0; i < 257; i++) {
             delete[] terrainData[i];
             if (this->jestF)
@@ -323,6 +414,7 @@ Terrain::~Terrain() {
             delete VBO;
         if(VAO != NULL)
             delete VAO;
+        delete texArray;
         //delete[] VBO;
         //delete[] VAO;
 
@@ -444,9 +536,63 @@ void Terrain::refresh() {
     if (!loaded) return;
     isOgl = false;
     lines.loaded = false;
+    // the whole VBO is made again, dirty samples go with it
+    isDirty = false;
+    oglDirty = false;
+    oglDirtyEdges = false;
     //reloadLines();
 }
 
+void Terrain::markDirty(int x, int z) {
+    int samples = *tfile->nsamples;
+    x = qBound(0, x, samples);
+    z = qBound(0, z, samples);
+    if(!isDirty){
+        dirtyRect[0] = dirtyRect[2] = x;
+        dirtyRect[1] = dirtyRect[3] = z;
+        isDirty = true;
+        return;
+    }
+    dirtyRect[0] = qMin(dirtyRect[0], x);
+    dirtyRect[1] = qMin(dirtyRect[1], z);
+    dirtyRect[2] = qMax(dirtyRect[2], x);
+    dirtyRect[3] = qMax(dirtyRect[3], z);
+}
+
+bool Terrain::getDirtyRect(int &x0, int &z0, int &x1, int &z1) {
+    if(!isDirty){
+        x0 = z0 = 0;
+        x1 = z1 = -1;
+        return false;
+    }
+    x0 = dirtyRect[0];
+    z0 = dirtyRect[1];
+    x1 = dirtyRect[2];
+    z1 = dirtyRect[3];
+    return true;
+}
+
+void Terrain::refreshDirty(bool edges) {
+    // like refresh(), but the VBO is only updated around dirty samples
+    if (!loaded) return;
+    lines.loaded = false;
+    if(isDirty){
+        if(!oglDirty){
+            for(int i = 0; i < 4; i++)
+                oglDirtyRect[i] = dirtyRect[i];
+        } else {
+            oglDirtyRect[0] = qMin(oglDirtyRect[0], dirtyRect[0]);
+            oglDirtyRect[1] = qMin(oglDirtyRect[1], dirtyRect[1]);
+            oglDirtyRect[2] = qMax(oglDirtyRect[2], dirtyRect[2]);
+            oglDirtyRect[3] = qMax(oglDirtyRect[3], dirtyRect[3]);
+        }
+        oglDirty = true;
+        isDirty = false;
+    }
+    if(edges)
+        oglDirtyEdges = true;
+}
+
 void Terrain::toggleGaps(int x, int z, float posx, float posz, float direction){
     if(!jestF)
         newF();
@@ -704,7 +850,8 @@ void Terrain::makeTextureFromMap(){
     }
     QString path = QString::number(hash)+".:maptex";
     QString tname = name + "_map.ace";
-    int mapTexid = TexLib::addTex(path);
+    // reload, the map image may have changed since the texture was made
+    int mapTexid = TexLib::addTex(path, true);
     if(!TexLib::mtex[mapTexid]->loaded){
         if(Game::debugOutput) qDebug() << "mat tex not loaded";
         return;
@@ -1533,6 +1680,10 @@ void Terrain::pushRenderItem(float lodx, float lodz, int tileX, int tileY, float
         normalInit();
         oglInit();
         isOgl = true;
+        oglDirty = false;
+        oglDirtyEdges = false;
+    } else if (oglDirty || oglDirtyEdges) {
+        oglUpdate();
     }
 
     if (!lines.loaded) {
@@ -1825,6 +1976,10 @@ void Terrain::render(float lodx, float lodz, int tileX, int tileY, float* player
         normalInit();
         oglInit();
         isOgl = true;
+        oglDirty = false;
+        oglDirtyEdges = false;
+    } else if (oglDirty || oglDirtyEdges) {
+        oglUpdate();
     }
 
     GLUU* gluu = GLUU::get();
@@ -1865,7 +2020,12 @@ void Terrain::render(float lodx, float lodz, int tileX, int tileY, float* player
 
     QOpenGLVertexArrayObject::Binder vaoBinder(VAO);
     
-    if(Game::viewTerrainShape && (!(showBlob && MapWindow::isAlpha == 0) || selectionColor != 0)){
+    bool arrayDrawn = false;
+    if(Game::terrainTextureArrays && selectionColor == 0 && gluu->currentShader->textureArrays)
+        if(Game::viewTerrainShape && !(showBlob && MapWindow::isAlpha == 0))
+            arrayDrawn = renderPatchesFromArray(patches, patchRes);
+
+    if(!arrayDrawn && Game::viewTerrainShape && (!(showBlob && MapWindow::isAlpha == 0) || selectionColor != 0)){
         float shaderSecondTexUV = 0;
         for (int uu = 0; uu < patches; uu++) {
             for (int yy = 0; yy < patches; yy++) {
@@ -1997,6 +2157,83 @@ void Terrain::render(float lodx, float lodz, int tileX, int tileY, float* player
     //    renderWater(lodx, lodz, playerT, playerW, target, fov);
 }
 
+// Patches drawn with their textures taken from the tile's texture array,
+// one draw for each run of patches lying next to each other in the VBO
+// with the same second texture. False until every texture is loaded, the
+// patch by patch loop loads them meanwhile.
+bool Terrain::renderPatchesFromArray(int patches, int patchRes) {
+    QVector<int> ids;
+    for (int i = 0; i < patches * patches; i++) {
+        if (hidden[i] || (tfile->flags[i] & 1) != 0)
+            continue;
+        if (texid[i] < 0 || texid2[i] == -1)
+            return false;
+        if (texid2[i] >= 0 && (!TexLib::mtex[texid2[i]]->loaded || !TexLib::mtex[texid2[i]]->glLoaded))
+            return false;
+        ids.push_back(texid[i]);
+    }
+    if (texArray == NULL)
+        texArray = new TerrainTexArray();
+    if (!texArray->update(ids))
+        return false;
+
+    GLUU* gluu = GLUU::get();
+    QOpenGLFunctions *f = QOpenGLContext::currentContext()->functions();
+    int patchVertices = patchRes * patchRes * 6;
+    // layers in VBO order, patch uu*patches+yy
+    float layers[256] = {};
+    for (int uu = 0; uu < patches; uu++)
+        for (int yy = 0; yy < patches; yy++)
+            if (texid[yy * patches + uu] >= 0)
+                layers[uu * patches + yy] = qMax(texArray->getLayer(texid[yy * patches + uu]), 0);
+    gluu->currentShader->setUniformValueArray(gluu->currentShader->patchLayers, layers, 64, 4);
+    gluu->currentShader->setUniformValue(gluu->currentShader->patchVertices, (float)patchVertices);
+    gluu->currentShader->setUniformValue(gluu->currentShader->textureArrayEnabled, 1.0f);
+    texArray->bind();
+
+    float shaderSecondTexUV = 0;
+    int runStart = -1;
+    int runTex2 = -2;
+    float runUV = 0;
+    for (int p = 0; p <= patches * patches; p++) {
+        int t = -1;
+        int tex2 = -2;
+        float uv = 0;
+        if (p < patches * patches) {
+            t = (p % patches) * patches + p / patches;
+            if (hidden[t] || (tfile->flags[t] & 1) != 0) {
+                t = -1;
+            } else if (texid2[t] >= 0) {
+                tex2 = texid2[t];
+                uv = *(float*)&tfile->materials[(int) tfile->tdata[t*13 + 0 + 6]].itex[1][3];
+            }
+        }
+        if (runStart >= 0 && (t < 0 || tex2 != runTex2 || uv != runUV)) {
+            f->glDrawArrays(GL_TRIANGLES, runStart * patchVertices, (p - runStart) * patchVertices);
+            runStart = -1;
+        }
+        if (t < 0 || runStart >= 0)
+            continue;
+        runStart = p;
+        runTex2 = tex2;
+        runUV = uv;
+        if (tex2 >= 0) {
+            f->glActiveTexture(GL_TEXTURE1);
+            f->glBindTexture(GL_TEXTURE_2D, TexLib::mtex[tex2]->tex[0]);
+            f->glActiveTexture(GL_TEXTURE0);
+        }
+        if (shaderSecondTexUV != uv) {
+            shaderSecondTexUV = uv;
+            gluu->currentShader->setUniformValue(gluu->currentShader->shaderSecondTexEnabled, shaderSecondTexUV);
+        }
+    }
+
+    gluu->currentShader->setUniformValue(gluu->currentShader->textureArrayEnabled, 0.0f);
+    gluu->currentShader->setUniformValue(gluu->currentShader->patchVertices, 0.0f);
+    gluu->currentShader->setUniformValue(gluu->currentShader->shaderSecondTexEnabled, 0.0f);
+    return true;
+}
+
 void Terrain::renderWater(float lodx, float lodz, float tileX, float tileY, float* playerW, float* target, float fov, int layer, int selectionColor) {
     float lod;
     if(showBlob)
@@ -2386,6 +2623,8 @@ void Terrain::vertexInit() {
     // this.vertexData[0] = new Array();
     int samples = *tfile->nsamples;
     int sampleSize = *tfile->sampleSize;
+    // arrays kept from edits are made again from scratch
+    freeVertexData();
 
     vertexData = new Vector3f*[samples+1];
     for (int i = 0; i < samples+1; i++)
@@ -2402,6 +2641,13 @@ void Terrain::vertexInit() {
     }
 }
 
+void Terrain::vertexInit(int x0, int z0, int x1, int z1) {
+    int sampleSize = *tfile->sampleSize;
+    for (int jj = x0; jj <= x1; jj++)
+        for (int ii = z0; ii <= z1; ii++)
+            vertexData[jj][ii].set(jj * sampleSize, terrainData[ii][jj], ii * sampleSize);
+}
+
 void Terrain::normalInit() {
     int samples = *tfile->nsamples;
     int sampleSize = *tfile->sampleSize;
@@ -2432,6 +2678,36 @@ void Terrain::normalInit() {
         }
     }
 };
+
+void Terrain::normalInit(int x0, int z0, int x1, int z1) {
+    // same as above, but only samples inside the rect are written
+    int samples = *tfile->nsamples;
+    for (int jj = x0; jj <= x1; jj++)
+        for (int ii = z0; ii <= z1; ii++)
+            normalData[jj][ii].set(0, 0, 0);
+    Vector3f U, V, O;
+    for (int jj = qMax(0, x0 - 1); jj < qMin(samples, x1 + 1); jj++) {
+        for (int ii = qMax(0, z0 - 1); ii < qMin(samples, z1 + 1); ii++) {
+            bool j0 = jj >= x0, j1 = jj + 1 <= x1;
+            bool i0 = ii >= z0, i1 = ii + 1 <= z1;
+            U.setFromSub( vertexData[jj][ii], vertexData[jj + 1][ii]);
+            V.setFromSub( vertexData[jj][ii], vertexData[jj][ii + 1]);
+            O.setFromCross(V, U);
+            if(j0 && i0) normalData[jj][ii].add( O );
+            if(j1 && i0) normalData[jj + 1][ii].add( O );
+            if(j0 && i1) normalData[jj][ii + 1].add( O );
+            U.setFromSub( vertexData[jj + 1][ii + 1], vertexData[jj + 1][ii]);
+            V.setFromSub( vertexData[jj + 1][ii + 1], vertexData[jj][ii + 1]);
+            O.setFromCross(U, V);
+            if(j1 && i1) normalData[jj + 1][ii + 1].add( O );
+            if(j1 && i0) normalData[jj + 1][ii].add( O );
+            if(j0 && i1) normalData[jj][ii + 1].add( O );
+        }
+    }
+    for (int jj = x0; jj <= x1; jj++)
+        for (int ii = z0; ii <= z1; ii++)
+            normalData[jj][ii].normalize();
+}
 /*
 void Terrain::oglInit() {
     if(!VAO->isCreated()){
@@ -2542,150 +2818,10 @@ void Terrain::oglInit() {
     int samples = *tfile->nsamples;
     int patches = tfile->patchsetNpatches;
     int patchRes = samples/patches;
-    float texRes = 1.0;// (float)16.0/patchRes;
     
     for (int uu = 0; uu < patches; uu++) {
         for (int yy = 0; yy < patches; yy++) {
-            int ptr = 0;
-            bool fi0j0 = true, fi1j0 = true, fi0j1 = true, fi1j1 = true;
-
-            for (int ii = 0; ii < patchRes; ii++) {
-                for (int jj = 0; jj < patchRes; jj++) {
-                    if (jestF) {
-                        fi0j0 = !(((fData[yy * patchRes + ii][uu * patchRes + jj]) & 0x04) >> 2);
-                        fi0j1 = !(((fData[yy * patchRes + ii][uu * patchRes + jj + 1]) & 0x04) >> 2);
-                        fi1j1 = !(((fData[yy * patchRes + ii + 1][uu * patchRes + jj + 1]) &0x04) >> 2);
-                        fi1j0 = !(((fData[yy * patchRes + ii + 1][uu * patchRes + jj]) & 0x04) >> 2);
-                    }
-                    /*if (jestF) {
-                        suma = ((fData[yy * 16 + ii][uu * 16 + jj]) & 0x04);
-                        suma += ((fData[yy * 16 + ii][uu * 16 + jj + 1]) & 0x04);
-                        suma += ((fData[yy * 16 + ii + 1][uu * 16 + jj + 1]) & 0x04);
-                        suma += ((fData[yy * 16 + ii + 1][uu * 16 + jj]) & 0x04);
-                    }*/
-
-                    //if (!jestF || (suma < 4)) {
-                        if(((ii+jj) % 2 == 0)){
-                            if(fi0j0 && fi1j0 && fi1j1){
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii].x;
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii].y;
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii].z;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii].x;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii].y;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii].z;
-                            punkty[ptr++] = texRes * (jj * tfile->tdata[(yy * patches + uu)*13 + 3 + 6] + ii * tfile->tdata[(yy * patches + uu)*13 + 4 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 1 + 6];
-                            punkty[ptr++] = texRes * (jj * tfile->tdata[(yy * patches + uu)*13 + 5 + 6] + ii * tfile->tdata[(yy * patches + uu)*13 + 6 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 2 + 6];
-
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii + 1].x;
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii + 1].y;
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii + 1].z;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii + 1].x;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii + 1].y;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii + 1].z;
-                            punkty[ptr++] = texRes * ((jj) * tfile->tdata[(yy * patches + uu)*13 + 3 + 6] + (ii + 1) * tfile->tdata[(yy * patches + uu)*13 + 4 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 1 + 6];
-                            punkty[ptr++] = texRes * ((jj) * tfile->tdata[(yy * patches + uu)*13 + 5 + 6] + (ii + 1) * tfile->tdata[(yy * patches + uu)*13 + 6 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 2 + 6];
-
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].x;
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].y;
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].z;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].x;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].y;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].z;
-                            punkty[ptr++] = texRes * ((jj + 1) * tfile->tdata[(yy * patches + uu)*13 + 3 + 6] + (ii + 1) * tfile->tdata[(yy * patches + uu)*13 + 4 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 1 + 6];
-                            punkty[ptr++] = texRes * ((jj + 1) * tfile->tdata[(yy * patches + uu)*13 + 5 + 6] + (ii + 1) * tfile->tdata[(yy * patches + uu)*13 + 6 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 2 + 6];
-                            }
-                            ///////////////////////////////////////////////////////////
-                            if(fi0j0 && fi0j1 && fi1j1){
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii].x;
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii].y;
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii].z;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii].x;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii].y;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii].z;
-                            punkty[ptr++] = texRes * (jj * tfile->tdata[(yy * patches + uu)*13 + 3 + 6] + ii * tfile->tdata[(yy * patches + uu)*13 + 4 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 1 + 6];
-                            punkty[ptr++] = texRes * (jj * tfile->tdata[(yy * patches + uu)*13 + 5 + 6] + ii * tfile->tdata[(yy * patches + uu)*13 + 6 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 2 + 6];
-
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].x;
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].y;
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].z;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].x;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].y;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].z;
-                            punkty[ptr++] = texRes * ((jj + 1) * tfile->tdata[(yy * patches + uu)*13 + 3 + 6] + (ii + 1) * tfile->tdata[(yy * patches + uu)*13 + 4 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 1 + 6];
-                            punkty[ptr++] = texRes * ((jj + 1) * tfile->tdata[(yy * patches + uu)*13 + 5 + 6] + (ii + 1) * tfile->tdata[(yy * patches + uu)*13 + 6 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 2 + 6];
-
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii].x;
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii].y;
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii].z;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii].x;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii].y;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii].z;
-                            punkty[ptr++] = texRes * ((jj + 1) * tfile->tdata[(yy * patches + uu)*13 + 3 + 6] + (ii) * tfile->tdata[(yy * patches + uu)*13 + 4 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 1 + 6];
-                            punkty[ptr++] = texRes * ((jj + 1) * tfile->tdata[(yy * patches + uu)*13 + 5 + 6] + (ii) * tfile->tdata[(yy * patches + uu)*13 + 6 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 2 + 6];
-                            }
-                        }
-                        if(((ii+jj) % 2 == 1)){
-                            if(fi0j1 && fi1j1 && fi1j0){
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii + 1].x;
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii + 1].y;
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii + 1].z;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii + 1].x;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii + 1].y;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii + 1].z;
-                            punkty[ptr++] = texRes * ((jj) * tfile->tdata[(yy * patches + uu)*13 + 3 + 6] + (ii + 1) * tfile->tdata[(yy * patches + uu)*13 + 4 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 1 + 6];
-                            punkty[ptr++] = texRes * ((jj) * tfile->tdata[(yy * patches + uu)*13 + 5 + 6] + (ii + 1) * tfile->tdata[(yy * patches + uu)*13 + 6 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 2 + 6];
-                            
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].x;
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].y;
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].z;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].x;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].y;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].z;
-                            punkty[ptr++] = texRes * ((jj + 1) * tfile->tdata[(yy * patches + uu)*13 + 3 + 6] + (ii + 1) * tfile->tdata[(yy * patches + uu)*13 + 4 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 1 + 6];
-                            punkty[ptr++] = texRes * ((jj + 1) * tfile->tdata[(yy * patches + uu)*13 + 5 + 6] + (ii + 1) * tfile->tdata[(yy * patches + uu)*13 + 6 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 2 + 6];
-
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii].x;
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii].y;
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii].z;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii].x;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii].y;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii].z;
-                            punkty[ptr++] = texRes * ((jj + 1) * tfile->tdata[(yy * patches + uu)*13 + 3 + 6] + (ii) * tfile->tdata[(yy * patches + uu)*13 + 4 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 1 + 6];
-                            punkty[ptr++] = texRes * ((jj + 1) * tfile->tdata[(yy * patches + uu)*13 + 5 + 6] + (ii) * tfile->tdata[(yy * patches + uu)*13 + 6 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 2 + 6];
-                            }
-                            ///////////////////////////////////////////////////////////
-                            if(fi0j0 && fi0j1 && fi1j0){
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii].x;
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii].y;
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii].z;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii].x;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii].y;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii].z;
-                            punkty[ptr++] = texRes * (jj * tfile->tdata[(yy * patches + uu)*13 + 3 + 6] + ii * tfile->tdata[(yy * patches + uu)*13 + 4 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 1 + 6];
-                            punkty[ptr++] = texRes * (jj * tfile->tdata[(yy * patches + uu)*13 + 5 + 6] + ii * tfile->tdata[(yy * patches + uu)*13 + 6 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 2 + 6];
-
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii + 1].x;
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii + 1].y;
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii + 1].z;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii + 1].x;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii + 1].y;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii + 1].z;
-                            punkty[ptr++] = texRes * ((jj) * tfile->tdata[(yy * patches + uu)*13 + 3 + 6] + (ii + 1) * tfile->tdata[(yy * patches + uu)*13 + 4 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 1 + 6];
-                            punkty[ptr++] = texRes * ((jj) * tfile->tdata[(yy * patches + uu)*13 + 5 + 6] + (ii + 1) * tfile->tdata[(yy * patches + uu)*13 + 6 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 2 + 6];
-
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii].x;
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii].y;
-                            punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii].z;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii].x;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii].y;
-                            punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii].z;
-                            punkty[ptr++] = texRes * ((jj + 1) * tfile->tdata[(yy * patches + uu)*13 + 3 + 6] + (ii) * tfile->tdata[(yy * patches + uu)*13 + 4 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 1 + 6];
-                            punkty[ptr++] = texRes * ((jj + 1) * tfile->tdata[(yy * patches + uu)*13 + 5 + 6] + (ii) * tfile->tdata[(yy * patches + uu)*13 + 6 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 2 + 6];
-                            }
-                        }
-                    //}
-                }
-            }
+            fillPatch(uu, yy, punkty);
             /*for(var jj = 0; jj<16; jj++){
                 for(var ii = 0; ii<16; ii++){
                     punkty.put(normalData[uu*16+jj][yy*16+ii].toFloat());
@@ -2726,12 +2862,232 @@ void Terrain::oglInit() {
     //    delete normalData[i];
     //delete normalData;
 
-    for (int i = 0; i < samples+1; i++){
-        delete[] vertexData[i];
-        delete[] normalData[i];
+    freeVertexData();
+}
+
+void Terrain::freeVertexData() {
+    int samples = *tfile->nsamples;
+    if(vertexData != NULL){
+        for (int i = 0; i < samples+1; i++)
+            delete[] vertexData[i];
+        delete[] vertexData;
+        vertexData = NULL;
+    }
+    if(normalData != NULL){
+        for (int i = 0; i < samples+1; i++)
+            delete[] normalData[i];
+        delete[] normalData;
+        normalData = NULL;
+    }
+}
+
+void Terrain::oglUpdate() {
+    int samples = *tfile->nsamples;
+    int patches = tfile->patchsetNpatches;
+    int patchRes = samples/patches;
+    // the last row and column come from the adjacent tiles, only needed
+    // when patches on that border are made again
+    if(oglDirtyEdges || (oglDirty && qMax(oglDirtyRect[2], oglDirtyRect[3]) + 1 >= samples - patchRes))
+        Game::terrainLib->fillRaw(this, (int) mojex, (int) mojez);
+
+    // only the patches around the dirty rect are written, so the arrays
+    // are made once and kept while the tile is edited
+    if(vertexData == NULL){
+        vertexData = new Vector3f*[samples+1];
+        normalData = new Vector3f*[samples+1];
+        for (int i = 0; i < samples+1; i++){
+            vertexData[i] = new Vector3f[samples+1];
+            normalData[i] = new Vector3f[samples+1];
+        }
+    }
+
+    if(oglDirty){
+        // normals one sample around the changed ones move too,
+        // a sample on a patch border belongs to both patches
+        int u0 = qMax(0, oglDirtyRect[0] - 2) / patchRes;
+        int y0 = qMax(0, oglDirtyRect[1] - 2) / patchRes;
+        int u1 = qMin(patches - 1, (oglDirtyRect[2] + 1) / patchRes);
+        int y1 = qMin(patches - 1, (oglDirtyRect[3] + 1) / patchRes);
+        oglUpdatePatches(u0, y0, u1, y1);
+    }
+    if(oglDirtyEdges){
+        // last column and row come from the adjacent tiles
+        oglUpdatePatches(patches - 1, 0, patches - 1, patches - 1);
+        oglUpdatePatches(0, patches - 1, patches - 1, patches - 1);
+    }
+    oglDirty = false;
+    oglDirtyEdges = false;
+}
+
+void Terrain::oglUpdatePatches(int u0, int y0, int u1, int y1) {
+    int samples = *tfile->nsamples;
+    int patches = tfile->patchsetNpatches;
+    int patchRes = samples/patches;
+    int x0 = u0 * patchRes;
+    int z0 = y0 * patchRes;
+    int x1 = (u1 + 1) * patchRes;
+    int z1 = (y1 + 1) * patchRes;
+    vertexInit(qMax(0, x0 - 1), qMax(0, z0 - 1), qMin(samples, x1 + 1), qMin(samples, z1 + 1));
+    normalInit(x0, z0, x1, z1);
+
+    float * punkty = new float[16 * 16 * 48];
+    VBO->bind();
+    for (int uu = u0; uu <= u1; uu++) {
+        for (int yy = y0; yy <= y1; yy++) {
+            fillPatch(uu, yy, punkty);
+            VBO->write((uu * patches + yy) * patchRes * patchRes * 6 * 8 * sizeof (GLfloat), punkty, patchRes * patchRes * 6 * 8 * sizeof (GLfloat));
+        }
+    }
+    VBO->release();
+    delete[] punkty;
+}
+
+void Terrain::fillPatch(int uu, int yy, float *punkty) {
+    int samples = *tfile->nsamples;
+    int patches = tfile->patchsetNpatches;
+    int patchRes = samples/patches;
+    float texRes = 1.0;// (float)16.0/patchRes;
+
+    int ptr = 0;
+    bool fi0j0 = true, fi1j0 = true, fi0j1 = true, fi1j1 = true;
+
+    for (int ii = 0; ii < patchRes; ii++) {
+        for (int jj = 0; jj < patchRes; jj++) {
+            if (jestF) {
+                fi0j0 = !(((fData[yy * patchRes + ii][uu * patchRes + jj]) & 0x04) >> 2);
+                fi0j1 = !(((fData[yy * patchRes + ii][uu * patchRes + jj + 1]) & 0x04) >> 2);
+                fi1j1 = !(((fData[yy * patchRes + ii + 1][uu * patchRes + jj + 1]) &0x04) >> 2);
+                fi1j0 = !(((fData[yy * patchRes + ii + 1][uu * patchRes + jj]) & 0x04) >> 2);
+            }
+            /*if (jestF) {
+                suma = ((fData[yy * 16 + ii][uu * 16 + jj]) & 0x04);
+                suma += ((fData[yy * 16 + ii][uu * 16 + jj + 1]) & 0x04);
+                suma += ((fData[yy * 16 + ii + 1][uu * 16 + jj + 1]) & 0x04);
+                suma += ((fData[yy * 16 + ii + 1][uu * 16 + jj]) & 0x04);
+            }*/
+
+            //if (!jestF || (suma < 4)) {
+                if(((ii+jj) % 2 == 0)){
+                    if(fi0j0 && fi1j0 && fi1j1){
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii].x;
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii].y;
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii].z;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii].x;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii].y;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii].z;
+                    punkty[ptr++] = texRes * (jj * tfile->tdata[(yy * patches + uu)*13 + 3 + 6] + ii * tfile->tdata[(yy * patches + uu)*13 + 4 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 1 + 6];
+                    punkty[ptr++] = texRes * (jj * tfile->tdata[(yy * patches + uu)*13 + 5 + 6] + ii * tfile->tdata[(yy * patches + uu)*13 + 6 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 2 + 6];
+
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii + 1].x;
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii + 1].y;
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii + 1].z;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii + 1].x;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii + 1].y;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii + 1].z;
+                    punkty[ptr++] = texRes * ((jj) * tfile->tdata[(yy * patches + uu)*13 + 3 + 6] + (ii + 1) * tfile->tdata[(yy * patches + uu)*13 + 4 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 1 + 6];
+                    punkty[ptr++] = texRes * ((jj) * tfile->tdata[(yy * patches + uu)*13 + 5 + 6] + (ii + 1) * tfile->tdata[(yy * patches + uu)*13 + 6 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 2 + 6];
+
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].x;
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].y;
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].z;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].x;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].y;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].z;
+                    punkty[ptr++] = texRes * ((jj + 1) * tfile->tdata[(yy * patches + uu)*13 + 3 + 6] + (ii + 1) * tfile->tdata[(yy * patches + uu)*13 + 4 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 1 + 6];
+                    punkty[ptr++] = texRes * ((jj + 1) * tfile->tdata[(yy * patches + uu)*13 + 5 + 6] + (ii + 1) * tfile->tdata[(yy * patches + uu)*13 + 6 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 2 + 6];
+                    }
+                    ///////////////////////////////////////////////////////////
+                    if(fi0j0 && fi0j1 && fi1j1){
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii].x;
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii].y;
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii].z;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii].x;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii].y;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii].z;
+                    punkty[ptr++] = texRes * (jj * tfile->tdata[(yy * patches + uu)*13 + 3 + 6] + ii * tfile->tdata[(yy * patches + uu)*13 + 4 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 1 + 6];
+                    punkty[ptr++] = texRes * (jj * tfile->tdata[(yy * patches + uu)*13 + 5 + 6] + ii * tfile->tdata[(yy * patches + uu)*13 + 6 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 2 + 6];
+
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].x;
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].y;
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].z;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].x;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].y;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].z;
+                    punkty[ptr++] = texRes * ((jj + 1) * tfile->tdata[(yy * patches + uu)*13 + 3 + 6] + (ii + 1) * tfile->tdata[(yy * patches + uu)*13 + 4 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 1 + 6];
+                    punkty[ptr++] = texRes * ((jj + 1) * tfile->tdata[(yy * patches + uu)*13 + 5 + 6] + (ii + 1) * tfile->tdata[(yy * patches + uu)*13 + 6 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 2 + 6];
+
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii].x;
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii].y;
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii].z;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii].x;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii].y;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii].z;
+                    punkty[ptr++] = texRes * ((jj + 1) * tfile->tdata[(yy * patches + uu)*13 + 3 + 6] + (ii) * tfile->tdata[(yy * patches + uu)*13 + 4 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 1 + 6];
+                    punkty[ptr++] = texRes * ((jj + 1) * tfile->tdata[(yy * patches + uu)*13 + 5 + 6] + (ii) * tfile->tdata[(yy * patches + uu)*13 + 6 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 2 + 6];
+                    }
+                }
+                if(((ii+jj) % 2 == 1)){
+                    if(fi0j1 && fi1j1 && fi1j0){
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii + 1].x;
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii + 1].y;
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii + 1].z;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii + 1].x;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii + 1].y;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii + 1].z;
+                    punkty[ptr++] = texRes * ((jj) * tfile->tdata[(yy * patches + uu)*13 + 3 + 6] + (ii + 1) * tfile->tdata[(yy * patches + uu)*13 + 4 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 1 + 6];
+                    punkty[ptr++] = texRes * ((jj) * tfile->tdata[(yy * patches + uu)*13 + 5 + 6] + (ii + 1) * tfile->tdata[(yy * patches + uu)*13 + 6 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 2 + 6];
+                    
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].x;
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].y;
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].z;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].x;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].y;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii + 1].z;
+                    punkty[ptr++] = texRes * ((jj + 1) * tfile->tdata[(yy * patches + uu)*13 + 3 + 6] + (ii + 1) * tfile->tdata[(yy * patches + uu)*13 + 4 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 1 + 6];
+                    punkty[ptr++] = texRes * ((jj + 1) * tfile->tdata[(yy * patches + uu)*13 + 5 + 6] + (ii + 1) * tfile->tdata[(yy * patches + uu)*13 + 6 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 2 + 6];
+
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii].x;
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii].y;
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii].z;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii].x;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii].y;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii].z;
+                    punkty[ptr++] = texRes * ((jj + 1) * tfile->tdata[(yy * patches + uu)*13 + 3 + 6] + (ii) * tfile->tdata[(yy * patches + uu)*13 + 4 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 1 + 6];
+                    punkty[ptr++] = texRes * ((jj + 1) * tfile->tdata[(yy * patches + uu)*13 + 5 + 6] + (ii) * tfile->tdata[(yy * patches + uu)*13 + 6 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 2 + 6];
+                    }
+                    ///////////////////////////////////////////////////////////
+                    if(fi0j0 && fi0j1 && fi1j0){
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii].x;
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii].y;
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii].z;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii].x;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii].y;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii].z;
+                    punkty[ptr++] = texRes * (jj * tfile->tdata[(yy * patches + uu)*13 + 3 + 6] + ii * tfile->tdata[(yy * patches + uu)*13 + 4 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 1 + 6];
+                    punkty[ptr++] = texRes * (jj * tfile->tdata[(yy * patches + uu)*13 + 5 + 6] + ii * tfile->tdata[(yy * patches + uu)*13 + 6 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 2 + 6];
+
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii + 1].x;
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii + 1].y;
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj)][yy * patchRes + ii + 1].z;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii + 1].x;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii + 1].y;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj)][yy * patchRes + ii + 1].z;
+                    punkty[ptr++] = texRes * ((jj) * tfile->tdata[(yy * patches + uu)*13 + 3 + 6] + (ii + 1) * tfile->tdata[(yy * patches + uu)*13 + 4 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 1 + 6];
+                    punkty[ptr++] = texRes * ((jj) * tfile->tdata[(yy * patches + uu)*13 + 5 + 6] + (ii + 1) * tfile->tdata[(yy * patches + uu)*13 + 6 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 2 + 6];
+
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii].x;
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii].y;
+                    punkty[ptr++] = vertexData[(uu * patchRes + jj + 1)][yy * patchRes + ii].z;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii].x;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii].y;
+                    punkty[ptr++] = normalData[(uu * patchRes + jj + 1)][yy * patchRes + ii].z;
+                    punkty[ptr++] = texRes * ((jj + 1) * tfile->tdata[(yy * patches + uu)*13 + 3 + 6] + (ii) * tfile->tdata[(yy * patches + uu)*13 + 4 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 1 + 6];
+                    punkty[ptr++] = texRes * ((jj + 1) * tfile->tdata[(yy * patches + uu)*13 + 5 + 6] + (ii) * tfile->tdata[(yy * patches + uu)*13 + 6 + 6]) + tfile->tdata[(yy * patches + uu)*13 + 2 + 6];
+                    }
+                }
+            //}
+        }
     }
-    delete[] vertexData;
-    delete[] normalData;
 }
 
 void Terrain::initBlob(){
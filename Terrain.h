@@ -11,6 +11,7 @@
 #ifndef TERRAIN_H
 #define	TERRAIN_H
 #include <QString>
+#include <QVector>
 #include "GLUU.h"
 #include "TFile.h"
 #include "Vector3f.h"
@@ -19,6 +20,7 @@
 
 class Brush;
 class TerrainInfo;
+class TerrainTexArray;
 class FileBuffer;
 class QDataStream;
 
@@ -63,12 +65,18 @@ public:
     void fillTerrainDataXY(Terrain* adjacent);
     void save();
     void refresh();
+    void markDirty(int x, int z);
+    bool getDirtyRect(int &x0, int &z0, int &x1, int &z1);
+    void refreshDirty(bool edges = false);
+    void saveRAWRectToStream(QDataStream &out, int x0, int z0, int x1, int z1);
+    void loadRAWRect(FileBuffer *data);
     bool isModified();
     void setModified(bool value = true);
     void getLowCornerTileXY(int &X, int &Y);
     int getSampleCount();
     float setHeight(int x, int z, float posx, float posz, float val, bool add = false);
     void setFixedHeight(float val);
+    void fitToCorridor(QVector<float> &segments, float halfWidth, float cut, float emb, float radius);
     void paintTexture(Brush* brush, int x, int z, float posx, float posz);
     void lockTexture(Brush* brush, int x, int z, float posx, float posz);
     void setTexture(Brush* brush, int x, int z, float posx, float posz);
@@ -159,10 +167,19 @@ protected:
     bool modifiedF = false;
     bool isOgl = false;
     bool modified = false;
+    // samples changed since the last refreshDirty, x0 z0 x1 z1
+    bool isDirty = false;
+    int dirtyRect[4];
+    // samples waiting for the next render to update the VBO
+    bool oglDirty = false;
+    bool oglDirtyEdges = false;
+    int oglDirtyRect[4];
     QString texturepath;
     QString rootTexturepath;
-    Vector3f **vertexData;//[257][257];
-    Vector3f **normalData;//[257][257];
+    // made for the first VBO and freed after it; a tile that is edited
+    // keeps them for the partial updates until it is released
+    Vector3f **vertexData = NULL;//[257][257];
+    Vector3f **normalData = NULL;//[257][257];
     bool hidden[256];
     bool uniqueTex[256];
     int texid[256];
@@ -172,6 +189,7 @@ protected:
     bool selectedPatchs[256];
     QOpenGLBuffer *VBO = NULL;
     QOpenGLVertexArrayObject *VAO = NULL;
+    TerrainTexArray *texArray = NULL;
 
     OglObj lines;
     OglObj mlines;
@@ -207,8 +225,14 @@ protected:
     void saveF(QDataStream &write);
     void newF();
     void vertexInit();
+    void vertexInit(int x0, int z0, int x1, int z1);
     void normalInit();
+    void normalInit(int x0, int z0, int x1, int z1);
     void oglInit();
+    void oglUpdate();
+    void oglUpdatePatches(int u0, int y0, int u1, int y1);
+    void freeVertexData();
+    void fillPatch(int uu, int yy, float *punkty);
     void initBlob();
     void rotateTex(int idx);
     void mirrorXTex(int idx);
@@ -221,6 +245,7 @@ protected:
     float getScaleTex(int idx);
     void convertTexToDefaultCoords(int idx);
     void paintTextureOnTile(Brush* brush, int y, int u, float x, float z);
+    bool renderPatchesFromArray(int patches, int patchRes);
     void reloadLines();
     
     virtual void load();
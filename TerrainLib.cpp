@@ -69,6 +69,10 @@ void TerrainLib::saveQtLoToStream(QTextStream &out){
 
 void TerrainLib::updateTerrainHeightmap(Terrain *t){
     
+}
+
+void TerrainLib::updateTerrainHeightmap(Terrain *t, int x0, int z0, int x1, int z1){
+    
 }
     
 void TerrainLib::updateTerrainTFile(Terrain *t){
@@ -143,6 +147,11 @@ void TerrainLib::fillHeightMap(int x, int z, float* data){
 
 }
 
+void TerrainLib::fillHeights(int x, int z, QVector<Vector4f> &points){
+    for(int i = 0; i < points.size(); i++)
+        points[i].y = getHeight(x, z, points[i].x, points[i].z);
+}
+
 void TerrainLib::getRotation(float* rot, int x, int z, float posx, float posz){
 
 }
@@ -171,6 +180,10 @@ void TerrainLib::setTerrainToTrackObj(Brush* brush, float* punkty, int length, i
 
 }
 
+void TerrainLib::setTerrainToTrackCorridor(Brush* brush, float* punkty, int length, int tx, int tz, float offsetY){
+
+}
+
 void TerrainLib::setTerrainTexture(Brush* brush, int x, int z, float* p){
 
 }
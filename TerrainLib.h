@@ -13,6 +13,7 @@
 
 #include <unordered_map>
 #include <QString>
+#include <QVector>
 #include "GLUU.h"
 
 class Terrain;
@@ -43,6 +44,7 @@ public:
     virtual void getRotation(float *rot, int x, int z, float posx, float posz);
     virtual void setHeight(int x, int z, float posx, float posz, float h);
     virtual void fillHeightMap(int x, int z, float *data);
+    virtual void fillHeights(int x, int z, QVector<Vector4f> &points);
     virtual void fillWaterLevels(float *w, int mojex, int mojez);
     virtual void setWaterLevels(float *w, int mojex, int mojez);
     virtual Terrain* setHeight256(int x, int z, int posx, int posz, float h);
@@ -66,6 +68,7 @@ public:
     virtual void setTileBlob(int x, int z, float* p);
     virtual void setTextureToTrackObj(Brush* brush, float* punkty, int length, int x, int z);
     virtual void setTerrainToTrackObj(Brush* brush, float* punkty, int length, int x, int z, float* matrix, float offsetY = 0);
+    virtual void setTerrainToTrackCorridor(Brush* brush, float* punkty, int length, int x, int z, float offsetY = 0);
     virtual int getTexture(int x, int z, float* p);
     virtual bool load(int x, int z);
     virtual void getUnsavedInfo(QVector<QString> &items);
@@ -77,6 +80,7 @@ public:
     virtual void saveEmpty(int x, int z);
     virtual void fillTerrainData(Terrain *tTile, float *offsetXYZ);
     virtual void updateTerrainHeightmap(Terrain *t);
+    virtual void updateTerrainHeightmap(Terrain *t, int x0, int z0, int x1, int z1);
     virtual void updateTerrainTFile(Terrain *t);
     virtual void pushRenderItems(float* playerT, float* playerW, float* target, float fov, int renderMode);
     virtual void render(GLUU *gluu, float* playerT, float* playerW, float* target, float fov, int renderMode);
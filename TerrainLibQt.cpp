@@ -24,6 +24,25 @@
 #include "TerrainInfo.h"
 #include "Renderer.h"
 #include "TexLib.h"
+#include <QRunnable>
+#include <QThreadPool>
+
+// One tile of a corridor fit. Tiles don't share samples, so they are
+// fitted side by side.
+class TerrainCorridorTask : public QRunnable {
+public:
+    Terrain *terrain = NULL;
+    QVector<float> segments;
+    float halfWidth = 0;
+    float cut = 0;
+    float emb = 0;
+    float radius = 0;
+    int lastSegment = -1;
+
+    void run(){
+        terrain->fitToCorridor(segments, halfWidth, cut, emb, radius);
+    }
+};
 
 TerrainLibQt::TerrainLibQt() {
 }
@@ -56,9 +75,10 @@ Terrain* TerrainLibQt::getTerrainByXY(int x, int y, bool load) {
 
     if (terrainNameId == 0)
         return NULL;
-    if ((*currentQt)[terrainNameId] != NULL) {
-        if((*currentQt)[terrainNameId]->t != NULL)
-            return (*currentQt)[terrainNameId]->t;
+    TerrainInfo *info = currentQt->value(terrainNameId, NULL);
+    if (info != NULL) {
+        if(info->t != NULL)
+            return info->t;
     }
     if (load) {
         (*currentQt)[terrainNameId] = new TerrainInfo();
@@ -288,6 +308,27 @@ void TerrainLibQt::fillHeightMap(int x, int z, float* data) {
     terr->fillHeightMap(data);
 }
 
+void TerrainLibQt::fillHeights(int x, int z, QVector<Vector4f> &points) {
+    // points are mostly on one or two tiles, look the terrain up per tile
+    int lastX = 0, lastZ = 0;
+    Terrain *terr = NULL;
+    for (int i = 0; i < points.size(); i++) {
+        int tx = x, tz = z;
+        float posx = points[i].x, posz = points[i].z;
+        Game::check_coords(tx, tz, posx, posz);
+        if (i == 0 || tx != lastX || tz != lastZ) {
+            terr = getTerrainByXY(tx, tz, false);
+            lastX = tx;
+            lastZ = tz;
+        }
+        if (terr == NULL || terr->loaded == false) {
+            points[i].y = -1;
+            continue;
+        }
+        points[i].y = terr->getHeight(tx, tz, posx, posz, false);
+    }
+}
+
 void TerrainLibQt::getRotation(float* rot, int x, int z, float posx, float posz) {
     Game::check_coords(x, z, posx, posz);
     rot[0] = 0;
@@ -548,6 +589,77 @@ void TerrainLibQt::setTerrainToTrackObj(Brush* brush, float* punkty, int length,
     }
 }
 
+void TerrainLibQt::setTerrainToTrackCorridor(Brush* brush, float* punkty, int length, int tx, int tz, float offsetY) {
+    // brush sizes are in samples, like in setTerrainToTrackObj
+    float radius = brush->eRadius;
+    float reach = radius*8;
+    QHash<Terrain*, TerrainCorridorTask*> tasks;
+    int ttx, ttz;
+    float px, pz, lx1, lz1, lx2, lz2;
+    Terrain *terr;
+    for(int i = 0; i + 5 < length; i+=3 ){
+        // a segment is much shorter than a tile, so its corners
+        // find every tile it can reach
+        float minx = qMin(punkty[i], punkty[i+3]) - reach;
+        float maxx = qMax(punkty[i], punkty[i+3]) + reach;
+        float minz = qMin(punkty[i+2], punkty[i+5]) - reach;
+        float maxz = qMax(punkty[i+2], punkty[i+5]) + reach;
+        for(int c = 0; c < 4; c++){
+            px = (c & 1) ? maxx : minx;
+            pz = (c & 2) ? maxz : minz;
+            ttx = tx;
+            ttz = tz;
+            Game::check_coords(ttx, ttz, px, pz);
+            terr = getTerrainByXY(ttx, ttz);
+            if (terr == NULL) continue;
+            if (!terr->loaded) continue;
+            TerrainCorridorTask *task = tasks.value(terr, NULL);
+            if(task == NULL){
+                Undo::PushTerrainHeightMap(terr->mojex, terr->mojez, terr->terrainData, terr->getSampleCount());
+                task = new TerrainCorridorTask();
+                task->setAutoDelete(false);
+                task->terrain = terr;
+                task->halfWidth = brush->eSize;
+                task->cut = brush->eCut;
+                task->emb = brush->eEmb;
+                task->radius = radius;
+                tasks[terr] = task;
+            }
+            if(task->lastSegment == i)
+                continue;
+            task->lastSegment = i;
+            int sampleSize = terr->getSampleSize();
+            lx1 = punkty[i]; lz1 = punkty[i+2];
+            lx2 = punkty[i+3]; lz2 = punkty[i+5];
+            terr->getLocalCoords(tx, tz, lx1, lz1);
+            terr->getLocalCoords(tx, tz, lx2, lz2);
+            task->segments.push_back(lx1/sampleSize);
+            task->segments.push_back(lz1/sampleSize);
+            task->segments.push_back(punkty[i+1] + offsetY);
+            task->segments.push_back(lx2/sampleSize);
+            task->segments.push_back(lz2/sampleSize);
+            task->segments.push_back(punkty[i+4] + offsetY);
+        }
+    }
+
+    // only the tiles of this corridor are waited for, not the global pool
+    QThreadPool pool;
+    foreach (TerrainCorridorTask *task, tasks)
+        pool.start(task);
+    pool.waitForDone();
+
+    // one refresh and one network update per tile
+    int x0, z0, x1, z1;
+    foreach (TerrainCorridorTask *task, tasks){
+        task->terrain->setModified(true);
+        task->terrain->getDirtyRect(x0, z0, x1, z1);
+        updateTerrainHeightmap(task->terrain, x0, z0, x1, z1);
+        task->terrain->refreshDirty(true);
+        delete task;
+    }
+    if(Game::debugOutput) qDebug() << "corridor tiles" << tasks.size();
+}
+
 void TerrainLibQt::setTerrainTexture(Brush* brush, int x, int z, float* p) {
     float posx = p[0];
     float posz = p[2];
@@ -820,12 +932,16 @@ QSet<Terrain*> TerrainLibQt::paintHeightMap(Brush* brush, int x, int z, float* p
                         terr->terrainData[tpz][tpx] = hAvg;
                 }
             }
+            terr->markDirty(tpx, tpz);
         }
     
+    // only the brush area is rebuilt and sent, edges follow the adjacent tiles
+    int x0, z0, x1, z1;
     foreach (Terrain *value, uterr){
         value->setModified(true);
-        value->refresh();
-        updateTerrainHeightmap(value);
+        value->getDirtyRect(x0, z0, x1, z1);
+        updateTerrainHeightmap(value, x0, z0, x1, z1);
+        value->refreshDirty(uterr.size() > 1);
     }
     return uterr;
 }
@@ -38,6 +38,7 @@ public:
     void getRotation(float *rot, int x, int z, float posx, float posz);
     void setHeight(int x, int z, float posx, float posz, float h);
     void fillHeightMap(int x, int z, float *data);
+    void fillHeights(int x, int z, QVector<Vector4f> &points);
     void fillWaterLevels(float *w, int mojex, int mojez);
     void setWaterLevels(float *w, int mojex, int mojez);
     Terrain* setHeight256(int x, int z, int posx, int posz, float h);
@@ -59,6 +60,7 @@ public:
     void setTileBlob(int x, int z, float* p);
     void setTextureToTrackObj(Brush* brush, float* punkty, int length, int x, int z);
     void setTerrainToTrackObj(Brush* brush, float* punkty, int length, int x, int z, float* matrix, float offsetY = 0);
+    void setTerrainToTrackCorridor(Brush* brush, float* punkty, int length, int x, int z, float offsetY = 0);
     int getTexture(int x, int z, float* p);
     bool load(int x, int z);
     void getUnsavedInfo(QVector<QString> &items);
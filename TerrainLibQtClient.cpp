@@ -27,6 +27,10 @@ void TerrainLibQtClient::updateTerrainHeightmap(Terrain *t){
     Game::serverClient->updateTerrainHeightmap(t);
 }
 
+void TerrainLibQtClient::updateTerrainHeightmap(Terrain *t, int x0, int z0, int x1, int z1){
+    Game::serverClient->updateTerrainHeightmap(t, x0, z0, x1, z1);
+}
+
 void TerrainLibQtClient::updateTerrainTFile(Terrain *t){
     Game::serverClient->updateTerrainTFile(t);
 }
@@ -42,9 +46,10 @@ Terrain* TerrainLibQtClient::getTerrainByXY(int x, int y, bool load) {
 
     if (terrainNameId == 0)
         return NULL;
-    if ((*currentQt)[terrainNameId] != NULL) {
-        if((*currentQt)[terrainNameId]->t != NULL)
-            return (*currentQt)[terrainNameId]->t;
+    TerrainInfo *info = currentQt->value(terrainNameId, NULL);
+    if (info != NULL) {
+        if(info->t != NULL)
+            return info->t;
     }
     if (load) {
         (*currentQt)[terrainNameId] = new TerrainInfo();
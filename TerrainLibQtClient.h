@@ -20,6 +20,7 @@ public:
     virtual ~TerrainLibQtClient();
     Terrain* getTerrainByXY(int x, int y, bool load = false);
     void updateTerrainHeightmap(Terrain *t);
+    void updateTerrainHeightmap(Terrain *t, int x0, int z0, int x1, int z1);
     void updateTerrainTFile(Terrain *t);
 private:
 
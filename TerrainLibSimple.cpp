@@ -661,6 +661,7 @@ QSet<Terrain*> TerrainLibSimple::paintHeightMap(Brush* brush, int x, int z, floa
     h = brush->alpha*brush->direction*10.0;
     if(brush->hType == 1){
         terr->terrainData[(pz+1024)/8][(px+1024)/8] += h;
+        terr->markDirty((px+1024)/8, (pz+1024)/8);
         //float rh = brush->alpha*brush->direction*10.0;
         rd = terr->terrainData[(pz+1024)/8][(px+1024)/8];
     }
@@ -735,11 +736,12 @@ QSet<Terrain*> TerrainLibSimple::paintHeightMap(Brush* brush, int x, int z, floa
                         terr->terrainData[tpz][tpx] = hAvg;
                 }
             }
+            terr->markDirty(tpx, tpz);
         }
     
     foreach (Terrain* value, uterr){
         value->setModified(true);
-        value->refresh();
+        value->refreshDirty(uterr.size() > 1);
     }
     //terr->setModified(true);
     //terr->refresh();
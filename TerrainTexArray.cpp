@@ -0,0 +1,168 @@
+/*  This file is part of TSRE5.
+ *
+ *  TSRE5 - train sim game engine and MSTS/OR Editors. 
+ *  Copyright (C) 2016 Piotr Gadecki <pgadecki@gmail.com>
+ *
+ *  Licensed under GNU General Public License 3.0 or later. 
+ *
+ *  See LICENSE.md or https://www.gnu.org/licenses/gpl.html
+ */
+
+#include "TerrainTexArray.h"
+#include "TexLib.h"
+#include "Game.h"
+#include "InitScheduler.h"
+#include <QDebug>
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
+#include <QImage>
+
+static const int MaxLayerSize = 2048;
+
+TerrainTexArray::TerrainTexArray() {
+}
+
+TerrainTexArray::~TerrainTexArray() {
+    if(QOpenGLContext::currentContext() == NULL)
+        return;
+    QOpenGLExtraFunctions *f = QOpenGLContext::currentContext()->extraFunctions();
+    if(tex != 0)
+        f->glDeleteTextures(1, &tex);
+    if(fbo[0] != 0)
+        f->glDeleteFramebuffers(2, fbo);
+}
+
+// Layers for all given textures, copied again where the texture changed.
+// False while one of them is not loaded yet.
+bool TerrainTexArray::update(const QVector<int> &texIds){
+    QVector<int> used;
+    int needSize = 0;
+    int newIds = 0;
+    for(int i = 0; i < texIds.size(); i++){
+        if(used.contains(texIds[i]))
+            continue;
+        Texture *t = TexLib::mtex[texIds[i]];
+        if(t == NULL || !t->loaded || !t->glLoaded)
+            return false;
+        needSize = qMax(needSize, qMax(t->width, t->height));
+        if(!layers.contains(texIds[i]))
+            newIds++;
+        used.push_back(texIds[i]);
+    }
+    needSize = qMin(needSize, MaxLayerSize);
+
+    // unused layers are dropped only when the array is made again
+    if(tex == 0 || needSize > size || layers.size() + newIds > capacity)
+        if(!allocate(qMax(needSize, size), ((used.size() + 15) / 16) * 16))
+            return false;
+
+    for(int i = 0; i < used.size(); i++){
+        Texture *t = TexLib::mtex[used[i]];
+        int layer = layers.value(used[i], -1);
+        if(layer < 0){
+            layer = layers.size();
+            layers[used[i]] = layer;
+            slots[layer].texId = used[i];
+            slots[layer].glTex = 0;
+        }
+        Layer &s = slots[layer];
+        if(s.glTex != t->tex[0] || s.version != t->version)
+            copyLayer(layer, used[i]);
+    }
+    return true;
+}
+
+int TerrainTexArray::getLayer(int texId){
+    return layers.value(texId, -1);
+}
+
+void TerrainTexArray::bind(){
+    QOpenGLExtraFunctions *f = QOpenGLContext::currentContext()->extraFunctions();
+    f->glActiveTexture(GL_TEXTURE4);
+    f->glBindTexture(GL_TEXTURE_2D_ARRAY, tex);
+    f->glActiveTexture(GL_TEXTURE0);
+}
+
+bool TerrainTexArray::allocate(int size, int capacity){
+    QOpenGLExtraFunctions *f = QOpenGLContext::currentContext()->extraFunctions();
+    GLint maxLayers = 0;
+    f->glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+    if(capacity > maxLayers)
+        return false;
+    if(tex == 0)
+        f->glGenTextures(1, &tex);
+    if(fbo[0] == 0)
+        f->glGenFramebuffers(2, fbo);
+    f->glBindTexture(GL_TEXTURE_2D_ARRAY, tex);
+    f->glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, size, size, capacity, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    // same sampling as the patch textures
+    f->glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    f->glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    f->glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    f->glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    f->glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    InitScheduler::AddUploadBytes((long long int)size * size * 4 * capacity);
+
+    this->size = size;
+    this->capacity = capacity;
+    layers.clear();
+    slots.fill(Layer(), capacity);
+    if(Game::debugOutput) qDebug() << "terrain texture array" << size << "x" << size << "layers" << capacity;
+    return true;
+}
+
+// Blit on the GPU, so ACE, DDS and painted textures are copied the same
+// way whatever their format and size.
+void TerrainTexArray::copyLayer(int layer, int texId){
+    QOpenGLExtraFunctions *f = QOpenGLContext::currentContext()->extraFunctions();
+    Texture *t = TexLib::mtex[texId];
+    if(t->compressedFormat != 0){
+        copyCompressedLayer(layer, texId);
+        return;
+    }
+    GLint drawFbo = 0, readFbo = 0;
+    f->glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &drawFbo);
+    f->glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &readFbo);
+    bool scissor = f->glIsEnabled(GL_SCISSOR_TEST);
+    if(scissor)
+        f->glDisable(GL_SCISSOR_TEST);
+
+    f->glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo[0]);
+    f->glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, t->tex[0], 0);
+    f->glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo[1]);
+    f->glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, tex, 0, layer);
+    f->glBlitFramebuffer(0, 0, t->width, t->height, 0, 0, size, size, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    f->glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+    f->glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, 0, 0, 0);
+
+    f->glBindFramebuffer(GL_READ_FRAMEBUFFER, readFbo);
+    f->glBindFramebuffer(GL_DRAW_FRAMEBUFFER, drawFbo);
+    if(scissor)
+        f->glEnable(GL_SCISSOR_TEST);
+
+    slots[layer].texId = texId;
+    slots[layer].glTex = t->tex[0];
+    slots[layer].version = t->version;
+}
+
+// Compressed textures can not be read by a framebuffer, they are read
+// back decoded and scaled on the CPU.
+void TerrainTexArray::copyCompressedLayer(int layer, int texId){
+    QOpenGLExtraFunctions *f = QOpenGLContext::currentContext()->extraFunctions();
+    Texture *t = TexLib::mtex[texId];
+    QImage img(t->width, t->height, QImage::Format_RGBA8888);
+    glBindTexture(GL_TEXTURE_2D, t->tex[0]);
+    f->glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, img.bits());
+    if(img.width() != size || img.height() != size)
+        img = img.scaled(size, size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+
+    f->glBindTexture(GL_TEXTURE_2D_ARRAY, tex);
+    f->glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, size, size, 1, GL_RGBA, GL_UNSIGNED_BYTE, img.constBits());
+    f->glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    InitScheduler::AddUploadBytes((long long int)size * size * 4);
+
+    slots[layer].texId = texId;
+    slots[layer].glTex = t->tex[0];
+    slots[layer].version = t->version;
+}
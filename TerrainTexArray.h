@@ -0,0 +1,46 @@
+/*  This file is part of TSRE5.
+ *
+ *  TSRE5 - train sim game engine and MSTS/OR Editors. 
+ *  Copyright (C) 2016 Piotr Gadecki <pgadecki@gmail.com>
+ *
+ *  Licensed under GNU General Public License 3.0 or later. 
+ *
+ *  See LICENSE.md or https://www.gnu.org/licenses/gpl.html
+ */
+
+#ifndef TERRAINTEXARRAY_H
+#define TERRAINTEXARRAY_H
+
+#include <QHash>
+#include <QVector>
+
+// Patch textures of one terrain tile copied into the layers of one array
+// texture, so all patches are drawn without a bind between them. Layers
+// are copied on the GPU from the patch textures and copied again when a
+// texture is painted or replaced.
+class TerrainTexArray {
+public:
+    TerrainTexArray();
+    virtual ~TerrainTexArray();
+    bool update(const QVector<int> &texIds);
+    int getLayer(int texId);
+    void bind();
+
+private:
+    struct Layer {
+        int texId;
+        unsigned int glTex;
+        int version;
+    };
+    unsigned int tex = 0;
+    unsigned int fbo[2] = {0, 0};
+    int size = 0;
+    int capacity = 0;
+    QHash<int, int> layers;
+    QVector<Layer> slots;
+    bool allocate(int size, int capacity);
+    void copyLayer(int layer, int texId);
+    void copyCompressedLayer(int layer, int texId);
+};
+
+#endif /* TERRAINTEXARRAY_H */
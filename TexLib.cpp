@@ -87,6 +87,7 @@ int TexLib::getTex(QString pathid) {
 int TexLib::addTex(QString pathid, bool reload) {
     
     Texture* newFile = NULL;
+    int texId = 0;
     for ( auto it = mtex.begin(); it != mtex.end(); ++it ){
         if(it->second == NULL) continue;
         for(int i = 0; i < ((Texture*) it->second)->hashid.size(); i++)
@@ -97,6 +98,7 @@ int TexLib::addTex(QString pathid, bool reload) {
                         return (int)it->first;
                     } else {
                         newFile = ((Texture*) it->second);
+                        texId = (int)it->first;
                         break;
                     }
                 }
@@ -147,7 +149,6 @@ int TexLib::addTex(QString pathid, bool reload) {
     }        
         
     
-    int texId = 0;
     if(newFile == NULL){
         newFile = new Texture(pathid);
         newFile->ref++;
@@ -182,7 +183,10 @@ int TexLib::addTex(QString pathid, bool reload) {
     } else if(tType == ":maptex"){
         MapLib* t = new MapLib();
         t->texture = newFile;
-        t->start();
+        if(!reload)
+            t->start();
+        else
+            t->run();
     }
     //AceLib::LoadACE(newFile);
     //tConcurrent::run();
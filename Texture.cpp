@@ -17,6 +17,7 @@
 #include <QColor>
 #include "GLUU.h"
 #include "Game.h"
+#include "InitScheduler.h"
 
 Texture::Texture() {
 }
@@ -351,14 +352,16 @@ void Texture::update(){
     //QOpenGLFunctions *f = QOpenGLContext::currentContext()->functions();
     glBindTexture(GL_TEXTURE_2D, tex[0]);
     glTexImage2D(GL_TEXTURE_2D, 0, type, width, height, 0, type, GL_UNSIGNED_BYTE, imageData);
+    if(compressedFormat != 0){
+        // the compressed mips below no longer match the painted level
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        compressedFormat = 0;
+    }
+    version++;
 }
 
-Texture::~Texture() {
-}
-
-bool Texture::GLTextures(bool mipmaps) {
-    if(!loaded) return false;
-    
+void Texture::removeBorderAlpha(){
     if(Game::AASamples > 0 && Game::AARemoveBorder)
         if(type == GL_RGBA){
             for (int i = 0; i < height; i++)
@@ -370,18 +373,40 @@ bool Texture::GLTextures(bool mipmaps) {
             for (int i = 0; i < width; i++)
                 imageData[i*bytesPerPixel + 3] = 0;
         }
+}
+
+Texture::~Texture() {
+}
 
+bool Texture::GLTextures(bool mipmaps) {
+    if(!loaded) return false;
+    
     tex = new unsigned int[1];
     QOpenGLFunctions *f = QOpenGLContext::currentContext()->functions();
     
     glGenTextures(1, tex);
     glBindTexture(GL_TEXTURE_2D, tex[0]);
-    glTexImage2D(GL_TEXTURE_2D, 0, type, width, height, 0, type, GL_UNSIGNED_BYTE, imageData);
+    if(compressedFormat != 0){
+        // levels made by the loader, the first one only without mipmaps
+        int levels = mipmaps ? compressedLevels.size() : 1;
+        for(int i = 0; i < levels; i++){
+            f->glCompressedTexImage2D(GL_TEXTURE_2D, i, compressedFormat, qMax(width >> i, 1), qMax(height >> i, 1), 0,
+                    compressedLevels[i].size(), compressedLevels[i].constData());
+            InitScheduler::AddUploadBytes(compressedLevels[i].size());
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+        compressedLevels.clear();
+    } else {
+        removeBorderAlpha();
+        glTexImage2D(GL_TEXTURE_2D, 0, type, width, height, 0, type, GL_UNSIGNED_BYTE, imageData);
+        InitScheduler::AddUploadBytes((long long int)bytesPerPixel * width * height);
+        if(mipmaps)
+            f->glGenerateMipmap(GL_TEXTURE_2D);
+    }
     
     //f->glTexStorage2D(GL_TEXTURE_2D, 4, GL_RGBA8, width, height);
     //f->glTexSubImage2D(GL_TEXTURE_2D, 0​, 0, 0, width​, height​, GL_BGRA, GL_UNSIGNED_BYTE, pixels);
     if(mipmaps){
-        f->glGenerateMipmap(GL_TEXTURE_2D);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,  GL_LINEAR_MIPMAP_LINEAR );
     } else {
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,  GL_LINEAR );
@@ -393,6 +418,7 @@ bool Texture::GLTextures(bool mipmaps) {
     imageData = NULL;
     this->editable = false;
     glLoaded = true;
+    version++;
     return true;
 }
 
@@ -404,6 +430,8 @@ void Texture::delVBO() {
     editable = false;
     missing = false;
     error = false;
+    compressedFormat = 0;
+    compressedLevels.clear();
     //gl.glDeleteTextures(1, tex, 0);
 }
 
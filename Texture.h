@@ -13,6 +13,7 @@
 
 #include <QString>
 #include <QVector>
+#include <QByteArray>
 
 class Brush;
 
@@ -40,13 +41,20 @@ public:
     bool loaded = false;
     int ref = 0;
     bool glLoaded = false;
+    // changed with every upload, copies of the texture follow it
+    int version = 0;
     bool editable = false;
     bool missing = false;
     bool error = false;
+    // mip levels compressed by the loader thread, GLTextures only uploads
+    // them; zero again once the texture is painted
+    unsigned int compressedFormat = 0;
+    QVector<QByteArray> compressedLevels;
 
     void setEditable();
     bool GLTextures(bool mipmaps = false);
     void update();
+    void removeBorderAlpha();
     void advancedCrop(float *texCoords, int w = 0, int h = 0);
     void crop(float x1, float y1, float x2, float y2);
     void paint(Brush* brush, float x, float z);
@@ -29,6 +29,7 @@
 #include <QString>
 #include <QDebug>
 #include <QFile>
+#include <QDateTime>
 #include "GLUU.h"
 #include "GLMatrix.h"
 #include "TS.h"
@@ -38,6 +39,8 @@
 #include "ErrorMessage.h"
 #include "Renderer.h"
 #include "Trk.h"
+#include "StaticBatch.h"
+#include "Intersections.h"
 #include "Route.h"
 
 Tile::Tile() {
@@ -88,6 +91,8 @@ Tile::Tile(const Tile& orig) {
 }
 
 Tile::~Tile() {
+    delete staticBatch;
+    delete proxyBatch;
 }
 
 QString Tile::getNameXY(int e) {
@@ -759,6 +764,38 @@ void Tile::saveWS() {
     
 }
 
+// Give objects consecutive UiDs in file order. Track objects that changed
+// are added to trackObjUpdates as {x, z, old UiD, x, z, new UiD} for TDB::updateUiDs.
+int Tile::renumberUiDs(QVector<int*> &trackObjUpdates){
+    int uid = 0;
+    int changed = 0;
+    for (int i = 0; i < jestObiektow; i++) {
+        WorldObj* obj = obiekty[i];
+        if(obj == NULL) continue;
+        if(!obj->loaded) continue;
+        if(obj->isSoundItem()) continue;
+        uid++;
+        if(obj->UiD == uid) continue;
+        if(obj->typeID == obj->trackobj || obj->typeID == obj->dyntrack){
+            int *u = new int[6];
+            u[0] = x;
+            u[1] = z;
+            u[2] = obj->UiD;
+            u[3] = x;
+            u[4] = z;
+            u[5] = uid;
+            trackObjUpdates.push_back(u);
+        }
+        obj->UiD = uid;
+        obj->modified = true;
+        changed++;
+    }
+    maxUiD = uid;
+    if(changed > 0)
+        modified = true;
+    return changed;
+}
+
 bool Tile::isModified(){
     bool value = this->modified;
     
@@ -914,7 +951,58 @@ void Tile::pushRenderItems(float* playerT, float* playerW, float* target, float
     }
 }
 
-void Tile::render(float * playerT, float* playerW, float* target, float fov, int renderMode) {
+// Bounds of the objects, made again at most once a second so that moved
+// objects are followed without walking the tile every frame.
+void Tile::updateBounds() {
+    unsigned long long int now = QDateTime::currentMSecsSinceEpoch();
+    if (boundsTime != 0 && now < boundsTime + 1000)
+        return;
+    boundsTime = now;
+    bounds[0] = bounds[1] = bounds[2] = 1e30f;
+    bounds[3] = bounds[4] = bounds[5] = -1e30f;
+    internalLodObjects = false;
+    for (auto it = obiekty.begin(); it != obiekty.end(); ++it) {
+        WorldObj* obj = it->second;
+        if (obj == NULL || !obj->loaded)
+            continue;
+        if (obj->isInternalLodControl())
+            internalLodObjects = true;
+        // size is not known until the shape is loaded
+        float size = obj->size > 0 ? obj->size : 200;
+        for (int k = 0; k < 3; k++) {
+            bounds[k] = qMin(bounds[k], obj->position[k] - size);
+            bounds[k+3] = qMax(bounds[k+3], obj->position[k] + size);
+        }
+    }
+}
+
+// Hidden when the objects are out of view or beyond objectLod, Far when
+// the tile covers less than tileProxySize pixels and a proxy can be used.
+int Tile::getVisibility(float *pvMatrix, float *playerT, float *playerW, float pixelScale) {
+    updateBounds();
+    // rulers and spawners draw themselves, whatever the distance
+    if (internalLodObjects)
+        return Near;
+    if (bounds[0] > bounds[3])
+        return Hidden;
+    if (!Intersections::boxInFrustum(bounds, pvMatrix))
+        return Hidden;
+    float cx = playerW[0] - (x - playerT[0])*2048;
+    float cz = playerW[2] - (z - playerT[1])*2048;
+    float dx = qMax(qMax(bounds[0] - cx, cx - bounds[3]), 0.0f);
+    float dz = qMax(qMax(bounds[2] - cz, cz - bounds[5]), 0.0f);
+    float dist = sqrt(dx * dx + dz * dz);
+    if (dist > Game::objectLod)
+        return Hidden;
+    if (!Game::tileProxies || dist <= 0)
+        return Near;
+    float radius = 0.5 * sqrt((bounds[3] - bounds[0])*(bounds[3] - bounds[0]) + (bounds[5] - bounds[2])*(bounds[5] - bounds[2]));
+    if (radius / dist * pixelScale < Game::tileProxySize)
+        return Far;
+    return Near;
+}
+
+void Tile::render(float * playerT, float* playerW, float* target, float fov, int renderMode, bool distant) {
     if (loaded != 1) return;
     GLUU* gluu = GLUU::get();
     //gl.activeTexture(gl.TEXTURE0);
@@ -922,9 +1010,25 @@ void Tile::render(float * playerT, float* playerW, float* target, float fov, int
     //this.obiekty.forEach(function(obj) {
     int selectionColor = 0;
     float lodx, lodz, lod;
+    // overlays and selection colors are drawn per object
+    bool batched = false;
+    StaticBatch* batch = NULL;
+    if (distant && Game::tileProxies && renderMode == gluu->RENDER_DEFAULT && !Game::viewSnapable && !Game::showWorldObjPivotPoints) {
+        if (proxyBatch == NULL)
+            proxyBatch = new StaticBatch(this, true);
+        batch = proxyBatch;
+    } else if (Game::staticBatching && renderMode == gluu->RENDER_DEFAULT && !Game::viewSnapable && !Game::showWorldObjPivotPoints) {
+        if (staticBatch == NULL)
+            staticBatch = new StaticBatch(this);
+        batch = staticBatch;
+    }
+    if (batch != NULL)
+        batched = batch->render(gluu, playerT, playerW);
     for (int i = 0; i < jestObiektow; i++) {
         if(obiekty[i] == NULL) continue;
         if (obiekty[i]->loaded) {
+            if (batched && batch->skip(obiekty[i]))
+                continue;
             lodx = (x - playerT[0])*2048 + obiekty[i]->position[0] - playerW[0];
             lodz = (z - playerT[1])*2048 + obiekty[i]->position[2] - playerW[2];
             //console.log(this.x);
@@ -960,6 +1064,8 @@ void Tile::render(float * playerT, float* playerW, float* target, float fov, int
             }
         }
     }
+    if (batched)
+        batch->endFrame();
     
     /*for (int i = 0; i < jestObiektowWS; i++) {
         if (obiektyWS[i]->loaded) {//
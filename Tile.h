@@ -17,9 +17,15 @@
 #include "Ref.h"
 
 class GroupObj;
+class StaticBatch;
 
 class Tile {
 public:
+    enum Visibility {
+        Hidden = 0,
+        Near = 1,
+        Far = 2
+    };
     struct ViewDbSphere {
         int vDbId;
 	float position[3];
@@ -41,6 +47,8 @@ public:
     //int jestObiektowWS = 0;
     int jestHiddenObj = 0;
     std::unordered_map<int, WorldObj*> obiekty;
+    // box of all objects in tile coordinates, min xyz then max xyz
+    float bounds[6];
     //std::unordered_map<int, WorldObj*> obiektyWS;
     Tile();
     Tile(int xx, int zz);
@@ -73,9 +81,11 @@ public:
     void updateSim(float deltaTime);
     void findSimilar(WorldObj* obj, GroupObj* group);
     void checkForErrors();
+    int renumberUiDs(QVector<int*> &trackObjUpdates);
     void render();
     void pushRenderItems(float *  playerT, float* playerW, float* target, float fov, int renderMode);
-    void render(float *  playerT, float* playerW, float* target, float fov, int renderMode);
+    void render(float *  playerT, float* playerW, float* target, float fov, int renderMode, bool distant = false);
+    int getVisibility(float *pvMatrix, float *playerT, float *playerW, float pixelScale);
     //void renderWS(float *  playerT, float* playerW, float* target, float fov, int renderMode);
     void save();
     void saveToStream(QTextStream &out);
@@ -85,6 +95,11 @@ private:
     int maxUiDWS = 100000;    
     bool modified;
     QString* viewDbSphereRaw = NULL;
+    StaticBatch* staticBatch = NULL;
+    StaticBatch* proxyBatch = NULL;
+    bool internalLodObjects = false;
+    unsigned long long int boundsTime = 0;
+    void updateBounds();
     void wczytajObiekty();
     void saveWS();
 };
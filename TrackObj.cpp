@@ -57,6 +57,7 @@ WorldObj* TrackObj::clone(){
 }
 
 TrackObj::~TrackObj() {
+    ProceduralShape::Release(procShape);
 }
 
 int TrackObj::updateTrackSectionInfo(QHash<unsigned int,unsigned int> shapes, QHash<unsigned int,unsigned int> sect){
@@ -131,10 +132,20 @@ void TrackObj::reload(){
         Game::currentShapeLib->shape[shape]->reload();
     } else {
         proceduralShapeInit = false;
-        procShape.clear();
+        ProceduralShape::Release(procShape);
     }
 }
 
+bool TrackObj::bakeProceduralShape(){
+    if(roadShape || templateName == "DISABLED")
+        return false;
+    TrackShape *tsh = Game::trackDB->tsection->shape[sectionIdx];
+    QMap<int, float> angles;
+    if(Game::useSuperelevation)
+        Game::trackDB->fillTrackAngles(x, -y, UiD, angles);
+    return ProceduralShape::Bake(templateName, tsh, angles);
+}
+
 float TrackObj::getElevation(){
     float vect[3];
     vect[0] = 0; vect[1] = 0; vect [2] = 1000;
@@ -357,12 +368,15 @@ void TrackObj::pushRenderItems(float lod, float posx, float posz, float* playerW
             QMap<int, float> angles;
             if(Game::useSuperelevation)
                 Game::trackDB->fillTrackAngles(x, -y, UiD, angles);
-            ProceduralShape::GetShape(templateName, procShape, tsh, angles);
-            proceduralShapeInit = true;
-        } else {
+            proceduralShapeInit = ProceduralShape::GetShape(templateName, procShape, tsh, angles);
+        }
+        if (proceduralShapeInit) {
             for(int i = 0; i < procShape.size(); i++){
                 procShape[i]->pushRenderItem(selectionColor, lod);
             }
+        } else if(shapePointer != NULL){
+            // MSTS shape until the procedural one is generated
+            shapePointer->pushRenderItem(selectionColor, 0);
         }
     }
 
@@ -440,12 +454,15 @@ void TrackObj::render(GLUU* gluu, float lod, float posx, float posz, float* pos,
             QMap<int, float> angles;
             if(Game::useSuperelevation)
                 Game::trackDB->fillTrackAngles(x, -y, UiD, angles);
-            ProceduralShape::GetShape(templateName, procShape, tsh, angles);
-            proceduralShapeInit = true;
-        } else {
+            proceduralShapeInit = ProceduralShape::GetShape(templateName, procShape, tsh, angles);
+        }
+        if (proceduralShapeInit) {
             for(int i = 0; i < procShape.size(); i++){
                 procShape[i]->render(selectionColor, lod);
             }
+        } else {
+            // MSTS shape until the procedural one is generated
+            Game::currentShapeLib->shape[shape]->render(selectionColor, 0);
         }
     }
     
@@ -454,6 +471,17 @@ void TrackObj::render(GLUU* gluu, float lod, float posx, float posz, float* pos,
     }
 };
 
+bool TrackObj::getStaticBatchShape(SFile *&sfile, unsigned int &stateId){
+    if (!loaded || shape < 0 || jestPQ < 2 || selected)
+        return false;
+    // procedural shapes are drawn by the object
+    if (Game::proceduralTracks && !roadShape && !templateDisabled)
+        return false;
+    sfile = Game::currentShapeLib->shape[shape];
+    stateId = 0;
+    return sfile != NULL;
+}
+
 void TrackObj::fillJNodePosn(){
     TDB* tdb = Game::trackDB;
     setModified(tdb->fillJNodePosn(this->x, this->y, this->UiD, &this->jNodePosn));
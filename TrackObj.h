@@ -43,6 +43,8 @@ public:
     int updateTrackSectionInfo(QHash<unsigned int, unsigned int> shapes, QHash<unsigned int, unsigned int> sect);
     void pushRenderItems(float lod, float posx, float posz, float* playerW, float* target, float fov, int selectionColor);
     void render(GLUU* gluu, float lod, float posx, float posz, float* playerW, float* target, float fov, int selectionColor, int renderMode);
+    bool getStaticBatchShape(SFile *&sfile, unsigned int &stateId);
+    bool bakeProceduralShape();
     QVector<std::array<float, 5>> jNodePosn;
     void fillJNodePosn();
     void setElevation(float prom);
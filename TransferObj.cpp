@@ -20,6 +20,7 @@
 #include "TerrainLib.h"
 #include <QOpenGLShaderProgram>
 #include "Game.h"
+#include "InitScheduler.h"
 #include "TS.h"
 #include "Ref.h"
 
@@ -253,10 +254,9 @@ void TransferObj::reload(){
 void TransferObj::drawShape(int selectionColor){
 
     if (!init) {
-        if(!Game::ignoreLoadLimits){
-            if(Game::allowObjLag < 1)  return;
-            Game::allowObjLag-=2;
-        }
+        bool scheduled = !Game::ignoreLoadLimits;
+        if(scheduled && !InitScheduler::Allow(this, GLUU::get()->mvMatrix, qMax(width, height) * 0.5f))
+            return;
         
             GLUU* gluu = GLUU::get();
             float alpha = -gluu->alphaTest;
@@ -364,6 +364,8 @@ void TransferObj::drawShape(int selectionColor){
         shape.setMaterial(texturePath);
         shape.init(punkty, ptr, RenderItem::VNTA, GL_TRIANGLES);
         delete[] punkty;
+        if(scheduled)
+            InitScheduler::Done();
         init = true;
     }
     
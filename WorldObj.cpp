@@ -384,6 +384,12 @@ bool WorldObj::isInternalLodControl(){
     return internalLodControl;
 }
 
+// Shape drawn as is at the object matrix, so it can go to the static
+// batch of its tile; objects with their own drawing return false.
+bool WorldObj::getStaticBatchShape(SFile *&, unsigned int &){
+    return false;
+}
+
 void WorldObj::setInternalLodControl(bool val){
     internalLodControl = val;
 }
@@ -169,6 +169,7 @@ public:
     virtual QString getTemplate();
     virtual void setTemplate(QString name);
     virtual bool isInternalLodControl();
+    virtual bool getStaticBatchShape(SFile *&sfile, unsigned int &stateId);
     virtual void setInternalLodControl(bool val);
     virtual void loadingFixes();
     virtual void setModified(bool val = true);
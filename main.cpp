@@ -26,6 +26,8 @@
 #include "MapWindow.h"
 #include "RouteEditorServer.h"
 #include "RouteEditorClient.h"
+#include "RouteBatch.h"
+#include "SyntheticRoute.h"
 #include "Undo.h"
 
 QFile logFile;
@@ -190,6 +192,13 @@ void RunRouteEditorServer(){
     //..server->run();
 }
 
+int RunRouteBatch(QString jobs, QString reportPath){
+    Game::loadAllWFiles = true;
+    Game::gui = false;
+    RouteBatch batch;
+    return batch.run(jobs.split(","), reportPath);
+}
+
 enum CommandLineParseResult {
     CommandLineOk,
     CommandLineError,
@@ -221,6 +230,12 @@ CommandLineParseResult parseCommandLineArgs(QCommandLineParser &parser){
     parser.addOption(PlayOption);
     const QCommandLineOption ServerOption("server", "Run Editor Server.");
     parser.addOption(ServerOption);
+    const QCommandLineOption BatchOption("batch", "Run jobs without gui: check,resave,renumber,terrain,benchmark,bake.", "jobs");
+    parser.addOption(BatchOption);
+    const QCommandLineOption ReportOption("report", "JSON report file for batch jobs.", "file");
+    parser.addOption(ReportOption);
+    const QCommandLineOption SyntheticOption("synthetic", "Create a generated route of size x size tiles first, for benchmark.", "size");
+    parser.addOption(SyntheticOption);
     
     if (!parser.parse(QCoreApplication::arguments())) {
         return CommandLineError;
@@ -265,6 +280,15 @@ CommandLineParseResult parseCommandLineArgs(QCommandLineParser &parser){
     if (parser.isSet(ServerOption)) {
         consoleArgs["SERVER"] = "TRUE";
     }
+    if (parser.isSet(BatchOption)) {
+        consoleArgs["BATCH"] = parser.value(BatchOption);
+    }
+    if (parser.isSet(ReportOption)) {
+        consoleArgs["REPORT"] = parser.value(ReportOption);
+    }
+    if (parser.isSet(SyntheticOption)) {
+        consoleArgs["SYNTHETIC"] = parser.value(SyntheticOption);
+    }
     
     return CommandLineOk;
 }
@@ -305,6 +329,11 @@ int main(int argc, char *argv[]){
     QApplication::setAttribute(Qt::AA_EnableHighDpiScaling, true);
     QApplication::setApplicationName(Game::AppName);
     QApplication::setApplicationVersion(Game::AppVersion);
+    // batch jobs run on machines without a display
+    for(int i = 1; i < argc; i++)
+        if(qstrcmp(argv[i], "-batch") == 0 || qstrcmp(argv[i], "--batch") == 0)
+            if(qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+                qputenv("QT_QPA_PLATFORM", "offscreen");
     //QApplication::pr
     QApplication app(argc, argv);
     
@@ -449,6 +478,13 @@ int main(int argc, char *argv[]){
         RunRouteEditorServer();
         return app.exec();
     }
+    if(consoleArgs["BATCH"].length() > 0){
+        if(consoleArgs["SYNTHETIC"].length() > 0)
+            SyntheticRoute::Create(consoleArgs["SYNTHETIC"].toInt());
+        Game::checkRoute(Game::route);
+        qDebug() << "Run batch" << consoleArgs["BATCH"];
+        return RunRouteBatch(consoleArgs["BATCH"], consoleArgs["REPORT"]);
+    }
         
     // Run route editor   //// EFO Detour
      LoadRouteEditor();
@@ -8,8 +8,8 @@ CONFIG -= debug_and_release app_bundle lib_bundle
 CONFIG += debug 
 PKGCONFIG +=
 QT = core gui widgets network opengl
-SOURCES += AboutWindow.cpp AceLib.cpp ActLib.cpp Activity.cpp ActivityEvent.cpp ActivityEventProperties.cpp ActivityEventWindow.cpp ActivityObject.cpp ActivityServiceProperties.cpp ActivityServiceWindow.cpp ActivityTimetable.cpp ActivityTimetableProperties.cpp ActivityTimetableWindow.cpp ActivityTools.cpp ActivityTrafficProperties.cpp ActivityTrafficWindow.cpp Brush.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ComplexLine.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ConInfoWidget.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ContentHierarchyInfo.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/EngInfoWidget.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/GlobalDefinitions.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/GuiGlCompass.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/MstsSoundDefinition.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ShapeHierarchyInfo.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ShapeHierarchyWindow.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ShapeInfoWidget.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ShapeTemplates.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ShapeTextureInfo.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ShapeTexturesWindow.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ShapeViewerNavigatorWidget.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ShapeViewerWindow.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/SimpleHud.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/Skydome.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/SoundLib.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/SoundSource.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/SoundVariables.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/TarFile.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/UriImageDrawThread.cpp CELoadWindow.cpp Camera.cpp CameraConsist.cpp CameraFree.cpp CameraRot.cpp CarSpawnerObj.cpp ChooseFileDialog.cpp ClickableLabel.cpp ConEditorWindow.cpp ConLib.cpp ConListWidget.cpp ConUnitsWidget.cpp Consist.cpp Coords.cpp CoordsGpx.cpp CoordsKml.cpp CoordsMkr.cpp CoordsRoutePlaces.cpp DynTrackObj.cpp EditFileNameDialog.cpp Eng.cpp EngLib.cpp EngListWidget.cpp Environment.cpp FileBuffer.cpp FileFunctions.cpp Flex.cpp ForestObj.cpp GLH.cpp GLMatrix.cpp GLUU.cpp Game.cpp GameObj.cpp GeoCoordinates.cpp GeoHgtFile.cpp GeoTerrainFile.cpp GeoTiffFile.cpp GeoTools.cpp GroupObj.cpp GuiFunct.cpp HazardObj.cpp HeightWindow.cpp ImageLib.cpp Intersections.cpp LevelCrObj.cpp LoadWindow.cpp MapData.cpp MapDataOSM.cpp MapDataUrlImage.cpp MapLib.cpp MapWindow.cpp NaviBox.cpp NaviWindow.cpp NewRouteWindow.cpp OSMFeatures.cpp ObjFile.cpp ObjTools.cpp OglObj.cpp OrtsWeatherChange.cpp OverwriteDialog.cpp PaintTexLib.cpp ParserX.cpp Path.cpp PickupObj.cpp PlatformObj.cpp PlayActivitySelectWindow.cpp Pointer3d.cpp PoleObj.cpp ProceduralMstsDyntrack.cpp ProceduralShape.cpp PropertiesAbstract.cpp PropertiesActivityObject.cpp PropertiesActivityPath.cpp PropertiesCarspawner.cpp PropertiesConsist.cpp PropertiesDyntrack.cpp PropertiesForest.cpp PropertiesGroup.cpp PropertiesLevelCr.cpp PropertiesPickup.cpp PropertiesPlatform.cpp PropertiesRuler.cpp PropertiesSiding.cpp PropertiesSignal.cpp PropertiesSoundRegion.cpp PropertiesSoundSource.cpp PropertiesSpeedpost.cpp PropertiesStatic.cpp PropertiesTerrain.cpp PropertiesTrackItem.cpp PropertiesTrackObj.cpp PropertiesTransfer.cpp PropertiesUndefined.cpp QuadTree.cpp RandomConsist.cpp ReadFile.cpp Ref.cpp Route.cpp RouteEditorGLWidget.cpp RouteEditorWindow.cpp Ruch.cpp RulerObj.cpp SFile.cpp SFileC.cpp SFileX.cpp Service.cpp Shader.cpp ShapeLib.cpp ShapeViewWindow.cpp ShapeViewerGLWidget.cpp SigCfg.cpp SignalObj.cpp SignalShape.cpp SignalType.cpp SignalWindow.cpp SignalWindowLink.cpp SoundList.cpp SoundManager.cpp SoundRegionObj.cpp SoundSourceObj.cpp SpeedPost.cpp SpeedPostDAT.cpp SpeedpostObj.cpp StaticObj.cpp TDB.cpp TFile.cpp TRitem.cpp TRnode.cpp TS.cpp TSection.cpp TSectionDAT.cpp Terrain.cpp TerrainInfo.cpp TerrainLib.cpp TerrainLibQt.cpp TerrainLibSimple.cpp TerrainTools.cpp TerrainTreeWindow.cpp TerrainWaterWindow.cpp TerrainWaterWindow2.cpp TexLib.cpp TextEditDialog.cpp TextObj.cpp Texture.cpp Tile.cpp TrWatermarkObj.cpp TrackItemObj.cpp TrackObj.cpp TrackShape.cpp Traffic.cpp TrainNetworkEng.cpp TransferObj.cpp TransformWorldObjDialog.cpp Trk.cpp TrkWindow.cpp Undo.cpp UnsavedDialog.cpp Vector2f.cpp Vector2i.cpp Vector3f.cpp Vector4f.cpp WorldObj.cpp main.cpp
-HEADERS += AboutWindow.h AceLib.h ActLib.h Activity.h ActivityEvent.h ActivityEventProperties.h ActivityEventWindow.h ActivityObject.h ActivityServiceProperties.h ActivityServiceWindow.h ActivityTimetable.h ActivityTimetableProperties.h ActivityTimetableWindow.h ActivityTools.h ActivityTrafficProperties.h ActivityTrafficWindow.h Brush.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ComplexLine.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ConInfoWidget.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ContentHierarchyInfo.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/EngInfoWidget.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/GlobalDefinitions.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/GuiGlCompass.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/MstsSoundDefinition.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ShapeHierarchyInfo.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ShapeHierarchyWindow.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ShapeInfoWidget.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ShapeTemplates.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ShapeTextureInfo.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ShapeTexturesWindow.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ShapeViewerNavigatorWidget.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ShapeViewerWindow.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/SimpleHud.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/Skydome.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/SoundLib.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/SoundSource.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/SoundVariables.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/TarFile.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/UriImageDrawThread.h CELoadWindow.h Camera.h CameraConsist.h CameraFree.h CameraRot.h CarSpawnerObj.h ChooseFileDialog.h ClickableLabel.h ConEditorWindow.h ConLib.h ConListWidget.h ConUnitsWidget.h Consist.h Coords.h CoordsGpx.h CoordsKml.h CoordsMkr.h CoordsRoutePlaces.h DynTrackObj.h EditFileNameDialog.h Eng.h EngLib.h EngListWidget.h Environment.h FileBuffer.h FileFunctions.h Flex.h ForestObj.h GLH.h GLMatrix.h GLUU.h Game.h GameObj.h GeoCoordinates.h GeoHgtFile.h GeoTerrainFile.h GeoTiffFile.h GeoTools.h GroupObj.h GuiFunct.h HazardObj.h HeightWindow.h ImageLib.h Intersections.h LevelCrObj.h LoadWindow.h MapData.h MapDataOSM.h MapDataUrlImage.h MapLib.h MapWindow.h NaviBox.h NaviWindow.h NewRouteWindow.h OSMFeatures.h ObjFile.h ObjTools.h OglObj.h OrtsWeatherChange.h OverwriteDialog.h PaintTexLib.h ParserX.h Path.h PickupObj.h PlatformObj.h PlayActivitySelectWindow.h Pointer3d.h PoleObj.h ProceduralMstsDyntrack.h ProceduralShape.h PropertiesAbstract.h PropertiesActivityObject.h PropertiesActivityPath.h PropertiesCarspawner.h PropertiesConsist.h PropertiesDyntrack.h PropertiesForest.h PropertiesGroup.h PropertiesLevelCr.h PropertiesPickup.h PropertiesPlatform.h PropertiesRuler.h PropertiesSiding.h PropertiesSignal.h PropertiesSoundRegion.h PropertiesSoundSource.h PropertiesSpeedpost.h PropertiesStatic.h PropertiesTerrain.h PropertiesTrackItem.h PropertiesTrackObj.h PropertiesTransfer.h PropertiesUndefined.h QuadTree.h RandomConsist.h ReadFile.h Ref.h Route.h RouteEditorGLWidget.h RouteEditorWindow.h Ruch.h RulerObj.h SFile.h SFileC.h SFileX.h Service.h Shader.h ShapeLib.h ShapeViewWindow.h ShapeViewerGLWidget.h SigCfg.h SignalObj.h SignalShape.h SignalType.h SignalWindow.h SignalWindowLink.h SoundList.h SoundManager.h SoundRegionObj.h SoundSourceObj.h SpeedPost.h SpeedPostDAT.h SpeedpostObj.h StaticObj.h TDB.h TFile.h TRitem.h TRnode.h TS.h TSection.h TSectionDAT.h Terrain.h TerrainInfo.h TerrainLib.h TerrainLibQt.h TerrainLibSimple.h TerrainTools.h TerrainTreeWindow.h TerrainWaterWindow.h TerrainWaterWindow2.h TexLib.h TextEditDialog.h TextObj.h Texture.h Tile.h TrWatermarkObj.h TrackItemObj.h TrackObj.h TrackShape.h Traffic.h TrainNetworkEng.h TransferObj.h TransformWorldObjDialog.h Trk.h TrkWindow.h Undo.h UnsavedDialog.h Vector2f.h Vector2i.h Vector3f.h Vector4f.h WorldObj.h
+SOURCES += AboutWindow.cpp AceLib.cpp ActLib.cpp Activity.cpp ActivityEvent.cpp ActivityEventProperties.cpp ActivityEventWindow.cpp ActivityObject.cpp ActivityServiceProperties.cpp ActivityServiceWindow.cpp ActivityTimetable.cpp ActivityTimetableProperties.cpp ActivityTimetableWindow.cpp ActivityTools.cpp ActivityTrafficProperties.cpp ActivityTrafficWindow.cpp Brush.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ComplexLine.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ConInfoWidget.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ContentHierarchyInfo.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/EngInfoWidget.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/GlobalDefinitions.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/GuiGlCompass.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/MstsSoundDefinition.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ShapeHierarchyInfo.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ShapeHierarchyWindow.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ShapeInfoWidget.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ShapeTemplates.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ShapeTextureInfo.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ShapeTexturesWindow.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ShapeViewerNavigatorWidget.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ShapeViewerWindow.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/SimpleHud.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/Skydome.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/SoundLib.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/SoundSource.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/SoundVariables.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/TarFile.cpp C:/Users/Goku/Documents/NetBeansProjects/TSRE5/UriImageDrawThread.cpp CELoadWindow.cpp Camera.cpp CameraConsist.cpp CameraFree.cpp CameraRot.cpp CarSpawnerObj.cpp ChooseFileDialog.cpp ClickableLabel.cpp ConEditorWindow.cpp ConLib.cpp ConListWidget.cpp ConUnitsWidget.cpp Consist.cpp Coords.cpp CoordsGpx.cpp CoordsKml.cpp CoordsMkr.cpp CoordsRoutePlaces.cpp DxtLib.cpp DynTrackObj.cpp EditFileNameDialog.cpp Eng.cpp EngIndex.cpp EngLib.cpp EngListWidget.cpp Environment.cpp FileBuffer.cpp FileFunctions.cpp Flex.cpp ForestObj.cpp GLH.cpp GLMatrix.cpp GLUU.cpp Game.cpp GameObj.cpp GeoCoordinates.cpp GeoHgtFile.cpp GeoTerrainFile.cpp GeoTerrainLib.cpp GeoTiffFile.cpp GeoTools.cpp GroupObj.cpp GuiFunct.cpp HazardObj.cpp HeightWindow.cpp ImageLib.cpp InitScheduler.cpp Intersections.cpp LevelCrObj.cpp LoadProfiler.cpp LoadWindow.cpp MapData.cpp MapDataOSM.cpp MapDataUrlImage.cpp MapLib.cpp MapTileBatch.cpp MapWindow.cpp NaviBox.cpp NaviWindow.cpp NewRouteWindow.cpp OSMFeatureStore.cpp OSMFeatures.cpp ObjFile.cpp ObjTools.cpp OglObj.cpp OrtsWeatherChange.cpp OverwriteDialog.cpp PaintTexLib.cpp ParserX.cpp Path.cpp PickupObj.cpp PlatformObj.cpp PlayActivitySelectWindow.cpp Pointer3d.cpp PoleObj.cpp ProceduralMstsDyntrack.cpp ProceduralShape.cpp ProceduralShapeCache.cpp PropertiesAbstract.cpp PropertiesActivityObject.cpp PropertiesActivityPath.cpp PropertiesCarspawner.cpp PropertiesConsist.cpp PropertiesDyntrack.cpp PropertiesForest.cpp PropertiesGroup.cpp PropertiesLevelCr.cpp PropertiesPickup.cpp PropertiesPlatform.cpp PropertiesRuler.cpp PropertiesSiding.cpp PropertiesSignal.cpp PropertiesSoundRegion.cpp PropertiesSoundSource.cpp PropertiesSpeedpost.cpp PropertiesStatic.cpp PropertiesTerrain.cpp PropertiesTrackItem.cpp PropertiesTrackObj.cpp PropertiesTransfer.cpp PropertiesUndefined.cpp QuadTree.cpp RandomConsist.cpp ReadFile.cpp Ref.cpp Route.cpp RouteBatch.cpp RouteChecker.cpp RouteEditorGLWidget.cpp RouteEditorWindow.cpp Ruch.cpp RulerObj.cpp SFile.cpp SFileC.cpp SFileX.cpp Service.cpp Shader.cpp ShapeLib.cpp ShapeViewWindow.cpp ShapeViewerGLWidget.cpp SigCfg.cpp SignalObj.cpp SignalShape.cpp SignalType.cpp SignalWindow.cpp SignalWindowLink.cpp SoundList.cpp SoundManager.cpp SoundRegionObj.cpp SoundSourceObj.cpp SpeedPost.cpp SpeedPostDAT.cpp SpeedpostObj.cpp StaticBatch.cpp StaticObj.cpp SyntheticRoute.cpp TDB.cpp TFile.cpp TRitem.cpp TRnode.cpp TS.cpp TSection.cpp TSectionDAT.cpp Terrain.cpp TerrainInfo.cpp TerrainLib.cpp TerrainLibQt.cpp TerrainLibSimple.cpp TerrainTexArray.cpp TerrainTools.cpp TerrainTreeWindow.cpp TerrainWaterWindow.cpp TerrainWaterWindow2.cpp TexLib.cpp TextEditDialog.cpp TextObj.cpp Texture.cpp Tile.cpp TrWatermarkObj.cpp TrackItemObj.cpp TrackObj.cpp TrackShape.cpp Traffic.cpp TrainNetworkEng.cpp TransferObj.cpp TransformWorldObjDialog.cpp Trk.cpp TrkWindow.cpp Undo.cpp UnsavedDialog.cpp Vector2f.cpp Vector2i.cpp Vector3f.cpp Vector4f.cpp WorldObj.cpp main.cpp
+HEADERS += AboutWindow.h AceLib.h ActLib.h Activity.h ActivityEvent.h ActivityEventProperties.h ActivityEventWindow.h ActivityObject.h ActivityServiceProperties.h ActivityServiceWindow.h ActivityTimetable.h ActivityTimetableProperties.h ActivityTimetableWindow.h ActivityTools.h ActivityTrafficProperties.h ActivityTrafficWindow.h Brush.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ComplexLine.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ConInfoWidget.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ContentHierarchyInfo.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/EngInfoWidget.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/GlobalDefinitions.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/GuiGlCompass.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/MstsSoundDefinition.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ShapeHierarchyInfo.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ShapeHierarchyWindow.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ShapeInfoWidget.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ShapeTemplates.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ShapeTextureInfo.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ShapeTexturesWindow.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ShapeViewerNavigatorWidget.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/ShapeViewerWindow.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/SimpleHud.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/Skydome.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/SoundLib.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/SoundSource.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/SoundVariables.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/TarFile.h C:/Users/Goku/Documents/NetBeansProjects/TSRE5/UriImageDrawThread.h CELoadWindow.h Camera.h CameraConsist.h CameraFree.h CameraRot.h CarSpawnerObj.h ChooseFileDialog.h ClickableLabel.h ConEditorWindow.h ConLib.h ConListWidget.h ConUnitsWidget.h Consist.h Coords.h CoordsGpx.h CoordsKml.h CoordsMkr.h CoordsRoutePlaces.h DxtLib.h DynTrackObj.h EditFileNameDialog.h Eng.h EngIndex.h EngLib.h EngListWidget.h Environment.h FileBuffer.h FileFunctions.h Flex.h ForestObj.h GLH.h GLMatrix.h GLUU.h Game.h GameObj.h GeoCoordinates.h GeoHgtFile.h GeoTerrainFile.h GeoTerrainLib.h GeoTiffFile.h GeoTools.h GroupObj.h GuiFunct.h HazardObj.h HeightWindow.h ImageLib.h InitScheduler.h Intersections.h LevelCrObj.h LoadProfiler.h LoadWindow.h MapData.h MapDataOSM.h MapDataUrlImage.h MapLib.h MapTileBatch.h MapWindow.h NaviBox.h NaviWindow.h NewRouteWindow.h OSMFeatureStore.h OSMFeatures.h ObjFile.h ObjTools.h OglObj.h OrtsWeatherChange.h OverwriteDialog.h PaintTexLib.h ParserX.h Path.h PickupObj.h PlatformObj.h PlayActivitySelectWindow.h Pointer3d.h PoleObj.h ProceduralMstsDyntrack.h ProceduralShape.h ProceduralShapeCache.h PropertiesAbstract.h PropertiesActivityObject.h PropertiesActivityPath.h PropertiesCarspawner.h PropertiesConsist.h PropertiesDyntrack.h PropertiesForest.h PropertiesGroup.h PropertiesLevelCr.h PropertiesPickup.h PropertiesPlatform.h PropertiesRuler.h PropertiesSiding.h PropertiesSignal.h PropertiesSoundRegion.h PropertiesSoundSource.h PropertiesSpeedpost.h PropertiesStatic.h PropertiesTerrain.h PropertiesTrackItem.h PropertiesTrackObj.h PropertiesTransfer.h PropertiesUndefined.h QuadTree.h RandomConsist.h ReadFile.h Ref.h Route.h RouteBatch.h RouteChecker.h RouteEditorGLWidget.h RouteEditorWindow.h Ruch.h RulerObj.h SFile.h SFileC.h SFileX.h Service.h Shader.h ShapeLib.h ShapeViewWindow.h ShapeViewerGLWidget.h SigCfg.h SignalObj.h SignalShape.h SignalType.h SignalWindow.h SignalWindowLink.h SoundList.h SoundManager.h SoundRegionObj.h SoundSourceObj.h SpeedPost.h SpeedPostDAT.h SpeedpostObj.h StaticBatch.h StaticObj.h SyntheticRoute.h TDB.h TDBTable.h TFile.h TRitem.h TRnode.h TS.h TSection.h TSectionDAT.h Terrain.h TerrainInfo.h TerrainLib.h TerrainLibQt.h TerrainLibSimple.h TerrainTexArray.h TerrainTools.h TerrainTreeWindow.h TerrainWaterWindow.h TerrainWaterWindow2.h TexLib.h TextEditDialog.h TextObj.h Texture.h Tile.h TrWatermarkObj.h TrackItemObj.h TrackObj.h TrackShape.h Traffic.h TrainNetworkEng.h TransferObj.h TransformWorldObjDialog.h Trk.h TrkWindow.h Undo.h UnsavedDialog.h Vector2f.h Vector2i.h Vector3f.h Vector4f.h WorldObj.h
 FORMS +=
 RESOURCES +=
 TRANSLATIONS +=
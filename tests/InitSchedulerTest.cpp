@@ -0,0 +1,47 @@
+/*  This file is part of TSRE5.
+ *
+ *  TSRE5 - train sim game engine and MSTS/OR Editors. 
+ *  Copyright (C) 2016 Piotr Gadecki <pgadecki@gmail.com>
+ *
+ *  Licensed under GNU General Public License 3.0 or later. 
+ *
+ *  See LICENSE.md or https://www.gnu.org/licenses/gpl.html
+ */
+
+#include "Tests.h"
+#include "InitScheduler.h"
+
+// Two widgets painting in turn: what one of them queued must be granted
+// in its own next frame, not taken or cleared by the other.
+bool InitSchedulerInterleavedTest(){
+    InitScheduler a, b;
+    int ownerA = 0, ownerB = 0;
+    bool ok = true;
+
+    a.beginFrame();
+    ok = ok && !InitScheduler::Allow(&ownerA, NULL, 1);
+    a.endFrame();
+    b.beginFrame();
+    ok = ok && !InitScheduler::Allow(&ownerB, NULL, 1);
+    b.endFrame();
+
+    a.beginFrame();
+    ok = ok && a.lastFrame.queued == 1;
+    ok = ok && InitScheduler::Allow(&ownerA, NULL, 1);
+    InitScheduler::Done();
+    a.endFrame();
+    b.beginFrame();
+    ok = ok && b.lastFrame.queued == 1;
+    ok = ok && InitScheduler::Allow(&ownerB, NULL, 1);
+    InitScheduler::Done();
+    b.endFrame();
+
+    // each counts only its own init
+    a.beginFrame();
+    ok = ok && a.lastFrame.done == 1;
+    a.endFrame();
+    b.beginFrame();
+    ok = ok && b.lastFrame.done == 1;
+    b.endFrame();
+    return ok;
+}
@@ -0,0 +1,62 @@
+/*  This file is part of TSRE5.
+ *
+ *  TSRE5 - train sim game engine and MSTS/OR Editors. 
+ *  Copyright (C) 2016 Piotr Gadecki <pgadecki@gmail.com>
+ *
+ *  Licensed under GNU General Public License 3.0 or later. 
+ *
+ *  See LICENSE.md or https://www.gnu.org/licenses/gpl.html
+ */
+
+#include "Tests.h"
+#include "GLMatrix.h"
+#include <QVector>
+#include <QDebug>
+#include <cmath>
+#include <cstdlib>
+
+// Batch math against the scalar versions, on counts around the vector
+// width so the tails are covered too.
+bool BatchKernelsTest(){
+    const int counts[] = {1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 33, 1001};
+    const float tolerance = 1e-5;
+    float maxError[3] = {0, 0, 0};
+    auto compare = [&](int kernel, const QVector<float> &a, const QVector<float> &b){
+        for(int i = 0; i < a.size(); i++)
+            maxError[kernel] = qMax(maxError[kernel], std::fabs(a[i] - b[i]) / qMax(1.0f, std::fabs(a[i])));
+    };
+    std::srand(2);
+    for(int c = 0; c < (int)(sizeof(counts)/sizeof(counts[0])); c++){
+        int count = counts[c];
+        QVector<float> q(count*4), v(count*3), m(16), points(count*9);
+        for(int i = 0; i < count; i++){
+            float *qq = &q[i*4];
+            Vec3::set(qq, std::rand()%200 - 100, std::rand()%200 - 100, std::rand()%200 - 100);
+            qq[3] = std::rand()%200 - 100 + 0.5;
+            Vec4::normalize(qq, qq);
+            Vec3::set(&v[i*3], (std::rand()%20000)*0.1, (std::rand()%2000)*0.1, (std::rand()%20000)*0.1);
+        }
+        for(int i = 0; i < points.size(); i++)
+            points[i] = (std::rand()%20000)*0.01 - 100;
+        Mat4::fromRotationTranslation(m.data(), &q[0], &v[0]);
+
+        QVector<float> scalar(count*16), batch(count*16);
+        Mat4::fromRotationTranslationBatchScalar(scalar.data(), q.data(), v.data(), count);
+        Mat4::fromRotationTranslationBatch(batch.data(), q.data(), v.data(), count);
+        compare(0, scalar, batch);
+
+        QVector<float> scalarM(count*16), batchM(count*16);
+        Mat4::multiplyBatchScalar(scalarM.data(), m.data(), scalar.data(), count);
+        Mat4::multiplyBatch(batchM.data(), m.data(), scalar.data(), count);
+        compare(1, scalarM, batchM);
+
+        // in place, normals and uv between the positions stay as they are
+        QVector<float> scalarP = points, batchP = points;
+        Vec3::transformMat4BatchScalar(scalarP.data(), scalarP.data(), count, 9, m.data());
+        Vec3::transformMat4Batch(batchP.data(), batchP.data(), count, 9, m.data());
+        compare(2, scalarP, batchP);
+    }
+
+    qDebug() << Mat4::BatchKernels() << maxError[0] << maxError[1] << maxError[2];
+    return maxError[0] <= tolerance && maxError[1] <= tolerance && maxError[2] <= tolerance;
+}
@@ -0,0 +1,28 @@
+/*  This file is part of TSRE5.
+ *
+ *  TSRE5 - train sim game engine and MSTS/OR Editors. 
+ *  Copyright (C) 2016 Piotr Gadecki <pgadecki@gmail.com>
+ *
+ *  Licensed under GNU General Public License 3.0 or later. 
+ *
+ *  See LICENSE.md or https://www.gnu.org/licenses/gpl.html
+ */
+
+#include <QDebug>
+#include "Tests.h"
+#include "Game.h"
+
+// Game.cpp is not linked, only the settings the tested code reads.
+float Game::objInitBudget = 4;
+
+static int check(const char* name, bool ok){
+    qDebug() << name << (ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char *argv[]){
+    int failed = 0;
+    failed += check("scheduler", InitSchedulerInterleavedTest());
+    failed += check("kernels", BatchKernelsTest());
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,14 @@
+# Checks of engine parts that run without a route or a GL context.
+# qmake tests.pro && make && ./tsre5-tests
+TEMPLATE = app
+TARGET = tsre5-tests
+QT = core
+CONFIG += console c++11
+CONFIG -= app_bundle
+INCLUDEPATH += ..
+HEADERS += Tests.h
+SOURCES += main.cpp \
+    InitSchedulerTest.cpp \
+    KernelTest.cpp \
+    ../InitScheduler.cpp \
+    ../GLMatrix.cpp
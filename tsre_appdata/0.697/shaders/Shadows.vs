@@ -1,6 +1,7 @@
 #version 130
 
 attribute vec4 vertex;
+attribute vec4 instance; // instanced draws: offset xyz, scale
 attribute vec3 normal;
 attribute vec2 aTextureCoord;
 
@@ -13,6 +14,7 @@ uniform mat4 uMSMatrix;
 out vec2 vTextureCoord;
 
 void main() {
-    gl_Position = uShadowPMatrix * uMVMatrix * uMSMatrix * vertex;
+    vec4 position = vec4(vertex.xyz * instance.w + instance.xyz, 1.0);
+    gl_Position = uShadowPMatrix * uMVMatrix * uMSMatrix * position;
     vTextureCoord = aTextureCoord;
 }
@@ -1,6 +1,7 @@
 #version 130
 
 attribute vec4 vertex;
+attribute vec4 instance; // instanced draws: offset xyz, scale
 attribute vec3 normal;
 attribute vec2 aTextureCoord;
 attribute float alpha;
@@ -13,6 +14,9 @@ uniform mat4 uFMatrix;
 uniform mat4 uMVMatrix;
 uniform mat4 uMSMatrix;
 uniform float fogDensity;
+// terrain drawn from a texture array: layer of each patch, 4 per vec4
+uniform vec4 patchLayers[64];
+uniform float patchVertices;
 
 varying vec2 vTextureCoord;
 varying float fogFactor;
@@ -20,12 +24,14 @@ varying vec3 vNormal;
 varying vec4 shadowPos;
 varying vec4 shadow2Pos;
 varying float vAlpha;
+varying float vLayer;
 
 void main() {
-    shadowPos = uShadowPMatrix * uMVMatrix * uMSMatrix * vertex;
-    shadow2Pos = uShadow2PMatrix * uMVMatrix * uMSMatrix * vertex;
-    gl_Position = uPMatrix * uMVMatrix * uMSMatrix * vertex;
-    vec4 fogPosition = uFMatrix * uMVMatrix * uMSMatrix * vertex;
+    vec4 position = vec4(vertex.xyz * instance.w + instance.xyz, 1.0);
+    shadowPos = uShadowPMatrix * uMVMatrix * uMSMatrix * position;
+    shadow2Pos = uShadow2PMatrix * uMVMatrix * uMSMatrix * position;
+    gl_Position = uPMatrix * uMVMatrix * uMSMatrix * position;
+    vec4 fogPosition = uFMatrix * uMVMatrix * uMSMatrix * position;
     vTextureCoord = aTextureCoord;
 
     fogFactor = sqrt((fogPosition.x)*(fogPosition.x) + (fogPosition.z)*(fogPosition.z))/(lod*1.4);
@@ -36,5 +42,10 @@ void main() {
 
     vNormal = normal;
     vAlpha = alpha;
+    vLayer = 0.0;
+    if(patchVertices > 0.0){
+        int p = gl_VertexID / int(patchVertices);
+        vLayer = patchLayers[p / 4][p % 4];
+    }
 
 }
@@ -6,6 +6,7 @@ varying vec3 vNormal;
 varying vec4 shadowPos;
 varying vec4 shadow2Pos;
 varying float vAlpha;
+varying float vLayer;
 
 uniform float textureEnabled;
 uniform int shadowsEnabled;
@@ -23,6 +24,8 @@ uniform vec4 specularColor;
 uniform vec3 lightDirection;
 uniform sampler2D uSampler;
 uniform sampler2D uSampler2;
+uniform sampler2DArray uSamplerArray;
+uniform float textureArrayEnabled;
 uniform sampler2DShadow shadow1;
 uniform sampler2DShadow shadow2;
 uniform float secondTexEnabled;
@@ -65,7 +68,10 @@ void main() {
         if(textureEnabled == 0) {
             gl_FragColor = shapeColor;
         } else {
-            gl_FragColor = texture(uSampler, vec2(vTextureCoord.s, vTextureCoord.t));
+            if(textureArrayEnabled > 0.0)
+                gl_FragColor = texture(uSamplerArray, vec3(vTextureCoord.s, vTextureCoord.t, floor(vLayer + 0.5)));
+            else
+                gl_FragColor = texture(uSampler, vec2(vTextureCoord.s, vTextureCoord.t));
             vec4 tex2 = texture(uSampler2, vec2(vTextureCoord.s*secondTexEnabled, vTextureCoord.t*secondTexEnabled));
             float isSecondTexEnabled = sign(secondTexEnabled);
             gl_FragColor = gl_FragColor*(1-isSecondTexEnabled) + gl_FragColor*tex2*2.0*isSecondTexEnabled;
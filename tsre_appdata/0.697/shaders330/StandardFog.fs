@@ -6,6 +6,7 @@ in vec3 vNormal;
 in vec4 shadowPos;
 in vec4 shadow2Pos;
 in float vAlpha;
+in float vLayer;
 out vec4 fragColor;
 
 uniform float textureEnabled;
@@ -24,6 +25,8 @@ uniform vec4 specularColor;
 uniform vec3 lightDirection;
 uniform sampler2D uSampler;
 uniform sampler2D uSampler2;
+uniform sampler2DArray uSamplerArray;
+uniform float textureArrayEnabled;
 uniform sampler2DShadow shadow1;
 uniform sampler2DShadow shadow2;
 uniform float secondTexEnabled;
@@ -66,7 +69,10 @@ void main() {
         if(textureEnabled == 0) {
             fragColor = shapeColor;
         } else {
-            fragColor = texture(uSampler, vec2(vTextureCoord.s, vTextureCoord.t));
+            if(textureArrayEnabled > 0.0)
+                fragColor = texture(uSamplerArray, vec3(vTextureCoord.s, vTextureCoord.t, floor(vLayer + 0.5)));
+            else
+                fragColor = texture(uSampler, vec2(vTextureCoord.s, vTextureCoord.t));
             vec4 tex2 = texture(uSampler2, vec2(vTextureCoord.s*secondTexEnabled, vTextureCoord.t*secondTexEnabled));
             float isSecondTexEnabled = sign(secondTexEnabled);
             fragColor = fragColor*(1-isSecondTexEnabled) + fragColor*tex2*2.0*isSecondTexEnabled;
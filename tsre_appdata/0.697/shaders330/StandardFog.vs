@@ -1,6 +1,7 @@
 #version 330 core
 
 in vec4 vertex;
+in vec4 instance; // instanced draws: offset xyz, scale
 in vec3 normal;
 in vec2 aTextureCoord;
 in float alpha;
@@ -13,6 +14,9 @@ uniform mat4 uFMatrix;
 uniform mat4 uMVMatrix;
 uniform mat4 uMSMatrix;
 uniform float fogDensity;
+// terrain drawn from a texture array: layer of each patch, 4 per vec4
+uniform vec4 patchLayers[64];
+uniform float patchVertices;
 
 out vec2 vTextureCoord;
 out float fogFactor;
@@ -20,12 +24,14 @@ out vec3 vNormal;
 out vec4 shadowPos;
 out vec4 shadow2Pos;
 out float vAlpha;
+out float vLayer;
 
 void main() {
-    shadowPos = uShadowPMatrix * uMVMatrix * uMSMatrix * vertex;
-    shadow2Pos = uShadow2PMatrix * uMVMatrix * uMSMatrix * vertex;
-    gl_Position = uPMatrix * uMVMatrix * uMSMatrix * vertex;
-    vec4 fogPosition = uFMatrix * uMVMatrix * uMSMatrix * vertex;
+    vec4 position = vec4(vertex.xyz * instance.w + instance.xyz, 1.0);
+    shadowPos = uShadowPMatrix * uMVMatrix * uMSMatrix * position;
+    shadow2Pos = uShadow2PMatrix * uMVMatrix * uMSMatrix * position;
+    gl_Position = uPMatrix * uMVMatrix * uMSMatrix * position;
+    vec4 fogPosition = uFMatrix * uMVMatrix * uMSMatrix * position;
     vTextureCoord = aTextureCoord;
 
     fogFactor = sqrt((fogPosition.x)*(fogPosition.x) + (fogPosition.z)*(fogPosition.z))/(lod*1.4);
@@ -36,5 +42,10 @@ void main() {
 
     vNormal = normal;
     vAlpha = alpha;
+    vLayer = 0.0;
+    if(patchVertices > 0.0){
+        int p = gl_VertexID / int(patchVertices);
+        vLayer = patchLayers[p / 4][p % 4];
+    }
 
 }